@@ -54,6 +54,10 @@ public:
     virtual bool is_openable_by_jailed_processes() const { return false; }
     void process_next_queued_request(Badge<AsyncDeviceRequest>, AsyncDeviceRequest const&);
 
+    // Devices that can keep several requests in flight start every request as soon as it is made,
+    // instead of only once the request before it has completed.
+    virtual bool starts_requests_immediately() const { return false; }
+
     template<typename AsyncRequestType, typename... Args>
     ErrorOr<NonnullLockRefPtr<AsyncRequestType>> try_make_request(Args&&... args)
     {
@@ -61,7 +65,7 @@ public:
         SpinlockLocker lock(m_requests_lock);
         bool was_empty = m_requests.is_empty();
         TRY(m_requests.try_append(request));
-        if (was_empty)
+        if (was_empty || starts_requests_immediately())
             request->do_start(move(lock));
         return request;
     }
@@ -5,6 +5,7 @@
  */
 
 #include <AK/IntrusiveList.h>
+#include <AK/QuickSort.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
 #include <Kernel/Process.h>
@@ -16,20 +17,46 @@ struct CacheEntry {
     BlockBasedFileSystem::BlockIndex block_index { 0 };
     u8* data { nullptr };
     bool has_data { false };
+    bool is_in_use { false };
+};
+
+// The cache is made up of segments of entries, so it can grow into free physical
+// memory when it's being thrashed, and give segments back when memory runs low.
+struct CacheSegment {
+    NonnullOwnPtr<KBuffer> block_data;
+    NonnullOwnPtr<KBuffer> entries_buffer;
+    size_t entry_count { 0 };
+
+    CacheEntry* entries() { return (CacheEntry*)entries_buffer->data(); }
 };
 
 class DiskCache {
 public:
-    static constexpr size_t EntryCount = 10000;
-    explicit DiskCache(BlockBasedFileSystem& fs, NonnullOwnPtr<KBuffer> cached_block_data, NonnullOwnPtr<KBuffer> entries_buffer)
-        : m_fs(fs)
-        , m_cached_block_data(move(cached_block_data))
-        , m_entries(move(entries_buffer))
+    static constexpr size_t SegmentSize = 4 * MiB;
+    // Adjacent blocks are read and written in requests of up to this size.
+    static constexpr size_t MaximumClusterSize = 256 * KiB;
+
+    // The cache only grows while at least 1/GrowthReserveRatio of physical memory is uncommitted,
+    // and shrinks back down once less than 1/ShrinkReserveRatio of it is left.
+    // NOTE: An eighth of memory (128 MiB out of 1 GiB) leaves processes plenty of room to allocate
+    //       before the cache has to give anything back. The shrink threshold is half of that, so
+    //       there's a gap between the two where the cache neither grows nor shrinks. Otherwise a
+    //       cache sitting right at the threshold would allocate and free a segment on every miss.
+    //       Either way, the MemoryManager can still take segments back when it runs out of memory
+    //       (see try_release_physical_pages()), so these only decide when we give memory back early.
+    static constexpr size_t GrowthReserveRatio = 8;
+    static constexpr size_t ShrinkReserveRatio = 16;
+    // No single cache ever takes up more than 1/MaximumSizeRatio of physical memory.
+    static constexpr size_t MaximumSizeRatio = 2;
+
+    static ErrorOr<NonnullOwnPtr<DiskCache>> try_create(BlockBasedFileSystem& fs)
     {
-        for (size_t i = 0; i < EntryCount; ++i) {
-            entries()[i].data = m_cached_block_data->data() + i * m_fs->block_size();
-            m_clean_list.append(entries()[i]);
-        }
+        auto cluster_size = max(MaximumClusterSize, fs.block_size());
+        auto read_cluster_buffer = TRY(KBuffer::try_create_with_size("BlockBasedFS: Read cluster buffer"sv, cluster_size));
+        auto write_cluster_buffer = TRY(KBuffer::try_create_with_size("BlockBasedFS: Write cluster buffer"sv, cluster_size));
+        auto cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(fs, move(read_cluster_buffer), move(write_cluster_buffer))));
+        TRY(cache->try_grow());
+        return cache;
     }
 
     ~DiskCache() = default;
@@ -65,47 +92,214 @@ public:
 
     ErrorOr<CacheEntry*> ensure(BlockBasedFileSystem::BlockIndex block_index) const
     {
-        if (auto* entry = get(block_index))
+        if (auto* entry = get(block_index)) {
+            ++m_statistics.hits;
             return entry;
+        }
+
+        ++m_statistics.misses;
+        return ensure_new_entry(block_index);
+    }
+
+    // For blocks that the caller already knows aren't cached. They are counted as prefetches rather than
+    // misses, as the read that actually wants the block is going to find it in the cache.
+    ErrorOr<CacheEntry*> add_prefetched(BlockBasedFileSystem::BlockIndex block_index) const
+    {
+        VERIFY(!get(block_index));
+        ++m_statistics.prefetches;
+        return ensure_new_entry(block_index);
+    }
+
+    template<typename Callback>
+    void for_each_dirty_entry(Callback callback)
+    {
+        for (auto& entry : m_dirty_list)
+            callback(entry);
+    }
+
+    // Calls the callback with runs of dirty blocks that are adjacent on disk, in block order.
+    template<typename Callback>
+    void for_each_dirty_cluster(Callback callback)
+    {
+        auto block_size = m_fs->block_size();
+
+        Vector<CacheEntry*> dirty_entries;
+        for (auto& entry : m_dirty_list) {
+            if (dirty_entries.try_append(&entry).is_error()) {
+                // We're out of memory, so fall back to writing out one block at a time.
+                for_each_dirty_entry([&](CacheEntry& entry) {
+                    callback(entry.block_index, ReadonlyBytes { entry.data, block_size });
+                });
+                return;
+            }
+        }
+        quick_sort(dirty_entries, [](auto* a, auto* b) { return a->block_index < b->block_index; });
+
+        auto max_blocks_per_cluster = max_blocks_per_request();
+        for (size_t i = 0; i < dirty_entries.size();) {
+            auto first_block_index = dirty_entries[i]->block_index;
+            size_t block_count = 1;
+            while (i + block_count < dirty_entries.size()
+                && block_count < max_blocks_per_cluster
+                && dirty_entries[i + block_count]->block_index.value() == first_block_index.value() + block_count)
+                ++block_count;
+
+            if (block_count == 1) {
+                callback(first_block_index, ReadonlyBytes { dirty_entries[i]->data, block_size });
+            } else {
+                for (size_t j = 0; j < block_count; ++j)
+                    memcpy(m_write_cluster_buffer->data() + j * block_size, dirty_entries[i + j]->data, block_size);
+                callback(first_block_index, ReadonlyBytes { m_write_cluster_buffer->data(), block_count * block_size });
+            }
+            i += block_count;
+        }
+    }
+
+    size_t max_blocks_per_request() const { return m_read_cluster_buffer->size() / m_fs->block_size(); }
+
+    // NOTE: Writes use a separate buffer, as ensure() may need to flush writes while we're reading ahead.
+    u8* read_cluster_buffer() const { return m_read_cluster_buffer->data(); }
+
+    void release_memory_if_under_pressure()
+    {
+        // We always keep the first segment around.
+        while (m_segments.size() > 1 && is_under_memory_pressure()) {
+            if (!try_release_last_segment())
+                break;
+        }
+    }
+
+    // Releases clean segments until at least page_count pages were given back, and returns how many were.
+    size_t release_physical_pages(size_t page_count)
+    {
+        size_t released_page_count = 0;
+        while (released_page_count < page_count && m_segments.size() > 1) {
+            auto segment_page_count = try_release_last_segment();
+            if (!segment_page_count)
+                break;
+            released_page_count += segment_page_count;
+        }
+        return released_page_count;
+    }
+
+    BlockBasedFileSystem::CacheStatistics statistics() const
+    {
+        auto statistics = m_statistics;
+        statistics.size = m_entry_count * m_fs->block_size();
+        return statistics;
+    }
+
+private:
+    DiskCache(BlockBasedFileSystem& fs, NonnullOwnPtr<KBuffer> read_cluster_buffer, NonnullOwnPtr<KBuffer> write_cluster_buffer)
+        : m_fs(fs)
+        , m_read_cluster_buffer(move(read_cluster_buffer))
+        , m_write_cluster_buffer(move(write_cluster_buffer))
+    {
+    }
+
+    size_t entries_per_segment() const { return max(SegmentSize / m_fs->block_size(), 1ul); }
+
+    static bool is_under_memory_pressure()
+    {
+        auto memory_info = MM.get_system_memory_info();
+        return memory_info.physical_pages_uncommitted < memory_info.physical_pages / ShrinkReserveRatio;
+    }
+
+    bool can_grow() const
+    {
+        auto memory_info = MM.get_system_memory_info();
+        auto segment_page_count = ceil_div(entries_per_segment() * m_fs->block_size(), static_cast<u64>(PAGE_SIZE));
+        auto cache_page_count = ceil_div(m_entry_count * m_fs->block_size(), static_cast<u64>(PAGE_SIZE));
+        if (cache_page_count + segment_page_count > memory_info.physical_pages / MaximumSizeRatio)
+            return false;
+        return memory_info.physical_pages_uncommitted >= memory_info.physical_pages / GrowthReserveRatio + segment_page_count;
+    }
+
+    ErrorOr<void> try_grow() const
+    {
+        auto entry_count = entries_per_segment();
+        auto block_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache blocks"sv, entry_count * m_fs->block_size()));
+        auto entries_buffer = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache entries"sv, entry_count * sizeof(CacheEntry)));
+        TRY(m_hash.try_ensure_capacity(m_entry_count + entry_count));
+        TRY(m_segments.try_append({ move(block_data), move(entries_buffer), entry_count }));
+
+        auto& segment = m_segments.last();
+        for (size_t i = 0; i < entry_count; ++i) {
+            auto& entry = segment.entries()[i];
+            entry.data = segment.block_data->data() + i * m_fs->block_size();
+            // Unused entries go to the back of the clean list, so they get picked before anything gets evicted.
+            m_clean_list.append(entry);
+        }
+        m_entry_count += entry_count;
+        dbgln_if(BBFS_DEBUG, "DiskCache: Grew to {} entries", m_entry_count);
+        return {};
+    }
+
+    // Returns the number of pages that were released, which is 0 if the segment still has dirty entries.
+    size_t try_release_last_segment()
+    {
+        auto& segment = m_segments.last();
+        for (size_t i = 0; i < segment.entry_count; ++i) {
+            if (entry_is_dirty(segment.entries()[i]))
+                return 0;
+        }
+        for (size_t i = 0; i < segment.entry_count; ++i) {
+            auto& entry = segment.entries()[i];
+            if (entry.is_in_use) {
+                m_hash.remove(entry.block_index);
+                ++m_statistics.evictions;
+            }
+            m_clean_list.remove(entry);
+        }
+        auto page_count = ceil_div(segment.block_data->size(), static_cast<size_t>(PAGE_SIZE)) + ceil_div(segment.entries_buffer->size(), static_cast<size_t>(PAGE_SIZE));
+        m_entry_count -= segment.entry_count;
+        m_segments.take_last();
+        dbgln_if(BBFS_DEBUG, "DiskCache: Shrunk to {} entries", m_entry_count);
+        return page_count;
+    }
+
+    ErrorOr<CacheEntry*> ensure_new_entry(BlockBasedFileSystem::BlockIndex block_index) const
+    {
+        // Rather than evicting something, see if we can make room for more entries first.
+        if (auto* last_entry = m_clean_list.last(); (!last_entry || last_entry->is_in_use) && can_grow()) {
+            if (auto result = try_grow(); result.is_error())
+                dbgln_if(BBFS_DEBUG, "DiskCache: Failed to grow: {}", result.error());
+        }
 
         if (m_clean_list.is_empty()) {
             // Not a single clean entry! Flush writes and try again.
             // NOTE: We want to make sure we only call FileBackedFileSystem flush here,
             //       not some FileBackedFileSystem subclass flush!
             m_fs->flush_writes_impl();
-            return ensure(block_index);
+            return ensure_new_entry(block_index);
         }
 
         VERIFY(m_clean_list.last());
         auto& new_entry = *m_clean_list.last();
         m_clean_list.prepend(new_entry);
 
-        m_hash.remove(new_entry.block_index);
+        if (new_entry.is_in_use) {
+            m_hash.remove(new_entry.block_index);
+            ++m_statistics.evictions;
+        }
         TRY(m_hash.try_set(block_index, &new_entry));
 
         new_entry.block_index = block_index;
         new_entry.has_data = false;
+        new_entry.is_in_use = true;
 
         return &new_entry;
     }
 
-    CacheEntry const* entries() const { return (CacheEntry const*)m_entries->data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries->data(); }
-
-    template<typename Callback>
-    void for_each_dirty_entry(Callback callback)
-    {
-        for (auto& entry : m_dirty_list)
-            callback(entry);
-    }
-
-private:
     mutable NonnullRefPtr<BlockBasedFileSystem> m_fs;
     mutable IntrusiveList<&CacheEntry::list_node> m_dirty_list;
     mutable IntrusiveList<&CacheEntry::list_node> m_clean_list;
     mutable HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
-    NonnullOwnPtr<KBuffer> m_cached_block_data;
-    NonnullOwnPtr<KBuffer> m_entries;
+    mutable Vector<CacheSegment> m_segments;
+    NonnullOwnPtr<KBuffer> m_read_cluster_buffer;
+    NonnullOwnPtr<KBuffer> m_write_cluster_buffer;
+    mutable size_t m_entry_count { 0 };
+    mutable BlockBasedFileSystem::CacheStatistics m_statistics;
 };
 
 BlockBasedFileSystem::BlockBasedFileSystem(OpenFileDescription& file_description)
@@ -114,11 +308,15 @@ BlockBasedFileSystem::BlockBasedFileSystem(OpenFileDescription& file_description
     VERIFY(file_description.file().is_seekable());
 }
 
-BlockBasedFileSystem::~BlockBasedFileSystem() = default;
+BlockBasedFileSystem::~BlockBasedFileSystem()
+{
+    MM.unregister_physical_memory_reclaimer(*this);
+}
 
 void BlockBasedFileSystem::remove_disk_cache_before_last_unmount()
 {
     VERIFY(m_lock.is_locked());
+    MM.unregister_physical_memory_reclaimer(*this);
     m_cache.with_exclusive([&](auto& cache) {
         cache.clear();
     });
@@ -129,13 +327,12 @@ ErrorOr<void> BlockBasedFileSystem::initialize_while_locked()
     VERIFY(m_lock.is_locked());
     VERIFY(!is_initialized_while_locked());
     VERIFY(block_size() != 0);
-    auto cached_block_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache blocks"sv, DiskCache::EntryCount * block_size()));
-    auto entries_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache entries"sv, DiskCache::EntryCount * sizeof(CacheEntry)));
-    auto disk_cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(*this, move(cached_block_data), move(entries_data))));
+    auto disk_cache = TRY(DiskCache::try_create(*this));
 
     m_cache.with_exclusive([&](auto& cache) {
         cache = move(disk_cache);
     });
+    MM.register_physical_memory_reclaimer(*this);
     return {};
 }
 
@@ -249,6 +446,45 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
     });
 }
 
+ErrorOr<void> BlockBasedFileSystem::read_ahead_blocks(BlockIndex index, size_t count) const
+{
+    VERIFY(m_logical_block_size);
+    dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_ahead_blocks {}, count={}", index, count);
+
+    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
+        auto max_blocks_per_request = cache->max_blocks_per_request();
+        for (size_t i = 0; i < count;) {
+            // Blocks that are already cached may be dirty, so we must not overwrite them with what's on disk.
+            if (cache->get(BlockIndex { index.value() + i })) {
+                ++i;
+                continue;
+            }
+
+            size_t block_count = 1;
+            while (i + block_count < count
+                && block_count < max_blocks_per_request
+                && !cache->get(BlockIndex { index.value() + i + block_count }))
+                ++block_count;
+
+            auto base_offset = (index.value() + i) * block_size();
+            auto cluster_buffer = UserOrKernelBuffer::for_kernel_buffer(cache->read_cluster_buffer());
+            auto nread = TRY(file_description().read(cluster_buffer, base_offset, block_count * block_size()));
+            if (nread < block_size())
+                return {};
+            block_count = min(block_count, nread / block_size());
+
+            for (size_t j = 0; j < block_count; ++j) {
+                // We checked above that none of these blocks are cached.
+                auto* entry = TRY(cache->add_prefetched(BlockIndex { index.value() + i + j }));
+                memcpy(entry->data, cache->read_cluster_buffer() + j * block_size(), block_size());
+                entry->has_data = true;
+            }
+            i += block_count;
+        }
+        return {};
+    });
+}
+
 ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count, UserOrKernelBuffer& buffer, bool allow_cache) const
 {
     VERIFY(m_logical_block_size);
@@ -287,11 +523,11 @@ void BlockBasedFileSystem::flush_writes_impl()
     m_cache.with_exclusive([&](auto& cache) {
         if (!cache->is_dirty())
             return;
-        cache->for_each_dirty_entry([&](CacheEntry& entry) {
-            auto base_offset = entry.block_index.value() * block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-            [[maybe_unused]] auto rc = file_description().write(base_offset, entry_data_buffer, block_size());
-            ++count;
+        cache->for_each_dirty_cluster([&](BlockIndex first_block_index, ReadonlyBytes data) {
+            auto base_offset = first_block_index.value() * block_size();
+            auto cluster_data_buffer = UserOrKernelBuffer::for_kernel_buffer(const_cast<u8*>(data.data()));
+            [[maybe_unused]] auto rc = file_description().write(base_offset, cluster_data_buffer, data.size());
+            count += data.size() / block_size();
         });
         cache->mark_all_clean();
         dbgln("{}: Flushed {} blocks to disk", class_name(), count);
@@ -301,6 +537,33 @@ void BlockBasedFileSystem::flush_writes_impl()
 void BlockBasedFileSystem::flush_writes()
 {
     flush_writes_impl();
+
+    // Everything is clean now, which makes this a good time to give memory back if it's needed elsewhere.
+    m_cache.with_exclusive([&](auto& cache) {
+        if (cache)
+            cache->release_memory_if_under_pressure();
+    });
+}
+
+size_t BlockBasedFileSystem::try_release_physical_pages(size_t page_count)
+{
+    // The MemoryManager calls this with its lock held, so we can't wait for the cache to become available.
+    // If it's in use, even by the current thread, we simply don't have anything to give back right now.
+    size_t released_page_count = 0;
+    m_cache.try_with_exclusive([&](auto& cache) {
+        if (cache)
+            released_page_count = cache->release_physical_pages(page_count);
+    });
+    return released_page_count;
+}
+
+BlockBasedFileSystem::CacheStatistics BlockBasedFileSystem::cache_statistics() const
+{
+    return m_cache.with_exclusive([&](auto& cache) -> CacheStatistics {
+        if (!cache)
+            return {};
+        return cache->statistics();
+    });
 }
 
 }
@@ -8,10 +8,13 @@
 
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/Locking/MutexProtected.h>
+#include <Kernel/Memory/MemoryManager.h>
 
 namespace Kernel {
 
-class BlockBasedFileSystem : public FileBackedFileSystem {
+class BlockBasedFileSystem
+    : public FileBackedFileSystem
+    , public Memory::PhysicalMemoryReclaimer {
 public:
     AK_TYPEDEF_DISTINCT_ORDERED_ID(u64, BlockIndex);
 
@@ -22,6 +25,16 @@ public:
     virtual void flush_writes() override;
     void flush_writes_impl();
 
+    struct CacheStatistics {
+        u64 hits { 0 };
+        u64 misses { 0 };
+        // Blocks that were read ahead of time. The reads that want them count as hits.
+        u64 prefetches { 0 };
+        u64 evictions { 0 };
+        u64 size { 0 };
+    };
+    CacheStatistics cache_statistics() const;
+
 protected:
     explicit BlockBasedFileSystem(OpenFileDescription&);
 
@@ -29,6 +42,8 @@ protected:
 
     ErrorOr<void> read_block(BlockIndex, UserOrKernelBuffer*, size_t count, u64 offset = 0, bool allow_cache = true) const;
     ErrorOr<void> read_blocks(BlockIndex, unsigned count, UserOrKernelBuffer&, bool allow_cache = true) const;
+    // Pulls the given blocks into the cache, reading runs of uncached blocks with a single request each.
+    ErrorOr<void> read_ahead_blocks(BlockIndex, size_t count) const;
 
     ErrorOr<void> raw_read(BlockIndex, UserOrKernelBuffer&);
     ErrorOr<void> raw_write(BlockIndex, UserOrKernelBuffer const&);
@@ -44,6 +59,9 @@ protected:
     void remove_disk_cache_before_last_unmount();
 
 private:
+    virtual bool is_block_based() const override { return true; }
+    virtual size_t try_release_physical_pages(size_t page_count) override;
+
     DiskCache& cache() const;
     void flush_specific_block_if_needed(BlockIndex index);
 
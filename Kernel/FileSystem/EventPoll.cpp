@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Singleton.h>
+#include <Kernel/API/POSIX/poll.h>
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+static Singleton<SpinlockProtected<EventPoll::AllInstancesList>> s_all_instances;
+
+SpinlockProtected<EventPoll::AllInstancesList>& EventPoll::all_instances()
+{
+    return s_all_instances;
+}
+
+static BlockFlags block_flags_for_events(u32 events)
+{
+    BlockFlags block_flags = BlockFlags::WriteError | BlockFlags::WriteHangUp; // always want EPOLLERR, EPOLLHUP
+    if (events & EPOLLIN)
+        block_flags |= BlockFlags::Read;
+    if (events & EPOLLOUT)
+        block_flags |= BlockFlags::Write;
+    if (events & EPOLLPRI)
+        block_flags |= BlockFlags::ReadPriority;
+    if (events & EPOLLWRBAND)
+        block_flags |= BlockFlags::WritePriority;
+    if (events & EPOLLRDHUP)
+        block_flags |= BlockFlags::ReadHangUp;
+    return block_flags;
+}
+
+static u32 events_for_unblocked_flags(BlockFlags unblocked_flags)
+{
+    u32 events = 0;
+    if (has_flag(unblocked_flags, BlockFlags::WriteHangUp))
+        events |= EPOLLHUP;
+    if (has_flag(unblocked_flags, BlockFlags::WriteError)) {
+        events |= EPOLLERR;
+        return events;
+    }
+    if (has_flag(unblocked_flags, BlockFlags::Read))
+        events |= EPOLLIN;
+    if (has_flag(unblocked_flags, BlockFlags::ReadPriority))
+        events |= EPOLLPRI;
+    if (!has_flag(unblocked_flags, BlockFlags::WriteHangUp) && has_flag(unblocked_flags, BlockFlags::Write))
+        events |= EPOLLOUT;
+    if (has_flag(unblocked_flags, BlockFlags::WritePriority))
+        events |= EPOLLWRBAND;
+    if (has_flag(unblocked_flags, BlockFlags::ReadHangUp))
+        events |= EPOLLRDHUP;
+    return events;
+}
+
+EventPoll::Interest::Interest(EventPoll& event_poll, OpenFileDescription& description, epoll_event const& event)
+    : m_event_poll(event_poll)
+    , m_description(description)
+    , m_blocker_set(description.blocker_set())
+{
+    set_event(event);
+}
+
+void EventPoll::Interest::set_event(epoll_event const& event)
+{
+    m_block_flags = block_flags_for_events(event.events);
+    m_events = event.events;
+    m_data = event.data;
+    m_is_disabled = false;
+}
+
+void EventPoll::Interest::file_state_may_have_changed()
+{
+    m_event_poll.interest_did_signal(*this);
+}
+
+ErrorOr<NonnullLockRefPtr<EventPoll>> EventPoll::try_create()
+{
+    auto event_poll = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) EventPoll));
+    all_instances().with([&](auto& list) { list.append(*event_poll); });
+    return event_poll;
+}
+
+EventPoll::~EventPoll()
+{
+    (void)close();
+}
+
+bool EventPoll::can_read(OpenFileDescription const&, u64) const
+{
+    SpinlockLocker locker(m_lock);
+    return !m_ready_list.is_empty();
+}
+
+ErrorOr<void> EventPoll::close()
+{
+    all_instances().with([&](auto& list) {
+        while (!m_interests.is_empty())
+            remove_interest_locked(*m_interests.begin()->key);
+        if (m_list_node.is_in_list())
+            list.remove(*this);
+    });
+    return {};
+}
+
+ErrorOr<NonnullOwnPtr<KString>> EventPoll::pseudo_path(OpenFileDescription const&) const
+{
+    return KString::formatted("EventPoll:{}", this);
+}
+
+ErrorOr<void> EventPoll::add_interest(OpenFileDescription& description, epoll_event const& event)
+{
+    // Nesting would make the blocker sets of event polls call into each other.
+    if (description.is_event_poll())
+        return EINVAL;
+
+    auto interest = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Interest(*this, description, event)));
+
+    return all_instances().with([&](auto&) -> ErrorOr<void> {
+        if (m_interests.contains(&description))
+            return EEXIST;
+        auto& new_interest = *interest;
+        TRY(m_interests.try_set(&description, move(interest)));
+        description.set_has_event_poll_interest({});
+        new_interest.m_blocker_set.add_observer(new_interest);
+        // If the description is ready already, this puts the interest on the ready list right away.
+        interest_did_signal(new_interest);
+        return {};
+    });
+}
+
+ErrorOr<void> EventPoll::modify_interest(OpenFileDescription& description, epoll_event const& event)
+{
+    return all_instances().with([&](auto&) -> ErrorOr<void> {
+        auto it = m_interests.find(&description);
+        if (it == m_interests.end())
+            return ENOENT;
+        auto& interest = *it->value;
+        {
+            SpinlockLocker locker(m_lock);
+            interest.set_event(event);
+            if (!interest.m_ready_list_node.is_in_list() && description.should_unblock(interest.m_block_flags) != BlockFlags::None)
+                m_ready_list.append(interest);
+        }
+        m_wait_queue.wake_all();
+        evaluate_block_conditions();
+        return {};
+    });
+}
+
+ErrorOr<void> EventPoll::remove_interest(OpenFileDescription& description)
+{
+    return all_instances().with([&](auto&) -> ErrorOr<void> {
+        if (!m_interests.contains(&description))
+            return ENOENT;
+        remove_interest_locked(description);
+        return {};
+    });
+}
+
+void EventPoll::remove_interest_locked(OpenFileDescription& description)
+{
+    auto it = m_interests.find(&description);
+    VERIFY(it != m_interests.end());
+    auto interest = move(it->value);
+    m_interests.remove(it);
+    // Once this returns, the description won't signal the interest anymore.
+    interest->m_blocker_set.remove_observer(*interest);
+    SpinlockLocker locker(m_lock);
+    if (interest->m_ready_list_node.is_in_list())
+        m_ready_list.remove(*interest);
+}
+
+void EventPoll::forget_description(Badge<OpenFileDescription>, OpenFileDescription& description)
+{
+    all_instances().with([&](auto& list) {
+        for (auto& event_poll : list) {
+            if (event_poll.m_interests.contains(&description))
+                event_poll.remove_interest_locked(description);
+        }
+    });
+}
+
+void EventPoll::interest_did_signal(Interest& interest)
+{
+    {
+        SpinlockLocker locker(m_lock);
+        if (interest.m_is_disabled || interest.m_ready_list_node.is_in_list())
+            return;
+        if (interest.m_description.should_unblock(interest.m_block_flags) == BlockFlags::None)
+            return;
+        m_ready_list.append(interest);
+    }
+    m_wait_queue.wake_all();
+    evaluate_block_conditions();
+}
+
+size_t EventPoll::collect_ready_events(Span<epoll_event> events)
+{
+    SpinlockLocker locker(m_lock);
+
+    // Level-triggered interests that are still ready go back to the end of the list, so
+    // stop once every interest that was on it has been looked at.
+    size_t count = 0;
+    size_t remaining = m_ready_list.size_slow();
+
+    while (count < events.size() && remaining-- > 0) {
+        auto& interest = *m_ready_list.take_first();
+
+        auto unblocked_flags = interest.m_description.should_unblock(interest.m_block_flags);
+        if (unblocked_flags == BlockFlags::None)
+            continue;
+
+        events[count].events = events_for_unblocked_flags(unblocked_flags);
+        events[count].data = interest.m_data;
+        ++count;
+
+        if (interest.m_events & EPOLLONESHOT)
+            interest.m_is_disabled = true;
+        else if (!(interest.m_events & EPOLLET))
+            m_ready_list.append(interest);
+    }
+
+    return count;
+}
+
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Badge.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <Kernel/API/POSIX/sys/epoll.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Locking/SpinlockProtected.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+// A persistent set of file descriptions to wait on, as used by the epoll_*() syscalls.
+//
+// Each registered description is watched by an Interest, which observes the description's blocker set
+// until it is removed. Whenever the file evaluates its block conditions, the Interest puts itself on the
+// ready list if the description is ready for the events it's interested in. Waiting then
+// only has to look at the ready list, so its cost depends on the number of ready descriptions instead of
+// the number of registered ones.
+class EventPoll final : public File {
+public:
+    static ErrorOr<NonnullLockRefPtr<EventPoll>> try_create();
+    virtual ~EventPoll() override;
+
+    virtual bool can_read(OpenFileDescription const&, u64) const override;
+    virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual bool can_write(OpenFileDescription const&, u64) const override { return false; }
+    virtual ErrorOr<size_t> write(OpenFileDescription&, u64, UserOrKernelBuffer const&, size_t) override { return EINVAL; }
+    virtual ErrorOr<void> close() override;
+
+    virtual ErrorOr<NonnullOwnPtr<KString>> pseudo_path(OpenFileDescription const&) const override;
+    virtual StringView class_name() const override { return "EventPoll"sv; }
+    virtual bool is_event_poll() const override { return true; }
+
+    ErrorOr<void> add_interest(OpenFileDescription&, epoll_event const&);
+    ErrorOr<void> modify_interest(OpenFileDescription&, epoll_event const&);
+    ErrorOr<void> remove_interest(OpenFileDescription&);
+
+    // Fills in events for the ready descriptions, and returns how many there were.
+    size_t collect_ready_events(Span<epoll_event>);
+
+    WaitQueue& wait_queue() { return m_wait_queue; }
+
+    // A description that goes away is no longer of interest to anyone, just like with Linux's epoll.
+    static void forget_description(Badge<OpenFileDescription>, OpenFileDescription&);
+
+private:
+    class Interest final : public FileStateObserver {
+    public:
+        Interest(EventPoll&, OpenFileDescription&, epoll_event const&);
+
+        virtual void file_state_may_have_changed() override;
+
+        void set_event(epoll_event const&);
+
+        EventPoll& m_event_poll;
+        OpenFileDescription& m_description;
+        // Not necessarily the one of the description's file itself, see SlavePTY.
+        FileBlockerSet& m_blocker_set;
+        Thread::FileBlocker::BlockFlags m_block_flags { Thread::FileBlocker::BlockFlags::None };
+        u32 m_events { 0 };
+        epoll_data_t m_data {};
+        // Set after a one-shot interest was reported, until it is modified again.
+        bool m_is_disabled { false };
+
+        IntrusiveListNode<Interest> m_ready_list_node;
+    };
+
+    EventPoll() = default;
+
+    void interest_did_signal(Interest&);
+    void remove_interest_locked(OpenFileDescription&);
+
+    using ReadyList = IntrusiveList<&Interest::m_ready_list_node>;
+
+    mutable Spinlock m_lock { LockRank::None };
+    ReadyList m_ready_list;
+    WaitQueue m_wait_queue;
+
+    // Only changed while holding the lock of all_instances(), as descriptions may go away at any time.
+    HashMap<OpenFileDescription*, NonnullOwnPtr<Interest>> m_interests;
+
+    IntrusiveListNode<EventPoll> m_list_node;
+
+public:
+    using AllInstancesList = IntrusiveList<&EventPoll::m_list_node>;
+    static SpinlockProtected<AllInstancesList>& all_instances();
+};
+
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BinarySearch.h>
+#include <Kernel/FileSystem/Ext2FS/BlockMap.h>
+
+namespace Kernel {
+
+Ext2FSBlockMap::BlockIndex Ext2FSBlockMap::Extent::block_at(u64 logical_index) const
+{
+    VERIFY(contains(logical_index));
+    if (is_hole())
+        return 0;
+    return static_cast<u64>(first_block_index) + (logical_index - first_logical_index);
+}
+
+Ext2FSBlockMap::Extent const* Ext2FSBlockMap::find_extent(u64 logical_index) const
+{
+    if (logical_index >= m_size)
+        return nullptr;
+    return binary_search(m_extents, logical_index, nullptr, [](u64 needle, Extent const& extent) {
+        if (needle < extent.first_logical_index)
+            return -1;
+        if (needle >= extent.end_logical_index())
+            return 1;
+        return 0;
+    });
+}
+
+Ext2FSBlockMap::BlockIndex Ext2FSBlockMap::operator[](u64 logical_index) const
+{
+    auto const* extent = find_extent(logical_index);
+    VERIFY(extent);
+    return extent->block_at(logical_index);
+}
+
+ErrorOr<void> Ext2FSBlockMap::try_append(BlockIndex block_index)
+{
+    VERIFY(block_index.value() <= NumericLimits<u32>::max());
+    VERIFY(m_size < NumericLimits<u32>::max());
+
+    if (!m_extents.is_empty()) {
+        auto& last = m_extents.last();
+        bool extends_last = block_index.value() == 0
+            ? last.is_hole()
+            : !last.is_hole() && block_index.value() == static_cast<u64>(last.first_block_index) + last.block_count;
+        if (extends_last) {
+            ++last.block_count;
+            ++m_size;
+            return {};
+        }
+    }
+
+    TRY(m_extents.try_append(Extent { static_cast<u32>(m_size), static_cast<u32>(block_index.value()), 1 }));
+    ++m_size;
+    return {};
+}
+
+ErrorOr<void> Ext2FSBlockMap::try_extend(Span<BlockIndex const> block_indices)
+{
+    for (auto block_index : block_indices)
+        TRY(try_append(block_index));
+    return {};
+}
+
+Ext2FSBlockMap::BlockIndex Ext2FSBlockMap::take_last()
+{
+    VERIFY(!is_empty());
+    auto& last = m_extents.last();
+    auto block_index = last.block_at(last.end_logical_index() - 1);
+    if (--last.block_count == 0)
+        m_extents.take_last();
+    --m_size;
+    return block_index;
+}
+
+ErrorOr<Vector<Ext2FSBlockMap::BlockIndex>> Ext2FSBlockMap::blocks_in_range(u64 first_logical_index, size_t count) const
+{
+    VERIFY(first_logical_index + count <= m_size);
+    Vector<BlockIndex> blocks;
+    TRY(blocks.try_ensure_capacity(count));
+    if (count == 0)
+        return blocks;
+
+    auto const* extent = find_extent(first_logical_index);
+    for (u64 logical_index = first_logical_index; logical_index < first_logical_index + count; ++logical_index) {
+        if (!extent->contains(logical_index))
+            ++extent;
+        blocks.unchecked_append(extent->block_at(logical_index));
+    }
+    return blocks;
+}
+
+ErrorOr<Vector<Ext2FSBlockMap::Extent>> Ext2FSBlockMap::extents_in_range(u64 first_logical_index, u64 last_logical_index) const
+{
+    Vector<Extent> extents;
+    auto const* extent = find_extent(first_logical_index);
+    if (!extent)
+        return extents;
+
+    for (size_t i = extent - m_extents.data(); i < m_extents.size() && m_extents[i].first_logical_index <= last_logical_index; ++i) {
+        auto const& current = m_extents[i];
+        auto first = max(first_logical_index, static_cast<u64>(current.first_logical_index));
+        auto end_logical_index = min(last_logical_index + 1, current.end_logical_index());
+        Extent trimmed_extent {
+            static_cast<u32>(first),
+            static_cast<u32>(current.block_at(first).value()),
+            static_cast<u32>(end_logical_index - first),
+        };
+        TRY(extents.try_append(trimmed_extent));
+    }
+    return extents;
+}
+
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <Kernel/FileSystem/BlockBasedFileSystem.h>
+
+namespace Kernel {
+
+// Maps the logical blocks of an inode to blocks on disk, stored as runs of blocks that are
+// consecutive both logically and on disk. Mostly contiguous files only need a handful of
+// extents no matter how large they are, and lookups are a binary search over the runs.
+class Ext2FSBlockMap {
+public:
+    using BlockIndex = BlockBasedFileSystem::BlockIndex;
+
+    // NOTE: Ext2 block pointers are 32 bits wide, so are the logical indices they can be reached by.
+    //       Holes are stored as extents starting at block 0.
+    struct Extent {
+        u32 first_logical_index { 0 };
+        u32 first_block_index { 0 };
+        u32 block_count { 0 };
+
+        bool is_hole() const { return first_block_index == 0; }
+        u64 end_logical_index() const { return static_cast<u64>(first_logical_index) + block_count; }
+        bool contains(u64 logical_index) const { return logical_index >= first_logical_index && logical_index < end_logical_index(); }
+        BlockIndex block_at(u64 logical_index) const;
+    };
+
+    bool is_empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+    Span<Extent const> extents() const { return m_extents.span(); }
+
+    BlockIndex operator[](u64 logical_index) const;
+    Extent const* find_extent(u64 logical_index) const;
+
+    ErrorOr<void> try_append(BlockIndex);
+    ErrorOr<void> try_extend(Span<BlockIndex const>);
+    BlockIndex take_last();
+
+    // Expands [first_logical_index, first_logical_index + count) into a flat list.
+    ErrorOr<Vector<BlockIndex>> blocks_in_range(u64 first_logical_index, size_t count) const;
+
+    // Returns the extents overlapping [first_logical_index, last_logical_index], trimmed to that range.
+    ErrorOr<Vector<Extent>> extents_in_range(u64 first_logical_index, u64 last_logical_index) const;
+
+    template<typename Callback>
+    void for_each_block(Callback callback) const
+    {
+        for (auto const& extent : m_extents) {
+            for (u64 logical_index = extent.first_logical_index; logical_index < extent.end_logical_index(); ++logical_index)
+                callback(extent.block_at(logical_index));
+        }
+    }
+
+private:
+    Vector<Extent, 1> m_extents;
+    size_t m_size { 0 };
+};
+
+}
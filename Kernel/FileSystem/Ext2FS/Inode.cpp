@@ -206,7 +206,7 @@ ErrorOr<void> Ext2FSInode::flush_block_list()
 {
     MutexLocker locker(m_inode_lock);
 
-    if (m_block_list.is_empty()) {
+    if (m_block_map.is_empty()) {
         m_raw_inode.i_blocks = 0;
         memset(m_raw_inode.i_block, 0, sizeof(m_raw_inode.i_block));
         set_metadata_dirty(true);
@@ -217,26 +217,27 @@ ErrorOr<void> Ext2FSInode::flush_block_list()
     auto const old_block_count = ceil_div(size(), static_cast<u64>(fs().block_size()));
 
     auto old_shape = fs().compute_block_list_shape(old_block_count);
-    auto const new_shape = fs().compute_block_list_shape(m_block_list.size());
+    auto const new_shape = fs().compute_block_list_shape(m_block_map.size());
 
     Vector<Ext2FS::BlockIndex> new_meta_blocks;
     if (new_shape.meta_blocks > old_shape.meta_blocks) {
         new_meta_blocks = TRY(fs().allocate_blocks(fs().group_index_from_inode(index()), new_shape.meta_blocks - old_shape.meta_blocks));
     }
 
-    m_raw_inode.i_blocks = (m_block_list.size() + new_shape.meta_blocks) * (fs().block_size() / 512);
+    m_raw_inode.i_blocks = (m_block_map.size() + new_shape.meta_blocks) * (fs().block_size() / 512);
     dbgln_if(EXT2_BLOCKLIST_DEBUG, "Ext2FSInode[{}]::flush_block_list(): Old shape=({};{};{};{}:{}), new shape=({};{};{};{}:{})", identifier(), old_shape.direct_blocks, old_shape.indirect_blocks, old_shape.doubly_indirect_blocks, old_shape.triply_indirect_blocks, old_shape.meta_blocks, new_shape.direct_blocks, new_shape.indirect_blocks, new_shape.doubly_indirect_blocks, new_shape.triply_indirect_blocks, new_shape.meta_blocks);
 
     unsigned output_block_index = 0;
-    unsigned remaining_blocks = m_block_list.size();
+    unsigned remaining_blocks = m_block_map.size();
 
     // Deal with direct blocks.
     bool inode_dirty = false;
     VERIFY(new_shape.direct_blocks <= EXT2_NDIR_BLOCKS);
     for (unsigned i = 0; i < new_shape.direct_blocks; ++i) {
-        if (BlockBasedFileSystem::BlockIndex(m_raw_inode.i_block[i]) != m_block_list[output_block_index])
+        auto block_index = m_block_map[output_block_index];
+        if (BlockBasedFileSystem::BlockIndex(m_raw_inode.i_block[i]) != block_index)
             inode_dirty = true;
-        m_raw_inode.i_block[i] = m_block_list[output_block_index].value();
+        m_raw_inode.i_block[i] = block_index.value();
         ++output_block_index;
         --remaining_blocks;
     }
@@ -251,9 +252,9 @@ ErrorOr<void> Ext2FSInode::flush_block_list()
     }
     if (inode_dirty) {
         if constexpr (EXT2_DEBUG) {
-            dbgln("Ext2FSInode[{}]::flush_block_list(): Writing {} direct block(s) to i_block array of inode {}", identifier(), min((size_t)EXT2_NDIR_BLOCKS, m_block_list.size()), index());
-            for (size_t i = 0; i < min((size_t)EXT2_NDIR_BLOCKS, m_block_list.size()); ++i)
-                dbgln("   + {}", m_block_list[i]);
+            dbgln("Ext2FSInode[{}]::flush_block_list(): Writing {} direct block(s) to i_block array of inode {}", identifier(), min((size_t)EXT2_NDIR_BLOCKS, m_block_map.size()), index());
+            for (size_t i = 0; i < min((size_t)EXT2_NDIR_BLOCKS, m_block_map.size()); ++i)
+                dbgln("   + {}", m_block_map[i]);
         }
         set_metadata_dirty(true);
     }
@@ -270,7 +271,8 @@ ErrorOr<void> Ext2FSInode::flush_block_list()
                 old_shape.meta_blocks++;
             }
 
-            TRY(write_indirect_block(m_raw_inode.i_block[EXT2_IND_BLOCK], m_block_list.span().slice(output_block_index, new_shape.indirect_blocks)));
+            auto blocks = TRY(m_block_map.blocks_in_range(output_block_index, new_shape.indirect_blocks));
+            TRY(write_indirect_block(m_raw_inode.i_block[EXT2_IND_BLOCK], blocks.span()));
         } else if ((new_shape.indirect_blocks == 0) && (old_shape.indirect_blocks != 0)) {
             dbgln_if(EXT2_BLOCKLIST_DEBUG, "Ext2FSInode[{}]::flush_block_list(): Freeing indirect block: {}", identifier(), m_raw_inode.i_block[EXT2_IND_BLOCK]);
             TRY(fs().set_block_allocation_state(m_raw_inode.i_block[EXT2_IND_BLOCK], false));
@@ -292,7 +294,8 @@ ErrorOr<void> Ext2FSInode::flush_block_list()
                 set_metadata_dirty(true);
                 old_shape.meta_blocks++;
             }
-            TRY(grow_doubly_indirect_block(m_raw_inode.i_block[EXT2_DIND_BLOCK], old_shape.doubly_indirect_blocks, m_block_list.span().slice(output_block_index, new_shape.doubly_indirect_blocks), new_meta_blocks, old_shape.meta_blocks));
+            auto blocks = TRY(m_block_map.blocks_in_range(output_block_index, new_shape.doubly_indirect_blocks));
+            TRY(grow_doubly_indirect_block(m_raw_inode.i_block[EXT2_DIND_BLOCK], old_shape.doubly_indirect_blocks, blocks.span(), new_meta_blocks, old_shape.meta_blocks));
         } else {
             TRY(shrink_doubly_indirect_block(m_raw_inode.i_block[EXT2_DIND_BLOCK], old_shape.doubly_indirect_blocks, new_shape.doubly_indirect_blocks, old_shape.meta_blocks));
             if (new_shape.doubly_indirect_blocks == 0)
@@ -313,7 +316,8 @@ ErrorOr<void> Ext2FSInode::flush_block_list()
                 set_metadata_dirty(true);
                 old_shape.meta_blocks++;
             }
-            TRY(grow_triply_indirect_block(m_raw_inode.i_block[EXT2_TIND_BLOCK], old_shape.triply_indirect_blocks, m_block_list.span().slice(output_block_index, new_shape.triply_indirect_blocks), new_meta_blocks, old_shape.meta_blocks));
+            auto blocks = TRY(m_block_map.blocks_in_range(output_block_index, new_shape.triply_indirect_blocks));
+            TRY(grow_triply_indirect_block(m_raw_inode.i_block[EXT2_TIND_BLOCK], old_shape.triply_indirect_blocks, blocks.span(), new_meta_blocks, old_shape.meta_blocks));
         } else {
             TRY(shrink_triply_indirect_block(m_raw_inode.i_block[EXT2_TIND_BLOCK], old_shape.triply_indirect_blocks, new_shape.triply_indirect_blocks, old_shape.meta_blocks));
             if (new_shape.triply_indirect_blocks == 0)
@@ -334,11 +338,6 @@ ErrorOr<void> Ext2FSInode::flush_block_list()
     VERIFY_NOT_REACHED();
 }
 
-ErrorOr<Vector<Ext2FS::BlockIndex>> Ext2FSInode::compute_block_list() const
-{
-    return compute_block_list_impl(false);
-}
-
 ErrorOr<Vector<Ext2FS::BlockIndex>> Ext2FSInode::compute_block_list_with_meta_blocks() const
 {
     return compute_block_list_impl(true);
@@ -357,15 +356,7 @@ ErrorOr<Vector<Ext2FS::BlockIndex>> Ext2FSInode::compute_block_list_impl_interna
 {
     unsigned entries_per_block = EXT2_ADDR_PER_BLOCK(&fs().super_block());
 
-    unsigned block_count = ceil_div(size(), static_cast<u64>(fs().block_size()));
-
-    // If we are handling a symbolic link, the path is stored in the 60 bytes in
-    // the inode that are used for the 12 direct and 3 indirect block pointers,
-    // If the path is longer than 60 characters, a block is allocated, and the
-    // block contains the destination path. The file size corresponds to the
-    // path length of the destination.
-    if (Kernel::is_symlink(e2inode.i_mode) && e2inode.i_blocks == 0)
-        block_count = 0;
+    unsigned block_count = data_block_count();
 
     dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::block_list_for_inode(): i_size={}, i_blocks={}, block_count={}", identifier(), e2inode.i_size, e2inode.i_blocks, block_count);
 
@@ -447,6 +438,96 @@ ErrorOr<Vector<Ext2FS::BlockIndex>> Ext2FSInode::compute_block_list_impl_interna
     return list;
 }
 
+unsigned Ext2FSInode::data_block_count() const
+{
+    // If we are handling a symbolic link, the path is stored in the 60 bytes in
+    // the inode that are used for the 12 direct and 3 indirect block pointers,
+    // If the path is longer than 60 characters, a block is allocated, and the
+    // block contains the destination path. The file size corresponds to the
+    // path length of the destination.
+    if (is_symlink() && m_raw_inode.i_blocks == 0)
+        return 0;
+    return ceil_div(size(), static_cast<u64>(fs().block_size()));
+}
+
+ErrorOr<Ext2FS::BlockIndex> Ext2FSInode::read_block_array_entry(Ext2FS::BlockIndex array_block_index, u64 entry_index) const
+{
+    // A missing block array means that everything it would map is a hole.
+    if (array_block_index.value() == 0)
+        return Ext2FS::BlockIndex { 0 };
+    u32 entry = 0;
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer((u8*)&entry);
+    TRY(fs().read_block(array_block_index, &buffer, sizeof(entry), entry_index * sizeof(entry)));
+    return Ext2FS::BlockIndex { entry };
+}
+
+ErrorOr<void> Ext2FSInode::load_next_block_map_range()
+{
+    VERIFY(!m_block_map_is_complete);
+
+    u64 const block_count = data_block_count();
+    u64 logical_index = m_block_map.size();
+    if (logical_index >= block_count) {
+        // The block list never ends in holes, the file size accounts for those.
+        while (!m_block_map.is_empty() && m_block_map[m_block_map.size() - 1] == 0)
+            m_block_map.take_last();
+        m_block_map_is_complete = true;
+        return {};
+    }
+
+    if (logical_index < EXT2_NDIR_BLOCKS) {
+        for (; logical_index < min(block_count, (u64)EXT2_NDIR_BLOCKS); ++logical_index)
+            TRY(m_block_map.try_append(m_raw_inode.i_block[logical_index]));
+        return {};
+    }
+
+    // Find the block array that maps the next logical block, and load the rest of it in one go.
+    // Only the arrays leading to blocks that are actually accessed are ever read.
+    u64 const entries_per_block = EXT2_ADDR_PER_BLOCK(&fs().super_block());
+    auto const remaining_blocks = block_count - logical_index;
+    auto array_index = logical_index - EXT2_NDIR_BLOCKS;
+    Ext2FS::BlockIndex array_block_index;
+    if (array_index < entries_per_block) {
+        array_block_index = m_raw_inode.i_block[EXT2_IND_BLOCK];
+    } else if ((array_index -= entries_per_block) < entries_per_block * entries_per_block) {
+        array_block_index = TRY(read_block_array_entry(m_raw_inode.i_block[EXT2_DIND_BLOCK], array_index / entries_per_block));
+    } else {
+        array_index -= entries_per_block * entries_per_block;
+        VERIFY(array_index < entries_per_block * entries_per_block * entries_per_block);
+        auto doubly_indirect_block_index = TRY(read_block_array_entry(m_raw_inode.i_block[EXT2_TIND_BLOCK], array_index / (entries_per_block * entries_per_block)));
+        array_block_index = TRY(read_block_array_entry(doubly_indirect_block_index, (array_index / entries_per_block) % entries_per_block));
+    }
+
+    auto first_entry = array_index % entries_per_block;
+    auto entry_count = min(entries_per_block - first_entry, remaining_blocks);
+    if (array_block_index.value() == 0) {
+        for (u64 i = 0; i < entry_count; ++i)
+            TRY(m_block_map.try_append(0));
+        return {};
+    }
+
+    size_t read_size = entry_count * sizeof(u32);
+    auto array_storage = TRY(ByteBuffer::create_uninitialized(read_size));
+    auto* array = (u32*)array_storage.data();
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer((u8*)array);
+    TRY(fs().read_block(array_block_index, &buffer, read_size, first_entry * sizeof(u32)));
+    for (u64 i = 0; i < entry_count; ++i)
+        TRY(m_block_map.try_append(array[i]));
+    return {};
+}
+
+ErrorOr<void> Ext2FSInode::load_block_map_up_to(u64 logical_index)
+{
+    while (!m_block_map_is_complete && logical_index >= m_block_map.size())
+        TRY(load_next_block_map_range());
+    return {};
+}
+
+ErrorOr<void> Ext2FSInode::load_complete_block_map()
+{
+    return load_block_map_up_to(NumericLimits<u64>::max());
+}
+
 Ext2FSInode::Ext2FSInode(Ext2FS& fs, InodeIndex index)
     : Inode(fs, index)
 {
@@ -510,17 +591,21 @@ ErrorOr<void> Ext2FSInode::flush_metadata()
     return {};
 }
 
-ErrorOr<void> Ext2FSInode::compute_block_list_with_exclusive_locking()
+ErrorOr<Vector<Ext2FSBlockMap::Extent>> Ext2FSInode::block_extents_with_exclusive_locking(u64 first_logical_index, u64 last_logical_index)
 {
     // Note: We verify that the inode mutex is being held locked. Because only the read_bytes_locked()
     // method uses this method and the mutex can be locked in shared mode when reading the Inode if
     // it is an ext2 regular file, but also in exclusive mode, when the Inode is an ext2 directory and being
-    // traversed, we use another exclusive lock to ensure we always mutate the block list safely.
+    // traversed, we use another exclusive lock to ensure we always mutate the block map safely.
+    // The extents are copied out while holding that lock, as other readers may extend the map.
     VERIFY(m_inode_lock.is_locked());
     MutexLocker block_list_locker(m_block_list_lock);
-    if (m_block_list.is_empty())
-        m_block_list = TRY(compute_block_list());
-    return {};
+    TRY(load_block_map_up_to(last_logical_index));
+    if (m_block_map.is_empty()) {
+        dmesgln("Ext2FSInode[{}]::read_bytes(): Empty block list", identifier());
+        return EIO;
+    }
+    return m_block_map.extents_in_range(first_logical_index, last_logical_index);
 }
 
 ErrorOr<size_t> Ext2FSInode::read_bytes_locked(off_t offset, size_t count, UserOrKernelBuffer& buffer, OpenFileDescription* description) const
@@ -542,36 +627,49 @@ ErrorOr<size_t> Ext2FSInode::read_bytes_locked(off_t offset, size_t count, UserO
         return nread;
     }
 
-    // Note: We bypass the const declaration of this method, but this is a strong
-    // requirement to be able to accomplish the read operation successfully.
-    // We call this special method because it locks a separate mutex to ensure we
-    // update the block list of the inode safely, as the m_inode_lock is locked in
-    // shared mode.
-    TRY(const_cast<Ext2FSInode&>(*this).compute_block_list_with_exclusive_locking());
-
-    if (m_block_list.is_empty()) {
-        dmesgln("Ext2FSInode[{}]::read_bytes(): Empty block list", identifier());
-        return EIO;
-    }
-
     bool allow_cache = !description || !description->is_direct();
 
     int const block_size = fs().block_size();
 
-    BlockBasedFileSystem::BlockIndex first_block_logical_index = offset / block_size;
-    BlockBasedFileSystem::BlockIndex last_block_logical_index = (offset + count) / block_size;
-    if (last_block_logical_index >= m_block_list.size())
-        last_block_logical_index = m_block_list.size() - 1;
+    u64 first_block_logical_index = offset / block_size;
+    u64 last_block_logical_index = (offset + count) / block_size;
 
     int offset_into_first_block = offset % block_size;
 
+    // Keep reading further ahead while this description is being read sequentially.
+    size_t readahead_block_count = 0;
+    if (allow_cache && description)
+        readahead_block_count = ceil_div(description->update_readahead_window(offset, count), (size_t)block_size);
+
+    // Note: We bypass the const declaration of this method, but this is a strong
+    // requirement to be able to accomplish the read operation successfully.
+    // We call this special method because it locks a separate mutex to ensure we
+    // update the block map of the inode safely, as the m_inode_lock is locked in
+    // shared mode.
+    auto extents = TRY(const_cast<Ext2FSInode&>(*this).block_extents_with_exclusive_locking(first_block_logical_index, last_block_logical_index + readahead_block_count));
+
+    if (allow_cache) {
+        // Pull the blocks into the cache with as few requests as possible, every extent is contiguous on disk.
+        for (auto const& extent : extents) {
+            if (extent.is_hole())
+                continue;
+            // NOTE: Errors are ignored here, reading the blocks we actually need will run into them again.
+            if (auto result = fs().read_ahead_blocks(extent.first_block_index, extent.block_count); result.is_error())
+                dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::read_bytes(): Failed to read ahead {} blocks at {}: {}", identifier(), extent.block_count, extent.first_block_index, result.error());
+        }
+    }
+
     size_t nread = 0;
     auto remaining_count = min((off_t)count, (off_t)size() - offset);
 
     dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::read_bytes(): Reading up to {} bytes, {} bytes into inode to {}", identifier(), count, offset, buffer.user_or_kernel_ptr());
 
-    for (auto bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index; bi = bi.value() + 1) {
-        auto block_index = m_block_list[bi.value()];
+    size_t extent_index = 0;
+    for (auto bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index; ++bi) {
+        while (extent_index < extents.size() && !extents[extent_index].contains(bi))
+            ++extent_index;
+        // NOTE: The block map does not cover the holes at the end of the file.
+        BlockBasedFileSystem::BlockIndex block_index = extent_index < extents.size() ? extents[extent_index].block_at(bi) : 0;
         size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
         size_t num_bytes_to_copy = min((size_t)block_size - offset_into_block, (size_t)remaining_count);
         auto buffer_offset = buffer.offset(nread);
@@ -615,21 +713,20 @@ ErrorOr<void> Ext2FSInode::resize(u64 new_size)
             return ENOSPC;
     }
 
-    if (m_block_list.is_empty())
-        m_block_list = TRY(compute_block_list());
+    TRY(load_complete_block_map());
 
     if (blocks_needed_after > blocks_needed_before) {
         auto blocks = TRY(fs().allocate_blocks(fs().group_index_from_inode(index()), blocks_needed_after - blocks_needed_before));
-        TRY(m_block_list.try_extend(move(blocks)));
+        TRY(m_block_map.try_extend(blocks.span()));
     } else if (blocks_needed_after < blocks_needed_before) {
         if constexpr (EXT2_VERY_DEBUG) {
-            dbgln("Ext2FSInode[{}]::resize(): Shrinking inode, old block list is {} entries:", identifier(), m_block_list.size());
-            for (auto block_index : m_block_list) {
+            dbgln("Ext2FSInode[{}]::resize(): Shrinking inode, old block list is {} entries in {} extents:", identifier(), m_block_map.size(), m_block_map.extents().size());
+            m_block_map.for_each_block([&](auto block_index) {
                 dbgln("    # {}", block_index);
-            }
+            });
         }
-        while (m_block_list.size() != blocks_needed_after) {
-            auto block_index = m_block_list.take_last();
+        while (m_block_map.size() != blocks_needed_after) {
+            auto block_index = m_block_map.take_last();
             if (block_index.value()) {
                 if (auto result = fs().set_block_allocation_state(block_index, false); result.is_error()) {
                     dbgln("Ext2FSInode[{}]::resize(): Failed to free block {}: {}", identifier(), block_index, result.error());
@@ -691,18 +788,18 @@ ErrorOr<size_t> Ext2FSInode::write_bytes_locked(off_t offset, size_t count, User
 
     TRY(resize(new_size));
 
-    if (m_block_list.is_empty())
-        m_block_list = TRY(compute_block_list());
+    BlockBasedFileSystem::BlockIndex first_block_logical_index = offset / block_size;
+    BlockBasedFileSystem::BlockIndex last_block_logical_index = (offset + count) / block_size;
 
-    if (m_block_list.is_empty()) {
+    TRY(load_block_map_up_to(last_block_logical_index.value()));
+
+    if (m_block_map.is_empty()) {
         dbgln("Ext2FSInode[{}]::write_bytes(): Empty block list", identifier());
         return EIO;
     }
 
-    BlockBasedFileSystem::BlockIndex first_block_logical_index = offset / block_size;
-    BlockBasedFileSystem::BlockIndex last_block_logical_index = (offset + count) / block_size;
-    if (last_block_logical_index >= m_block_list.size())
-        last_block_logical_index = m_block_list.size() - 1;
+    if (last_block_logical_index >= m_block_map.size())
+        last_block_logical_index = m_block_map.size() - 1;
 
     size_t offset_into_first_block = offset % block_size;
 
@@ -714,9 +811,10 @@ ErrorOr<size_t> Ext2FSInode::write_bytes_locked(off_t offset, size_t count, User
     for (auto bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index; bi = bi.value() + 1) {
         size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
         size_t num_bytes_to_copy = min((size_t)block_size - offset_into_block, (size_t)remaining_count);
-        dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::write_bytes_locked(): Writing block {} (offset_into_block: {})", identifier(), m_block_list[bi.value()], offset_into_block);
-        if (auto result = fs().write_block(m_block_list[bi.value()], data.offset(nwritten), num_bytes_to_copy, offset_into_block, allow_cache); result.is_error()) {
-            dbgln("Ext2FSInode[{}]::write_bytes_locked(): Failed to write block {} (index {})", identifier(), m_block_list[bi.value()], bi);
+        auto block_index = m_block_map[bi.value()];
+        dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::write_bytes_locked(): Writing block {} (offset_into_block: {})", identifier(), block_index, offset_into_block);
+        if (auto result = fs().write_block(block_index, data.offset(nwritten), num_bytes_to_copy, offset_into_block, allow_cache); result.is_error()) {
+            dbgln("Ext2FSInode[{}]::write_bytes_locked(): Failed to write block {} (index {})", identifier(), block_index, bi);
             return result.release_error();
         }
         remaining_count -= num_bytes_to_copy;
@@ -725,7 +823,7 @@ ErrorOr<size_t> Ext2FSInode::write_bytes_locked(off_t offset, size_t count, User
 
     did_modify_contents();
 
-    dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::write_bytes_locked(): After write, i_size={}, i_blocks={} ({} blocks in list)", identifier(), size(), m_raw_inode.i_blocks, m_block_list.size());
+    dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::write_bytes_locked(): After write, i_size={}, i_blocks={} ({} blocks in list)", identifier(), size(), m_raw_inode.i_blocks, m_block_map.size());
     return nwritten;
 }
 
@@ -1074,13 +1172,14 @@ ErrorOr<int> Ext2FSInode::get_block_address(int index)
 {
     MutexLocker locker(m_inode_lock);
 
-    if (m_block_list.is_empty())
-        m_block_list = TRY(compute_block_list());
+    if (index < 0)
+        return 0;
 
-    if (index < 0 || (size_t)index >= m_block_list.size())
+    TRY(load_block_map_up_to(index));
+    if ((size_t)index >= m_block_map.size())
         return 0;
 
-    return m_block_list[index].value();
+    return m_block_map[index].value();
 }
 
 }
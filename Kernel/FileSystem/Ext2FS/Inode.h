@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/HashMap.h>
+#include <Kernel/FileSystem/Ext2FS/BlockMap.h>
 #include <Kernel/FileSystem/Ext2FS/Definitions.h>
 #include <Kernel/FileSystem/Ext2FS/DirectoryEntry.h>
 #include <Kernel/FileSystem/Ext2FS/FileSystem.h>
@@ -55,8 +56,12 @@ private:
     ErrorOr<void> shrink_triply_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, size_t, unsigned&);
     ErrorOr<void> flush_block_list();
 
-    ErrorOr<void> compute_block_list_with_exclusive_locking();
-    ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> compute_block_list() const;
+    ErrorOr<Vector<Ext2FSBlockMap::Extent>> block_extents_with_exclusive_locking(u64 first_logical_index, u64 last_logical_index);
+    ErrorOr<void> load_block_map_up_to(u64 logical_index);
+    ErrorOr<void> load_complete_block_map();
+    ErrorOr<void> load_next_block_map_range();
+    ErrorOr<BlockBasedFileSystem::BlockIndex> read_block_array_entry(BlockBasedFileSystem::BlockIndex array_block_index, u64 entry_index) const;
+    unsigned data_block_count() const;
     ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> compute_block_list_with_meta_blocks() const;
     ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> compute_block_list_impl(bool include_block_list_blocks) const;
     ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> compute_block_list_impl_internal(ext2_inode const&, bool include_block_list_blocks) const;
@@ -65,7 +70,8 @@ private:
     Ext2FS const& fs() const;
     Ext2FSInode(Ext2FS&, InodeIndex);
 
-    Vector<BlockBasedFileSystem::BlockIndex> m_block_list;
+    Ext2FSBlockMap m_block_map;
+    bool m_block_map_is_complete { false };
     HashMap<NonnullOwnPtr<KString>, InodeIndex> m_lookup_cache;
     ext2_inode m_raw_inode {};
 
@@ -8,6 +8,7 @@
 
 #include <AK/AtomicRefCounted.h>
 #include <AK/Error.h>
+#include <AK/IntrusiveList.h>
 #include <AK/StringView.h>
 #include <AK/Types.h>
 #include <Kernel/Forward.h>
@@ -21,10 +22,43 @@ namespace Kernel {
 
 class File;
 
+// Gets told whenever a file evaluates the conditions of its blockers, without being a blocker itself.
+// Unlike a Thread::Blocker, an observer isn't tied to any thread, so it can keep watching a file for
+// as long as it likes without keeping a thread (and with it, its process) alive.
+class FileStateObserver {
+public:
+    virtual ~FileStateObserver() = default;
+
+    virtual void file_state_may_have_changed() = 0;
+
+private:
+    friend class FileBlockerSet;
+    IntrusiveListNode<FileStateObserver> m_observer_list_node;
+};
+
 class FileBlockerSet final : public Thread::BlockerSet {
 public:
     FileBlockerSet() { }
 
+    virtual ~FileBlockerSet() override
+    {
+        VERIFY(m_observers.is_empty());
+    }
+
+    void add_observer(FileStateObserver& observer)
+    {
+        SpinlockLocker lock(m_lock);
+        m_observers.append(observer);
+    }
+
+    // Once this returns, the observer won't be called anymore.
+    void remove_observer(FileStateObserver& observer)
+    {
+        SpinlockLocker lock(m_lock);
+        if (observer.m_observer_list_node.is_in_list())
+            m_observers.remove(observer);
+    }
+
     virtual bool should_add_blocker(Thread::Blocker& b, void* data) override
     {
         VERIFY(b.blocker_type() == Thread::Blocker::Type::File);
@@ -40,7 +74,12 @@ public:
             auto& blocker = static_cast<Thread::FileBlocker&>(b);
             return blocker.unblock_if_conditions_are_met(false, data);
         });
+        for (auto& observer : m_observers)
+            observer.file_state_may_have_changed();
     }
+
+private:
+    IntrusiveList<&FileStateObserver::m_observer_list_node> m_observers;
 };
 
 // File is the base class for anything that can be referenced by a OpenFileDescription.
@@ -114,6 +153,7 @@ public:
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
     virtual bool is_inode_watcher() const { return false; }
+    virtual bool is_event_poll() const { return false; }
 
     virtual bool is_regular_file() const { return false; }
 
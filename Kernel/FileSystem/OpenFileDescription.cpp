@@ -9,6 +9,7 @@
 #include <Kernel/API/POSIX/errno.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/EventPoll.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/InodeFile.h>
 #include <Kernel/FileSystem/InodeWatcher.h>
@@ -52,6 +53,8 @@ OpenFileDescription::OpenFileDescription(File& file)
 
 OpenFileDescription::~OpenFileDescription()
 {
+    if (m_state.with([](auto& state) { return state.has_event_poll_interest; }))
+        EventPoll::forget_description({}, *this);
     m_file->detach(*this);
     if (is_fifo())
         static_cast<FIFO*>(m_file.ptr())->detach(fifo_direction());
@@ -76,6 +79,11 @@ void OpenFileDescription::set_original_custody(Badge<VirtualFileSystem>, Custody
     m_state.with([&](auto& state) { state.custody = custody; });
 }
 
+void OpenFileDescription::set_has_event_poll_interest(Badge<EventPoll>)
+{
+    m_state.with([](auto& state) { state.has_event_poll_interest = true; });
+}
+
 Thread::FileBlocker::BlockFlags OpenFileDescription::should_unblock(Thread::FileBlocker::BlockFlags block_flags) const
 {
     using BlockFlags = Thread::FileBlocker::BlockFlags;
@@ -328,6 +336,25 @@ InodeWatcher* OpenFileDescription::inode_watcher()
     return static_cast<InodeWatcher*>(m_file.ptr());
 }
 
+bool OpenFileDescription::is_event_poll() const
+{
+    return m_file->is_event_poll();
+}
+
+EventPoll const* OpenFileDescription::event_poll() const
+{
+    if (!is_event_poll())
+        return nullptr;
+    return static_cast<EventPoll const*>(m_file.ptr());
+}
+
+EventPoll* OpenFileDescription::event_poll()
+{
+    if (!is_event_poll())
+        return nullptr;
+    return static_cast<EventPoll*>(m_file.ptr());
+}
+
 bool OpenFileDescription::is_master_pty() const
 {
     return m_file->is_master_pty();
@@ -494,6 +521,21 @@ bool OpenFileDescription::is_direct() const
     return m_state.with([](auto& state) { return state.direct; });
 }
 
+size_t OpenFileDescription::update_readahead_window(off_t offset, size_t count)
+{
+    static constexpr size_t initial_readahead_window = 16 * KiB;
+    static constexpr size_t maximum_readahead_window = 256 * KiB;
+
+    return m_state.with([&](auto& state) {
+        if (offset == state.readahead_next_offset)
+            state.readahead_window = state.readahead_window ? min(state.readahead_window * 2, maximum_readahead_window) : initial_readahead_window;
+        else
+            state.readahead_window = 0;
+        state.readahead_next_offset = offset + count;
+        return state.readahead_window;
+    });
+}
+
 bool OpenFileDescription::is_directory() const
 {
     return m_state.with([](auto& state) { return state.is_directory; });
@@ -65,6 +65,10 @@ public:
 
     bool is_direct() const;
 
+    // Returns how many bytes past the end of a read at the given offset are worth reading ahead,
+    // which grows as long as this description keeps being read sequentially.
+    size_t update_readahead_window(off_t offset, size_t count);
+
     bool is_directory() const;
 
     File& file() { return *m_file; }
@@ -82,6 +86,10 @@ public:
     InodeWatcher const* inode_watcher() const;
     InodeWatcher* inode_watcher();
 
+    bool is_event_poll() const;
+    EventPoll const* event_poll() const;
+    EventPoll* event_poll();
+
     bool is_master_pty() const;
     MasterPTY const* master_pty() const;
     MasterPTY* master_pty();
@@ -117,6 +125,8 @@ public:
     void set_original_inode(Badge<VirtualFileSystem>, NonnullLockRefPtr<Inode>&& inode) { m_inode = move(inode); }
     void set_original_custody(Badge<VirtualFileSystem>, Custody& custody);
 
+    void set_has_event_poll_interest(Badge<EventPoll>);
+
     ErrorOr<void> truncate(u64);
     ErrorOr<void> sync();
 
@@ -147,6 +157,8 @@ private:
         OwnPtr<OpenFileDescriptionData> data;
         RefPtr<Custody> custody;
         off_t current_offset { 0 };
+        off_t readahead_next_offset { 0 };
+        size_t readahead_window { 0 };
         u32 file_flags { 0 };
         bool readable : 1 { false };
         bool writable : 1 { false };
@@ -154,6 +166,7 @@ private:
         bool is_directory : 1 { false };
         bool should_append : 1 { false };
         bool direct : 1 { false };
+        bool has_event_poll_interest : 1 { false };
         FIFO::Direction fifo_direction : 2 { FIFO::Direction::Neither };
     };
 
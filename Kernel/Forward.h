@@ -19,6 +19,7 @@ class Custody;
 class Device;
 class DiskCache;
 class DoubleBuffer;
+class EventPoll;
 class File;
 class FATInode;
 class OpenFileDescription;
@@ -148,6 +148,33 @@ void Mutex::lock(Mode mode, [[maybe_unused]] LockLocation const& location)
     }
 }
 
+bool Mutex::try_lock_exclusive([[maybe_unused]] LockLocation const& location)
+{
+    VERIFY(!Processor::current_in_irq());
+    auto* current_thread = Thread::current();
+
+    SpinlockLocker lock(m_lock);
+    // NOTE: We don't even lock recursively here, as the current thread may be in the middle of
+    //       changing whatever this Mutex protects.
+    if (m_mode != Mode::Unlocked)
+        return false;
+
+    dbgln_if(LOCK_TRACE_DEBUG, "Mutex::try_lock_exclusive @ ({}) {}: acquire, currently unlocked", this, m_name);
+    m_mode = Mode::Exclusive;
+    VERIFY(!m_holder);
+    VERIFY(m_shared_holders == 0);
+    m_holder = current_thread;
+    VERIFY(m_times_locked == 0);
+    m_times_locked++;
+
+#if LOCK_DEBUG
+    if (current_thread) {
+        current_thread->holding_lock(*this, 1, location);
+    }
+#endif
+    return true;
+}
+
 void Mutex::unlock()
 {
     // NOTE: This may be called from an interrupt handler (not an IRQ handler)
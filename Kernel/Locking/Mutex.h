@@ -41,6 +41,8 @@ public:
     ~Mutex() = default;
 
     void lock(Mode mode = Mode::Exclusive, LockLocation const& location = LockLocation::current());
+    // Only succeeds if nobody (including the current thread) is holding the lock, and never blocks.
+    [[nodiscard]] bool try_lock_exclusive(LockLocation const& location = LockLocation::current());
     void restore_exclusive_lock(u32, LockLocation const& location = LockLocation::current());
 
     void unlock();
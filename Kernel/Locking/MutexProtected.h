@@ -75,6 +75,17 @@ public:
         return callback(*lock);
     }
 
+    // Calls the callback only if the mutex can be locked without blocking, and returns whether it did.
+    template<typename Callback>
+    bool try_with_exclusive(Callback callback, LockLocation const& location = LockLocation::current())
+    {
+        if (!m_mutex.try_lock_exclusive(location))
+            return false;
+        callback(m_value);
+        m_mutex.unlock();
+        return true;
+    }
+
     template<typename Callback>
     void for_each_shared(Callback callback, LockLocation const& location = LockLocation::current()) const
     {
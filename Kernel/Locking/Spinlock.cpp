@@ -19,6 +19,20 @@ InterruptsState Spinlock::lock()
     return previous_interrupts_state;
 }
 
+Optional<InterruptsState> Spinlock::try_lock()
+{
+    InterruptsState previous_interrupts_state = processor_interrupts_state();
+    Processor::enter_critical();
+    Processor::disable_interrupts();
+    if (m_lock.exchange(1, AK::memory_order_acquire) != 0) {
+        Processor::leave_critical();
+        restore_processor_interrupts_state(previous_interrupts_state);
+        return {};
+    }
+    track_lock_acquire(m_rank);
+    return previous_interrupts_state;
+}
+
 void Spinlock::unlock(InterruptsState previous_interrupts_state)
 {
     VERIFY(is_locked());
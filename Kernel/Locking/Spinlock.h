@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Atomic.h>
+#include <AK/Optional.h>
 #include <AK/Types.h>
 #include <Kernel/Arch/Processor.h>
 #include <Kernel/Locking/LockRank.h>
@@ -26,6 +27,9 @@ public:
     InterruptsState lock();
     void unlock(InterruptsState);
 
+    // Returns the state to pass to unlock() if the lock was free, or nothing without waiting if it wasn't.
+    Optional<InterruptsState> try_lock();
+
     [[nodiscard]] ALWAYS_INLINE bool is_locked() const
     {
         return m_lock.load(AK::memory_order_relaxed) != 0;
@@ -848,6 +848,12 @@ ErrorOr<CommittedPhysicalPageSet> MemoryManager::commit_physical_pages(size_t pa
 {
     VERIFY(page_count > 0);
     auto result = m_global_data.with([&](auto& global_data) -> ErrorOr<CommittedPhysicalPageSet> {
+        if (global_data.system_memory_info.physical_pages_uncommitted < page_count) {
+            // Memory held by caches is committed as well, so see if they can give us some of it back.
+            auto missing_page_count = page_count - global_data.system_memory_info.physical_pages_uncommitted;
+            if (auto released_page_count = release_reclaimable_physical_pages(missing_page_count))
+                dbgln("MM: Released {} reclaimable pages to commit {} pages", released_page_count, page_count);
+        }
         if (global_data.system_memory_info.physical_pages_uncommitted < page_count) {
             dbgln("MM: Unable to commit {} pages, have only {}", page_count, global_data.system_memory_info.physical_pages_uncommitted);
             return ENOMEM;
@@ -912,6 +918,35 @@ void MemoryManager::deallocate_physical_page(PhysicalAddress paddr)
     });
 }
 
+void MemoryManager::register_physical_memory_reclaimer(PhysicalMemoryReclaimer& reclaimer)
+{
+    m_global_data.with([&](auto& global_data) {
+        global_data.physical_memory_reclaimers.append(reclaimer);
+    });
+}
+
+void MemoryManager::unregister_physical_memory_reclaimer(PhysicalMemoryReclaimer& reclaimer)
+{
+    m_global_data.with([&](auto& global_data) {
+        global_data.physical_memory_reclaimers.remove(reclaimer);
+    });
+}
+
+size_t MemoryManager::release_reclaimable_physical_pages(size_t page_count)
+{
+    // NOTE: The reclaimers free their memory while we're holding the (recursive) global lock,
+    //       which also keeps them from being unregistered and destroyed underneath us.
+    return m_global_data.with([&](auto& global_data) {
+        size_t released_page_count = 0;
+        for (auto& reclaimer : global_data.physical_memory_reclaimers) {
+            if (released_page_count >= page_count)
+                break;
+            released_page_count += reclaimer.try_release_physical_pages(page_count - released_page_count);
+        }
+        return released_page_count;
+    });
+}
+
 RefPtr<PhysicalPage> MemoryManager::find_free_physical_page(bool committed)
 {
     RefPtr<PhysicalPage> page;
@@ -994,6 +1029,13 @@ ErrorOr<NonnullRefPtr<PhysicalPage>> MemoryManager::allocate_physical_page(Shoul
                 return IterationDecision::Continue;
             });
         }
+        if (!page) {
+            // Third, we ask the caches that hold on to memory they don't strictly need.
+            if (auto released_page_count = release_reclaimable_physical_pages(1)) {
+                dbgln("MM: Reclaim saved the day! Released {} pages from caches", released_page_count);
+                page = find_free_physical_page(false);
+            }
+        }
         if (!page) {
             dmesgln("MM: no physical pages available");
             return ENOMEM;
@@ -9,6 +9,7 @@
 #include <AK/Badge.h>
 #include <AK/Concepts.h>
 #include <AK/HashTable.h>
+#include <AK/IntrusiveList.h>
 #include <AK/IntrusiveRedBlackTree.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <Kernel/Forward.h>
@@ -125,6 +126,23 @@ private:
     size_t m_page_count { 0 };
 };
 
+// Something that holds on to physical memory it doesn't strictly need, like the disk caches.
+// MemoryManager asks these to give some of it back before it fails an allocation.
+class PhysicalMemoryReclaimer {
+public:
+    virtual ~PhysicalMemoryReclaimer() = default;
+
+    // Called with the MemoryManager lock held, so this must not block.
+    // Returns the number of pages that were released.
+    virtual size_t try_release_physical_pages(size_t page_count) = 0;
+
+private:
+    IntrusiveListNode<PhysicalMemoryReclaimer> m_list_node;
+
+public:
+    using List = IntrusiveList<&PhysicalMemoryReclaimer::m_list_node>;
+};
+
 class MemoryManager {
     friend class PageDirectory;
     friend class AnonymousVMObject;
@@ -171,6 +189,9 @@ public:
     ErrorOr<NonnullRefPtrVector<PhysicalPage>> allocate_contiguous_physical_pages(size_t size);
     void deallocate_physical_page(PhysicalAddress);
 
+    void register_physical_memory_reclaimer(PhysicalMemoryReclaimer&);
+    void unregister_physical_memory_reclaimer(PhysicalMemoryReclaimer&);
+
     ErrorOr<NonnullOwnPtr<Region>> allocate_contiguous_kernel_region(size_t, StringView name, Region::Access access, Region::Cacheable = Region::Cacheable::Yes);
     ErrorOr<NonnullOwnPtr<Memory::Region>> allocate_dma_buffer_page(StringView name, Memory::Region::Access access, RefPtr<Memory::PhysicalPage>& dma_buffer_page);
     ErrorOr<NonnullOwnPtr<Memory::Region>> allocate_dma_buffer_page(StringView name, Memory::Region::Access access);
@@ -258,6 +279,7 @@ private:
     static Region* find_region_from_vaddr(VirtualAddress);
 
     RefPtr<PhysicalPage> find_free_physical_page(bool);
+    size_t release_reclaimable_physical_pages(size_t page_count);
 
     ALWAYS_INLINE u8* quickmap_page(PhysicalPage& page)
     {
@@ -302,6 +324,8 @@ private:
         Vector<UsedMemoryRange> used_memory_ranges;
         Vector<PhysicalMemoryRange> physical_memory_ranges;
         Vector<ContiguousReservedMemoryRange> reserved_memory_ranges;
+
+        PhysicalMemoryReclaimer::List physical_memory_reclaimers;
     };
 
     SpinlockProtected<GlobalData> m_global_data;
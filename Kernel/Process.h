@@ -337,6 +337,9 @@ public:
     ErrorOr<FlatPtr> sys$msync(Userspace<void*>, size_t, int flags);
     ErrorOr<FlatPtr> sys$purge(int mode);
     ErrorOr<FlatPtr> sys$poll(Userspace<Syscall::SC_poll_params const*>);
+    ErrorOr<FlatPtr> sys$epoll_create(int flags);
+    ErrorOr<FlatPtr> sys$epoll_ctl(int epfd, int op, int fd, Userspace<epoll_event const*>);
+    ErrorOr<FlatPtr> sys$epoll_wait(Userspace<Syscall::SC_epoll_wait_params const*>);
     ErrorOr<FlatPtr> sys$get_dir_entries(int fd, Userspace<void*>, size_t);
     ErrorOr<FlatPtr> sys$getcwd(Userspace<char*>, size_t);
     ErrorOr<FlatPtr> sys$chdir(Userspace<char const*>, size_t);
@@ -430,6 +433,7 @@ public:
     ErrorOr<FlatPtr> sys$get_stack_bounds(Userspace<FlatPtr*> stack_base, Userspace<size_t*> stack_size);
     ErrorOr<FlatPtr> sys$ptrace(Userspace<Syscall::SC_ptrace_params const*>);
     ErrorOr<FlatPtr> sys$sendfd(int sockfd, int fd);
+    ErrorOr<FlatPtr> sys$sendfile(int out_fd, int in_fd, Userspace<off_t*>, size_t count);
     ErrorOr<FlatPtr> sys$recvfd(int sockfd, int options);
     ErrorOr<FlatPtr> sys$sysconf(int name);
     ErrorOr<FlatPtr> sys$disown(ProcessID);
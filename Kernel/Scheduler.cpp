@@ -44,9 +44,139 @@ struct ThreadReadyQueues {
     u32 mask {};
     static constexpr size_t count = sizeof(mask) * 8;
     Array<ThreadReadyQueue, count> queues;
+    size_t thread_count { 0 };
+
+    void add(Thread& thread, u32 priority, u32 cpu)
+    {
+        VERIFY(thread.m_runnable_lock.is_locked());
+        VERIFY(thread.m_runnable_priority < 0);
+        VERIFY(thread.m_runnable_cpu < 0);
+        VERIFY(!thread.m_ready_queue_node.is_in_list());
+        thread.m_runnable_priority = (int)priority;
+        thread.m_runnable_cpu = (int)cpu;
+        link(thread, priority);
+    }
+
+    void remove(Thread& thread)
+    {
+        VERIFY(thread.m_runnable_lock.is_locked());
+        auto priority = thread.m_runnable_priority;
+        unlink(thread, priority);
+        thread.m_runnable_priority = -1;
+        thread.m_runnable_cpu = -1;
+    }
+
+    // Moves a thread over from another processor's queues, with both of them locked.
+    void take_from(ThreadReadyQueues& other, Thread& thread, u32 cpu)
+    {
+        VERIFY(thread.m_runnable_lock.is_locked());
+        auto priority = thread.m_runnable_priority;
+        other.unlink(thread, priority);
+        link(thread, priority);
+        thread.m_runnable_cpu = (int)cpu;
+    }
+
+    enum class LockThread {
+        No,
+        Yes,
+    };
+
+    // Returns the highest priority thread that is allowed to run on a processor in the given mask.
+    // With LockThread::Yes, threads whose m_runnable_lock is taken are skipped: they are being dequeued
+    // right now, and waiting for them with our lock held would invert the lock order. The lock of the
+    // returned thread is held, and has to be released with unlock_runnable_thread().
+    Thread* first_runnable_thread(u32 affinity_mask, LockThread lock_thread = LockThread::No)
+    {
+        auto priority_mask = mask;
+        while (priority_mask != 0) {
+            auto priority = bit_scan_forward(priority_mask);
+            VERIFY(priority > 0);
+            auto& ready_queue = queues[--priority];
+            for (auto& thread : ready_queue.thread_list) {
+                VERIFY(thread.m_runnable_priority == (int)priority);
+                if (thread.is_active())
+                    continue;
+                if (!(thread.affinity() & affinity_mask))
+                    continue;
+                if (lock_thread == LockThread::Yes) {
+                    auto previous_interrupts_state = thread.m_runnable_lock.try_lock();
+                    if (!previous_interrupts_state.has_value())
+                        continue;
+                    // Our own lock already disabled interrupts.
+                    VERIFY(previous_interrupts_state.value() == InterruptsState::Disabled);
+                }
+                return &thread;
+            }
+            priority_mask &= ~(1u << priority);
+        }
+        return nullptr;
+    }
+
+    static void unlock_runnable_thread(Thread& thread)
+    {
+        thread.m_runnable_lock.unlock(InterruptsState::Disabled);
+    }
+
+private:
+    void link(Thread& thread, u32 priority)
+    {
+        auto& ready_queue = queues[priority];
+        bool was_empty = ready_queue.thread_list.is_empty();
+        ready_queue.thread_list.append(thread);
+        if (was_empty)
+            mask |= (1u << priority);
+        thread_count++;
+    }
+
+    void unlink(Thread& thread, int priority)
+    {
+        VERIFY(priority >= 0);
+        VERIFY(mask & (1u << priority));
+        auto& ready_queue = queues[priority];
+        ready_queue.thread_list.remove(thread);
+        if (ready_queue.thread_list.is_empty())
+            mask &= ~(1u << priority);
+        VERIFY(thread_count > 0);
+        thread_count--;
+    }
+};
+
+// Every processor owns a set of ready queues, each protected by its own lock. Together with the
+// m_runnable_lock of each thread, that is all the queues need: none of the functions working on
+// them rely on g_scheduler_lock, so processors only contend when they touch the same queue.
+//
+// NOTE: Thread state changes and context switches are still protected by g_scheduler_lock, and state changes
+//       are what queues and dequeues threads. So those calls still serialize, but picking the next thread and
+//       stealing work from other processors in pick_next() happen before it takes g_scheduler_lock.
+struct ProcessorReadyQueues {
+    SpinlockProtected<ThreadReadyQueues> ready_queues { LockRank::None };
+    // Mirrors ThreadReadyQueues::thread_count, so other processors can look for
+    // work without taking our lock.
+    Atomic<size_t> thread_count { 0 };
+    // Only ever touched by the owning processor from its timer interrupt.
+    u32 ticks_since_load_balance { 0 };
+
+    template<typename Callback>
+    decltype(auto) with(Callback callback)
+    {
+        return ready_queues.with([&](auto& queues) {
+            ScopeGuard update_thread_count = [&] {
+                thread_count.store(queues.thread_count, AK::MemoryOrder::memory_order_relaxed);
+            };
+            return callback(queues);
+        });
+    }
+
+    bool is_empty() const { return thread_count.load(AK::MemoryOrder::memory_order_relaxed) == 0; }
+    size_t size() const { return thread_count.load(AK::MemoryOrder::memory_order_relaxed); }
 };
 
-static Singleton<SpinlockProtected<ThreadReadyQueues>> g_ready_queues;
+// Thread affinity is a u32 mask, so there's no point in having queues for more processors than that.
+static constexpr size_t max_ready_queue_count = min(MAX_CPU_COUNT, sizeof(u32) * 8);
+static Singleton<Array<ProcessorReadyQueues, max_ready_queue_count>> g_ready_queues;
+
+// Every processor tries to even out the ready queues once per this many timer ticks.
+static constexpr u32 load_balance_interval_ticks = 25;
 
 static SpinlockProtected<TotalTimeScheduled> g_total_time_scheduled { LockRank::None };
 
@@ -64,71 +194,112 @@ static inline u32 thread_priority_to_priority_index(u32 thread_priority)
     return priority_bucket;
 }
 
-Thread& Scheduler::pull_next_runnable_thread()
+static inline u32 ready_queue_count()
 {
-    auto affinity_mask = 1u << Processor::current_id();
+    return min(Processor::count(), (u32)max_ready_queue_count);
+}
 
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread& {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
-                thread.m_runnable_priority = -1;
-                ready_queue.thread_list.remove(thread);
-                if (ready_queue.thread_list.is_empty())
-                    ready_queues.mask &= ~(1u << priority);
-                // Mark it as active because we are using this thread. This is similar
-                // to comparing it with Processor::current_thread, but when there are
-                // multiple processors there's no easy way to check whether the thread
-                // is actually still needed. This prevents accidental finalization when
-                // a thread is no longer in Running state, but running on another core.
-
-                // We need to mark it active here so that this thread won't be
-                // scheduled on another core if it were to be queued before actually
-                // switching to it.
-                // FIXME: Figure out a better way maybe?
-                thread.set_active(true);
-                return thread;
-            }
-            priority_mask &= ~(1u << priority);
+static inline ProcessorReadyQueues& ready_queues_for(u32 cpu)
+{
+    VERIFY(cpu < max_ready_queue_count);
+    return (*g_ready_queues)[cpu];
+}
+
+// Returns the processor with the most queued threads, other than the given one.
+static Optional<u32> busiest_processor_other_than(u32 cpu)
+{
+    Optional<u32> busiest_cpu;
+    size_t busiest_size = 0;
+    auto queue_count = ready_queue_count();
+    for (u32 i = 1; i < queue_count; i++) {
+        auto other_cpu = (cpu + i) % queue_count;
+        auto size = ready_queues_for(other_cpu).size();
+        if (size > busiest_size) {
+            busiest_size = size;
+            busiest_cpu = other_cpu;
         }
-        return *Processor::idle_thread();
+    }
+    return busiest_cpu;
+}
+
+static Thread* take_runnable_thread_from(u32 cpu, u32 affinity_mask)
+{
+    auto& processor_queues = ready_queues_for(cpu);
+    if (processor_queues.is_empty())
+        return nullptr;
+
+    return processor_queues.with([&](auto& ready_queues) -> Thread* {
+        auto* thread = ready_queues.first_runnable_thread(affinity_mask, ThreadReadyQueues::LockThread::Yes);
+        if (!thread)
+            return nullptr;
+        ScopeGuard unlock_thread = [&] { ThreadReadyQueues::unlock_runnable_thread(*thread); };
+        ready_queues.remove(*thread);
+        // Mark it as active because we are using this thread. This is similar
+        // to comparing it with Processor::current_thread, but when there are
+        // multiple processors there's no easy way to check whether the thread
+        // is actually still needed. This prevents accidental finalization when
+        // a thread is no longer in Running state, but running on another core.
+
+        // We need to mark it active here so that this thread won't be
+        // scheduled on another core if it were to be queued before actually
+        // switching to it.
+        // FIXME: Figure out a better way maybe?
+        thread->set_active(true);
+        return thread;
     });
 }
 
-Thread* Scheduler::peek_next_runnable_thread()
+Thread& Scheduler::pull_next_runnable_thread()
 {
-    auto affinity_mask = 1u << Processor::current_id();
+    auto current_cpu = Processor::current_id();
+    auto affinity_mask = 1u << current_cpu;
 
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread* {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
-                return &thread;
-            }
-            priority_mask &= ~(1u << priority);
-        }
+    if (current_cpu >= ready_queue_count())
+        return *Processor::idle_thread();
+
+    if (auto* thread = take_runnable_thread_from(current_cpu, affinity_mask))
+        return *thread;
+
+    // Nothing is queued up for us, so try to steal some work from another
+    // processor, starting with the one that has the most threads waiting.
+    if (auto busiest_cpu = busiest_processor_other_than(current_cpu); busiest_cpu.has_value()) {
+        if (auto* thread = take_runnable_thread_from(busiest_cpu.value(), affinity_mask))
+            return *thread;
+    }
+    auto queue_count = ready_queue_count();
+    for (u32 i = 1; i < queue_count; i++) {
+        if (auto* thread = take_runnable_thread_from((current_cpu + i) % queue_count, affinity_mask))
+            return *thread;
+    }
 
-        // Unlike in pull_next_runnable_thread() we don't want to fall back to
-        // the idle thread. We just want to see if we have any other thread ready
-        // to be scheduled.
+    return *Processor::idle_thread();
+}
+
+Thread* Scheduler::peek_next_runnable_thread()
+{
+    auto current_cpu = Processor::current_id();
+    auto affinity_mask = 1u << current_cpu;
+
+    auto queue_count = ready_queue_count();
+    if (current_cpu >= queue_count)
         return nullptr;
-    });
+
+    // Unlike in pull_next_runnable_thread() we don't want to fall back to
+    // the idle thread. We just want to see if we have any other thread ready
+    // to be scheduled. That includes the threads we would steal from other
+    // processors, or we'd keep running our current thread while another
+    // processor has threads queued up that could run here.
+    for (u32 i = 0; i < queue_count; i++) {
+        auto& processor_queues = ready_queues_for((current_cpu + i) % queue_count);
+        if (processor_queues.is_empty())
+            continue;
+        auto* thread = processor_queues.with([&](auto& ready_queues) {
+            return ready_queues.first_runnable_thread(affinity_mask);
+        });
+        if (thread)
+            return thread;
+    }
+    return nullptr;
 }
 
 bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
@@ -136,42 +307,106 @@ bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
     if (thread.is_idle_thread())
         return true;
 
-    return g_ready_queues->with([&](auto& ready_queues) {
-        auto priority = thread.m_runnable_priority;
-        if (priority < 0) {
-            VERIFY(!thread.m_ready_queue_node.is_in_list());
-            return false;
-        }
+    // Nobody can put the thread into a queue, take it out or move it to another processor while we hold its lock.
+    SpinlockLocker thread_locker(thread.m_runnable_lock);
+    auto cpu = thread.m_runnable_cpu.load(AK::MemoryOrder::memory_order_relaxed);
+    if (cpu < 0)
+        return false;
+
+    return ready_queues_for(cpu).with([&](auto& ready_queues) {
+        VERIFY(thread.m_runnable_cpu.load(AK::MemoryOrder::memory_order_relaxed) == cpu);
+        VERIFY(thread.m_runnable_priority >= 0);
+        VERIFY(thread.m_ready_queue_node.is_in_list());
 
         if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
             return false;
 
-        VERIFY(ready_queues.mask & (1u << priority));
-        auto& ready_queue = ready_queues.queues[priority];
-        thread.m_runnable_priority = -1;
-        ready_queue.thread_list.remove(thread);
-        if (ready_queue.thread_list.is_empty())
-            ready_queues.mask &= ~(1u << priority);
+        ready_queues.remove(thread);
         return true;
     });
 }
 
+static u32 pick_processor_for(Thread const& thread)
+{
+    auto affinity = thread.affinity();
+    auto queue_count = ready_queue_count();
+
+    // Prefer the processor the thread last ran on, its caches are most likely still warm.
+    auto last_cpu = thread.cpu();
+    if (last_cpu < queue_count && (affinity & (1u << last_cpu)))
+        return last_cpu;
+
+    auto current_cpu = Processor::current_id();
+    if (current_cpu < queue_count && (affinity & (1u << current_cpu)))
+        return current_cpu;
+
+    // Otherwise pick the least loaded processor the thread is allowed to run on.
+    Optional<u32> best_cpu;
+    size_t best_size = 0;
+    for (u32 cpu = 0; cpu < queue_count; cpu++) {
+        if (!(affinity & (1u << cpu)))
+            continue;
+        auto size = ready_queues_for(cpu).size();
+        if (!best_cpu.has_value() || size < best_size) {
+            best_cpu = cpu;
+            best_size = size;
+        }
+    }
+    return best_cpu.value_or(0);
+}
+
 void Scheduler::enqueue_runnable_thread(Thread& thread)
 {
-    VERIFY(g_scheduler_lock.is_locked_by_current_processor());
     if (thread.is_idle_thread())
         return;
     auto priority = thread_priority_to_priority_index(thread.priority());
 
-    g_ready_queues->with([&](auto& ready_queues) {
-        VERIFY(thread.m_runnable_priority < 0);
-        thread.m_runnable_priority = (int)priority;
-        VERIFY(!thread.m_ready_queue_node.is_in_list());
-        auto& ready_queue = ready_queues.queues[priority];
-        bool was_empty = ready_queue.thread_list.is_empty();
-        ready_queue.thread_list.append(thread);
-        if (was_empty)
-            ready_queues.mask |= (1u << priority);
+    SpinlockLocker thread_locker(thread.m_runnable_lock);
+    auto cpu = pick_processor_for(thread);
+
+    ready_queues_for(cpu).with([&](auto& ready_queues) {
+        ready_queues.add(thread, priority, cpu);
+    });
+}
+
+void Scheduler::balance_load()
+{
+    // Pull over a single thread from the busiest processor if it has at least two more
+    // threads queued up than we do. Every processor doing this periodically keeps the
+    // queues roughly even, without bouncing threads back and forth between processors.
+    auto current_cpu = Processor::current_id();
+    if (current_cpu >= ready_queue_count())
+        return;
+    auto busiest_cpu = busiest_processor_other_than(current_cpu);
+    if (!busiest_cpu.has_value())
+        return;
+
+    auto& our_queues = ready_queues_for(current_cpu);
+    auto& busiest_queues = ready_queues_for(busiest_cpu.value());
+    if (busiest_queues.size() < our_queues.size() + 2)
+        return;
+
+    // The thread moves while both queues are locked, so anyone looking for it finds it in one of them.
+    // To avoid deadlocking with a processor that balances the other way, the lower numbered queue is
+    // always locked first.
+    bool ours_first = current_cpu < busiest_cpu.value();
+    auto& first_queues = ours_first ? our_queues : busiest_queues;
+    auto& second_queues = ours_first ? busiest_queues : our_queues;
+    first_queues.with([&](auto& first_ready_queues) {
+        second_queues.with([&](auto& second_ready_queues) {
+            auto& our_ready_queues = ours_first ? first_ready_queues : second_ready_queues;
+            auto& busiest_ready_queues = ours_first ? second_ready_queues : first_ready_queues;
+            if (busiest_ready_queues.thread_count < our_ready_queues.thread_count + 2)
+                return;
+
+            auto* thread = busiest_ready_queues.first_runnable_thread(1u << current_cpu, ThreadReadyQueues::LockThread::Yes);
+            if (!thread)
+                return;
+
+            dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Migrating {} from processor {}", current_cpu, *thread, busiest_cpu.value());
+            our_ready_queues.take_from(busiest_ready_queues, *thread, current_cpu);
+            ThreadReadyQueues::unlock_runnable_thread(*thread);
+        });
     });
 }
 
@@ -214,13 +449,31 @@ void Scheduler::pick_next()
             Processor::set_current_in_scheduler(false);
         });
 
+    // Looking through the ready queues (and those of other processors, if ours are empty) only takes their locks,
+    // so it happens before we start serializing with every other processor on g_scheduler_lock.
+    auto* next_thread = &pull_next_runnable_thread();
+
     SpinlockLocker lock(g_scheduler_lock);
 
     if constexpr (SCHEDULER_RUNNABLE_DEBUG) {
         dump_thread_list();
     }
 
-    auto& thread_to_schedule = pull_next_runnable_thread();
+    // The thread was runnable when we took it out of the queue, but until we got g_scheduler_lock, another processor
+    // could still change its state. Since we marked it as active, the finalizer leaves it alone if it's dying.
+    if (!next_thread->is_idle_thread() && next_thread->state() != Thread::State::Runnable) {
+        dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: {} stopped being runnable before we could switch to it", Processor::current_id(), *next_thread);
+        next_thread->set_active(false);
+        if (next_thread->state() == Thread::State::Dying)
+            notify_finalizer();
+        next_thread = &pull_next_runnable_thread();
+    } else {
+        // It may also have blocked and been woken up again, which queued it while we already had it. Nobody else
+        // takes it out of the queue while it's marked as active, so that's up to us.
+        dequeue_runnable_thread(*next_thread);
+    }
+
+    auto& thread_to_schedule = *next_thread;
     if constexpr (SCHEDULER_DEBUG) {
         dbgln("Scheduler[{}]: Switch to {} @ {:p}",
             Processor::current_id(),
@@ -435,6 +688,14 @@ void Scheduler::timer_tick(RegisterState const& regs)
         return;
     }
 
+    if (auto current_cpu = Processor::current_id(); Processor::count() > 1 && current_cpu < ready_queue_count()) {
+        auto& processor_queues = ready_queues_for(current_cpu);
+        if (++processor_queues.ticks_since_load_balance >= load_balance_interval_ticks) {
+            processor_queues.ticks_since_load_balance = 0;
+            balance_load();
+        }
+    }
+
     if (current_thread->tick())
         return;
 
@@ -51,6 +51,7 @@ public:
     static Thread* peek_next_runnable_thread();
     static bool dequeue_runnable_thread(Thread&, bool = false);
     static void enqueue_runnable_thread(Thread&);
+    static void balance_load();
     static void dump_scheduler_state(bool = false);
     static bool is_initialized();
     static TotalTimeScheduled get_total_time_scheduled();
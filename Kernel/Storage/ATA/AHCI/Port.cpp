@@ -38,11 +38,12 @@ ErrorOr<void> AHCIPort::allocate_resources_and_initialize_ports()
 
     m_fis_receive_page = TRY(MM.allocate_physical_page());
 
-    for (size_t index = 0; index < 1; index++) {
+    auto command_slots_count = min(m_hba_capabilities.max_command_list_entries_count, m_command_slots.size());
+    for (size_t index = 0; index < command_slots_count; index++) {
         auto dma_page = TRY(MM.allocate_physical_page());
         m_dma_buffers.append(move(dma_page));
     }
-    for (size_t index = 0; index < 1; index++) {
+    for (size_t index = 0; index < command_slots_count; index++) {
         auto command_table_page = TRY(MM.allocate_physical_page());
         m_command_table_pages.append(move(command_table_page));
     }
@@ -86,20 +87,14 @@ void AHCIPort::handle_interrupt()
             auto work_item_creation_result = g_io_work->try_queue([this]() {
                 m_connected_device.clear();
             });
-            if (work_item_creation_result.is_error()) {
-                auto current_request = m_current_request;
-                m_current_request.clear();
-                current_request->complete(AsyncDeviceRequest::OutOfMemory);
-            }
+            if (work_item_creation_result.is_error())
+                fail_active_requests(AsyncDeviceRequest::OutOfMemory);
         } else {
             auto work_item_creation_result = g_io_work->try_queue([this]() {
                 reset();
             });
-            if (work_item_creation_result.is_error()) {
-                auto current_request = m_current_request;
-                m_current_request.clear();
-                current_request->complete(AsyncDeviceRequest::OutOfMemory);
-            }
+            if (work_item_creation_result.is_error())
+                fail_active_requests(AsyncDeviceRequest::OutOfMemory);
         }
         return;
     }
@@ -112,64 +107,108 @@ void AHCIPort::handle_interrupt()
         auto work_item_creation_result = g_io_work->try_queue([this]() {
             reset();
         });
-        if (work_item_creation_result.is_error()) {
-            auto current_request = m_current_request;
-            m_current_request.clear();
-            current_request->complete(AsyncDeviceRequest::OutOfMemory);
-        }
+        if (work_item_creation_result.is_error())
+            fail_active_requests(AsyncDeviceRequest::OutOfMemory);
         return;
     }
     if (m_interrupt_status.is_set(AHCI::PortInterruptFlag::IF) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::TFE) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::HBD) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::HBF)) {
         auto work_item_creation_result = g_io_work->try_queue([this]() {
             recover_from_fatal_error();
         });
-        if (work_item_creation_result.is_error()) {
-            auto current_request = m_current_request;
-            m_current_request.clear();
-            current_request->complete(AsyncDeviceRequest::OutOfMemory);
-        }
+        if (work_item_creation_result.is_error())
+            fail_active_requests(AsyncDeviceRequest::OutOfMemory);
+        return;
+    }
+    if (m_interrupt_status.is_set(AHCI::PortInterruptFlag::DHR) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::PS) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::SDB)) {
+        // Note: Clear the interrupt status before looking at which commands are done,
+        // so a command that finishes meanwhile raises a new interrupt.
+        m_interrupt_status.clear();
+        complete_finished_commands();
         return;
     }
-    if (m_interrupt_status.is_set(AHCI::PortInterruptFlag::DHR) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::PS)) {
-        m_wait_for_completion = false;
 
-        // Now schedule reading/writing the buffer as soon as we leave the irq handler.
-        // This is important so that we can safely access the buffers, which could
-        // trigger page faults
-        if (!m_current_request) {
-            dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request handled, probably identify request", representative_port_index());
-        } else {
-            auto work_item_creation_result = g_io_work->try_queue([this]() {
-                dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request handled", representative_port_index());
-                MutexLocker locker(m_lock);
-                VERIFY(m_current_request);
-                VERIFY(m_current_scatter_list);
-                if (!m_connected_device) {
-                    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request success", representative_port_index());
-                    complete_current_request(AsyncDeviceRequest::Failure);
-                    return;
-                }
-                if (m_current_request->request_type() == AsyncBlockDeviceRequest::Read) {
-                    if (auto result = m_current_request->write_to_buffer(m_current_request->buffer(), m_current_scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * m_current_request->block_count()); result.is_error()) {
-                        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure, memory fault occurred when reading in data.", representative_port_index());
-                        m_current_scatter_list = nullptr;
-                        complete_current_request(AsyncDeviceRequest::MemoryFault);
-                        return;
-                    }
-                }
-                m_current_scatter_list = nullptr;
-                dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request success", representative_port_index());
-                complete_current_request(AsyncDeviceRequest::Success);
-            });
-            if (work_item_creation_result.is_error()) {
-                auto current_request = m_current_request;
-                m_current_request.clear();
-                current_request->complete(AsyncDeviceRequest::OutOfMemory);
+    m_interrupt_status.clear();
+}
+
+void AHCIPort::complete_finished_commands()
+{
+    SpinlockLocker lock(m_hard_lock);
+    // A queued command is done once the device clears its bit in PxSACT, a non-queued one once the HBA clears it in PxCI.
+    u32 running_command_slots = m_port_registers.sact | m_port_registers.ci;
+    u32 finished_command_slots = m_issued_command_slots & ~running_command_slots;
+    if (finished_command_slots == 0) {
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request handled, probably identify request", representative_port_index());
+        return;
+    }
+    m_issued_command_slots &= ~finished_command_slots;
+    m_finished_command_slots |= finished_command_slots;
+    if (m_finished_commands_work_queued)
+        return;
+
+    // Now schedule reading/writing the buffers as soon as we leave the irq handler.
+    // This is important so that we can safely access the buffers, which could
+    // trigger page faults
+    auto work_item_creation_result = g_io_work->try_queue([this]() {
+        handle_finished_commands();
+    });
+    if (work_item_creation_result.is_error()) {
+        lock.unlock();
+        fail_active_requests(AsyncDeviceRequest::OutOfMemory);
+        return;
+    }
+    m_finished_commands_work_queued = true;
+}
+
+void AHCIPort::handle_finished_commands()
+{
+    MutexLocker locker(m_lock);
+    u32 finished_command_slots;
+    {
+        SpinlockLocker lock(m_hard_lock);
+        finished_command_slots = m_finished_command_slots;
+        m_finished_command_slots = 0;
+        m_finished_commands_work_queued = false;
+    }
+
+    for (u8 slot_index = 0; slot_index < m_command_slots.size(); slot_index++) {
+        if (!(finished_command_slots & (1u << slot_index)))
+            continue;
+        auto& slot = m_command_slots[slot_index];
+        if (!slot.request)
+            continue;
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request in slot {} handled", representative_port_index(), slot_index);
+        VERIFY(slot.scatter_list);
+        if (!m_connected_device) {
+            dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure, device is gone", representative_port_index());
+            complete_request_in_slot(slot_index, AsyncDeviceRequest::Failure);
+            continue;
+        }
+        if (slot.request->request_type() == AsyncBlockDeviceRequest::Read) {
+            if (auto result = slot.request->write_to_buffer(slot.request->buffer(), slot.scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * slot.request->block_count()); result.is_error()) {
+                dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure, memory fault occurred when reading in data.", representative_port_index());
+                complete_request_in_slot(slot_index, AsyncDeviceRequest::MemoryFault);
+                continue;
             }
         }
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request success", representative_port_index());
+        complete_request_in_slot(slot_index, AsyncDeviceRequest::Success);
     }
 
-    m_interrupt_status.clear();
+    start_pending_requests();
+}
+
+void AHCIPort::fail_active_requests(AsyncDeviceRequest::RequestResult result)
+{
+    Vector<NonnullLockRefPtr<AsyncBlockDeviceRequest>, 32> failed_requests;
+    {
+        SpinlockLocker lock(m_hard_lock);
+        for (auto& slot : m_command_slots) {
+            if (auto request = move(slot.request))
+                failed_requests.unchecked_append(request.release_nonnull());
+        }
+    }
+    for (auto& request : failed_requests)
+        request->complete(result);
 }
 
 bool AHCIPort::is_interrupts_enabled() const
@@ -177,21 +216,36 @@ bool AHCIPort::is_interrupts_enabled() const
     return !m_interrupt_enable.is_cleared();
 }
 
+void AHCIPort::fail_pending_requests(AsyncDeviceRequest::RequestResult result)
+{
+    VERIFY(m_lock.is_locked());
+    auto pending_requests = move(m_pending_requests);
+    for (auto& request : pending_requests)
+        request->complete(result);
+}
+
 void AHCIPort::recover_from_fatal_error()
 {
     MutexLocker locker(m_lock);
-    SpinlockLocker lock(m_hard_lock);
-    LockRefPtr<AHCIController> controller = m_parent_controller.strong_ref();
-    if (!controller) {
-        dmesgln("AHCI Port {}: fatal error, controller not available", representative_port_index());
-        return;
-    }
+    {
+        SpinlockLocker lock(m_hard_lock);
+        LockRefPtr<AHCIController> controller = m_parent_controller.strong_ref();
+        if (!controller) {
+            dmesgln("AHCI Port {}: fatal error, controller not available", representative_port_index());
+            return;
+        }
 
-    dmesgln("{}: AHCI Port {} fatal error, shutting down!", controller->pci_address(), representative_port_index());
-    dmesgln("{}: AHCI Port {} fatal error, SError {}", controller->pci_address(), representative_port_index(), (u32)m_port_registers.serr);
-    stop_command_list_processing();
-    stop_fis_receiving();
-    m_interrupt_enable.clear();
+        dmesgln("{}: AHCI Port {} fatal error, shutting down!", controller->pci_address(), representative_port_index());
+        dmesgln("{}: AHCI Port {} fatal error, SError {}", controller->pci_address(), representative_port_index(), (u32)m_port_registers.serr);
+        stop_command_list_processing();
+        stop_fis_receiving();
+        m_interrupt_enable.clear();
+        // The port is stopped, so none of the commands it was working on will finish anymore.
+        m_issued_command_slots = 0;
+        m_finished_command_slots = 0;
+    }
+    fail_active_requests(AsyncDeviceRequest::Failure);
+    fail_pending_requests(AsyncDeviceRequest::Failure);
 }
 
 void AHCIPort::eject()
@@ -270,26 +324,34 @@ void AHCIPort::eject()
 bool AHCIPort::reset()
 {
     MutexLocker locker(m_lock);
-    SpinlockLocker lock(m_hard_lock);
+    bool success = false;
+    {
+        SpinlockLocker lock(m_hard_lock);
 
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Resetting", representative_port_index());
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Resetting", representative_port_index());
 
-    if (m_disabled_by_firmware) {
-        dmesgln("AHCI Port {}: Disabled by firmware ", representative_port_index());
-        return false;
-    }
-    full_memory_barrier();
-    m_interrupt_enable.clear();
-    m_interrupt_status.clear();
-    full_memory_barrier();
-    start_fis_receiving();
-    full_memory_barrier();
-    clear_sata_error_register();
-    full_memory_barrier();
-    if (!initiate_sata_reset()) {
-        return false;
+        if (m_disabled_by_firmware) {
+            dmesgln("AHCI Port {}: Disabled by firmware ", representative_port_index());
+            return false;
+        }
+        full_memory_barrier();
+        m_interrupt_enable.clear();
+        m_interrupt_status.clear();
+        // Whatever commands the port was working on are lost with the reset.
+        m_issued_command_slots = 0;
+        m_finished_command_slots = 0;
+        full_memory_barrier();
+        start_fis_receiving();
+        full_memory_barrier();
+        clear_sata_error_register();
+        full_memory_barrier();
+        if (initiate_sata_reset())
+            success = initialize();
     }
-    return initialize();
+    fail_active_requests(AsyncDeviceRequest::Failure);
+    // Requests that were waiting for a command slot get to go now, or fail if the device didn't come back.
+    start_pending_requests();
+    return success;
 }
 
 UNMAP_AFTER_INIT bool AHCIPort::initialize_without_reset()
@@ -342,6 +404,15 @@ bool AHCIPort::initialize()
                 physical_sector_size = logical_sector_size << (identify_block->physical_sector_size_to_logical_sector_size & 0xf);
             }
         }
+        // Check if both the HBA and the device support NCQ (word 76, bit 8), and how many commands the device can queue (word 75)
+        m_usable_command_slots_count = 1;
+        m_native_command_queuing_enabled = false;
+        if (m_hba_capabilities.native_command_queuing_supported && !is_atapi_attached() && (identify_block->serial_ata_capabilities & (1 << 8))) {
+            size_t device_queue_depth = (identify_block->queue_depth & 0x1f) + 1;
+            m_usable_command_slots_count = min(device_queue_depth, m_dma_buffers.size());
+            m_native_command_queuing_enabled = m_usable_command_slots_count > 1;
+            dbgln_if(AHCI_DEBUG, "AHCI Port {}: Using NCQ with {} command slots", representative_port_index(), m_usable_command_slots_count);
+        }
         // Check if the device supports LBA48 mode
         if (identify_block->commands_and_feature_sets_supported[1] & (1 << 10)) {
             max_addressable_sector = identify_block->user_addressable_logical_sectors_count;
@@ -361,7 +432,8 @@ bool AHCIPort::initialize()
                 dmesgln("AHCI Port {}: Device found, but parent controller is not available, abort.", representative_port_index());
                 return false;
             }
-            m_connected_device = ATADiskDevice::create(*controller, { m_port_index, 0 }, 0, logical_sector_size, max_addressable_sector);
+            auto command_queuing = m_native_command_queuing_enabled ? ATADevice::CommandQueuing::Yes : ATADevice::CommandQueuing::No;
+            m_connected_device = ATADiskDevice::create(*controller, { m_port_index, 0 }, 0, logical_sector_size, max_addressable_sector, command_queuing);
         } else {
             dbgln("AHCI Port {}: Ignoring ATAPI devices for now as we don't currently support them.", representative_port_index());
         }
@@ -488,25 +560,27 @@ size_t AHCIPort::calculate_descriptors_count(size_t block_count) const
 {
     VERIFY(m_connected_device);
     size_t needed_dma_regions_count = Memory::page_round_up((block_count * m_connected_device->block_size())).value() / PAGE_SIZE;
-    VERIFY(needed_dma_regions_count <= m_dma_buffers.size());
+    // Note: Each command slot has a single page of DMA memory.
+    VERIFY(needed_dma_regions_count <= 1);
     return needed_dma_regions_count;
 }
 
-Optional<AsyncDeviceRequest::RequestResult> AHCIPort::prepare_and_set_scatter_list(AsyncBlockDeviceRequest& request)
+Optional<AsyncDeviceRequest::RequestResult> AHCIPort::prepare_and_set_scatter_list(u8 slot_index, AsyncBlockDeviceRequest& request)
 {
     VERIFY(m_lock.is_locked());
     VERIFY(request.block_count() > 0);
 
     NonnullRefPtrVector<Memory::PhysicalPage> allocated_dma_regions;
     for (size_t index = 0; index < calculate_descriptors_count(request.block_count()); index++) {
-        allocated_dma_regions.append(m_dma_buffers.at(index));
+        allocated_dma_regions.append(m_dma_buffers.at(slot_index + index));
     }
 
-    m_current_scatter_list = Memory::ScatterGatherList::try_create(request, allocated_dma_regions.span(), m_connected_device->block_size());
-    if (!m_current_scatter_list)
+    auto& slot = m_command_slots[slot_index];
+    slot.scatter_list = Memory::ScatterGatherList::try_create(request, allocated_dma_regions.span(), m_connected_device->block_size());
+    if (!slot.scatter_list)
         return AsyncDeviceRequest::Failure;
     if (request.request_type() == AsyncBlockDeviceRequest::Write) {
-        if (auto result = request.read_from_buffer(request.buffer(), m_current_scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * request.block_count()); result.is_error()) {
+        if (auto result = request.read_from_buffer(request.buffer(), slot.scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * request.block_count()); result.is_error()) {
             return AsyncDeviceRequest::MemoryFault;
         }
     }
@@ -517,34 +591,86 @@ void AHCIPort::start_request(AsyncBlockDeviceRequest& request)
 {
     MutexLocker locker(m_lock);
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request start", representative_port_index());
-    VERIFY(!m_current_request);
-    VERIFY(!m_current_scatter_list);
 
-    m_current_request = request;
+    // Older requests go first.
+    start_pending_requests();
+    auto slot_index = try_to_find_free_command_slot();
+    if (!slot_index.has_value()) {
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: All command slots are busy, deferring request", representative_port_index());
+        if (m_pending_requests.try_append(request).is_error()) {
+            locker.unlock();
+            request.complete(AsyncDeviceRequest::OutOfMemory);
+        }
+        return;
+    }
+    start_request_in_slot(slot_index.value(), request);
+}
 
-    auto result = prepare_and_set_scatter_list(request);
+void AHCIPort::start_request_in_slot(u8 slot_index, AsyncBlockDeviceRequest& request)
+{
+    VERIFY(m_lock.is_locked());
+    auto& slot = m_command_slots[slot_index];
+    VERIFY(!slot.request);
+    {
+        SpinlockLocker lock(m_hard_lock);
+        slot.request = request;
+    }
+
+    if (!m_connected_device || !is_operable()) {
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure, port is not operable.", representative_port_index());
+        complete_request_in_slot(slot_index, AsyncDeviceRequest::Failure);
+        return;
+    }
+
+    auto result = prepare_and_set_scatter_list(slot_index, request);
     if (result.has_value()) {
         dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure.", representative_port_index());
-        locker.unlock();
-        complete_current_request(result.value());
+        complete_request_in_slot(slot_index, result.value());
         return;
     }
 
-    auto success = access_device(request.request_type(), request.block_index(), request.block_count());
+    auto success = access_device(slot_index, request.request_type(), request.block_index(), request.block_count());
     if (!success) {
         dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure.", representative_port_index());
-        locker.unlock();
-        complete_current_request(AsyncDeviceRequest::Failure);
+        complete_request_in_slot(slot_index, AsyncDeviceRequest::Failure);
         return;
     }
 }
 
-void AHCIPort::complete_current_request(AsyncDeviceRequest::RequestResult result)
+void AHCIPort::start_pending_requests()
 {
-    VERIFY(m_current_request);
-    auto current_request = m_current_request;
-    m_current_request.clear();
-    current_request->complete(result);
+    VERIFY(m_lock.is_locked());
+    while (!m_pending_requests.is_empty()) {
+        auto slot_index = try_to_find_free_command_slot();
+        if (!slot_index.has_value())
+            return;
+        auto request = m_pending_requests.take_first();
+        start_request_in_slot(slot_index.value(), request);
+    }
+}
+
+Optional<u8> AHCIPort::try_to_find_free_command_slot() const
+{
+    VERIFY(m_lock.is_locked());
+    for (u8 slot_index = 0; slot_index < m_usable_command_slots_count; slot_index++) {
+        if (!m_command_slots[slot_index].request && !(m_issued_command_slots & (1u << slot_index)))
+            return slot_index;
+    }
+    return {};
+}
+
+void AHCIPort::complete_request_in_slot(u8 slot_index, AsyncDeviceRequest::RequestResult result)
+{
+    VERIFY(m_lock.is_locked());
+    auto& slot = m_command_slots[slot_index];
+    LockRefPtr<AsyncBlockDeviceRequest> request;
+    {
+        SpinlockLocker lock(m_hard_lock);
+        request = move(slot.request);
+    }
+    slot.scatter_list = nullptr;
+    if (request)
+        request->complete(result);
 }
 
 bool AHCIPort::spin_until_ready() const
@@ -563,35 +689,35 @@ bool AHCIPort::spin_until_ready() const
     return true;
 }
 
-bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64 lba, u8 block_count)
+bool AHCIPort::access_device(u8 slot_index, AsyncBlockDeviceRequest::RequestType direction, u64 lba, u16 block_count)
 {
     VERIFY(m_connected_device);
     VERIFY(is_operable());
     VERIFY(m_lock.is_locked());
-    VERIFY(m_current_scatter_list);
+    auto& scatter_list = m_command_slots[slot_index].scatter_list;
+    VERIFY(scatter_list);
     SpinlockLocker lock(m_hard_lock);
 
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {}", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count);
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {}, slot {}", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count, slot_index);
+    // Note: With NCQ, the device is ready for another command as soon as it has accepted the previous one.
     if (!spin_until_ready())
         return false;
 
-    auto unused_command_header = try_to_find_unused_command_header();
-    VERIFY(unused_command_header.has_value());
     auto* command_list_entries = (volatile AHCI::CommandHeader*)m_command_list_region->vaddr().as_ptr();
-    command_list_entries[unused_command_header.value()].ctba = m_command_table_pages[unused_command_header.value()].paddr().get();
-    command_list_entries[unused_command_header.value()].ctbau = 0;
-    command_list_entries[unused_command_header.value()].prdbc = 0;
-    command_list_entries[unused_command_header.value()].prdtl = m_current_scatter_list->scatters_count();
+    command_list_entries[slot_index].ctba = m_command_table_pages[slot_index].paddr().get();
+    command_list_entries[slot_index].ctbau = 0;
+    command_list_entries[slot_index].prdbc = 0;
+    command_list_entries[slot_index].prdtl = scatter_list->scatters_count();
 
     // Note: we must set the correct Dword count in this register. Real hardware
     // AHCI controllers do care about this field! QEMU doesn't care if we don't
     // set the correct CFL field in this register, real hardware will set an
     // handshake error bit in PxSERR register if CFL is incorrect.
-    command_list_entries[unused_command_header.value()].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | AHCI::CommandHeaderAttributes::P | (is_atapi_attached() ? AHCI::CommandHeaderAttributes::A : 0) | (direction == AsyncBlockDeviceRequest::RequestType::Write ? AHCI::CommandHeaderAttributes::W : 0);
+    command_list_entries[slot_index].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | AHCI::CommandHeaderAttributes::P | (is_atapi_attached() ? AHCI::CommandHeaderAttributes::A : 0) | (direction == AsyncBlockDeviceRequest::RequestType::Write ? AHCI::CommandHeaderAttributes::W : 0);
 
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: CLE: ctba={:#08x}, ctbau={:#08x}, prdbc={:#08x}, prdtl={:#04x}, attributes={:#04x}", representative_port_index(), (u32)command_list_entries[unused_command_header.value()].ctba, (u32)command_list_entries[unused_command_header.value()].ctbau, (u32)command_list_entries[unused_command_header.value()].prdbc, (u16)command_list_entries[unused_command_header.value()].prdtl, (u16)command_list_entries[unused_command_header.value()].attributes);
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: CLE: ctba={:#08x}, ctbau={:#08x}, prdbc={:#08x}, prdtl={:#04x}, attributes={:#04x}", representative_port_index(), (u32)command_list_entries[slot_index].ctba, (u32)command_list_entries[slot_index].ctbau, (u32)command_list_entries[slot_index].prdbc, (u16)command_list_entries[slot_index].prdtl, (u16)command_list_entries[slot_index].attributes);
 
-    auto command_table_region = MM.allocate_kernel_region(m_command_table_pages[unused_command_header.value()].paddr().page_base(), Memory::page_round_up(sizeof(AHCI::CommandTable)).value(), "AHCI Command Table"sv, Memory::Region::Access::ReadWrite, Memory::Region::Cacheable::No).release_value();
+    auto command_table_region = MM.allocate_kernel_region(m_command_table_pages[slot_index].paddr().page_base(), Memory::page_round_up(sizeof(AHCI::CommandTable)).value(), "AHCI Command Table"sv, Memory::Region::Access::ReadWrite, Memory::Region::Cacheable::No).release_value();
     auto& command_table = *(volatile AHCI::CommandTable*)command_table_region->vaddr().as_ptr();
 
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Allocated command table at {}", representative_port_index(), command_table_region->vaddr());
@@ -600,7 +726,7 @@ bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64
 
     size_t scatter_entry_index = 0;
     size_t data_transfer_count = (block_count * m_connected_device->block_size());
-    for (auto scatter_page : m_current_scatter_list->vmobject().physical_pages()) {
+    for (auto scatter_page : scatter_list->vmobject().physical_pages()) {
         VERIFY(data_transfer_count != 0);
         VERIFY(scatter_page);
         dbgln_if(AHCI_DEBUG, "AHCI Port {}: Add a transfer scatter entry @ {}", representative_port_index(), scatter_page->paddr());
@@ -624,6 +750,11 @@ bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64
     if (is_atapi_attached()) {
         fis.command = ATA_CMD_PACKET;
         TODO();
+    } else if (m_native_command_queuing_enabled) {
+        if (direction == AsyncBlockDeviceRequest::RequestType::Write)
+            fis.command = ATA_CMD_WRITE_FPDMA_QUEUED;
+        else
+            fis.command = ATA_CMD_READ_FPDMA_QUEUED;
     } else {
         if (direction == AsyncBlockDeviceRequest::RequestType::Write)
             fis.command = ATA_CMD_WRITE_DMA_EXT;
@@ -642,17 +773,25 @@ bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64
     fis.lba_low[0] = lba & 0xff;
     fis.lba_low[1] = (lba >> 8) & 0xff;
     fis.lba_low[2] = (lba >> 16) & 0xff;
-    fis.count = (block_count);
+    if (m_native_command_queuing_enabled) {
+        // Note: Queued commands carry the sector count in the features fields,
+        // and the tag (which is the command slot) in bits 7:3 of the count field.
+        fis.features_low = block_count & 0xff;
+        fis.features_high = (block_count >> 8) & 0xff;
+        fis.count = slot_index << 3;
+    } else {
+        fis.count = (block_count);
+    }
 
     // The below loop waits until the port is no longer busy before issuing a new command
     if (!spin_until_ready())
         return false;
 
     full_memory_barrier();
-    mark_command_header_ready_to_process(unused_command_header.value());
+    mark_command_header_ready_to_process(slot_index);
     full_memory_barrier();
 
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {} @ {}, ended", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count, m_dma_buffers[0].paddr());
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {} @ {}, ended", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count, m_dma_buffers[slot_index].paddr());
     return true;
 }
 
@@ -757,7 +896,7 @@ bool AHCIPort::shutdown()
 Optional<u8> AHCIPort::try_to_find_unused_command_header()
 {
     VERIFY(m_lock.is_locked());
-    u32 commands_issued = m_port_registers.ci;
+    u32 commands_issued = m_port_registers.ci | m_port_registers.sact | m_issued_command_slots;
     for (size_t index = 0; index < 32; index++) {
         if (!(commands_issued & 1)) {
             dbgln_if(AHCI_DEBUG, "AHCI Port {}: unused command header at index {}", representative_port_index(), index);
@@ -777,15 +916,19 @@ void AHCIPort::start_command_list_processing() const
     m_port_registers.cmd = m_port_registers.cmd | 1;
 }
 
-void AHCIPort::mark_command_header_ready_to_process(u8 command_header_index) const
+void AHCIPort::mark_command_header_ready_to_process(u8 command_header_index)
 {
     VERIFY(m_lock.is_locked());
     VERIFY(m_hard_lock.is_locked());
     VERIFY(is_operable());
-    VERIFY(!m_wait_for_completion);
-    m_wait_for_completion = true;
+    VERIFY(!(m_issued_command_slots & (1u << command_header_index)));
+    m_issued_command_slots |= 1u << command_header_index;
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Marking command header at index {} as ready to process.", representative_port_index(), command_header_index);
-    m_port_registers.ci = 1 << command_header_index;
+    // Note: Queued commands have to be marked active in PxSACT before they're issued.
+    if (m_native_command_queuing_enabled)
+        m_port_registers.sact = 1u << command_header_index;
+    m_port_registers.ci = 1u << command_header_index;
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Issued command slots {:#08x}, PxSACT {:#08x}, PxCI {:#08x}", representative_port_index(), m_issued_command_slots, (u32)m_port_registers.sact, (u32)m_port_registers.ci);
 }
 
 void AHCIPort::stop_command_list_processing() const
@@ -6,9 +6,11 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
+#include <AK/Vector.h>
 #include <Kernel/Devices/Device.h>
 #include <Kernel/Interrupts/IRQHandler.h>
 #include <Kernel/Library/LockWeakPtr.h>
@@ -74,10 +76,17 @@ private:
     ALWAYS_INLINE void power_on() const;
 
     void start_request(AsyncBlockDeviceRequest&);
-    void complete_current_request(AsyncDeviceRequest::RequestResult);
-    bool access_device(AsyncBlockDeviceRequest::RequestType, u64 lba, u8 block_count);
+    void start_request_in_slot(u8 slot_index, AsyncBlockDeviceRequest&);
+    void start_pending_requests();
+    Optional<u8> try_to_find_free_command_slot() const;
+    void complete_request_in_slot(u8 slot_index, AsyncDeviceRequest::RequestResult);
+    void complete_finished_commands();
+    void handle_finished_commands();
+    void fail_active_requests(AsyncDeviceRequest::RequestResult);
+    void fail_pending_requests(AsyncDeviceRequest::RequestResult);
+    bool access_device(u8 slot_index, AsyncBlockDeviceRequest::RequestType, u64 lba, u16 block_count);
     size_t calculate_descriptors_count(size_t block_count) const;
-    [[nodiscard]] Optional<AsyncDeviceRequest::RequestResult> prepare_and_set_scatter_list(AsyncBlockDeviceRequest& request);
+    [[nodiscard]] Optional<AsyncDeviceRequest::RequestResult> prepare_and_set_scatter_list(u8 slot_index, AsyncBlockDeviceRequest& request);
 
     ALWAYS_INLINE bool is_interrupts_enabled() const;
 
@@ -86,7 +95,7 @@ private:
     bool identify_device();
 
     ALWAYS_INLINE void start_command_list_processing() const;
-    ALWAYS_INLINE void mark_command_header_ready_to_process(u8 command_header_index) const;
+    ALWAYS_INLINE void mark_command_header_ready_to_process(u8 command_header_index);
     ALWAYS_INLINE void stop_command_list_processing() const;
 
     ALWAYS_INLINE void start_fis_receiving() const;
@@ -105,13 +114,27 @@ private:
 
     // Data members
 
+    struct CommandSlot {
+        LockRefPtr<AsyncBlockDeviceRequest> request;
+        LockRefPtr<Memory::ScatterGatherList> scatter_list;
+    };
+
     EntropySource m_entropy_source;
-    LockRefPtr<AsyncBlockDeviceRequest> m_current_request;
     Spinlock m_hard_lock { LockRank::None };
     Mutex m_lock { "AHCIPort"sv };
 
-    mutable bool m_wait_for_completion { false };
-
+    // Every command slot can serve a request of its own. Without NCQ we only ever use the first one.
+    // The requests are assigned with both locks held, and the bit masks are only touched with the hard lock held.
+    Array<CommandSlot, 32> m_command_slots;
+    size_t m_usable_command_slots_count { 1 };
+    bool m_native_command_queuing_enabled { false };
+    u32 m_issued_command_slots { 0 };
+    u32 m_finished_command_slots { 0 };
+    bool m_finished_commands_work_queued { false };
+    // Requests that came in while all command slots were busy.
+    Vector<NonnullLockRefPtr<AsyncBlockDeviceRequest>> m_pending_requests;
+
+    // One page of DMA memory per command slot.
     NonnullRefPtrVector<Memory::PhysicalPage> m_dma_buffers;
     NonnullRefPtrVector<Memory::PhysicalPage> m_command_table_pages;
     RefPtr<Memory::PhysicalPage> m_command_list_page;
@@ -133,7 +156,6 @@ private:
     AHCI::PortInterruptStatusBitField m_interrupt_status;
     AHCI::PortInterruptEnableBitField m_interrupt_enable;
 
-    LockRefPtr<Memory::ScatterGatherList> m_current_scatter_list;
     bool m_disabled_by_firmware { false };
 };
 }
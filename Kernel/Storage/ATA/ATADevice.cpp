@@ -16,11 +16,12 @@ static StorageDevice::LUNAddress convert_ata_address_to_lun_address(ATAControlle
     return StorageDevice::LUNAddress { controller.controller_id(), ata_address.port, ata_address.subport };
 }
 
-ATADevice::ATADevice(ATAController const& controller, ATADevice::Address ata_address, u16 capabilities, u16 logical_sector_size, u64 max_addressable_block)
+ATADevice::ATADevice(ATAController const& controller, ATADevice::Address ata_address, u16 capabilities, u16 logical_sector_size, u64 max_addressable_block, CommandQueuing command_queuing)
     : StorageDevice(convert_ata_address_to_lun_address(controller, ata_address), controller.hardware_relative_controller_id(), logical_sector_size, max_addressable_block)
     , m_controller(controller)
     , m_ata_address(ata_address)
     , m_capabilities(capabilities)
+    , m_command_queuing(command_queuing)
 {
 }
 
@@ -26,21 +26,31 @@ public:
         u8 subport;
     };
 
+    // Whether the controller can have several commands in flight for the device, i.e. with NCQ.
+    enum class CommandQueuing {
+        No,
+        Yes,
+    };
+
 public:
     virtual ~ATADevice() override;
 
     // ^BlockDevice
     virtual void start_request(AsyncBlockDeviceRequest&) override;
 
+    // ^Device
+    virtual bool starts_requests_immediately() const override { return m_command_queuing == CommandQueuing::Yes; }
+
     u16 ata_capabilites() const { return m_capabilities; }
     Address const& ata_address() const { return m_ata_address; }
 
 protected:
-    ATADevice(ATAController const&, Address, u16, u16, u64);
+    ATADevice(ATAController const&, Address, u16, u16, u64, CommandQueuing);
 
     LockWeakPtr<ATAController> m_controller;
     const Address m_ata_address;
     const u16 m_capabilities;
+    const CommandQueuing m_command_queuing;
 };
 
 }
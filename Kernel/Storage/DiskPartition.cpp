@@ -23,6 +23,7 @@ DiskPartition::DiskPartition(BlockDevice& device, MinorNumber minor_number, Part
     : BlockDevice(100, minor_number, device.block_size())
     , m_device(device)
     , m_metadata(metadata)
+    , m_starts_requests_immediately(device.starts_requests_immediately())
 {
 }
 
@@ -22,6 +22,9 @@ public:
 
     virtual void start_request(AsyncBlockDeviceRequest&) override;
 
+    // ^Device
+    virtual bool starts_requests_immediately() const override { return m_starts_requests_immediately; }
+
     // ^BlockDevice
     virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override;
     virtual bool can_read(OpenFileDescription const&, u64) const override;
@@ -36,6 +39,8 @@ private:
 
     LockWeakPtr<BlockDevice> m_device;
     Partition::DiskPartitionMetadata m_metadata;
+    // Our requests are only passed on to the device, so there's no point in holding them back if it doesn't.
+    bool const m_starts_requests_immediately { false };
 };
 
 }
@@ -33,10 +33,6 @@ void NVMeNameSpace::start_request(AsyncBlockDeviceRequest& request)
     // Eventually remove this constraint by using the PRP2 field in the submission struct and remove block layer constraint for NVMe driver.
     VERIFY(request.block_count() <= (PAGE_SIZE / block_size()));
 
-    if (request.request_type() == AsyncBlockDeviceRequest::Read) {
-        queue.read(request, m_nsid, request.block_index(), request.block_count());
-    } else {
-        queue.write(request, m_nsid, request.block_index(), request.block_count());
-    }
+    queue.enqueue_request(request, m_nsid);
 }
 }
@@ -28,6 +28,8 @@ public:
 
     CommandSet command_set() const override { return CommandSet::NVMe; };
     void start_request(AsyncBlockDeviceRequest& request) override;
+    // Every IO queue has many request slots of its own, see NVMeQueue.
+    virtual bool starts_requests_immediately() const override { return true; }
 
 private:
     NVMeNameSpace(LUNAddress, u32 hardware_relative_controller_id, NonnullLockRefPtrVector<NVMeQueue> queues, size_t storage_size, size_t lba_size, u16 nsid);
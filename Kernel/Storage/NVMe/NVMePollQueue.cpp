@@ -10,35 +10,34 @@
 #include <Kernel/Storage/NVMe/NVMePollQueue.h>
 
 namespace Kernel {
-UNMAP_AFTER_INIT NVMePollQueue::NVMePollQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs)
-    : NVMeQueue(move(rw_dma_region), rw_dma_page, qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))
+UNMAP_AFTER_INIT NVMePollQueue::NVMePollQueue(OwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs)
+    : NVMeQueue(move(rw_dma_region), move(rw_dma_pages), qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))
 {
 }
 
 void NVMePollQueue::submit_sqe(NVMeSubmission& sub)
 {
     NVMeQueue::submit_sqe(sub);
-    SpinlockLocker lock_cq(m_cq_lock);
-    while (!process_cq()) {
-        microseconds_delay(1);
+    // Only admin commands come through here, and those are submitted one at a time.
+    while (has_outstanding_commands()) {
+        if (!process_cq())
+            microseconds_delay(1);
     }
 }
 
-void NVMePollQueue::complete_current_request(u16 status)
+void NVMePollQueue::wait_for_completion(AsyncBlockDeviceRequest& request)
 {
-    auto current_request = m_current_request;
-    m_current_request.clear();
-    if (status) {
-        current_request->complete(AsyncBlockDeviceRequest::Failure);
-        return;
+    // Other submitters may reap our completion, and process_cq() submits waiting requests as slots free up,
+    // so just poll until our own request is done. That's immediately if it failed to be submitted.
+    while (!request.is_completed()) {
+        if (!process_cq())
+            microseconds_delay(1);
     }
-    if (current_request->request_type() == AsyncBlockDeviceRequest::RequestType::Read) {
-        if (auto result = current_request->write_to_buffer(current_request->buffer(), m_rw_dma_region->vaddr().as_ptr(), current_request->buffer_size()); result.is_error()) {
-            current_request->complete(AsyncDeviceRequest::MemoryFault);
-            return;
-        }
-    }
-    current_request->complete(AsyncDeviceRequest::Success);
-    return;
+}
+
+void NVMePollQueue::complete_requests(Span<Completion const> completions)
+{
+    for (auto& completion : completions)
+        complete_request(completion.command_id, completion.status);
 }
 }
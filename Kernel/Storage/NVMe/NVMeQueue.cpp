@@ -4,7 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <Kernel/Arch/Delay.h>
+#include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/StdLib.h>
 #include <Kernel/Storage/NVMe/NVMeController.h>
 #include <Kernel/Storage/NVMe/NVMeInterruptQueue.h>
@@ -14,21 +16,24 @@
 namespace Kernel {
 ErrorOr<NonnullLockRefPtr<NVMeQueue>> NVMeQueue::try_create(u16 qid, Optional<u8> irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs)
 {
-    // Note: Allocate DMA region for RW operation. For now the requests don't exceed more than 4096 bytes (Storage device takes care of it)
-    RefPtr<Memory::PhysicalPage> rw_dma_page;
-    auto rw_dma_region = TRY(MM.allocate_dma_buffer_page("NVMe Queue Read/Write DMA"sv, Memory::Region::Access::ReadWrite, rw_dma_page));
+    // Note: Allocate a page of DMA memory for each request that can be in flight on an IO queue. For now the requests
+    // don't exceed more than 4096 bytes (Storage device takes care of it)
+    OwnPtr<Memory::Region> rw_dma_region;
+    NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages;
+    if (qid != 0) {
+        VERIFY(q_depth <= IO_QUEUE_SIZE);
+        rw_dma_region = TRY(MM.allocate_dma_buffer_pages((q_depth - 1) * PAGE_SIZE, "NVMe Queue Read/Write DMA"sv, Memory::Region::Access::ReadWrite, rw_dma_pages));
+    }
     if (!irq.has_value()) {
-        auto queue = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) NVMePollQueue(move(rw_dma_region), *rw_dma_page, qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
+        auto queue = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) NVMePollQueue(move(rw_dma_region), move(rw_dma_pages), qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
         return queue;
     }
-    auto queue = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) NVMeInterruptQueue(move(rw_dma_region), *rw_dma_page, qid, irq.value(), q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
+    auto queue = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) NVMeInterruptQueue(move(rw_dma_region), move(rw_dma_pages), qid, irq.value(), q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
     return queue;
 }
 
-UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs)
-    : m_current_request(nullptr)
-    , m_rw_dma_region(move(rw_dma_region))
-    , m_qid(qid)
+UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(OwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs)
+    : m_qid(qid)
     , m_admin_queue(qid == 0)
     , m_qdepth(q_depth)
     , m_cq_dma_region(move(cq_dma_region))
@@ -36,11 +41,16 @@ UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_regio
     , m_sq_dma_region(move(sq_dma_region))
     , m_sq_dma_page(sq_dma_page)
     , m_db_regs(move(db_regs))
-    , m_rw_dma_page(rw_dma_page)
-
+    , m_rw_dma_region(move(rw_dma_region))
+    , m_rw_dma_pages(move(rw_dma_pages))
 {
     m_sqe_array = { reinterpret_cast<NVMeSubmission*>(m_sq_dma_region->vaddr().as_ptr()), m_qdepth };
     m_cqe_array = { reinterpret_cast<NVMeCompletion*>(m_cq_dma_region->vaddr().as_ptr()), m_qdepth };
+
+    // The vectors have enough inline capacity for every slot, so this doesn't allocate.
+    m_requests.resize(m_rw_dma_pages.size());
+    for (size_t command_id = m_rw_dma_pages.size(); command_id > 0; --command_id)
+        m_free_command_ids.unchecked_append(command_id - 1);
 }
 
 bool NVMeQueue::cqe_available()
@@ -63,28 +73,37 @@ void NVMeQueue::update_cqe_head()
 u32 NVMeQueue::process_cq()
 {
     u32 nr_of_processed_cqes = 0;
-    while (cqe_available()) {
-        u16 status;
-        u16 cmdid;
-        ++nr_of_processed_cqes;
-        status = CQ_STATUS_FIELD(m_cqe_array[m_cq_head].status);
-        cmdid = m_cqe_array[m_cq_head].command_id;
-        dbgln_if(NVME_DEBUG, "NVMe: Completion with status {:x} and command identifier {}. CQ_HEAD: {}", status, cmdid, m_cq_head);
-        // TODO: We don't use AsyncBlockDevice requests for admin queue as it is only applicable for a block device (NVMe namespace)
-        //  But admin commands precedes namespace creation. Unify requests to avoid special conditions
-        if (m_admin_queue == false) {
-            // As the block layer calls are now sync (as we wait on each requests),
-            // everything is operated on a single request similar to BMIDE driver.
-            // TODO: Remove this constraint eventually.
-            VERIFY(cmdid == m_prev_sq_tail);
-            if (m_current_request) {
-                complete_current_request(status);
+    for (;;) {
+        // Reap as many completions as are available before ringing the doorbell once,
+        // and only then complete the requests, outside of the completion queue lock.
+        Array<Completion, IO_QUEUE_SIZE> completions;
+        size_t nr_of_completions = 0;
+        size_t batch_size = 0;
+        {
+            SpinlockLocker lock(m_cq_lock);
+            while (batch_size < completions.size() && cqe_available()) {
+                u16 status = CQ_STATUS_FIELD(m_cqe_array[m_cq_head].status);
+                u16 cmdid = m_cqe_array[m_cq_head].command_id;
+                dbgln_if(NVME_DEBUG, "NVMe: Completion with status {:x} and command identifier {}. CQ_HEAD: {}", status, cmdid, m_cq_head);
+                // TODO: We don't use AsyncBlockDevice requests for admin queue as it is only applicable for a block device (NVMe namespace)
+                //  But admin commands precedes namespace creation. Unify requests to avoid special conditions
+                if (m_admin_queue == false) {
+                    VERIFY(cmdid < m_requests.size());
+                    completions[nr_of_completions++] = { cmdid, status };
+                }
+                update_cqe_head();
+                ++batch_size;
+            }
+            if (batch_size) {
+                update_cq_doorbell();
+                m_nr_of_outstanding_commands -= batch_size;
             }
         }
-        update_cqe_head();
-    }
-    if (nr_of_processed_cqes) {
-        update_cq_doorbell();
+        nr_of_processed_cqes += batch_size;
+        if (nr_of_completions)
+            complete_requests(completions.span().trim(nr_of_completions));
+        if (batch_size < completions.size())
+            break;
     }
     return nr_of_processed_cqes;
 }
@@ -92,11 +111,12 @@ u32 NVMeQueue::process_cq()
 void NVMeQueue::submit_sqe(NVMeSubmission& sub)
 {
     SpinlockLocker lock(m_sq_lock);
-    // For now let's use sq tail as a unique command id.
-    sub.cmdid = m_sq_tail;
-    m_prev_sq_tail = m_sq_tail;
+    // The admin queue uses the sq tail as a unique command id, IO commands are tagged with their request slot.
+    if (m_admin_queue)
+        sub.cmdid = m_sq_tail;
 
     memcpy(&m_sqe_array[m_sq_tail], &sub, sizeof(NVMeSubmission));
+    ++m_nr_of_outstanding_commands;
     {
         u32 temp_sq_tail = m_sq_tail + 1;
         if (temp_sq_tail == m_qdepth)
@@ -133,42 +153,92 @@ u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub)
     return status;
 }
 
-void NVMeQueue::read(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count)
+void NVMeQueue::enqueue_request(AsyncBlockDeviceRequest& request, u16 nsid)
+{
+    VERIFY(!m_admin_queue);
+    SpinlockLocker lock(m_request_lock);
+    if (m_free_command_ids.is_empty()) {
+        auto result = m_pending_requests.try_append({ request, nsid });
+        lock.unlock();
+        if (result.is_error())
+            request.complete(AsyncDeviceRequest::OutOfMemory);
+    } else {
+        auto command_id = m_free_command_ids.take_last();
+        m_requests[command_id] = request;
+        lock.unlock();
+        submit_request(command_id, request, nsid);
+    }
+
+    wait_for_completion(request);
+}
+
+void NVMeQueue::submit_request(u16 command_id, AsyncBlockDeviceRequest& request, u16 nsid)
 {
     NVMeSubmission sub {};
-    SpinlockLocker m_lock(m_request_lock);
-    m_current_request = request;
 
-    sub.op = OP_NVME_READ;
+    if (request.request_type() == AsyncBlockDeviceRequest::Read) {
+        sub.op = OP_NVME_READ;
+    } else {
+        if (auto result = request.read_from_buffer(request.buffer(), request_buffer(command_id), request.buffer_size()); result.is_error()) {
+            finish_request(command_id, AsyncDeviceRequest::MemoryFault);
+            return;
+        }
+        sub.op = OP_NVME_WRITE;
+    }
+    sub.cmdid = command_id;
     sub.rw.nsid = nsid;
-    sub.rw.slba = AK::convert_between_host_and_little_endian(index);
+    sub.rw.slba = AK::convert_between_host_and_little_endian(request.block_index());
     // No. of lbas is 0 based
-    sub.rw.length = AK::convert_between_host_and_little_endian((count - 1) & 0xFFFF);
-    sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_page->paddr().as_ptr()));
+    sub.rw.length = AK::convert_between_host_and_little_endian((request.block_count() - 1) & 0xFFFF);
+    sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_pages[command_id].paddr().as_ptr()));
 
     full_memory_barrier();
-    submit_sqe(sub);
+    // This also runs while completing another request, so don't let poll queues wait for completions here.
+    NVMeQueue::submit_sqe(sub);
 }
 
-void NVMeQueue::write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count)
+void NVMeQueue::complete_request(u16 command_id, u16 status)
 {
-    NVMeSubmission sub {};
-    SpinlockLocker m_lock(m_request_lock);
-    m_current_request = request;
+    LockRefPtr<AsyncBlockDeviceRequest> request;
+    {
+        SpinlockLocker lock(m_request_lock);
+        request = m_requests[command_id];
+    }
+    VERIFY(request);
 
-    if (auto result = m_current_request->read_from_buffer(m_current_request->buffer(), m_rw_dma_region->vaddr().as_ptr(), m_current_request->buffer_size()); result.is_error()) {
-        complete_current_request(AsyncDeviceRequest::MemoryFault);
+    if (status) {
+        finish_request(command_id, AsyncBlockDeviceRequest::Failure);
         return;
     }
-    sub.op = OP_NVME_WRITE;
-    sub.rw.nsid = nsid;
-    sub.rw.slba = AK::convert_between_host_and_little_endian(index);
-    // No. of lbas is 0 based
-    sub.rw.length = AK::convert_between_host_and_little_endian((count - 1) & 0xFFFF);
-    sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_page->paddr().as_ptr()));
+    // The slot is still ours until it's finished, so nobody else can be using its DMA page.
+    if (request->request_type() == AsyncBlockDeviceRequest::RequestType::Read) {
+        if (auto result = request->write_to_buffer(request->buffer(), request_buffer(command_id), request->buffer_size()); result.is_error()) {
+            finish_request(command_id, AsyncDeviceRequest::MemoryFault);
+            return;
+        }
+    }
+    finish_request(command_id, AsyncDeviceRequest::Success);
+}
 
-    full_memory_barrier();
-    submit_sqe(sub);
+void NVMeQueue::finish_request(u16 command_id, AsyncDeviceRequest::RequestResult result)
+{
+    LockRefPtr<AsyncBlockDeviceRequest> request;
+    Optional<PendingRequest> next_request;
+    {
+        SpinlockLocker lock(m_request_lock);
+        request = move(m_requests[command_id]);
+        // Hand the slot straight to the oldest waiting request, if there is one.
+        if (!m_pending_requests.is_empty()) {
+            next_request = m_pending_requests.take_first();
+            m_requests[command_id] = next_request->request;
+        } else {
+            m_free_command_ids.unchecked_append(command_id);
+        }
+    }
+    request->complete(result);
+
+    if (next_request.has_value())
+        submit_request(command_id, next_request->request, next_request->nsid);
 }
 
 UNMAP_AFTER_INIT NVMeQueue::~NVMeQueue() = default;
@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/AtomicRefCounted.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <AK/Types.h>
+#include <AK/Vector.h>
 #include <Kernel/Bus/PCI/Device.h>
+#include <Kernel/Devices/AsyncDeviceRequest.h>
 #include <Kernel/Interrupts/IRQHandler.h>
 #include <Kernel/Library/LockRefPtr.h>
 #include <Kernel/Library/NonnullLockRefPtr.h>
@@ -33,23 +36,41 @@ public:
     static ErrorOr<NonnullLockRefPtr<NVMeQueue>> try_create(u16 qid, Optional<u8> irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs);
     bool is_admin_queue() { return m_admin_queue; };
     u16 submit_sync_sqe(NVMeSubmission&);
-    void read(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
-    void write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
+    // Submits the request right away if one of the queue's request slots is free, or once one frees up.
+    void enqueue_request(AsyncBlockDeviceRequest&, u16 nsid);
     virtual void submit_sqe(NVMeSubmission&);
     virtual ~NVMeQueue();
 
 protected:
+    struct Completion {
+        u16 command_id;
+        u16 status;
+    };
+
     u32 process_cq();
+    bool has_outstanding_commands() const { return m_nr_of_outstanding_commands.load() != 0; }
+    // Interrupt queues complete requests from their IRQ handler, poll queues have to look for completions themselves.
+    virtual void wait_for_completion(AsyncBlockDeviceRequest&) { }
+    void complete_request(u16 command_id, u16 status);
+    void finish_request(u16 command_id, AsyncDeviceRequest::RequestResult);
     void update_sq_doorbell()
     {
         m_db_regs->sq_tail = m_sq_tail;
     }
-    NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs);
+    NVMeQueue(OwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs);
 
 private:
+    struct PendingRequest {
+        NonnullLockRefPtr<AsyncBlockDeviceRequest> request;
+        u16 nsid;
+    };
+
     bool cqe_available();
     void update_cqe_head();
-    virtual void complete_current_request(u16 status) = 0;
+    // Called with a batch of completed I/O commands, from whichever context processed the completion queue.
+    virtual void complete_requests(Span<Completion const>) = 0;
+    void submit_request(u16 command_id, AsyncBlockDeviceRequest&, u16 nsid);
+    u8* request_buffer(u16 command_id) { return m_rw_dma_region->vaddr().offset(command_id * PAGE_SIZE).as_ptr(); }
     void update_cq_doorbell()
     {
         m_db_regs->cq_head = m_cq_head;
@@ -57,16 +78,14 @@ private:
 
 protected:
     Spinlock m_cq_lock { LockRank::Interrupts };
-    LockRefPtr<AsyncBlockDeviceRequest> m_current_request;
-    NonnullOwnPtr<Memory::Region> m_rw_dma_region;
     Spinlock m_request_lock { LockRank::None };
 
 private:
     u16 m_qid {};
     u8 m_cq_valid_phase { 1 };
     u16 m_sq_tail {};
-    u16 m_prev_sq_tail {};
     u16 m_cq_head {};
+    Atomic<u32> m_nr_of_outstanding_commands { 0 };
     bool m_admin_queue { false };
     u32 m_qdepth {};
     Spinlock m_sq_lock { LockRank::Interrupts };
@@ -77,6 +96,15 @@ private:
     NonnullRefPtrVector<Memory::PhysicalPage> m_sq_dma_page;
     Span<NVMeCompletion> m_cqe_array;
     Memory::TypedMapping<DoorbellRegister volatile> m_db_regs;
-    NonnullRefPtr<Memory::PhysicalPage> m_rw_dma_page;
+
+    // I/O commands are identified by the index of the request slot they occupy, and each slot has
+    // its own page of DMA memory. There is one slot less than the queue depth, so the submission
+    // queue can never overflow.
+    OwnPtr<Memory::Region> m_rw_dma_region;
+    NonnullRefPtrVector<Memory::PhysicalPage> m_rw_dma_pages;
+    Vector<LockRefPtr<AsyncBlockDeviceRequest>, IO_QUEUE_SIZE> m_requests;
+    Vector<u16, IO_QUEUE_SIZE> m_free_command_ids;
+    // Requests that came in while all slots were taken.
+    Vector<PendingRequest> m_pending_requests;
 };
 }
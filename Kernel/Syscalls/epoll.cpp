@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+ErrorOr<FlatPtr> Process::sys$epoll_create(int flags)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    auto event_poll = TRY(EventPoll::try_create());
+    auto description = TRY(OpenFileDescription::try_create(move(event_poll)));
+
+    description->set_readable(true);
+
+    u32 fd_flags = 0;
+    if (flags & EPOLL_CLOEXEC)
+        fd_flags |= FD_CLOEXEC;
+
+    return m_fds.with_exclusive([&](auto& fds) -> ErrorOr<FlatPtr> {
+        auto new_fd = TRY(fds.allocate());
+        fds[new_fd.fd].set(move(description), fd_flags);
+        return new_fd.fd;
+    });
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_ctl(int epfd, int op, int fd, Userspace<epoll_event const*> user_event)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    auto epoll_description = TRY(open_file_description(epfd));
+    auto* event_poll = epoll_description->event_poll();
+    if (!event_poll)
+        return EINVAL;
+
+    auto description = TRY(open_file_description(fd));
+
+    switch (op) {
+    case EPOLL_CTL_ADD: {
+        auto event = TRY(copy_typed_from_user(user_event));
+        TRY(event_poll->add_interest(*description, event));
+        return 0;
+    }
+    case EPOLL_CTL_MOD: {
+        auto event = TRY(copy_typed_from_user(user_event));
+        TRY(event_poll->modify_interest(*description, event));
+        return 0;
+    }
+    case EPOLL_CTL_DEL:
+        TRY(event_poll->remove_interest(*description));
+        return 0;
+    default:
+        return EINVAL;
+    }
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_wait(Userspace<Syscall::SC_epoll_wait_params const*> user_params)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    auto params = TRY(copy_typed_from_user(user_params));
+
+    if (params.max_events <= 0)
+        return EINVAL;
+
+    auto epoll_description = TRY(open_file_description(params.epfd));
+    auto* event_poll = epoll_description->event_poll();
+    if (!event_poll)
+        return EINVAL;
+
+    Thread::BlockTimeout timeout;
+    if (params.timeout) {
+        auto timeout_time = TRY(copy_time_from_user(params.timeout));
+        timeout = Thread::BlockTimeout(false, &timeout_time);
+    }
+
+    sigset_t sigmask = {};
+    if (params.sigmask)
+        TRY(copy_from_user(&sigmask, params.sigmask));
+
+    Vector<epoll_event> events;
+    TRY(events.try_resize(min(static_cast<size_t>(params.max_events), OpenFileDescriptions::max_open())));
+
+    auto* current_thread = Thread::current();
+
+    u32 previous_signal_mask = 0;
+    if (params.sigmask)
+        previous_signal_mask = current_thread->update_signal_mask(sigmask);
+    ScopeGuard rollback_signal_mask([&]() {
+        if (params.sigmask)
+            current_thread->update_signal_mask(previous_signal_mask);
+    });
+
+    dbgln_if(POLL_SELECT_DEBUG, "epoll_wait on fd {}, max_events={}, timeout={}", params.epfd, params.max_events, params.timeout);
+
+    for (;;) {
+        // Only the ready list is looked at, so this doesn't depend on how many descriptions are registered.
+        auto count = event_poll->collect_ready_events(events.span());
+        if (count > 0) {
+            TRY(copy_n_to_user(params.events, events.data(), count));
+            return count;
+        }
+
+        auto result = event_poll->wait_queue().wait_on(timeout, "EventPoll"sv);
+        if (result.was_interrupted())
+            return EINTR;
+        if (result == Thread::BlockResult::InterruptedByTimeout)
+            return 0;
+    }
+}
+
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+// Large enough to keep the number of trips through the file system low, small enough to not tie up much memory per call.
+static constexpr size_t sendfile_chunk_size = 64 * KiB;
+
+// NOTE: The offset is passed by pointer because off_t is 64bit,
+// hence it can't be passed by register on 32bit platforms.
+ErrorOr<FlatPtr> Process::sys$sendfile(int out_fd, int in_fd, Userspace<off_t*> userspace_offset, size_t count)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+    if (count > NumericLimits<ssize_t>::max())
+        return EINVAL;
+
+    auto in_description = TRY(open_file_description(in_fd));
+    if (!in_description->is_readable())
+        return EBADF;
+    if (in_description->is_directory())
+        return EISDIR;
+    auto out_description = TRY(open_file_description(out_fd));
+    if (!out_description->is_writable())
+        return EBADF;
+
+    // NOTE: Without an offset, we read from and advance the file offset of in_fd like read() does.
+    Optional<off_t> base_offset;
+    if (userspace_offset) {
+        base_offset = TRY(copy_typed_from_user(userspace_offset));
+        if (base_offset.value() < 0)
+            return EINVAL;
+        if (!in_description->file().is_seekable())
+            return ESPIPE;
+    }
+
+    if (count == 0)
+        return 0;
+
+    // The data only ever passes through this kernel buffer, instead of being copied out to userspace and back in again.
+    auto chunk_size = min(count, sendfile_chunk_size);
+    auto chunk = TRY(KBuffer::try_create_with_size("sendfile"sv, chunk_size, Memory::Region::Access::ReadWrite, AllocationStrategy::AllocateNow));
+    auto chunk_buffer = UserOrKernelBuffer::for_kernel_buffer(chunk->data());
+
+    size_t total_sent = 0;
+    while (total_sent < count) {
+        auto size = min(count - total_sent, chunk_size);
+        auto nread_or_error = base_offset.has_value()
+            ? in_description->read(chunk_buffer, base_offset.value() + total_sent, size)
+            : in_description->read(chunk_buffer, size);
+        if (nread_or_error.is_error()) {
+            if (total_sent > 0)
+                break;
+            return nread_or_error.release_error();
+        }
+        auto nread = nread_or_error.value();
+        if (nread == 0)
+            break;
+
+        auto nwritten_or_error = do_write(*out_description, chunk_buffer, nread);
+        if (nwritten_or_error.is_error() && total_sent == 0) {
+            if (!base_offset.has_value())
+                (void)in_description->seek(-static_cast<off_t>(nread), SEEK_CUR);
+            return nwritten_or_error.release_error();
+        }
+        auto nwritten = nwritten_or_error.is_error() ? 0 : nwritten_or_error.value();
+        total_sent += nwritten;
+
+        if (nwritten < nread) {
+            // Don't skip over what couldn't be written.
+            if (!base_offset.has_value())
+                (void)in_description->seek(-static_cast<off_t>(nread - nwritten), SEEK_CUR);
+            break;
+        }
+    }
+
+    if (base_offset.has_value()) {
+        off_t new_offset = base_offset.value() + total_sent;
+        TRY(copy_to_user(userspace_offset, &new_offset));
+    }
+    return total_sent;
+}
+
+}
@@ -60,6 +60,7 @@ class Thread
     friend class Process;
     friend class Scheduler;
     friend struct ThreadReadyQueue;
+    friend struct ThreadReadyQueues;
 
 public:
     inline static Thread* current()
@@ -1100,7 +1101,13 @@ private:
     BlockResult block_impl(BlockTimeout const&, Blocker&);
 
     IntrusiveListNode<Thread> m_process_thread_list_node;
+    // Serializes putting the thread into a ready queue, taking it out and moving it between queues. It is taken
+    // before the lock of the ready queues, code that already holds a queue lock may only try to take it.
+    Spinlock m_runnable_lock { LockRank::None };
     int m_runnable_priority { -1 };
+    // Only changed with both m_runnable_lock and the lock of the ready queues the thread is in (or goes to) held,
+    // but read without them.
+    Atomic<int> m_runnable_cpu { -1 };
 
     friend class WaitQueue;
 
@@ -395,12 +395,12 @@ public:)~~~");
     message_generator.appendln(R"~~~(
     virtual bool valid() const override { return m_ipc_message_valid; }
 
-    virtual IPC::MessageBuffer encode() const override
+    virtual IPC::MessageBuffer encode(IPC::SharedPayloadPool* payload_pool = nullptr) const override
     {
         VERIFY(valid());
 
         IPC::MessageBuffer buffer;
-        IPC::Encoder stream(buffer);
+        IPC::Encoder stream(buffer, payload_pool);
         stream << endpoint_magic();
         stream << (int)MessageID::@message.pascal_name@;)~~~");
 
@@ -665,7 +665,7 @@ public:
     virtual u32 magic() const override { return @endpoint.magic@; }
     virtual DeprecatedString name() const override { return "@endpoint.name@"; }
 
-    virtual OwnPtr<IPC::MessageBuffer> handle(const IPC::Message& message) override
+    virtual OwnPtr<IPC::MessageBuffer> handle(const IPC::Message& message, [[maybe_unused]] IPC::SharedPayloadPool* payload_pool = nullptr) override
     {
         switch (message.message_id()) {)~~~");
     for (auto const& message : endpoint.messages) {
@@ -694,14 +694,14 @@ public:
             [[maybe_unused]] auto& request = static_cast<const Messages::@endpoint.name@::@message.pascal_name@&>(message);
             @handler_name@(@arguments@);
             auto response = Messages::@endpoint.name@::@message.response_type@ { };
-            return make<IPC::MessageBuffer>(response.encode());)~~~");
+            return make<IPC::MessageBuffer>(response.encode(payload_pool));)~~~");
                 } else {
                     message_generator.appendln(R"~~~(
             [[maybe_unused]] auto& request = static_cast<const Messages::@endpoint.name@::@message.pascal_name@&>(message);
             auto response = @handler_name@(@arguments@);
             if (!response.valid())
                 return {};
-            return make<IPC::MessageBuffer>(response.encode());)~~~");
+            return make<IPC::MessageBuffer>(response.encode(payload_pool));)~~~");
                 }
             } else {
                 message_generator.appendln(R"~~~(
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Format.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibTest/TestCase.h>
+#include <pthread.h>
+#include <sched.h>
+
+// Passes a token around a ring of threads, every thread yields until it's its turn.
+// With more threads than processors this mostly measures how fast the scheduler can
+// pick the next thread, which should stay flat as the processor count goes up.
+
+struct PingPongContext {
+    Atomic<size_t> turn { 0 };
+    size_t thread_count { 0 };
+    size_t round_count { 0 };
+};
+
+struct PingPongThread {
+    PingPongContext* context { nullptr };
+    size_t index { 0 };
+};
+
+static void* ping_pong_thread(void* argument)
+{
+    auto& thread = *static_cast<PingPongThread*>(argument);
+    auto& context = *thread.context;
+    auto last_turn = context.thread_count * context.round_count;
+
+    for (size_t next_turn = thread.index; next_turn < last_turn; next_turn += context.thread_count) {
+        while (context.turn.load(AK::MemoryOrder::memory_order_acquire) != next_turn)
+            sched_yield();
+        context.turn.store(next_turn + 1, AK::MemoryOrder::memory_order_release);
+    }
+    return nullptr;
+}
+
+static void yield_ping_pong(size_t thread_count, size_t round_count)
+{
+    PingPongContext context;
+    context.thread_count = thread_count;
+    context.round_count = round_count;
+
+    Vector<PingPongThread> threads;
+    Vector<pthread_t> thread_ids;
+    threads.resize(thread_count);
+    thread_ids.resize(thread_count);
+
+    auto timer = Core::ElapsedTimer::start_new();
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads[i] = { &context, i };
+        EXPECT_EQ(pthread_create(&thread_ids[i], nullptr, ping_pong_thread, &threads[i]), 0);
+    }
+    for (auto thread_id : thread_ids)
+        EXPECT_EQ(pthread_join(thread_id, nullptr), 0);
+    auto elapsed_ms = max(timer.elapsed(), 1);
+
+    EXPECT_EQ(context.turn.load(), thread_count * round_count);
+    outln("{} threads: {} handoffs in {} ms ({} handoffs/s)", thread_count, thread_count * round_count, elapsed_ms, thread_count * round_count * 1000 / elapsed_ms);
+}
+
+BENCHMARK_CASE(yield_ping_pong_2_threads)
+{
+    yield_ping_pong(2, 20000);
+}
+
+BENCHMARK_CASE(yield_ping_pong_4_threads)
+{
+    yield_ping_pong(4, 10000);
+}
+
+BENCHMARK_CASE(yield_ping_pong_8_threads)
+{
+    yield_ping_pong(8, 5000);
+}
+
+BENCHMARK_CASE(yield_ping_pong_16_threads)
+{
+    yield_ping_pong(16, 2500);
+}
+
+BENCHMARK_CASE(yield_ping_pong_32_threads)
+{
+    yield_ping_pong(32, 1250);
+}
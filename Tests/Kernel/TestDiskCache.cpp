@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/Vector.h>
+#include <LibCore/Stream.h>
+#include <LibCore/System.h>
+#include <LibTest/TestCase.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static constexpr size_t file_size = 32 * MiB;
+static constexpr size_t chunk_size = 16 * MiB;
+
+static u64 cache_size_of(StringView mount_point)
+{
+    auto file = MUST(Core::Stream::File::open("/sys/kernel/df"sv, Core::Stream::OpenMode::Read));
+    auto json = MUST(JsonValue::from_string(MUST(file->read_until_eof())));
+    u64 cache_size = 0;
+    json.as_array().for_each([&](auto& value) {
+        auto& fs_object = value.as_object();
+        if (fs_object.get("mount_point"sv).to_deprecated_string() == mount_point)
+            cache_size = fs_object.get("cache_size"sv).to_u64();
+    });
+    return cache_size;
+}
+
+TEST_CASE(disk_cache_grows_and_shrinks_under_memory_pressure)
+{
+    char path[] = "/home/anon/disk-cache-test.XXXXXX";
+    auto fd = MUST(Core::System::mkstemp(path));
+    auto initial_cache_size = cache_size_of("/"sv);
+    EXPECT(initial_cache_size > 0u);
+
+    // Touching more blocks than the cache holds makes it grow rather than evict.
+    auto buffer = MUST(ByteBuffer::create_zeroed(1 * MiB));
+    for (size_t offset = 0; offset < file_size; offset += buffer.size())
+        EXPECT_EQ(MUST(Core::System::write(fd, buffer)), static_cast<ssize_t>(buffer.size()));
+    sync();
+    auto grown_cache_size = cache_size_of("/"sv);
+    EXPECT(grown_cache_size > initial_cache_size);
+
+    // Now commit memory until there's none left. The cache has to give memory back before we get there.
+    Vector<void*> chunks;
+    for (;;) {
+        auto* chunk = mmap(nullptr, chunk_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+        if (chunk == MAP_FAILED)
+            break;
+        chunks.append(chunk);
+    }
+    for (auto* chunk : chunks)
+        MUST(Core::System::munmap(chunk, chunk_size));
+    // Nothing reads from the disk in between, so the cache hasn't had a reason to grow back yet.
+    auto cache_size_under_pressure = cache_size_of("/"sv);
+
+    EXPECT(!chunks.is_empty());
+    EXPECT(cache_size_under_pressure < grown_cache_size);
+    EXPECT(cache_size_under_pressure > 0u);
+
+    MUST(Core::System::close(fd));
+    MUST(Core::System::unlink({ path, strlen(path) }));
+}
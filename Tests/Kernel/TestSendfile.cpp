@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <LibCore/System.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/ThreadPool.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+// More than one of the chunks that the kernel copies through at a time.
+static constexpr size_t test_file_size = 150 * KiB + 13;
+
+static u8 test_byte(size_t index)
+{
+    return static_cast<u8>(index * 7 + index / 509);
+}
+
+static int create_test_file()
+{
+    char pattern[] = "/tmp/sendfile.XXXXXX";
+    auto fd = MUST(Core::System::mkstemp(pattern));
+    MUST(Core::System::unlink({ pattern, strlen(pattern) }));
+
+    Array<u8, 4096> buffer;
+    for (size_t offset = 0; offset < test_file_size; offset += buffer.size()) {
+        auto size = min(buffer.size(), test_file_size - offset);
+        for (size_t i = 0; i < size; ++i)
+            buffer[i] = test_byte(offset + i);
+        EXPECT_EQ(MUST(Core::System::write(fd, { buffer.data(), size })), static_cast<ssize_t>(size));
+    }
+    return fd;
+}
+
+static int create_output_file()
+{
+    char pattern[] = "/tmp/sendfile-out.XXXXXX";
+    auto fd = MUST(Core::System::mkstemp(pattern));
+    MUST(Core::System::unlink({ pattern, strlen(pattern) }));
+    return fd;
+}
+
+// Checks that the output file holds exactly the bytes [offset, offset + size) of the test file.
+static void expect_output_matches(int output_fd, size_t offset, size_t size)
+{
+    EXPECT_EQ(static_cast<size_t>(MUST(Core::System::fstat(output_fd)).st_size), size);
+
+    Array<u8, 4096> buffer;
+    size_t position = 0;
+    while (position < size) {
+        auto nread = pread(output_fd, buffer.data(), buffer.size(), position);
+        VERIFY(nread > 0);
+        for (size_t i = 0; i < static_cast<size_t>(nread); ++i) {
+            if (buffer[i] != test_byte(offset + position + i)) {
+                FAIL(DeprecatedString::formatted("Mismatch at byte {}", position + i));
+                return;
+            }
+        }
+        position += nread;
+    }
+}
+
+TEST_CASE(sendfile_with_offset_leaves_file_offset_alone)
+{
+    auto input_fd = create_test_file();
+    auto output_fd = create_output_file();
+
+    MUST(Core::System::lseek(input_fd, 0, SEEK_SET));
+    off_t offset = 1000;
+    auto nsent = MUST(Core::System::sendfile(output_fd, input_fd, &offset, test_file_size));
+    EXPECT_EQ(nsent, test_file_size - 1000);
+    EXPECT_EQ(offset, static_cast<off_t>(test_file_size));
+    EXPECT_EQ(MUST(Core::System::lseek(input_fd, 0, SEEK_CUR)), 0);
+    expect_output_matches(output_fd, 1000, test_file_size - 1000);
+
+    MUST(Core::System::close(input_fd));
+    MUST(Core::System::close(output_fd));
+}
+
+TEST_CASE(sendfile_without_offset_advances_file_offset)
+{
+    auto input_fd = create_test_file();
+    auto output_fd = create_output_file();
+
+    MUST(Core::System::lseek(input_fd, 100, SEEK_SET));
+    auto nsent = MUST(Core::System::sendfile(output_fd, input_fd, nullptr, 5000));
+    EXPECT_EQ(nsent, 5000u);
+    EXPECT_EQ(MUST(Core::System::lseek(input_fd, 0, SEEK_CUR)), 5100);
+    expect_output_matches(output_fd, 100, 5000);
+
+    MUST(Core::System::close(input_fd));
+    MUST(Core::System::close(output_fd));
+}
+
+TEST_CASE(sendfile_into_pipe)
+{
+    auto input_fd = create_test_file();
+    auto pipe_fds = MUST(Core::System::pipe2(0));
+
+    off_t offset = 0;
+    auto nsent = MUST(Core::System::sendfile(pipe_fds[1], input_fd, &offset, 1234));
+    EXPECT_EQ(nsent, 1234u);
+
+    Array<u8, 1234> buffer;
+    EXPECT_EQ(MUST(Core::System::read(pipe_fds[0], buffer)), static_cast<ssize_t>(buffer.size()));
+    for (size_t i = 0; i < buffer.size(); ++i)
+        EXPECT_EQ(buffer[i], test_byte(i));
+
+    MUST(Core::System::close(input_fd));
+    MUST(Core::System::close(pipe_fds[0]));
+    MUST(Core::System::close(pipe_fds[1]));
+}
+
+TEST_CASE(sendfile_errors)
+{
+    auto input_fd = create_test_file();
+    auto output_fd = create_output_file();
+    off_t offset = 0;
+
+    auto result = Core::System::sendfile(output_fd, -1, &offset, 10);
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error().code(), EBADF);
+
+    auto read_only_fd = MUST(Core::System::open("/etc/passwd"sv, O_RDONLY));
+    result = Core::System::sendfile(read_only_fd, input_fd, &offset, 10);
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error().code(), EBADF);
+    MUST(Core::System::close(read_only_fd));
+
+    auto directory_fd = MUST(Core::System::open("/tmp"sv, O_RDONLY | O_DIRECTORY));
+    result = Core::System::sendfile(output_fd, directory_fd, &offset, 10);
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error().code(), EISDIR);
+    MUST(Core::System::close(directory_fd));
+
+    auto pipe_fds = MUST(Core::System::pipe2(0));
+    result = Core::System::sendfile(output_fd, pipe_fds[0], &offset, 10);
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error().code(), ESPIPE);
+    MUST(Core::System::close(pipe_fds[0]));
+    MUST(Core::System::close(pipe_fds[1]));
+
+    offset = -1;
+    result = Core::System::sendfile(output_fd, input_fd, &offset, 10);
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error().code(), EINVAL);
+
+    MUST(Core::System::close(input_fd));
+    MUST(Core::System::close(output_fd));
+}
+
+TEST_CASE(sendfile_from_several_threads_at_once)
+{
+    // sendfile() doesn't take the process' big lock, so these all make progress at the same time.
+    auto input_fd = create_test_file();
+    Array<int, 4> output_fds;
+    for (auto& fd : output_fds)
+        fd = create_output_file();
+
+    Threading::ThreadPool pool(output_fds.size());
+    Atomic<size_t> total_sent { 0 };
+    pool.for_each_index(output_fds.size(), [&](size_t index) {
+        off_t offset = 0;
+        for (size_t round = 0; round < 8; ++round) {
+            offset = 0;
+            MUST(Core::System::ftruncate(output_fds[index], 0));
+            auto nsent = MUST(Core::System::sendfile(output_fds[index], input_fd, &offset, test_file_size));
+            total_sent.fetch_add(nsent);
+        }
+    });
+    EXPECT_EQ(total_sent.load(), output_fds.size() * 8 * test_file_size);
+
+    for (auto fd : output_fds) {
+        expect_output_matches(fd, 0, test_file_size);
+        MUST(Core::System::close(fd));
+    }
+    MUST(Core::System::close(input_fd));
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+static int add_interest(int epfd, int fd, u32 events)
+{
+    struct epoll_event event {};
+    event.events = events;
+    event.data.fd = fd;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event);
+}
+
+TEST_CASE(epoll_level_triggered)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    EXPECT_NE(epfd, -1);
+
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    EXPECT_EQ(add_interest(epfd, pipe_fds[0], EPOLLIN), 0);
+
+    struct epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 1000), 1);
+    EXPECT_EQ(events[0].data.fd, pipe_fds[0]);
+    EXPECT(events[0].events & EPOLLIN);
+
+    // Still readable, so it's reported again.
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+
+    char c;
+    EXPECT_EQ(read(pipe_fds[0], &c, 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(epfd);
+}
+
+TEST_CASE(epoll_edge_triggered)
+{
+    int epfd = epoll_create1(0);
+    EXPECT_NE(epfd, -1);
+
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    EXPECT_EQ(add_interest(epfd, pipe_fds[0], EPOLLIN | EPOLLET), 0);
+
+    struct epoll_event events[4];
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 1000), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "y", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 1000), 1);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(epfd);
+}
+
+TEST_CASE(epoll_oneshot)
+{
+    int epfd = epoll_create1(0);
+    EXPECT_NE(epfd, -1);
+
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    EXPECT_EQ(add_interest(epfd, pipe_fds[0], EPOLLIN | EPOLLONESHOT), 0);
+
+    struct epoll_event events[4];
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 1000), 1);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    // Modifying the interest arms it again.
+    struct epoll_event event {};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.fd = pipe_fds[0];
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_MOD, pipe_fds[0], &event), 0);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 1000), 1);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(epfd);
+}
+
+TEST_CASE(epoll_ctl_errors)
+{
+    int epfd = epoll_create1(0);
+    EXPECT_NE(epfd, -1);
+
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_DEL, pipe_fds[0], nullptr), -1);
+    EXPECT_EQ(errno, ENOENT);
+
+    EXPECT_EQ(add_interest(epfd, pipe_fds[0], EPOLLIN), 0);
+    EXPECT_EQ(add_interest(epfd, pipe_fds[0], EPOLLIN), -1);
+    EXPECT_EQ(errno, EEXIST);
+
+    EXPECT_EQ(add_interest(epfd, epfd, EPOLLIN), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    EXPECT_EQ(add_interest(pipe_fds[1], pipe_fds[0], EPOLLIN), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_DEL, pipe_fds[0], nullptr), 0);
+
+    struct epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 0, 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(epfd);
+}
+
+TEST_CASE(epoll_forgets_closed_descriptions)
+{
+    int epfd = epoll_create1(0);
+    EXPECT_NE(epfd, -1);
+
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    EXPECT_EQ(add_interest(epfd, pipe_fds[1], EPOLLOUT), 0);
+
+    struct epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 1);
+
+    close(pipe_fds[1]);
+    EXPECT_EQ(epoll_wait(epfd, events, 4, 0), 0);
+
+    close(pipe_fds[0]);
+    close(epfd);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/EventLoop.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/System.h>
+#include <LibTest/TestCase.h>
+#include <fcntl.h>
+
+TEST_CASE(notifier_sees_readable_fd)
+{
+    Core::EventLoop event_loop;
+    auto fds = MUST(Core::System::pipe2(O_CLOEXEC));
+
+    auto notifier = Core::Notifier::construct(fds[0], Core::Notifier::Read);
+    bool did_fire = false;
+    notifier->on_ready_to_read = [&] { did_fire = true; };
+
+    event_loop.pump(Core::EventLoop::WaitMode::PollForEvents);
+    EXPECT(!did_fire);
+
+    MUST(Core::System::write(fds[1], "x"sv.bytes()));
+    event_loop.pump(Core::EventLoop::WaitMode::PollForEvents);
+    EXPECT(did_fire);
+
+    notifier->close();
+    MUST(Core::System::close(fds[0]));
+    MUST(Core::System::close(fds[1]));
+}
+
+TEST_CASE(reused_fd_does_not_see_events_of_fd_closed_while_watched)
+{
+    Core::EventLoop event_loop;
+    auto first_fds = MUST(Core::System::pipe2(O_CLOEXEC));
+
+    // Close the watched fd before its notifier goes away, while a duplicate keeps its description open.
+    RefPtr<Core::Notifier> first_notifier = Core::Notifier::construct(first_fds[0], Core::Notifier::Read);
+    auto duplicate_fd = MUST(Core::System::dup(first_fds[0]));
+    MUST(Core::System::close(first_fds[0]));
+    first_notifier = nullptr;
+
+    auto second_fds = MUST(Core::System::pipe2(O_CLOEXEC));
+    EXPECT_EQ(second_fds[0], first_fds[0]);
+
+    auto second_notifier = Core::Notifier::construct(second_fds[0], Core::Notifier::Read);
+    bool did_fire = false;
+    second_notifier->on_ready_to_read = [&] { did_fire = true; };
+
+    MUST(Core::System::write(first_fds[1], "x"sv.bytes()));
+    event_loop.pump(Core::EventLoop::WaitMode::PollForEvents);
+    EXPECT(!did_fire);
+
+    MUST(Core::System::write(second_fds[1], "x"sv.bytes()));
+    event_loop.pump(Core::EventLoop::WaitMode::PollForEvents);
+    EXPECT(did_fire);
+
+    second_notifier->close();
+    MUST(Core::System::close(duplicate_fd));
+    MUST(Core::System::close(first_fds[1]));
+    MUST(Core::System::close(second_fds[0]));
+    MUST(Core::System::close(second_fds[1]));
+}
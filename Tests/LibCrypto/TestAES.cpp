@@ -454,3 +454,54 @@ TEST_CASE(test_AES_GCM_128bit_decrypt_multiple_blocks_with_aad)
     EXPECT(memcmp(result_pt, out.data(), out.size()) == 0);
     EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
 }
+
+TEST_CASE(test_AES_GCM_256bit_encrypt_zeros)
+{
+    Crypto::Cipher::AESCipher::GCMMode cipher(ReadonlyBytes { "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00", 32 }, 256, Crypto::Cipher::Intent::Encryption);
+    u8 result_tag[] { 0xd0, 0xd1, 0xc8, 0xa7, 0x99, 0x99, 0x6b, 0xf0, 0x26, 0x5b, 0x98, 0xb5, 0xd4, 0x8a, 0xb9, 0x19 };
+    u8 result_ct[] { 0xce, 0xa7, 0x40, 0x3d, 0x4d, 0x60, 0x6b, 0x6e, 0x07, 0x4e, 0xc5, 0xd3, 0xba, 0xf3, 0x9d, 0x18 };
+    auto tag = ByteBuffer::create_uninitialized(16).release_value();
+    auto out = ByteBuffer::create_uninitialized(16).release_value();
+    auto out_bytes = out.bytes();
+    cipher.encrypt("\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"_b, out_bytes, "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"_b, {}, tag);
+    EXPECT(memcmp(result_ct, out.data(), out.size()) == 0);
+    EXPECT(memcmp(result_tag, tag.data(), tag.size()) == 0);
+}
+
+TEST_CASE(test_AES_CBC_256bit_roundtrip_many_blocks)
+{
+    auto key = "WellHelloFriendsWellHelloFriends"_b;
+    auto iv = "0123456789abcdef"_b;
+    auto input = ByteBuffer::create_zeroed(4096).release_value();
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = static_cast<u8>(i * 7);
+
+    Crypto::Cipher::AESCipher::CBCMode encryptor(key, 256, Crypto::Cipher::Intent::Encryption, Crypto::Cipher::PaddingMode::Null);
+    auto encrypted = ByteBuffer::create_zeroed(input.size()).release_value();
+    auto encrypted_bytes = encrypted.bytes();
+    encryptor.encrypt(input, encrypted_bytes, iv);
+    EXPECT_NE(encrypted.bytes(), input.bytes());
+
+    Crypto::Cipher::AESCipher::CBCMode decryptor(key, 256, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::Null);
+    auto decrypted = ByteBuffer::create_zeroed(input.size()).release_value();
+    auto decrypted_bytes = decrypted.bytes();
+    decryptor.decrypt(encrypted, decrypted_bytes, iv);
+    EXPECT_EQ(decrypted.bytes(), input.bytes());
+}
+
+BENCHMARK_CASE(benchmark_AES_GCM_128bit_encrypt)
+{
+    Crypto::Cipher::AESCipher::GCMMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Encryption);
+    auto input = ByteBuffer::create_zeroed(4 * MiB).release_value();
+    auto out = ByteBuffer::create_uninitialized(input.size()).release_value();
+    auto tag = ByteBuffer::create_uninitialized(16).release_value();
+    auto out_bytes = out.bytes();
+    cipher.encrypt(input, out_bytes, "0123456789abcdef"_b, "some additional data"_b, tag);
+
+    Crypto::Cipher::AESCipher::GCMMode decipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Encryption);
+    auto decrypted = ByteBuffer::create_uninitialized(input.size()).release_value();
+    auto decrypted_bytes = decrypted.bytes();
+    auto consistency = decipher.decrypt(out, decrypted_bytes, "0123456789abcdef"_b, "some additional data"_b, tag);
+    EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
+    EXPECT_EQ(decrypted.bytes(), input.bytes());
+}
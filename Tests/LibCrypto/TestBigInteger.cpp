@@ -35,6 +35,31 @@ static Crypto::SignedBigInteger bigint_signed_fibonacci(size_t n)
     return num1;
 }
 
+static Crypto::UnsignedBigInteger bigint_with_pseudo_random_words(size_t length, u32 seed)
+{
+    // A xorshift generator, so that the numbers are the same in every run.
+    Vector<u32, Crypto::STARTING_WORD_SIZE> words;
+    u32 state = seed;
+    for (size_t i = 0; i < length; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        words.append(state);
+    }
+    return Crypto::UnsignedBigInteger { move(words) };
+}
+
+// Multiplies one bit at a time, as a reference for the word based algorithms.
+static Crypto::UnsignedBigInteger bigint_shift_and_add_multiply(Crypto::UnsignedBigInteger const& left, Crypto::UnsignedBigInteger const& right)
+{
+    Crypto::UnsignedBigInteger result { 0 };
+    for (size_t i = 0; i < left.length() * Crypto::UnsignedBigInteger::BITS_IN_WORD; ++i) {
+        if (left.words()[i / Crypto::UnsignedBigInteger::BITS_IN_WORD] & (1u << (i % Crypto::UnsignedBigInteger::BITS_IN_WORD)))
+            result = result.plus(right.shift_left(i));
+    }
+    return result;
+}
+
 TEST_CASE(test_bigint_fib500)
 {
     Vector<u32> result {
@@ -201,6 +226,54 @@ TEST_CASE(test_unsigned_bigint_multiplication_with_big_numbers2)
     EXPECT_EQ(result.words(), expected_result);
 }
 
+TEST_CASE(test_unsigned_bigint_multiplication_with_karatsuba_sized_numbers)
+{
+    // Lengths below, at and above the Karatsuba threshold, including lopsided pairs that get sliced up.
+    size_t const lengths[] = { 1, 7, 31, 32, 33, 64, 97, 150 };
+    u32 seed = 1;
+    for (auto left_length : lengths) {
+        for (auto right_length : lengths) {
+            auto left = bigint_with_pseudo_random_words(left_length, seed++);
+            auto right = bigint_with_pseudo_random_words(right_length, seed++);
+            EXPECT_EQ(left.multiplied_by(right), bigint_shift_and_add_multiply(left, right));
+        }
+    }
+}
+
+TEST_CASE(test_unsigned_bigint_multiplication_with_all_bits_set)
+{
+    // (2^n - 1)^2 carries through every word.
+    for (size_t length : { 16, 32, 80 }) {
+        Vector<u32, Crypto::STARTING_WORD_SIZE> words;
+        for (size_t i = 0; i < length; ++i)
+            words.append(NumericLimits<u32>::max());
+        Crypto::UnsignedBigInteger all_ones { move(words) };
+        auto copy = all_ones;
+
+        auto expected = bigint_shift_and_add_multiply(all_ones, copy);
+        EXPECT_EQ(all_ones.multiplied_by(copy), expected);
+        EXPECT_EQ(all_ones.multiplied_by(all_ones), expected);
+    }
+}
+
+TEST_CASE(test_unsigned_bigint_square)
+{
+    for (size_t length : { 3, 31, 32, 45, 128 }) {
+        auto number = bigint_with_pseudo_random_words(length, length);
+        auto copy = number;
+        EXPECT_EQ(number.multiplied_by(number), number.multiplied_by(copy));
+        EXPECT_EQ(number.multiplied_by(number), bigint_shift_and_add_multiply(number, copy));
+    }
+}
+
+TEST_CASE(test_unsigned_bigint_multiplication_with_zero)
+{
+    auto number = bigint_with_pseudo_random_words(40, 7);
+    Crypto::UnsignedBigInteger zero { 0 };
+    EXPECT(number.multiplied_by(zero).is_zero());
+    EXPECT(zero.multiplied_by(number).is_zero());
+}
+
 TEST_CASE(test_unsigned_bigint_simple_division)
 {
     Crypto::UnsignedBigInteger num1(27194);
@@ -330,6 +403,55 @@ TEST_CASE(test_bigint_modular_power_extra_tests)
     }
 }
 
+TEST_CASE(test_bigint_montgomery_modular_power_window_sizes)
+{
+    // Exponent lengths for every sliding window size, checked against the square-and-multiply power.
+    auto modulo = bigint_with_pseudo_random_words(16, 1234);
+    modulo.set_bit_inplace(0);
+    auto base = bigint_with_pseudo_random_words(20, 5678);
+
+    for (size_t exponent_length : { 1, 2, 5, 16, 40 }) {
+        auto exponent = bigint_with_pseudo_random_words(exponent_length, exponent_length);
+        auto expected = [&] {
+            Crypto::UnsignedBigInteger ep { exponent };
+            Crypto::UnsignedBigInteger b { base };
+            Crypto::UnsignedBigInteger temp_1, temp_2, temp_3, temp_4, temp_multiply, temp_quotient, temp_remainder, result;
+            Crypto::UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(ep, b, modulo, temp_1, temp_2, temp_3, temp_4, temp_multiply, temp_quotient, temp_remainder, result);
+            return result;
+        }();
+        EXPECT_EQ(Crypto::NumberTheory::ModularPower(base, exponent, modulo), expected);
+    }
+
+    EXPECT_EQ(Crypto::NumberTheory::ModularPower(base, 0u, modulo), 1u);
+    EXPECT_EQ(Crypto::NumberTheory::ModularPower(base, 1u, modulo), base.divided_by(modulo).remainder);
+}
+
+BENCHMARK_CASE(benchmark_bigint_multiplication_4096_bits)
+{
+    auto left = bigint_with_pseudo_random_words(128, 1);
+    auto right = bigint_with_pseudo_random_words(128, 2);
+    for (size_t i = 0; i < 1000; ++i)
+        EXPECT_EQ(left.multiplied_by(right).trimmed_length(), 256u);
+}
+
+BENCHMARK_CASE(benchmark_bigint_square_16384_bits)
+{
+    auto number = bigint_with_pseudo_random_words(512, 3);
+    for (size_t i = 0; i < 100; ++i)
+        EXPECT_EQ(number.multiplied_by(number).trimmed_length(), 1024u);
+}
+
+BENCHMARK_CASE(benchmark_bigint_modular_power_2048_bits)
+{
+    // The shape of an RSA-2048 private key operation without CRT.
+    auto modulo = bigint_with_pseudo_random_words(64, 4);
+    modulo.set_bit_inplace(0);
+    auto exponent = bigint_with_pseudo_random_words(64, 5);
+    auto base = bigint_with_pseudo_random_words(63, 6);
+    for (size_t i = 0; i < 10; ++i)
+        EXPECT(Crypto::NumberTheory::ModularPower(base, exponent, modulo) < modulo);
+}
+
 TEST_CASE(test_bigint_primality_test)
 {
     struct {
@@ -33,3 +33,51 @@ TEST_CASE(test_crc32)
     do_test(DeprecatedString("The quick brown fox jumps over the lazy dog").bytes(), 0x414FA339);
     do_test(DeprecatedString("various CRC algorithms input data").bytes(), 0x9BD366AE);
 }
+
+// Processes one bit at a time, as a reference for the table driven implementation.
+static u32 crc32_bitwise(ReadonlyBytes data)
+{
+    u32 state = ~0u;
+    for (auto byte : data) {
+        state ^= byte;
+        for (auto i = 0; i < 8; ++i)
+            state = (state & 1) ? (0xEDB88320 ^ (state >> 1)) : (state >> 1);
+    }
+    return ~state;
+}
+
+TEST_CASE(test_crc32_lengths_and_alignments)
+{
+    u8 data[64 + 7];
+    for (size_t i = 0; i < sizeof(data); ++i)
+        data[i] = static_cast<u8>(i * 37 + 11);
+
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t length = 0; offset + length <= sizeof(data); ++length) {
+            ReadonlyBytes bytes { data + offset, length };
+            EXPECT_EQ(Crypto::Checksum::CRC32(bytes).digest(), crc32_bitwise(bytes));
+        }
+    }
+}
+
+TEST_CASE(test_crc32_successive_updates)
+{
+    u8 data[100];
+    for (size_t i = 0; i < sizeof(data); ++i)
+        data[i] = static_cast<u8>(i ^ 0x5a);
+
+    Crypto::Checksum::CRC32 crc;
+    crc.update({ data, 3 });
+    crc.update({ data + 3, 50 });
+    crc.update({ data + 53, 47 });
+    EXPECT_EQ(crc.digest(), crc32_bitwise({ data, sizeof(data) }));
+}
+
+BENCHMARK_CASE(benchmark_crc32)
+{
+    auto data = ByteBuffer::create_zeroed(16 * MiB).release_value();
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<u8>(i);
+
+    EXPECT_EQ(Crypto::Checksum::CRC32(data).digest(), Crypto::Checksum::CRC32(data).digest());
+}
@@ -166,6 +166,43 @@ TEST_CASE(test_SHA256_hash_empty_string)
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
 }
 
+TEST_CASE(test_SHA256_hash_two_blocks)
+{
+    u8 result[] {
+        0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39, 0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1
+    };
+    auto digest = Crypto::Hash::SHA256::hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"sv);
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+}
+
+TEST_CASE(test_SHA256_hash_million_as_in_uneven_updates)
+{
+    u8 result[] {
+        0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67, 0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+    };
+    u8 as[1000];
+    memset(as, 'a', sizeof(as));
+
+    // Chunk sizes that don't line up with the block size, so that both the buffered and the direct path get used.
+    Crypto::Hash::SHA256 sha;
+    size_t const chunk_sizes[] = { 1, 63, 64, 65, 127, 128, 200, 1000 };
+    size_t remaining = 1'000'000;
+    for (size_t i = 0; remaining > 0; ++i) {
+        auto chunk_size = min(remaining, chunk_sizes[i % array_size(chunk_sizes)]);
+        sha.update(as, chunk_size);
+        remaining -= chunk_size;
+    }
+    auto digest = sha.digest();
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+}
+
+BENCHMARK_CASE(benchmark_SHA256)
+{
+    auto data = ByteBuffer::create_zeroed(16 * MiB).release_value();
+    auto digest = Crypto::Hash::SHA256::hash(data);
+    EXPECT_EQ(digest.data[0], Crypto::Hash::SHA256::hash(data).data[0]);
+}
+
 TEST_CASE(test_SHA384_name)
 {
     Crypto::Hash::SHA384 sha;
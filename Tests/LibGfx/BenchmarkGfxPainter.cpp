@@ -6,6 +6,7 @@
 
 #include <LibTest/TestCase.h>
 
+#include <LibCore/ElapsedTimer.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Font/FontDatabase.h>
 #include <LibGfx/Painter.h>
@@ -61,3 +62,89 @@ BENCHMARK_CASE(fill_with_gradient)
         painter.fill_rect_with_gradient(bitmap->rect(), Color::Blue, Color::Red);
     }
 }
+
+// Fills a bitmap with noise in which a quarter of the pixels is fully transparent and a quarter is opaque,
+// so the blending benchmarks go through all the paths of Color::blend().
+static NonnullRefPtr<Gfx::Bitmap> create_noise_bitmap(Gfx::BitmapFormat format, Gfx::IntSize size)
+{
+    auto bitmap = Gfx::Bitmap::try_create(format, size).release_value_but_fixme_should_propagate_errors();
+    u32 seed = 0x12345678;
+    for (int y = 0; y < bitmap->physical_height(); ++y) {
+        auto* scanline = bitmap->scanline(y);
+        for (int x = 0; x < bitmap->physical_width(); ++x) {
+            seed = seed * 1103515245 + 12345;
+            u32 pixel = seed ^ (seed >> 16);
+            if ((seed >> 28) % 4 == 0)
+                pixel &= 0x00ffffff;
+            else if ((seed >> 28) % 4 == 1)
+                pixel |= 0xff000000;
+            scanline[x] = pixel;
+        }
+    }
+    return bitmap;
+}
+
+template<typename Callback>
+static void measure_megapixels_per_second(StringView name, int run_count, Gfx::IntSize size, Callback callback)
+{
+    auto timer = Core::ElapsedTimer::start_new();
+    for (int run = 0; run < run_count; run++)
+        callback();
+    auto elapsed_seconds = max(timer.elapsed(), 1) / 1000.0;
+    outln("{}: {:.1} megapixels per second", name, static_cast<double>(size.width()) * size.height() * run_count / 1'000'000 / elapsed_seconds);
+}
+
+BENCHMARK_CASE(fill_with_alpha)
+{
+    int const run_count = 100;
+    int const bitmap_size = 2000;
+
+    auto bitmap = create_noise_bitmap(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size });
+    Gfx::Painter painter(bitmap);
+
+    measure_megapixels_per_second("fill_rect() with alpha"sv, run_count, bitmap->size(), [&] {
+        painter.fill_rect(bitmap->rect(), Color(255, 0, 0, 128));
+    });
+}
+
+BENCHMARK_CASE(blit_with_alpha)
+{
+    int const run_count = 100;
+    int const bitmap_size = 2000;
+
+    auto bitmap = create_noise_bitmap(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size });
+    auto source = create_noise_bitmap(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size });
+    Gfx::Painter painter(bitmap);
+
+    measure_megapixels_per_second("blit() with alpha"sv, run_count, bitmap->size(), [&] {
+        painter.blit({ 0, 0 }, source, source->rect());
+    });
+}
+
+BENCHMARK_CASE(blit_with_opacity)
+{
+    int const run_count = 100;
+    int const bitmap_size = 2000;
+
+    auto bitmap = create_noise_bitmap(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size });
+    auto source = create_noise_bitmap(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size });
+    Gfx::Painter painter(bitmap);
+
+    measure_megapixels_per_second("blit() with opacity"sv, run_count, bitmap->size(), [&] {
+        painter.blit({ 0, 0 }, source, source->rect(), 0.5f);
+    });
+}
+
+BENCHMARK_CASE(draw_scaled_bitmap_with_bilinear_blend)
+{
+    int const run_count = 20;
+    int const bitmap_size = 2000;
+
+    auto bitmap = create_noise_bitmap(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size });
+    auto source = create_noise_bitmap(Gfx::BitmapFormat::BGRA8888, { bitmap_size / 3, bitmap_size / 3 });
+    Gfx::Painter painter(bitmap);
+
+    measure_megapixels_per_second("draw_scaled_bitmap() with bilinear blending"sv, run_count, bitmap->size(), [&] {
+        painter.draw_scaled_bitmap(bitmap->rect(), source, source->rect(), 1.0f, Gfx::Painter::ScalingMode::BilinearBlend);
+    });
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/MemoryStream.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/Stream.h>
+#include <LibCore/System.h>
+#include <LibIPC/Decoder.h>
+#include <LibIPC/Encoder.h>
+#include <LibIPC/SharedPayloadPool.h>
+#include <LibTest/TestCase.h>
+#include <sys/socket.h>
+
+struct SocketPair {
+    NonnullOwnPtr<Core::Stream::LocalSocket> sender;
+    NonnullOwnPtr<Core::Stream::LocalSocket> receiver;
+};
+
+// NOTE: The sockets need a Core::EventLoop through Core::Notifier, so tests have to create one first.
+static SocketPair make_socket_pair()
+{
+    int fds[2];
+    MUST(Core::System::socketpair(AF_LOCAL, SOCK_STREAM, 0, fds));
+    return { MUST(Core::Stream::LocalSocket::adopt_fd(fds[0])), MUST(Core::Stream::LocalSocket::adopt_fd(fds[1])) };
+}
+
+static ByteBuffer make_payload(size_t size)
+{
+    auto payload = MUST(ByteBuffer::create_uninitialized(size));
+    for (size_t i = 0; i < size; ++i)
+        payload[i] = static_cast<u8>(i * 7 + (i >> 8));
+    return payload;
+}
+
+static IPC::MessageBuffer encode(ByteBuffer const& payload, IPC::SharedPayloadPool* pool = nullptr)
+{
+    IPC::MessageBuffer buffer;
+    IPC::Encoder encoder(buffer, pool);
+    encoder << payload;
+    return buffer;
+}
+
+template<typename T>
+static T decode(IPC::MessageBuffer const& buffer, SocketPair& sockets)
+{
+    for (auto& fd : buffer.fds)
+        MUST(sockets.sender->send_fd(fd.value()));
+
+    InputMemoryStream stream { buffer.data.span() };
+    IPC::Decoder decoder(stream, *sockets.receiver);
+    auto value = MUST(decoder.decode<T>());
+    EXPECT(stream.eof());
+    return value;
+}
+
+static ino_t inode_of(IPC::MessageBuffer const& buffer)
+{
+    VERIFY(buffer.fds.size() == 1);
+    return MUST(Core::System::fstat(buffer.fds[0].value())).st_ino;
+}
+
+TEST_CASE(payload_below_threshold_is_sent_inline)
+{
+    Core::EventLoop event_loop;
+    auto sockets = make_socket_pair();
+    auto payload = make_payload(IPC::shared_payload_threshold - 1);
+
+    auto buffer = encode(payload);
+    EXPECT(buffer.fds.is_empty());
+    EXPECT_EQ(buffer.data.size(), sizeof(i32) + payload.size());
+    EXPECT_EQ(decode<ByteBuffer>(buffer, sockets), payload);
+}
+
+TEST_CASE(payload_at_threshold_is_shared)
+{
+    Core::EventLoop event_loop;
+    auto sockets = make_socket_pair();
+    auto payload = make_payload(IPC::shared_payload_threshold);
+
+    auto buffer = encode(payload);
+    EXPECT_EQ(buffer.fds.size(), 1u);
+    EXPECT_EQ(buffer.data.size(), sizeof(i32) + sizeof(IPC::PayloadLocation));
+    EXPECT_EQ(decode<ByteBuffer>(buffer, sockets), payload);
+}
+
+TEST_CASE(payload_above_threshold_is_shared)
+{
+    Core::EventLoop event_loop;
+    auto sockets = make_socket_pair();
+    auto payload = make_payload(IPC::shared_payload_threshold * 4 + 123);
+
+    auto buffer = encode(payload);
+    EXPECT_EQ(buffer.fds.size(), 1u);
+    EXPECT_EQ(decode<ByteBuffer>(buffer, sockets), payload);
+
+    DeprecatedString string { payload.bytes() };
+    IPC::MessageBuffer string_buffer;
+    IPC::Encoder encoder(string_buffer);
+    encoder << string;
+    EXPECT_EQ(string_buffer.fds.size(), 1u);
+    EXPECT_EQ(decode<DeprecatedString>(string_buffer, sockets), string);
+}
+
+TEST_CASE(large_payload_sent_inline_is_decoded)
+{
+    // This is what the encoder falls back to when it can't share the payload.
+    Core::EventLoop event_loop;
+    auto sockets = make_socket_pair();
+    auto payload = make_payload(IPC::shared_payload_threshold * 2);
+
+    IPC::MessageBuffer buffer;
+    IPC::Encoder encoder(buffer);
+    encoder << static_cast<i32>(payload.size()) << IPC::PayloadLocation::Inline << StringView { payload.bytes() };
+    EXPECT_EQ(decode<ByteBuffer>(buffer, sockets), payload);
+}
+
+TEST_CASE(pool_reuses_buffers_once_they_have_been_received)
+{
+    Core::EventLoop event_loop;
+    auto sockets = make_socket_pair();
+    auto payload = make_payload(IPC::shared_payload_threshold * 2);
+    IPC::SharedPayloadPool pool;
+
+    // The first buffer hasn't been read yet, so the second message can't use it.
+    auto first = encode(payload, &pool);
+    auto second = encode(payload, &pool);
+    EXPECT_NE(inode_of(first), inode_of(second));
+
+    EXPECT_EQ(decode<ByteBuffer>(first, sockets), payload);
+    auto third = encode(payload, &pool);
+    EXPECT_EQ(inode_of(third), inode_of(first));
+
+    EXPECT_EQ(decode<ByteBuffer>(second, sockets), payload);
+    EXPECT_EQ(decode<ByteBuffer>(third, sockets), payload);
+
+    // A smaller payload fits into a buffer that was already handed back.
+    auto smaller = make_payload(IPC::shared_payload_threshold);
+    auto fourth = encode(smaller, &pool);
+    auto fourth_inode = inode_of(fourth);
+    EXPECT(fourth_inode == inode_of(first) || fourth_inode == inode_of(second));
+    EXPECT_EQ(decode<ByteBuffer>(fourth, sockets), smaller);
+}
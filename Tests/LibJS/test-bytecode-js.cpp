@@ -7,6 +7,7 @@
 #include <LibJS/AST.h>
 #include <LibJS/Bytecode/Generator.h>
 #include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/Pass/Liveness.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/VM.h>
 #include <LibJS/Script.h>
@@ -30,14 +31,17 @@
     if (result.is_error())                                              \
         dbgln("Error: {}", MUST(result.throw_completion().value()->to_string(vm)));
 
-#define EXPECT_NO_EXCEPTION_WITH_OPTIMIZATIONS(executable)                  \
-    auto& passes = JS::Bytecode::Interpreter::optimization_pipeline();      \
-    passes.perform(*executable);                                            \
-                                                                            \
-    auto result_with_optimizations = bytecode_interpreter.run(*executable); \
-                                                                            \
-    EXPECT(!result_with_optimizations.is_error());                          \
-    if (result_with_optimizations.is_error())                               \
+// Functions created while running the optimized executable are optimized as well.
+#define EXPECT_NO_EXCEPTION_WITH_OPTIMIZATIONS(executable)                                                                   \
+    auto& passes = JS::Bytecode::Interpreter::optimization_pipeline(JS::Bytecode::Interpreter::OptimizationLevel::Optimize); \
+    passes.perform(*executable);                                                                                           \
+                                                                                                                           \
+    JS::Bytecode::Interpreter::set_optimizations_enabled(true);                                                            \
+    auto result_with_optimizations = bytecode_interpreter.run(*executable);                                                \
+    JS::Bytecode::Interpreter::set_optimizations_enabled(false);                                                           \
+                                                                                                                           \
+    EXPECT(!result_with_optimizations.is_error());                                                                         \
+    if (result_with_optimizations.is_error())                                                                              \
         dbgln("Error: {}", MUST(result_with_optimizations.throw_completion().value()->to_string(vm)));
 
 #define EXPECT_NO_EXCEPTION_ALL(source)           \
@@ -139,3 +143,177 @@ TEST_CASE(catch_exception)
                             "if (hitCatch !== true) throw new Exception('failed');\n"
                             "if (hitFinally !== true) throw new Exception('failed');");
 }
+
+TEST_CASE(loops)
+{
+    EXPECT_NO_EXCEPTION_ALL("var sum = 0;\n"
+                            "for (var i = 0; i < 10; ++i) {\n"
+                            "    if (i === 3) continue;\n"
+                            "    for (var j = 0; j < i; ++j) {\n"
+                            "        if (j === 5) break;\n"
+                            "        sum += i * (j + 1);\n"
+                            "    }\n"
+                            "}\n"
+                            "if (sum !== 572) throw new Exception('failed');\n"
+                            "var digits = 0;\n"
+                            "for (var x of [1, 2, 3]) digits = digits * 10 + x;\n"
+                            "if (digits !== 123) throw new Exception('failed');\n"
+                            "var keys = '';\n"
+                            "for (var key in { a: 1, b: 2, c: 3 }) keys = keys + key + (keys.length + 1);\n"
+                            "if (keys !== 'a1b3c5') throw new Exception('failed');\n"
+                            "var n = 0;\n"
+                            "do { n += 2; } while (n < 7);\n"
+                            "while (n > 3) n -= 3;\n"
+                            "if (n !== 2) throw new Exception('failed');");
+}
+
+TEST_CASE(exception_handlers_in_loops)
+{
+    // The iterator of the for-of loop is live into the catch and finally blocks.
+    EXPECT_NO_EXCEPTION_ALL("var caught = 0;\n"
+                            "var finallies = 0;\n"
+                            "var sum = 0;\n"
+                            "for (var x of [1, 2, 3, 4]) {\n"
+                            "    try {\n"
+                            "        if (x % 2 === 0) throw x;\n"
+                            "        sum += x;\n"
+                            "    } catch (e) {\n"
+                            "        caught += e;\n"
+                            "    } finally {\n"
+                            "        ++finallies;\n"
+                            "    }\n"
+                            "}\n"
+                            "if (sum !== 4 || caught !== 6 || finallies !== 4) throw new Exception('failed');\n"
+                            "var log = '';\n"
+                            "for (var i = 0; i < 3; ++i) {\n"
+                            "    try {\n"
+                            "        if (i === 1) throw i;\n"
+                            "        log += 't' + i;\n"
+                            "    } catch (e) {\n"
+                            "        log += 'c' + e;\n"
+                            "    }\n"
+                            "    log += ';';\n"
+                            "}\n"
+                            "if (log !== 't0;c1;t2;') throw new Exception('failed');\n"
+                            "var doubled = 0;\n"
+                            "for (var j = 0; j < 3; ++j) {\n"
+                            "    try {\n"
+                            "        doubled += j;\n"
+                            "    } finally {\n"
+                            "        doubled *= 2;\n"
+                            "    }\n"
+                            "}\n"
+                            "if (doubled !== 8) throw new Exception('failed');");
+}
+
+TEST_CASE(exception_handlers)
+{
+    EXPECT_NO_EXCEPTION_ALL("var log = [];\n"
+                            "var result = (function () {\n"
+                            "    try {\n"
+                            "        return log.push('try') * 10;\n"
+                            "    } finally {\n"
+                            "        log.push('finally');\n"
+                            "    }\n"
+                            "})();\n"
+                            "if (result + log.length !== 12) throw new Exception('failed');\n"
+                            "var nested = 0;\n"
+                            "try {\n"
+                            "    try {\n"
+                            "        throw 1;\n"
+                            "    } catch (e) {\n"
+                            "        nested += e;\n"
+                            "        throw e + 1;\n"
+                            "    } finally {\n"
+                            "        nested *= 10;\n"
+                            "    }\n"
+                            "} catch (e) {\n"
+                            "    nested += e;\n"
+                            "}\n"
+                            "if (nested !== 12) throw new Exception('failed');");
+}
+
+TEST_CASE(generators)
+{
+    EXPECT_NO_EXCEPTION_ALL("function* sum() {\n"
+                            "    var a = (yield 1) + (yield 2);\n"
+                            "    yield a * 10;\n"
+                            "}\n"
+                            "var gen = sum();\n"
+                            "gen.next();\n"
+                            "gen.next(5);\n"
+                            "if (gen.next(6).value !== 110) throw new Exception('failed');\n"
+                            "var cleanedUp = false;\n"
+                            "function* squares() {\n"
+                            "    try {\n"
+                            "        for (var i = 0; ; ++i)\n"
+                            "            yield i * i;\n"
+                            "    } finally {\n"
+                            "        cleanedUp = true;\n"
+                            "    }\n"
+                            "}\n"
+                            "var total = 0;\n"
+                            "for (var square of squares()) {\n"
+                            "    if (square > 10) break;\n"
+                            "    total += square;\n"
+                            "}\n"
+                            "if (total !== 14 || !cleanedUp) throw new Exception('failed');\n"
+                            "function* inner() { yield 1; yield 2; return 3; }\n"
+                            "function* outer() { var result = yield* inner(); yield result + 1; }\n"
+                            "if ([...outer()].join() !== '1,2,4') throw new Exception('failed');");
+}
+
+TEST_CASE(registers_with_disjoint_live_ranges_share_a_slot)
+{
+    SETUP_AND_PARSE("var a = 1, b = 2, c = 3;\n"
+                    "var x = a + b + c;\n"
+                    "var y = c - b - a;\n"
+                    "var z = (a + b) * (b + c) * (c + a);\n"
+                    "if (x !== 6 || y !== 0 || z !== 60) throw new Exception('failed');");
+
+    auto executable = MUST(JS::Bytecode::Generator::generate(program));
+    auto number_of_registers = executable->number_of_registers;
+    JS::Bytecode::Interpreter::optimization_pipeline(JS::Bytecode::Interpreter::OptimizationLevel::Optimize).perform(*executable);
+    EXPECT(executable->number_of_registers < number_of_registers);
+
+    auto result = bytecode_interpreter.run(*executable);
+    EXPECT(!result.is_error());
+}
+
+TEST_CASE(default_pipeline_shares_registers)
+{
+    // Function bodies are compiled with this pipeline unless optimizations are enabled.
+    SETUP_AND_PARSE("var a = 1, b = 2, c = 3;\n"
+                    "var x = a + b + c;\n"
+                    "var y = c - b - a;\n"
+                    "var z = (a + b) * (b + c) * (c + a);\n"
+                    "function f(a, b, c) { return (a + b) * (b + c) * (c + a); }\n"
+                    "if (x !== 6 || y !== 0 || z !== 60 || f(a, b, c) !== z) throw new Exception('failed');");
+
+    auto executable = MUST(JS::Bytecode::Generator::generate(program));
+    auto number_of_registers = executable->number_of_registers;
+    JS::Bytecode::Interpreter::optimization_pipeline(JS::Bytecode::Interpreter::OptimizationLevel::Default).perform(*executable);
+    EXPECT(executable->number_of_registers < number_of_registers);
+
+    auto result = bytecode_interpreter.run(*executable);
+    EXPECT(!result.is_error());
+}
+
+TEST_CASE(registers_live_into_exception_handlers_are_pinned)
+{
+    // The catch block continues the loop, so it reads the iterator of the for-of loop.
+    SETUP_AND_PARSE("for (var x of [1, 2]) {\n"
+                    "    try {\n"
+                    "        throw x;\n"
+                    "    } catch (e) {\n"
+                    "    }\n"
+                    "}");
+
+    auto executable = MUST(JS::Bytecode::Generator::generate(program));
+    JS::Bytecode::PassManager passes;
+    passes.add<JS::Bytecode::Passes::GenerateCFG>();
+    JS::Bytecode::PassPipelineExecutable pipeline_executable { *executable };
+    passes.perform(pipeline_executable);
+    auto liveness = JS::Bytecode::Passes::compute_register_liveness(pipeline_executable);
+    EXPECT(liveness.pinned.view().count_slow(true) > 0);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Heap/Heap.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/VM.h>
+#include <LibJS/Script.h>
+#include <LibTest/TestCase.h>
+
+#define SETUP_INTERPRETER()                                            \
+    auto vm = JS::VM::create();                                        \
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm); \
+    auto const& statistics = vm->heap().statistics();
+
+static void run(JS::Interpreter& interpreter, StringView source)
+{
+    auto script_or_error = JS::Script::parse(source, interpreter.realm());
+    EXPECT(!script_or_error.is_error());
+    if (script_or_error.is_error())
+        return;
+    auto result = interpreter.run(*script_or_error.release_value());
+    EXPECT(!result.is_error());
+}
+
+static size_t histogram_total(JS::Heap::Statistics const& statistics)
+{
+    size_t total = 0;
+    for (auto count : statistics.pause_histogram)
+        total += count;
+    return total;
+}
+
+TEST_CASE(gc_updates_collection_count_and_pause_times)
+{
+    SETUP_INTERPRETER();
+    auto collection_count = statistics.collection_count;
+    auto total_pause_time = statistics.total_pause_time;
+
+    run(*interpreter, "gc();"sv);
+    EXPECT_EQ(statistics.collection_count, collection_count + 1);
+    EXPECT_EQ(histogram_total(statistics), statistics.collection_count);
+    EXPECT(statistics.total_pause_time > total_pause_time);
+    EXPECT(!statistics.longest_pause_time.is_negative());
+    EXPECT(statistics.longest_pause_time <= statistics.total_pause_time);
+    EXPECT(statistics.live_bytes_after_last_collection > 0u);
+
+    run(*interpreter, "gc(); gc();"sv);
+    EXPECT_EQ(statistics.collection_count, collection_count + 3);
+    EXPECT_EQ(histogram_total(statistics), statistics.collection_count);
+}
+
+TEST_CASE(gc_accounts_for_collected_and_surviving_bytes)
+{
+    SETUP_INTERPRETER();
+    run(*interpreter,
+        "var kept = [];\n"
+        "for (var i = 0; i < 1000; ++i) {\n"
+        "    kept.push({ i });\n"
+        "    ({ garbage: i });\n"
+        "}"sv);
+
+    auto surviving_bytes = statistics.surviving_bytes;
+    run(*interpreter, "gc();"sv);
+    auto collected_bytes = statistics.collected_bytes;
+    auto live_bytes = statistics.live_bytes_after_last_collection;
+    EXPECT(collected_bytes > 0u);
+    EXPECT_EQ(statistics.surviving_bytes, surviving_bytes + live_bytes);
+
+    // Dropping the kept objects turns them into garbage for the next collection.
+    run(*interpreter, "kept = null; gc();"sv);
+    EXPECT(statistics.collected_bytes > collected_bytes);
+    EXPECT(statistics.live_bytes_after_last_collection < live_bytes);
+    EXPECT_EQ(statistics.surviving_bytes, surviving_bytes + live_bytes + statistics.live_bytes_after_last_collection);
+}
@@ -1110,3 +1110,77 @@ TEST_CASE(inversion_state_in_char_class)
         EXPECT_EQ(result.capture_group_matches.first()[1].view.to_deprecated_string(), "}"sv);
     }
 }
+
+TEST_CASE(pike_vm_nested_quantifiers)
+{
+    // These take exponential time to fail when every way of splitting up the input is backtracked through.
+    Array patterns {
+        "(a+)+b"sv,
+        "(a|aa)*c"sv,
+        "(a*)*b"sv,
+        "^(\\w+\\s?)*$"sv,
+    };
+
+    auto subject = DeprecatedString::repeated('a', 64);
+    for (auto& pattern : patterns) {
+        Regex<ECMA262> re(pattern);
+        EXPECT(re.pike_vm.has_value());
+        EXPECT_EQ(re.match(DeprecatedString::formatted("{}!", subject)).success, false);
+        EXPECT_EQ(re.search(DeprecatedString::formatted("{}!", subject)).success, false);
+    }
+
+    // Backreferences need the backtracking VM.
+    Regex<ECMA262> re("(a+)\\1b");
+    EXPECT(!re.pike_vm.has_value());
+    EXPECT_EQ(re.match("aaaab"sv).success, true);
+}
+
+TEST_CASE(pike_vm_capture_groups)
+{
+    {
+        Regex<ECMA262> re("(a|ab)(c|bcd)(d*)");
+        auto result = re.match("abcd"sv);
+        EXPECT(result.success);
+        EXPECT_EQ(result.matches.first().view, "abcd"sv);
+        EXPECT_EQ(result.capture_group_matches.first()[0].view, "a"sv);
+        EXPECT_EQ(result.capture_group_matches.first()[1].view, "bcd"sv);
+        EXPECT_EQ(result.capture_group_matches.first()[2].view, ""sv);
+    }
+    {
+        // The capture group is not overwritten by the empty iteration that ends the loop.
+        Regex<ECMA262> re("([ac]?)+");
+        auto result = re.match("cc"sv);
+        EXPECT(result.success);
+        EXPECT_EQ(result.capture_group_matches.first()[0].view, "c"sv);
+        EXPECT_EQ(result.capture_group_matches.first()[0].column, 1u);
+    }
+    {
+        Regex<ECMA262> re("(?<word>[a-z]+?)(\\d*)$", ECMAScriptFlags::Global);
+        auto result = re.search("x foo42"sv);
+        EXPECT(result.success);
+        EXPECT_EQ(result.matches.first().view, "foo42"sv);
+        EXPECT_EQ(result.capture_group_matches.first()[0].view, "foo"sv);
+        EXPECT_EQ(result.capture_group_matches.first()[0].capture_group_name, "word"sv);
+        EXPECT_EQ(result.capture_group_matches.first()[1].view, "42"sv);
+    }
+}
+
+TEST_CASE(search_literal_prefix)
+{
+    Regex<PosixExtended> re("foo[0-9]+");
+    EXPECT_EQ(re.literal_prefix.size(), 3u);
+
+    StringBuilder builder;
+    for (size_t i = 0; i < 1000; ++i)
+        builder.append("fo fooo f "sv);
+    builder.append("foo123 foo4"sv);
+
+    auto result = re.search(builder.string_view(), PosixFlags::Global);
+    EXPECT(result.success);
+    EXPECT_EQ(result.count, 2u);
+    EXPECT_EQ(result.matches[0].view, "foo123"sv);
+    EXPECT_EQ(result.matches[0].column, 10000u);
+    EXPECT_EQ(result.matches[1].view, "foo4"sv);
+
+    EXPECT_EQ(re.search("fo foo bar"sv).success, false);
+}
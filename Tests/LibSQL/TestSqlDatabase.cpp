@@ -113,6 +113,40 @@ TEST_CASE(create_heap)
     EXPECT_EQ(heap->version(), SQL::Heap::current_version);
 }
 
+TEST_CASE(read_blocks_through_small_page_cache)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    constexpr u8 block_count = 32;
+    Vector<u32> blocks;
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        heap->set_page_cache_size(4);
+        for (u8 i = 0; i < block_count; ++i) {
+            blocks.append(heap->new_record_pointer());
+            auto buffer = MUST(ByteBuffer::create_zeroed(SQL::BLOCKSIZE / 2));
+            buffer[0] = i;
+            heap->add_to_wal(blocks.last(), buffer);
+        }
+        EXPECT(!heap->flush().is_error());
+
+        for (u8 i = 0; i < block_count; ++i) {
+            auto buffer = MUST(heap->read_block(blocks[i]));
+            EXPECT_EQ(buffer[0], i);
+        }
+    }
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        heap->set_page_cache_size(4);
+        for (u8 i = block_count; i > 0; --i) {
+            auto buffer = MUST(heap->read_block(blocks[i - 1]));
+            EXPECT_EQ(buffer.size(), SQL::BLOCKSIZE);
+            EXPECT_EQ(buffer[0], i - 1);
+        }
+    }
+}
+
 TEST_CASE(create_from_dev_random)
 {
     auto heap = SQL::Heap::construct("/dev/random");
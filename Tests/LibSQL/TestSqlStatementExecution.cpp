@@ -322,6 +322,31 @@ TEST_CASE(select_with_where)
     }
 }
 
+TEST_CASE(select_with_non_boolean_where_operands)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    auto result = execute(database,
+        "INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES "
+        "( 'Test_1', 42 ), "
+        "( 'Test_2', 43 );");
+    EXPECT(result.size() == 2);
+
+    auto select_result = try_execute(database, "SELECT TextColumn FROM TestSchema.TestTable WHERE (IntColumn = 42) AND TextColumn;");
+    EXPECT(select_result.is_error());
+    EXPECT_EQ(select_result.release_error().error(), SQL::SQLErrorCode::BooleanOperatorTypeMismatch);
+
+    select_result = try_execute(database, "SELECT TextColumn FROM TestSchema.TestTable WHERE TextColumn OR (IntColumn = 42);");
+    EXPECT(select_result.is_error());
+    EXPECT_EQ(select_result.release_error().error(), SQL::SQLErrorCode::BooleanOperatorTypeMismatch);
+
+    // A WHERE clause that is just a single non-boolean term doesn't match any row.
+    result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable WHERE TextColumn;");
+    EXPECT_EQ(result.size(), 0u);
+}
+
 TEST_CASE(select_cross_join)
 {
     ScopeGuard guard([]() { unlink(db_name); });
@@ -388,6 +413,44 @@ TEST_CASE(select_inner_join)
     EXPECT_EQ(result[0].row[2].to_deprecated_string(), "Test_12");
 }
 
+TEST_CASE(select_inner_join_with_filter_and_order)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_two_tables(database);
+    auto result = execute(database,
+        "INSERT INTO TestSchema.TestTable1 ( TextColumn1, IntColumn ) VALUES "
+        "( 'Test_1', 42 ), "
+        "( 'Test_2', 43 ), "
+        "( 'Test_3', 42 ), "
+        "( 'Test_4', 45 ), "
+        "( 'Test_5', 44 );");
+    EXPECT(result.size() == 5);
+    result = execute(database,
+        "INSERT INTO TestSchema.TestTable2 ( TextColumn2, IntColumn ) VALUES "
+        "( 'Test_10', 42 ), "
+        "( 'Test_11', 44 ), "
+        "( 'Test_12', 42 ), "
+        "( 'Test_13', 46 ), "
+        "( 'Test_14', 43 );");
+    EXPECT(result.size() == 5);
+    result = execute(database,
+        "SELECT TextColumn1, TextColumn2 "
+        "FROM TestSchema.TestTable1, TestSchema.TestTable2 "
+        "WHERE (TestTable1.IntColumn = TestTable2.IntColumn) AND (TextColumn1 != 'Test_2') AND (TextColumn2 != 'Test_11') "
+        "ORDER BY TextColumn1 DESC, TextColumn2;");
+    EXPECT_EQ(result.size(), 4u);
+
+    Array<StringView, 4> expected_text_column1 { "Test_3"sv, "Test_3"sv, "Test_1"sv, "Test_1"sv };
+    Array<StringView, 4> expected_text_column2 { "Test_10"sv, "Test_12"sv, "Test_10"sv, "Test_12"sv };
+    for (size_t i = 0; i < result.size(); ++i) {
+        EXPECT_EQ(result[i].row.size(), 2u);
+        EXPECT_EQ(result[i].row[0].to_deprecated_string(), expected_text_column1[i]);
+        EXPECT_EQ(result[i].row[1].to_deprecated_string(), expected_text_column2[i]);
+    }
+}
+
 TEST_CASE(select_with_like)
 {
     ScopeGuard guard([]() { unlink(db_name); });
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/ThreadPool.h>
+
+TEST_CASE(submitted_work_runs_before_wait_for_all_returns)
+{
+    Threading::ThreadPool pool(4);
+    Atomic<size_t> sum { 0 };
+    for (size_t i = 1; i <= 100; ++i)
+        pool.submit([&sum, i] { sum.fetch_add(i); });
+    pool.wait_for_all();
+    EXPECT_EQ(sum.load(), 5050u);
+}
+
+TEST_CASE(for_each_index_visits_every_index_once)
+{
+    Threading::ThreadPool pool(3);
+    Array<Atomic<u32>, 1000> visits;
+    pool.for_each_index(visits.size(), [&](size_t index) {
+        visits[index].fetch_add(1);
+    });
+    for (auto& count : visits)
+        EXPECT_EQ(count.load(), 1u);
+}
+
+TEST_CASE(pool_without_threads_runs_work_on_the_calling_thread)
+{
+    Threading::ThreadPool pool(0);
+    EXPECT_EQ(pool.thread_count(), 0u);
+
+    size_t sum = 0;
+    pool.submit([&] { sum += 1; });
+    pool.for_each_index(10, [&](size_t index) { sum += index; });
+    EXPECT_EQ(sum, 46u);
+}
+
+TEST_CASE(destroying_pool_finishes_submitted_work)
+{
+    Atomic<size_t> count { 0 };
+    {
+        Threading::ThreadPool pool(2);
+        for (size_t i = 0; i < 50; ++i)
+            pool.submit([&] { count.fetch_add(1); });
+    }
+    EXPECT_EQ(count.load(), 50u);
+}
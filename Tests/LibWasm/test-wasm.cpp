@@ -137,6 +137,16 @@ TESTJS_GLOBAL_FUNCTION(parse_webassembly_module, parseWebAssemblyModule)
     return JS::Value(TRY(WebAssemblyModule::create(realm, result.release_value(), imports)));
 }
 
+TESTJS_GLOBAL_FUNCTION(is_compiled_wasm_function, isCompiledWasmFunction)
+{
+    auto address = static_cast<unsigned long>(TRY(vm.argument(0).to_double(vm)));
+    auto function_instance = WebAssemblyModule::machine().store().get(Wasm::FunctionAddress { address });
+    if (!function_instance)
+        return vm.throw_completion<JS::TypeError>("Invalid function address");
+    auto* wasm_function = function_instance->get_pointer<Wasm::WasmFunction>();
+    return JS::Value(wasm_function && wasm_function->compiled_function());
+}
+
 TESTJS_GLOBAL_FUNCTION(compare_typed_arrays, compareTypedArrays)
 {
     auto* lhs = TRY(vm.argument(0).to_object(vm));
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/DeprecatedString.h>
+#include <AK/Function.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/Stream.h>
+#include <LibCore/System.h>
+#include <LibCore/TCPServer.h>
+#include <LibCore/Timer.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/ThreadPool.h>
+#include <WebServer/Client.h>
+#include <WebServer/Configuration.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// If a request gets stuck, this is when we give up on it.
+static constexpr int test_timeout_milliseconds = 10000;
+
+static DeprecatedString const& document_root_path()
+{
+    static DeprecatedString path = [] {
+        char path_template[] = "/tmp/webserver-test-XXXXXX";
+        VERIFY(mkdtemp(path_template));
+        return DeprecatedString { path_template };
+    }();
+    return path;
+}
+
+static void write_document(StringView name, ReadonlyBytes contents)
+{
+    auto path = DeprecatedString::formatted("{}/{}", document_root_path(), name);
+    auto file = MUST(Core::Stream::File::open(path, Core::Stream::OpenMode::Write | Core::Stream::OpenMode::Truncate));
+    MUST(file->write_entire_buffer(contents));
+}
+
+static void remove_document(StringView name)
+{
+    MUST(Core::System::unlink(DeprecatedString::formatted("{}/{}", document_root_path(), name)));
+}
+
+// The configuration is a process-wide singleton, and the clients only ever look at the document root.
+static void ensure_configuration()
+{
+    static WebServer::Configuration configuration(document_root_path());
+}
+
+// Serves the document root on the calling thread's event loop with a pool of the given number of workers,
+// while the client callback talks to it from another thread. Returns once the client callback has returned.
+static void serve_while(size_t worker_count, Function<void(u16 port)> client)
+{
+    ensure_configuration();
+
+    Core::EventLoop loop;
+    Threading::ThreadPool thread_pool(worker_count, "WebServer"sv);
+
+    RefPtr<Core::TCPServer> server = MUST(Core::TCPServer::try_create());
+    server->on_ready_to_accept = [&] {
+        auto client_socket = MUST(server->accept());
+        auto client_socket_fd = client_socket->fd().value();
+        auto buffered_socket = MUST(Core::Stream::BufferedTCPSocket::create(move(client_socket)));
+        MUST(buffered_socket->set_blocking(true));
+        auto client = WebServer::Client::construct(move(buffered_socket), client_socket_fd, thread_pool, server.ptr());
+        client->start();
+    };
+    MUST(server->listen({ 127, 0, 0, 1 }, 0));
+    auto port = server->local_port().value();
+
+    auto watchdog = Core::Timer::create_single_shot(test_timeout_milliseconds, [&] {
+        FAIL("Timed out waiting for the server to respond");
+        loop.quit(1);
+    });
+    watchdog->start();
+
+    Threading::ThreadPool client_thread(1, "WebServerClient"sv);
+    client_thread.submit([&] {
+        {
+            // The client's sockets register notifiers, which need an event loop on this thread.
+            Core::EventLoop client_loop;
+            client(port);
+        }
+        loop.deferred_invoke([&] { loop.quit(0); });
+        loop.wake();
+    });
+
+    loop.exec();
+    // If the watchdog fired, the client might still be waiting on a socket; the sockets go away with the server.
+    server = nullptr;
+}
+
+struct Response {
+    DeprecatedString head;
+    ByteBuffer body;
+};
+
+static Response read_response(Core::Stream::Socket& socket)
+{
+    ByteBuffer received;
+    Optional<size_t> head_length;
+    u8 buffer[4096];
+    while (!head_length.has_value()) {
+        auto bytes = MUST(socket.read({ buffer, sizeof(buffer) }));
+        VERIFY(!bytes.is_empty());
+        received.append(bytes);
+        head_length = StringView { received.bytes() }.find("\r\n\r\n"sv);
+    }
+
+    Response response;
+    response.head = StringView { received.bytes().trim(head_length.value()) };
+
+    size_t content_length = 0;
+    for (auto line : response.head.view().split_view("\r\n"sv)) {
+        if (line.starts_with("Content-Length: "sv))
+            content_length = line.substring_view(16).to_uint().value();
+    }
+
+    response.body.append(received.bytes().slice(head_length.value() + 4));
+    while (response.body.size() < content_length) {
+        auto bytes = MUST(socket.read({ buffer, sizeof(buffer) }));
+        VERIFY(!bytes.is_empty());
+        response.body.append(bytes);
+    }
+    EXPECT_EQ(response.body.size(), content_length);
+    return response;
+}
+
+static void send_request(Core::Stream::Socket& socket, StringView resource, StringView connection)
+{
+    auto request = DeprecatedString::formatted("GET {} HTTP/1.1\r\nHost: localhost\r\nConnection: {}\r\n\r\n", resource, connection);
+    MUST(socket.write_entire_buffer(request.bytes()));
+}
+
+static void expect_closed_by_server(Core::Stream::Socket& socket)
+{
+    u8 byte;
+    auto bytes = MUST(socket.read({ &byte, 1 }));
+    EXPECT(bytes.is_empty());
+}
+
+TEST_CASE(kept_alive_connection_handles_requests_on_workers)
+{
+    write_document("hello.txt"sv, "Hello, friends!\n"sv.bytes());
+
+    serve_while(2, [](u16 port) {
+        auto socket = MUST(Core::Stream::TCPSocket::connect("127.0.0.1"sv, port));
+
+        // Every response has to make it back to the event loop, which only then reads the next request.
+        for (size_t i = 0; i < 3; ++i) {
+            send_request(*socket, "/hello.txt"sv, "keep-alive"sv);
+            auto response = read_response(*socket);
+            EXPECT(response.head.starts_with("HTTP/1.0 200 OK"sv));
+            EXPECT(response.head.contains("Connection: keep-alive"sv));
+            EXPECT_EQ(StringView { response.body.bytes() }, "Hello, friends!\n"sv);
+        }
+
+        send_request(*socket, "/hello.txt"sv, "close"sv);
+        auto response = read_response(*socket);
+        EXPECT(response.head.contains("Connection: close"sv));
+        EXPECT_EQ(StringView { response.body.bytes() }, "Hello, friends!\n"sv);
+        expect_closed_by_server(*socket);
+    });
+
+    remove_document("hello.txt"sv);
+}
+
+TEST_CASE(large_file_is_sent_in_full)
+{
+    // Several times the size of the chunks that sendfile() copies at once.
+    auto contents = MUST(ByteBuffer::create_uninitialized(300 * KiB + 7));
+    for (size_t i = 0; i < contents.size(); ++i)
+        contents[i] = static_cast<u8>(i * 31 + i / 251);
+    write_document("large.bin"sv, contents);
+
+    serve_while(2, [&](u16 port) {
+        auto socket = MUST(Core::Stream::TCPSocket::connect("127.0.0.1"sv, port));
+        send_request(*socket, "/large.bin"sv, "close"sv);
+        auto response = read_response(*socket);
+        EXPECT(response.head.starts_with("HTTP/1.0 200 OK"sv));
+        EXPECT(response.body == contents);
+        expect_closed_by_server(*socket);
+    });
+
+    remove_document("large.bin"sv);
+}
+
+TEST_CASE(concurrent_connections_are_all_answered)
+{
+    write_document("hello.txt"sv, "Hello, friends!\n"sv.bytes());
+
+    serve_while(3, [](u16 port) {
+        Vector<NonnullOwnPtr<Core::Stream::TCPSocket>> sockets;
+        for (size_t i = 0; i < 8; ++i) {
+            sockets.append(MUST(Core::Stream::TCPSocket::connect("127.0.0.1"sv, port)));
+            send_request(*sockets.last(), "/hello.txt"sv, "keep-alive"sv);
+        }
+        for (auto& socket : sockets) {
+            auto response = read_response(*socket);
+            EXPECT_EQ(StringView { response.body.bytes() }, "Hello, friends!\n"sv);
+        }
+        auto& socket = *sockets.first();
+        send_request(socket, "/missing.txt"sv, "keep-alive"sv);
+        auto response = read_response(socket);
+        EXPECT(response.head.starts_with("HTTP/1.0 404"sv));
+    });
+
+    remove_document("hello.txt"sv);
+}
+
+TEST_CASE(requests_are_handled_on_the_event_loop_without_workers)
+{
+    write_document("hello.txt"sv, "Hello, friends!\n"sv.bytes());
+
+    serve_while(0, [](u16 port) {
+        auto socket = MUST(Core::Stream::TCPSocket::connect("127.0.0.1"sv, port));
+        for (size_t i = 0; i < 2; ++i) {
+            send_request(*socket, "/hello.txt"sv, "keep-alive"sv);
+            auto response = read_response(*socket);
+            EXPECT_EQ(StringView { response.body.bytes() }, "Hello, friends!\n"sv);
+        }
+    });
+
+    remove_document("hello.txt"sv);
+}
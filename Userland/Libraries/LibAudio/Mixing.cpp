@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
+#include <AK/SIMDMath.h>
+#include <LibAudio/Mixing.h>
+
+// See comment in AK/SIMDExtras.h
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace Audio {
+
+using AK::SIMD::f32x4;
+using AK::SIMD::i16x4;
+
+static_assert(sizeof(Sample) == 2 * sizeof(float));
+
+// Samples are pairs of floats, so a vector holds two of them.
+static constexpr size_t samples_per_vector = sizeof(f32x4) / sizeof(Sample);
+
+ALWAYS_INLINE static f32x4 load_unaligned(float const* data)
+{
+    f32x4 vector;
+    __builtin_memcpy(&vector, data, sizeof(vector));
+    return vector;
+}
+
+ALWAYS_INLINE static void store_unaligned(float* data, f32x4 vector)
+{
+    __builtin_memcpy(data, &vector, sizeof(vector));
+}
+
+float log_volume_to_gain(float volume)
+{
+    return Sample {}.linear_to_log(volume);
+}
+
+void mix_into(Span<Sample> destination, Span<Sample const> source, float gain)
+{
+    VERIFY(source.size() <= destination.size());
+
+    auto* out = reinterpret_cast<float*>(destination.data());
+    auto const* in = reinterpret_cast<float const*>(source.data());
+    auto gain_vector = AK::SIMD::expand4(gain);
+
+    size_t i = 0;
+    for (; i + samples_per_vector <= source.size(); i += samples_per_vector) {
+        auto offset = i * 2;
+        store_unaligned(out + offset, load_unaligned(out + offset) + load_unaligned(in + offset) * gain_vector);
+    }
+    for (; i < source.size(); ++i)
+        destination[i] += source[i] * gain;
+}
+
+void convert_to_i16(Span<i16> destination, Span<Sample const> source, float gain)
+{
+    VERIFY(destination.size() >= source.size() * 2);
+
+    auto const* in = reinterpret_cast<float const*>(source.data());
+    auto scale = AK::SIMD::expand4(gain * NumericLimits<i16>::max());
+    auto limit = static_cast<float>(NumericLimits<i16>::max());
+
+    size_t i = 0;
+    for (; i + samples_per_vector <= source.size(); i += samples_per_vector) {
+        auto scaled = AK::SIMD::clamp(load_unaligned(in + i * 2) * scale, -limit, limit);
+        auto converted = __builtin_convertvector(scaled, i16x4);
+        __builtin_memcpy(destination.offset_pointer(i * 2), &converted, sizeof(converted));
+    }
+    for (; i < source.size(); ++i) {
+        auto sample = source[i] * gain;
+        sample.clip();
+        destination[i * 2] = static_cast<i16>(sample.left * NumericLimits<i16>::max());
+        destination[i * 2 + 1] = static_cast<i16>(sample.right * NumericLimits<i16>::max());
+    }
+}
+
+}
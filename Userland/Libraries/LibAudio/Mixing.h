@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <LibAudio/Sample.h>
+
+namespace Audio {
+
+// The linear factor corresponding to a logarithmic volume, see Sample::linear_to_log().
+float log_volume_to_gain(float volume);
+
+// Adds the source samples, multiplied by the gain, to the destination samples.
+void mix_into(Span<Sample> destination, Span<Sample const> source, float gain);
+
+// Multiplies the samples by the gain, clips them and converts them to interleaved signed 16-bit PCM.
+// The destination needs to hold two values per sample.
+void convert_to_i16(Span<i16> destination, Span<Sample const> source, float gain);
+
+}
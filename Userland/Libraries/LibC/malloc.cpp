@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/BuiltinWrappers.h>
 #include <AK/Debug.h>
 #include <AK/ScopedValueRollback.h>
@@ -22,21 +23,31 @@
 #include <sys/mman.h>
 #include <syscall.h>
 
+// The number of malloc locks currently held by any thread. The heap is only considered stable when
+// there are none, since the thread asking might be the one holding a lock it would need to allocate.
+static Atomic<size_t> s_held_malloc_lock_count { 0 };
+
 class PthreadMutexLocker {
 public:
     ALWAYS_INLINE explicit PthreadMutexLocker(pthread_mutex_t& mutex)
         : m_mutex(mutex)
     {
         lock();
-        __heap_is_stable = false;
     }
     ALWAYS_INLINE ~PthreadMutexLocker()
     {
-        __heap_is_stable = true;
         unlock();
     }
-    ALWAYS_INLINE void lock() { pthread_mutex_lock(&m_mutex); }
-    ALWAYS_INLINE void unlock() { pthread_mutex_unlock(&m_mutex); }
+    ALWAYS_INLINE void lock()
+    {
+        pthread_mutex_lock(&m_mutex);
+        s_held_malloc_lock_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    }
+    ALWAYS_INLINE void unlock()
+    {
+        s_held_malloc_lock_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
+        pthread_mutex_unlock(&m_mutex);
+    }
 
 private:
     pthread_mutex_t& m_mutex;
@@ -44,13 +55,35 @@ private:
 
 #define RECYCLE_BIG_ALLOCATIONS
 
+// Protects the big allocators and the hot and cold empty block caches.
+// Each size class has its own lock protecting its block lists, which must
+// always be taken before this one.
 static pthread_mutex_t s_malloc_mutex = PTHREAD_MUTEX_INITIALIZER;
-bool __heap_is_stable = true;
+
+bool __heap_is_stable()
+{
+    return s_held_malloc_lock_count.load(AK::MemoryOrder::memory_order_relaxed) == 0;
+}
 
 constexpr size_t number_of_hot_chunked_blocks_to_keep_around = 16;
 constexpr size_t number_of_cold_chunked_blocks_to_keep_around = 16;
 constexpr size_t number_of_big_blocks_to_keep_around_per_size_class = 8;
 
+// Every thread keeps a few free chunks of the small size classes around, so
+// that most malloc() and free() calls don't need to take any lock at all.
+constexpr size_t largest_thread_cached_chunk_size = 1008;
+constexpr size_t number_of_chunks_to_move_between_thread_cache_and_blocks = 16;
+constexpr size_t number_of_chunks_to_keep_in_thread_cache = 2 * number_of_chunks_to_move_between_thread_cache_and_blocks;
+
+consteval size_t count_thread_cached_size_classes()
+{
+    size_t count = 0;
+    while (count < num_size_classes && size_classes[count] <= largest_thread_cached_chunk_size)
+        ++count;
+    return count;
+}
+static constexpr size_t num_thread_cached_size_classes = count_thread_cached_size_classes();
+
 static bool s_log_malloc = false;
 static bool s_scrub_malloc = true;
 static bool s_scrub_free = true;
@@ -94,30 +127,42 @@ struct MemoryAuditingSuppressor {
     }
 };
 
+// The counters are bumped under different locks, or without holding any lock at all.
 struct MallocStats {
-    size_t number_of_malloc_calls;
+    Atomic<size_t> number_of_malloc_calls;
+
+    Atomic<size_t> number_of_thread_cache_hits;
+    Atomic<size_t> number_of_thread_cache_misses;
 
-    size_t number_of_big_allocator_hits;
-    size_t number_of_big_allocator_purge_hits;
-    size_t number_of_big_allocs;
+    Atomic<size_t> number_of_big_allocator_hits;
+    Atomic<size_t> number_of_big_allocator_purge_hits;
+    Atomic<size_t> number_of_big_allocs;
 
-    size_t number_of_hot_empty_block_hits;
-    size_t number_of_cold_empty_block_hits;
-    size_t number_of_cold_empty_block_purge_hits;
-    size_t number_of_block_allocs;
-    size_t number_of_blocks_full;
+    Atomic<size_t> number_of_hot_empty_block_hits;
+    Atomic<size_t> number_of_cold_empty_block_hits;
+    Atomic<size_t> number_of_cold_empty_block_purge_hits;
+    Atomic<size_t> number_of_block_allocs;
+    Atomic<size_t> number_of_blocks_full;
 
-    size_t number_of_free_calls;
+    Atomic<size_t> number_of_free_calls;
 
-    size_t number_of_big_allocator_keeps;
-    size_t number_of_big_allocator_frees;
+    Atomic<size_t> number_of_thread_cache_keeps;
+    Atomic<size_t> number_of_thread_cache_flushes;
 
-    size_t number_of_freed_full_blocks;
-    size_t number_of_hot_keeps;
-    size_t number_of_cold_keeps;
-    size_t number_of_frees;
+    Atomic<size_t> number_of_big_allocator_keeps;
+    Atomic<size_t> number_of_big_allocator_frees;
+
+    Atomic<size_t> number_of_freed_full_blocks;
+    Atomic<size_t> number_of_hot_keeps;
+    Atomic<size_t> number_of_cold_keeps;
+    Atomic<size_t> number_of_frees;
 };
-static MallocStats g_malloc_stats = {};
+static MallocStats g_malloc_stats;
+
+static ALWAYS_INLINE void increment_stat(Atomic<size_t>& counter, size_t amount = 1)
+{
+    counter.fetch_add(amount, AK::MemoryOrder::memory_order_relaxed);
+}
 
 static size_t s_hot_empty_block_count { 0 };
 static ChunkedBlock* s_hot_empty_blocks[number_of_hot_chunked_blocks_to_keep_around] { nullptr };
@@ -125,6 +170,7 @@ static size_t s_cold_empty_block_count { 0 };
 static ChunkedBlock* s_cold_empty_blocks[number_of_cold_chunked_blocks_to_keep_around] { nullptr };
 
 struct Allocator {
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
     size_t size { 0 };
     size_t block_count { 0 };
     ChunkedBlock::List usable_blocks;
@@ -294,93 +340,58 @@ enum class CallerWillInitializeMemory {
 __thread bool s_allocation_enabled = true;
 #endif
 
-static ErrorOr<void*> malloc_impl(size_t size, size_t align, CallerWillInitializeMemory caller_will_initialize_memory)
+static ErrorOr<void*> big_malloc_impl(size_t size, size_t align)
 {
-#ifndef NO_TLS
-    VERIFY(s_allocation_enabled);
-#endif
-
-    // Align must be a power of 2.
-    if (popcount(align) != 1)
-        return EINVAL;
-
-    // FIXME: Support larger than 32KiB alignments (if you dare).
-    if (sizeof(BigAllocationBlock) + align >= ChunkedBlock::block_size)
-        return EINVAL;
-
-    if (s_log_malloc)
-        dbgln("LibC: malloc({})", size);
-
-    if (!size) {
-        // Legally we could just return a null pointer here, but this is more
-        // compatible with existing software.
-        size = 1;
-    }
-
-    g_malloc_stats.number_of_malloc_calls++;
-
-    size_t good_size;
-    auto* allocator = allocator_for_size(size, good_size, align);
-
     PthreadMutexLocker locker(s_malloc_mutex);
 
-    if (!allocator) {
-        size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size + ((align > 16) ? align : 0), ChunkedBlock::block_size);
-        if (real_size < size) {
-            dbgln_if(MALLOC_DEBUG, "LibC: Detected overflow trying to do big allocation of size {} for {}", real_size, size);
-            return ENOMEM;
-        }
+    size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size + ((align > 16) ? align : 0), ChunkedBlock::block_size);
+    if (real_size < size) {
+        dbgln_if(MALLOC_DEBUG, "LibC: Detected overflow trying to do big allocation of size {} for {}", real_size, size);
+        return ENOMEM;
+    }
 #ifdef RECYCLE_BIG_ALLOCATIONS
-        if (auto* allocator = big_allocator_for_size(real_size)) {
-            if (!allocator->blocks.is_empty()) {
-                g_malloc_stats.number_of_big_allocator_hits++;
-                auto* block = allocator->blocks.take_last();
-                int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
-                bool this_block_was_purged = rc == 1;
-                if (rc < 0) {
-                    perror("madvise");
-                    VERIFY_NOT_REACHED();
-                }
-                if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
-                    perror("mprotect");
-                    VERIFY_NOT_REACHED();
-                }
-                if (this_block_was_purged) {
-                    g_malloc_stats.number_of_big_allocator_purge_hits++;
-                    new (block) BigAllocationBlock(real_size);
-                }
+    if (auto* allocator = big_allocator_for_size(real_size)) {
+        if (!allocator->blocks.is_empty()) {
+            increment_stat(g_malloc_stats.number_of_big_allocator_hits);
+            auto* block = allocator->blocks.take_last();
+            int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
+            bool this_block_was_purged = rc == 1;
+            if (rc < 0) {
+                perror("madvise");
+                VERIFY_NOT_REACHED();
+            }
+            if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
+                perror("mprotect");
+                VERIFY_NOT_REACHED();
+            }
+            if (this_block_was_purged) {
+                increment_stat(g_malloc_stats.number_of_big_allocator_purge_hits);
+                new (block) BigAllocationBlock(real_size);
+            }
 
-                void* ptr = reinterpret_cast<void*>(round_up_to_power_of_two(reinterpret_cast<uintptr_t>(&block->m_slot[0]), align));
+            void* ptr = reinterpret_cast<void*>(round_up_to_power_of_two(reinterpret_cast<uintptr_t>(&block->m_slot[0]), align));
 
-                ue_notify_malloc(ptr, size);
-                return ptr;
-            }
+            ue_notify_malloc(ptr, size);
+            return ptr;
         }
+    }
 #endif
-        auto* block = (BigAllocationBlock*)TRY(os_alloc(real_size, "malloc: BigAllocationBlock"));
-        g_malloc_stats.number_of_big_allocs++;
-        new (block) BigAllocationBlock(real_size);
+    auto* block = (BigAllocationBlock*)TRY(os_alloc(real_size, "malloc: BigAllocationBlock"));
+    increment_stat(g_malloc_stats.number_of_big_allocs);
+    new (block) BigAllocationBlock(real_size);
 
-        void* ptr = reinterpret_cast<void*>(round_up_to_power_of_two(reinterpret_cast<uintptr_t>(&block->m_slot[0]), align));
-        ue_notify_malloc(ptr, size);
-        return ptr;
-    }
+    void* ptr = reinterpret_cast<void*>(round_up_to_power_of_two(reinterpret_cast<uintptr_t>(&block->m_slot[0]), align));
+    ue_notify_malloc(ptr, size);
+    return ptr;
+}
 
-    ChunkedBlock* block = nullptr;
-    void* ptr = nullptr;
-    for (auto& current : allocator->usable_blocks) {
-        if (current.free_chunks()) {
-            ptr = try_allocate_chunk_aligned(align, current);
-            if (ptr) {
-                block = &current;
-                break;
-            }
-        }
-    }
+static ChunkedBlock* take_empty_block(size_t good_size)
+{
+    PthreadMutexLocker locker(s_malloc_mutex);
 
-    if (!block && s_hot_empty_block_count) {
-        g_malloc_stats.number_of_hot_empty_block_hits++;
-        block = s_hot_empty_blocks[--s_hot_empty_block_count];
+    if (s_hot_empty_block_count) {
+        increment_stat(g_malloc_stats.number_of_hot_empty_block_hits);
+        auto* block = s_hot_empty_blocks[--s_hot_empty_block_count];
         if (block->m_size != good_size) {
             new (block) ChunkedBlock(good_size);
             ue_notify_chunk_size_changed(block, good_size);
@@ -388,12 +399,12 @@ static ErrorOr<void*> malloc_impl(size_t size, size_t align, CallerWillInitializ
             snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
             set_mmap_name(block, ChunkedBlock::block_size, buffer);
         }
-        allocator->usable_blocks.append(*block);
+        return block;
     }
 
-    if (!block && s_cold_empty_block_count) {
-        g_malloc_stats.number_of_cold_empty_block_hits++;
-        block = s_cold_empty_blocks[--s_cold_empty_block_count];
+    if (s_cold_empty_block_count) {
+        increment_stat(g_malloc_stats.number_of_cold_empty_block_hits);
+        auto* block = s_cold_empty_blocks[--s_cold_empty_block_count];
         int rc = madvise(block, ChunkedBlock::block_size, MADV_SET_NONVOLATILE);
         bool this_block_was_purged = rc == 1;
         if (rc < 0) {
@@ -407,21 +418,67 @@ static ErrorOr<void*> malloc_impl(size_t size, size_t align, CallerWillInitializ
         }
         if (this_block_was_purged || block->m_size != good_size) {
             if (this_block_was_purged)
-                g_malloc_stats.number_of_cold_empty_block_purge_hits++;
+                increment_stat(g_malloc_stats.number_of_cold_empty_block_purge_hits);
             new (block) ChunkedBlock(good_size);
             ue_notify_chunk_size_changed(block, good_size);
         }
-        allocator->usable_blocks.append(*block);
+        return block;
+    }
+
+    return nullptr;
+}
+
+// Returns true if the block was kept around, in which case the caller must forget about it.
+static bool keep_empty_block(ChunkedBlock* block)
+{
+    PthreadMutexLocker locker(s_malloc_mutex);
+
+    if (s_hot_empty_block_count < number_of_hot_chunked_blocks_to_keep_around) {
+        dbgln_if(MALLOC_DEBUG, "Keeping hot block {:p} around", block);
+        increment_stat(g_malloc_stats.number_of_hot_keeps);
+        s_hot_empty_blocks[s_hot_empty_block_count++] = block;
+        return true;
+    }
+    if (s_cold_empty_block_count < number_of_cold_chunked_blocks_to_keep_around) {
+        dbgln_if(MALLOC_DEBUG, "Keeping cold block {:p} around", block);
+        increment_stat(g_malloc_stats.number_of_cold_keeps);
+        s_cold_empty_blocks[s_cold_empty_block_count++] = block;
+        mprotect(block, ChunkedBlock::block_size, PROT_NONE);
+        madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
+        return true;
+    }
+    return false;
+}
+
+// Must be called with the allocator's lock held.
+static ErrorOr<void*> allocate_chunk(Allocator& allocator, size_t good_size, size_t align)
+{
+    ChunkedBlock* block = nullptr;
+    void* ptr = nullptr;
+    for (auto& current : allocator.usable_blocks) {
+        if (current.free_chunks()) {
+            ptr = try_allocate_chunk_aligned(align, current);
+            if (ptr) {
+                block = &current;
+                break;
+            }
+        }
+    }
+
+    if (!block) {
+        block = take_empty_block(good_size);
+        if (block)
+            allocator.usable_blocks.append(*block);
     }
 
     if (!block) {
-        g_malloc_stats.number_of_block_allocs++;
+        increment_stat(g_malloc_stats.number_of_block_allocs);
         char buffer[64];
         snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
         block = (ChunkedBlock*)TRY(os_alloc(ChunkedBlock::block_size, buffer));
         new (block) ChunkedBlock(good_size);
-        allocator->usable_blocks.append(*block);
-        ++allocator->block_count;
+        allocator.usable_blocks.append(*block);
+        ++allocator.block_count;
     }
 
     if (!ptr) {
@@ -430,15 +487,189 @@ static ErrorOr<void*> malloc_impl(size_t size, size_t align, CallerWillInitializ
 
     VERIFY(ptr);
     if (block->is_full()) {
-        g_malloc_stats.number_of_blocks_full++;
+        increment_stat(g_malloc_stats.number_of_blocks_full);
         dbgln_if(MALLOC_DEBUG, "Block {:p} is now full in size class {}", block, good_size);
-        allocator->usable_blocks.remove(*block);
-        allocator->full_blocks.append(*block);
+        allocator.usable_blocks.remove(*block);
+        allocator.full_blocks.append(*block);
     }
     dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (chunk in block {:p}, size {})", ptr, block, block->bytes_per_chunk());
+    return ptr;
+}
+
+// Must be called with the allocator's lock held.
+static void free_chunk(Allocator& allocator, ChunkedBlock& block, void* ptr)
+{
+    auto* entry = (FreelistEntry*)ptr;
+    entry->next = block.m_freelist;
+    block.m_freelist = entry;
+
+    if (block.is_full()) {
+        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", &block, allocator.size);
+        increment_stat(g_malloc_stats.number_of_freed_full_blocks);
+        allocator.full_blocks.remove(block);
+        allocator.usable_blocks.prepend(block);
+    }
+
+    ++block.m_free_chunks;
+
+    if (!block.used_chunks()) {
+        allocator.usable_blocks.remove(block);
+        if (keep_empty_block(&block))
+            return;
+        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", &block, allocator.size);
+        increment_stat(g_malloc_stats.number_of_frees);
+        --allocator.block_count;
+        os_free(&block, ChunkedBlock::block_size);
+    }
+}
+
+#ifndef NO_TLS
+struct ThreadCacheBin {
+    FreelistEntry* chunks { nullptr };
+    size_t count { 0 };
+};
+
+struct ThreadCache {
+    ThreadCacheBin bins[num_thread_cached_size_classes];
+
+    // The calls that don't take any lock are only counted here, so that they don't all contend on
+    // g_malloc_stats. They're added to it whenever this thread takes a lock for its cache anyway.
+    size_t number_of_malloc_calls { 0 };
+    size_t number_of_free_calls { 0 };
+    size_t number_of_thread_cache_hits { 0 };
+    size_t number_of_thread_cache_keeps { 0 };
+};
+
+static __thread ThreadCache s_thread_cache;
+
+static void thread_cache_publish_stats()
+{
+    increment_stat(g_malloc_stats.number_of_malloc_calls, exchange(s_thread_cache.number_of_malloc_calls, 0));
+    increment_stat(g_malloc_stats.number_of_free_calls, exchange(s_thread_cache.number_of_free_calls, 0));
+    increment_stat(g_malloc_stats.number_of_thread_cache_hits, exchange(s_thread_cache.number_of_thread_cache_hits, 0));
+    increment_stat(g_malloc_stats.number_of_thread_cache_keeps, exchange(s_thread_cache.number_of_thread_cache_keeps, 0));
+}
+
+static ALWAYS_INLINE bool should_use_thread_cache()
+{
+    // The userspace emulator tracks every chunk handed out, so don't hide any from it.
+    return !s_in_userspace_emulator;
+}
+
+static ALWAYS_INLINE Optional<size_t> thread_cache_bin_index(Allocator const& allocator)
+{
+    size_t index = &allocator - &allocators()[0];
+    if (index >= num_thread_cached_size_classes)
+        return {};
+    return index;
+}
+
+static ErrorOr<void*> thread_cache_allocate(Allocator& allocator, size_t bin_index)
+{
+    auto& bin = s_thread_cache.bins[bin_index];
+    if (bin.chunks) {
+        ++s_thread_cache.number_of_thread_cache_hits;
+        auto* entry = bin.chunks;
+        bin.chunks = entry->next;
+        --bin.count;
+        return entry;
+    }
+
+    increment_stat(g_malloc_stats.number_of_thread_cache_misses);
+    thread_cache_publish_stats();
+
+    // Grab a whole batch of chunks while we're holding the lock anyway, and hand out the first one.
+    PthreadMutexLocker locker(allocator.mutex);
+    auto* ptr = TRY(allocate_chunk(allocator, allocator.size, 16));
+    for (size_t i = 1; i < number_of_chunks_to_move_between_thread_cache_and_blocks; ++i) {
+        auto chunk_or_error = allocate_chunk(allocator, allocator.size, 16);
+        if (chunk_or_error.is_error())
+            break;
+        auto* entry = (FreelistEntry*)chunk_or_error.value();
+        entry->next = bin.chunks;
+        bin.chunks = entry;
+        ++bin.count;
+    }
+    return ptr;
+}
+
+static void thread_cache_flush(Allocator& allocator, ThreadCacheBin& bin, size_t count)
+{
+    increment_stat(g_malloc_stats.number_of_thread_cache_flushes);
+    thread_cache_publish_stats();
+
+    PthreadMutexLocker locker(allocator.mutex);
+    for (size_t i = 0; i < count && bin.chunks; ++i) {
+        auto* entry = bin.chunks;
+        bin.chunks = entry->next;
+        --bin.count;
+        auto* block = (ChunkedBlock*)((FlatPtr)entry & ChunkedBlock::block_mask);
+        free_chunk(allocator, *block, entry);
+    }
+}
+
+static void thread_cache_deallocate(Allocator& allocator, size_t bin_index, void* ptr)
+{
+    auto& bin = s_thread_cache.bins[bin_index];
+    ++s_thread_cache.number_of_thread_cache_keeps;
+    auto* entry = (FreelistEntry*)ptr;
+    entry->next = bin.chunks;
+    bin.chunks = entry;
+    ++bin.count;
+
+    if (bin.count > number_of_chunks_to_keep_in_thread_cache)
+        thread_cache_flush(allocator, bin, number_of_chunks_to_move_between_thread_cache_and_blocks);
+}
+#endif
+
+static ErrorOr<void*> malloc_impl(size_t size, size_t align, CallerWillInitializeMemory caller_will_initialize_memory)
+{
+#ifndef NO_TLS
+    VERIFY(s_allocation_enabled);
+#endif
+
+    // Align must be a power of 2.
+    if (popcount(align) != 1)
+        return EINVAL;
+
+    // FIXME: Support larger than 32KiB alignments (if you dare).
+    if (sizeof(BigAllocationBlock) + align >= ChunkedBlock::block_size)
+        return EINVAL;
+
+    if (s_log_malloc)
+        dbgln("LibC: malloc({})", size);
+
+    if (!size) {
+        // Legally we could just return a null pointer here, but this is more
+        // compatible with existing software.
+        size = 1;
+    }
+
+#ifndef NO_TLS
+    ++s_thread_cache.number_of_malloc_calls;
+#else
+    increment_stat(g_malloc_stats.number_of_malloc_calls);
+#endif
+
+    size_t good_size;
+    auto* allocator = allocator_for_size(size, good_size, align);
+
+    if (!allocator)
+        return big_malloc_impl(size, align);
+
+    void* ptr = nullptr;
+#ifndef NO_TLS
+    // All chunks are at least 16-byte aligned, so anything in the thread cache will do.
+    if (auto bin_index = thread_cache_bin_index(*allocator); bin_index.has_value() && align <= 16 && should_use_thread_cache())
+        ptr = TRY(thread_cache_allocate(*allocator, bin_index.value()));
+#endif
+    if (!ptr) {
+        PthreadMutexLocker locker(allocator->mutex);
+        ptr = TRY(allocate_chunk(*allocator, good_size, align));
+    }
 
     if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
-        memset(ptr, MALLOC_SCRUB_BYTE, block->m_size);
+        memset(ptr, MALLOC_SCRUB_BYTE, good_size);
 
     ue_notify_malloc(ptr, size);
     return ptr;
@@ -455,19 +686,22 @@ static void free_impl(void* ptr)
     if (!ptr)
         return;
 
-    g_malloc_stats.number_of_free_calls++;
+#ifndef NO_TLS
+    ++s_thread_cache.number_of_free_calls;
+#else
+    increment_stat(g_malloc_stats.number_of_free_calls);
+#endif
 
     void* block_base = (void*)((FlatPtr)ptr & ChunkedBlock::ChunkedBlock::block_mask);
     size_t magic = *(size_t*)block_base;
 
-    PthreadMutexLocker locker(s_malloc_mutex);
-
     if (magic == MAGIC_BIGALLOC_HEADER) {
+        PthreadMutexLocker locker(s_malloc_mutex);
         auto* block = (BigAllocationBlock*)block_base;
 #ifdef RECYCLE_BIG_ALLOCATIONS
         if (auto* allocator = big_allocator_for_size(block->m_size)) {
             if (allocator->blocks.size() < number_of_big_blocks_to_keep_around_per_size_class) {
-                g_malloc_stats.number_of_big_allocator_keeps++;
+                increment_stat(g_malloc_stats.number_of_big_allocator_keeps);
                 allocator->blocks.append(block);
                 size_t this_block_size = block->m_size;
                 if (mprotect(block, this_block_size, PROT_NONE) < 0) {
@@ -482,7 +716,7 @@ static void free_impl(void* ptr)
             }
         }
 #endif
-        g_malloc_stats.number_of_big_allocator_frees++;
+        increment_stat(g_malloc_stats.number_of_big_allocator_frees);
         os_free(block, block->m_size);
         return;
     }
@@ -495,46 +729,20 @@ static void free_impl(void* ptr)
     if (s_scrub_free)
         memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
 
-    auto* entry = (FreelistEntry*)ptr;
-    entry->next = block->m_freelist;
-    block->m_freelist = entry;
+    // NOTE: The chunk size of a block can't change while we're holding on to one of its chunks.
+    size_t good_size;
+    auto* allocator = allocator_for_size(block->m_size, good_size);
+    VERIFY(allocator);
 
-    if (block->is_full()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
-        g_malloc_stats.number_of_freed_full_blocks++;
-        allocator->full_blocks.remove(*block);
-        allocator->usable_blocks.prepend(*block);
-    }
-
-    ++block->m_free_chunks;
-
-    if (!block->used_chunks()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        if (s_hot_empty_block_count < number_of_hot_chunked_blocks_to_keep_around) {
-            dbgln_if(MALLOC_DEBUG, "Keeping hot block {:p} around", block);
-            g_malloc_stats.number_of_hot_keeps++;
-            allocator->usable_blocks.remove(*block);
-            s_hot_empty_blocks[s_hot_empty_block_count++] = block;
-            return;
-        }
-        if (s_cold_empty_block_count < number_of_cold_chunked_blocks_to_keep_around) {
-            dbgln_if(MALLOC_DEBUG, "Keeping cold block {:p} around", block);
-            g_malloc_stats.number_of_cold_keeps++;
-            allocator->usable_blocks.remove(*block);
-            s_cold_empty_blocks[s_cold_empty_block_count++] = block;
-            mprotect(block, ChunkedBlock::block_size, PROT_NONE);
-            madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
-            return;
-        }
-        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, good_size);
-        g_malloc_stats.number_of_frees++;
-        allocator->usable_blocks.remove(*block);
-        --allocator->block_count;
-        os_free(block, ChunkedBlock::block_size);
+#ifndef NO_TLS
+    if (auto bin_index = thread_cache_bin_index(*allocator); bin_index.has_value() && should_use_thread_cache()) {
+        thread_cache_deallocate(*allocator, bin_index.value(), ptr);
+        return;
     }
+#endif
+
+    PthreadMutexLocker locker(allocator->mutex);
+    free_chunk(*allocator, *block, ptr);
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/malloc.html
@@ -683,28 +891,49 @@ void __malloc_init()
     new (&big_allocators()[0])(BigAllocator);
 }
 
+void __malloc_flush_thread_cache()
+{
+#ifndef NO_TLS
+    for (size_t i = 0; i < num_thread_cached_size_classes; ++i) {
+        auto& bin = s_thread_cache.bins[i];
+        if (bin.count)
+            thread_cache_flush(allocators()[i], bin, bin.count);
+    }
+    thread_cache_publish_stats();
+#endif
+}
+
 void serenity_dump_malloc_stats()
 {
-    dbgln("# malloc() calls: {}", g_malloc_stats.number_of_malloc_calls);
+#ifndef NO_TLS
+    thread_cache_publish_stats();
+#endif
+    dbgln("# malloc() calls: {}", g_malloc_stats.number_of_malloc_calls.load());
+    dbgln();
+    dbgln("thread cache hits: {}", g_malloc_stats.number_of_thread_cache_hits.load());
+    dbgln("thread cache misses: {}", g_malloc_stats.number_of_thread_cache_misses.load());
+    dbgln();
+    dbgln("big alloc hits: {}", g_malloc_stats.number_of_big_allocator_hits.load());
+    dbgln("big alloc hits that were purged: {}", g_malloc_stats.number_of_big_allocator_purge_hits.load());
+    dbgln("big allocs: {}", g_malloc_stats.number_of_big_allocs.load());
     dbgln();
-    dbgln("big alloc hits: {}", g_malloc_stats.number_of_big_allocator_hits);
-    dbgln("big alloc hits that were purged: {}", g_malloc_stats.number_of_big_allocator_purge_hits);
-    dbgln("big allocs: {}", g_malloc_stats.number_of_big_allocs);
+    dbgln("empty hot block hits: {}", g_malloc_stats.number_of_hot_empty_block_hits.load());
+    dbgln("empty cold block hits: {}", g_malloc_stats.number_of_cold_empty_block_hits.load());
+    dbgln("empty cold block hits that were purged: {}", g_malloc_stats.number_of_cold_empty_block_purge_hits.load());
+    dbgln("block allocs: {}", g_malloc_stats.number_of_block_allocs.load());
+    dbgln("filled blocks: {}", g_malloc_stats.number_of_blocks_full.load());
     dbgln();
-    dbgln("empty hot block hits: {}", g_malloc_stats.number_of_hot_empty_block_hits);
-    dbgln("empty cold block hits: {}", g_malloc_stats.number_of_cold_empty_block_hits);
-    dbgln("empty cold block hits that were purged: {}", g_malloc_stats.number_of_cold_empty_block_purge_hits);
-    dbgln("block allocs: {}", g_malloc_stats.number_of_block_allocs);
-    dbgln("filled blocks: {}", g_malloc_stats.number_of_blocks_full);
+    dbgln("# free() calls: {}", g_malloc_stats.number_of_free_calls.load());
     dbgln();
-    dbgln("# free() calls: {}", g_malloc_stats.number_of_free_calls);
+    dbgln("thread cache keeps: {}", g_malloc_stats.number_of_thread_cache_keeps.load());
+    dbgln("thread cache flushes: {}", g_malloc_stats.number_of_thread_cache_flushes.load());
     dbgln();
-    dbgln("big alloc keeps: {}", g_malloc_stats.number_of_big_allocator_keeps);
-    dbgln("big alloc frees: {}", g_malloc_stats.number_of_big_allocator_frees);
+    dbgln("big alloc keeps: {}", g_malloc_stats.number_of_big_allocator_keeps.load());
+    dbgln("big alloc frees: {}", g_malloc_stats.number_of_big_allocator_frees.load());
     dbgln();
-    dbgln("full block frees: {}", g_malloc_stats.number_of_freed_full_blocks);
-    dbgln("number of hot keeps: {}", g_malloc_stats.number_of_hot_keeps);
-    dbgln("number of cold keeps: {}", g_malloc_stats.number_of_cold_keeps);
-    dbgln("number of frees: {}", g_malloc_stats.number_of_frees);
+    dbgln("full block frees: {}", g_malloc_stats.number_of_freed_full_blocks.load());
+    dbgln("number of hot keeps: {}", g_malloc_stats.number_of_hot_keeps.load());
+    dbgln("number of cold keeps: {}", g_malloc_stats.number_of_cold_keeps.load());
+    dbgln("number of frees: {}", g_malloc_stats.number_of_frees.load());
 }
 }
@@ -14,12 +14,13 @@ typedef void (*AtExitFunction)(void*);
 
 extern void __libc_init(void);
 extern void __malloc_init(void);
+extern void __malloc_flush_thread_cache(void);
 extern void __stdio_init(void);
 extern void __begin_atexit_locking(void);
 extern void _init(void);
 extern bool __environ_is_malloced;
 extern bool __stdio_is_initialized;
-extern bool __heap_is_stable;
+extern bool __heap_is_stable(void);
 extern void* __auxiliary_vector;
 
 int __cxa_atexit(AtExitFunction exit_function, void* parameter, void* dso_handle);
@@ -36,6 +36,11 @@
 #include <time.h>
 #include <unistd.h>
 
+#if defined(AK_OS_SERENITY) || defined(AK_OS_LINUX)
+#    define EVENTLOOP_USES_EPOLL
+#    include <sys/epoll.h>
+#endif
+
 #ifdef AK_OS_SERENITY
 #    include <LibCore/Account.h>
 
@@ -74,6 +79,111 @@ static thread_local HashTable<Notifier*>* s_notifiers;
 thread_local int EventLoop::s_wake_pipe_fds[2];
 thread_local bool EventLoop::s_wake_pipe_initialized { false };
 
+#ifdef EVENTLOOP_USES_EPOLL
+// The wake pipe and the fds of all notifiers stay registered with an epoll instance, so waiting
+// doesn't have to hand the kernel every fd again and look at all of them afterwards.
+struct NotifiersForFD {
+    Vector<Notifier*, 1> notifiers;
+    u32 registered_events { 0 };
+};
+static thread_local int s_epoll_fd { -1 };
+static thread_local HashMap<int, NotifiersForFD>* s_notifiers_by_fd;
+// Regular files can't be watched with epoll on Linux, but select() considers them to be always ready.
+static thread_local HashTable<int>* s_always_ready_fds;
+// Set when an fd was closed while it was still registered, see update_epoll_registration().
+static thread_local bool s_epoll_instance_has_stale_registrations { false };
+
+static void create_epoll_instance(int wake_pipe_read_fd)
+{
+    s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    VERIFY(s_epoll_fd >= 0);
+
+    struct epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = wake_pipe_read_fd;
+    int rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, wake_pipe_read_fd, &event);
+    VERIFY(rc == 0);
+}
+
+// Registrations belong to open file descriptions rather than fds. If an fd is closed while it is
+// still registered, but its description lives on (because the fd was dup()'ed, or inherited by a
+// child process), the registration stays around and keeps reporting events under the old fd number,
+// and there's no way left to remove it. The only way to get rid of it is to start over.
+static void recreate_epoll_instance(int wake_pipe_read_fd)
+{
+    s_epoll_instance_has_stale_registrations = false;
+    close(s_epoll_fd);
+    create_epoll_instance(wake_pipe_read_fd);
+
+    for (auto& it : *s_notifiers_by_fd) {
+        auto fd = it.key;
+        if (it.value.registered_events == 0 || s_always_ready_fds->contains(fd))
+            continue;
+        struct epoll_event event {};
+        event.events = it.value.registered_events;
+        event.data.fd = fd;
+        if (epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+            dbgln("Core::EventLoop: Failed to watch fd {} with epoll: {}", fd, strerror(errno));
+    }
+}
+
+static void update_epoll_registration(int fd)
+{
+    auto& notifiers_for_fd = s_notifiers_by_fd->ensure(fd);
+
+    u32 events = 0;
+    for (auto* notifier : notifiers_for_fd.notifiers) {
+        if (notifier->event_mask() & Notifier::Read)
+            events |= EPOLLIN;
+        if (notifier->event_mask() & Notifier::Write)
+            events |= EPOLLOUT;
+        if (notifier->event_mask() & Notifier::Exceptional)
+            VERIFY_NOT_REACHED();
+    }
+
+    if (events != notifiers_for_fd.registered_events && !s_always_ready_fds->contains(fd)) {
+        int rc = 0;
+        if (events == 0) {
+            struct epoll_event event {};
+            if (epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, &event) < 0) {
+                if (errno == EBADF || errno == ENOENT) {
+                    // The fd was closed (and maybe reused) before its notifiers went away. The kernel has only
+                    // forgotten about it on its own if nothing else kept the fd's description open.
+                    dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: fd {} was closed while it was still being watched", fd);
+                    s_epoll_instance_has_stale_registrations = true;
+                } else {
+                    dbgln("Core::EventLoop: Failed to stop watching fd {} with epoll: {}", fd, strerror(errno));
+                }
+            }
+        } else {
+            struct epoll_event event {};
+            event.events = events;
+            event.data.fd = fd;
+            rc = epoll_ctl(s_epoll_fd, notifiers_for_fd.registered_events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event);
+            // The fd may have been closed and reused behind our back.
+            if (rc < 0 && errno == EEXIST) {
+                rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+            } else if (rc < 0 && errno == ENOENT) {
+                s_epoll_instance_has_stale_registrations = true;
+                rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+            }
+            if (rc < 0 && errno == EPERM) {
+                s_always_ready_fds->set(fd);
+                rc = 0;
+            }
+        }
+        if (rc < 0)
+            dbgln("Core::EventLoop: Failed to watch fd {} with epoll: {}", fd, strerror(errno));
+    }
+    notifiers_for_fd.registered_events = events;
+
+    if (notifiers_for_fd.notifiers.is_empty()) {
+        s_notifiers_by_fd->remove(fd);
+        s_always_ready_fds->remove(fd);
+    }
+}
+#endif
+
 void EventLoop::initialize_wake_pipes()
 {
     if (!s_wake_pipe_initialized) {
@@ -86,6 +196,14 @@ void EventLoop::initialize_wake_pipes()
 
 #endif
         VERIFY(rc == 0);
+
+#ifdef EVENTLOOP_USES_EPOLL
+        // After a fork, the child would otherwise share the epoll instance with its parent.
+        if (s_epoll_fd >= 0)
+            close(s_epoll_fd);
+        create_epoll_instance(s_wake_pipe_fds[0]);
+#endif
+
         s_wake_pipe_initialized = true;
     }
 }
@@ -328,6 +446,10 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
         s_event_loop_stack = new Vector<EventLoop&>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
         s_notifiers = new HashTable<Notifier*>;
+#ifdef EVENTLOOP_USES_EPOLL
+        s_notifiers_by_fd = new HashMap<int, NotifiersForFD>;
+        s_always_ready_fds = new HashTable<int>;
+#endif
     }
 
     if (s_event_loop_stack->is_empty()) {
@@ -663,6 +785,10 @@ void EventLoop::notify_forked(ForkEvent event)
         s_event_loop_stack->clear();
         s_timers->clear();
         s_notifiers->clear();
+#ifdef EVENTLOOP_USES_EPOLL
+        s_notifiers_by_fd->clear();
+        s_always_ready_fds->clear();
+#endif
         s_wake_pipe_initialized = false;
         initialize_wake_pipes();
         if (auto* info = signals_info<false>()) {
@@ -678,6 +804,10 @@ void EventLoop::notify_forked(ForkEvent event)
 
 void EventLoop::wait_for_event(WaitMode mode)
 {
+#ifdef EVENTLOOP_USES_EPOLL
+    struct epoll_event events[64];
+retry:
+#else
     fd_set rfds;
     fd_set wfds;
 retry:
@@ -703,6 +833,7 @@ retry:
         if (notifier->event_mask() & Notifier::Exceptional)
             VERIFY_NOT_REACHED();
     }
+#endif
 
     bool queued_events_is_empty;
     {
@@ -711,23 +842,37 @@ retry:
     }
 
     Time now;
-    struct timeval timeout = { 0, 0 };
+    Time timeout;
     bool should_wait_forever = false;
     if (mode == WaitMode::WaitForEvents && queued_events_is_empty) {
         auto next_timer_expiration = get_next_timer_expiration();
         if (next_timer_expiration.has_value()) {
             now = Time::now_monotonic_coarse();
-            auto computed_timeout = next_timer_expiration.value() - now;
-            if (computed_timeout.is_negative())
-                computed_timeout = Time::zero();
-            timeout = computed_timeout.to_timeval();
+            timeout = next_timer_expiration.value() - now;
+            if (timeout.is_negative())
+                timeout = Time::zero();
         } else {
             should_wait_forever = true;
         }
     }
 
+#ifdef EVENTLOOP_USES_EPOLL
+    if (s_epoll_instance_has_stale_registrations)
+        recreate_epoll_instance(s_wake_pipe_fds[0]);
+
+    if (!s_always_ready_fds->is_empty()) {
+        timeout = Time::zero();
+        should_wait_forever = false;
+    }
+
+try_select_again:
+    int marked_fd_count = epoll_wait(s_epoll_fd, events, array_size(events), should_wait_forever ? -1 : static_cast<int>(min(timeout.to_milliseconds(), static_cast<i64>(NumericLimits<int>::max()))));
+#else
+    auto timeout_timeval = timeout.to_timeval();
+
 try_select_again:
-    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout_timeval);
+#endif
     if (marked_fd_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
@@ -738,7 +883,16 @@ try_select_again:
         dbgln("Core::EventLoop::wait_for_event: {} ({}: {})", marked_fd_count, saved_errno, strerror(saved_errno));
         VERIFY_NOT_REACHED();
     }
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+#ifdef EVENTLOOP_USES_EPOLL
+    bool wake_pipe_is_readable = false;
+    for (int i = 0; i < marked_fd_count; ++i) {
+        if (events[i].data.fd == s_wake_pipe_fds[0])
+            wake_pipe_is_readable = true;
+    }
+#else
+    bool wake_pipe_is_readable = FD_ISSET(s_wake_pipe_fds[0], &rfds);
+#endif
+    if (wake_pipe_is_readable) {
         int wake_events[8];
         ssize_t nread;
         // We might receive another signal while read()ing here. The signal will go to the handle_signal properly,
@@ -793,6 +947,26 @@ try_select_again:
         }
     }
 
+#ifdef EVENTLOOP_USES_EPOLL
+    auto post_notifier_events = [&](int fd, u32 ready_events) {
+        auto it = s_notifiers_by_fd->find(fd);
+        if (it == s_notifiers_by_fd->end())
+            return;
+        for (auto* notifier : it->value.notifiers) {
+            if ((ready_events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && (notifier->event_mask() & Notifier::Event::Read))
+                post_event(*notifier, make<NotifierReadEvent>(fd));
+            if ((ready_events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) && (notifier->event_mask() & Notifier::Event::Write))
+                post_event(*notifier, make<NotifierWriteEvent>(fd));
+        }
+    };
+
+    for (int i = 0; i < marked_fd_count; ++i) {
+        if (events[i].data.fd != s_wake_pipe_fds[0])
+            post_notifier_events(events[i].data.fd, events[i].events);
+    }
+    for (auto fd : *s_always_ready_fds)
+        post_notifier_events(fd, EPOLLIN | EPOLLOUT);
+#else
     if (!marked_fd_count)
         return;
 
@@ -806,6 +980,7 @@ try_select_again:
                 post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
         }
     }
+#endif
 }
 
 bool EventLoopTimer::has_expired(Time const& now) const
@@ -869,13 +1044,31 @@ bool EventLoop::unregister_timer(int timer_id)
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
     VERIFY_EVENT_LOOP_INITIALIZED();
-    s_notifiers->set(&notifier);
+    if (s_notifiers->set(&notifier) != HashSetResult::InsertedNewEntry)
+        return;
+#ifdef EVENTLOOP_USES_EPOLL
+    s_notifiers_by_fd->ensure(notifier.fd()).notifiers.append(&notifier);
+    update_epoll_registration(notifier.fd());
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
     VERIFY_EVENT_LOOP_INITIALIZED();
-    s_notifiers->remove(&notifier);
+    if (!s_notifiers->remove(&notifier))
+        return;
+#ifdef EVENTLOOP_USES_EPOLL
+    s_notifiers_by_fd->ensure(notifier.fd()).notifiers.remove_first_matching([&](auto* other) { return other == &notifier; });
+    update_epoll_registration(notifier.fd());
+#endif
+}
+
+void EventLoop::notifier_event_mask_did_change(Badge<Notifier>, [[maybe_unused]] Notifier& notifier)
+{
+#ifdef EVENTLOOP_USES_EPOLL
+    if (s_notifiers && s_notifiers->contains(&notifier))
+        update_epoll_registration(notifier.fd());
+#endif
 }
 
 void EventLoop::wake_current()
@@ -202,8 +202,10 @@ FileWatcher::FileWatcher(int watcher_fd, NonnullRefPtr<Notifier> notifier)
 FileWatcher::~FileWatcher()
 {
     m_notifier->on_ready_to_read = nullptr;
-    close(m_notifier->fd());
-    dbgln_if(FILE_WATCHER_DEBUG, "Stopped watcher at fd {}", m_notifier->fd());
+    auto watcher_fd = m_notifier->fd();
+    m_notifier->close();
+    close(watcher_fd);
+    dbgln_if(FILE_WATCHER_DEBUG, "Stopped watcher at fd {}", watcher_fd);
 }
 
 #else
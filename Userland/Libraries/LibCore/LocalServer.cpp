@@ -29,6 +29,9 @@ LocalServer::LocalServer(Object* parent)
 
 LocalServer::~LocalServer()
 {
+    // Stop watching the fd before closing it, or the event loop can't tell it apart from a reused one.
+    if (m_notifier)
+        m_notifier->close();
     if (m_fd >= 0)
         ::close(m_fd);
 }
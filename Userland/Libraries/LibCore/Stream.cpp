@@ -521,6 +521,13 @@ ErrorOr<NonnullOwnPtr<TCPSocket>> TCPSocket::adopt_fd(int fd)
     return socket;
 }
 
+Optional<int> TCPSocket::fd() const
+{
+    if (!is_open())
+        return {};
+    return m_helper.fd();
+}
+
 ErrorOr<size_t> PosixSocketHelper::pending_bytes() const
 {
     if (!is_open()) {
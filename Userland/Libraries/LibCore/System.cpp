@@ -46,6 +46,10 @@ static int memfd_create(char const* name, unsigned int flags)
 #    include <sys/mman.h>
 #endif
 
+#if defined(AK_OS_SERENITY) || defined(AK_OS_LINUX)
+#    include <sys/sendfile.h>
+#endif
+
 #define HANDLE_SYSCALL_RETURN_VALUE(syscall_name, rc, success_value) \
     if ((rc) < 0) {                                                  \
         return Error::from_syscall(syscall_name##sv, rc);            \
@@ -323,6 +327,16 @@ ErrorOr<int> accept4(int sockfd, sockaddr* address, socklen_t* address_length, i
 }
 #endif
 
+#if defined(AK_OS_SERENITY) || defined(AK_OS_LINUX)
+ErrorOr<size_t> sendfile(int out_fd, int in_fd, off_t* offset, size_t count)
+{
+    auto rc = ::sendfile(out_fd, in_fd, offset, count);
+    if (rc < 0)
+        return Error::from_syscall("sendfile"sv, -errno);
+    return rc;
+}
+#endif
+
 ErrorOr<void> sigaction(int signal, struct sigaction const* action, struct sigaction* old_action)
 {
     if (::sigaction(signal, action, old_action) < 0)
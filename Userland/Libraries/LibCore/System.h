@@ -92,6 +92,10 @@ ErrorOr<Optional<struct spwd>> getspnam(StringView name);
 ErrorOr<int> accept4(int sockfd, struct sockaddr*, socklen_t*, int flags);
 #endif
 
+#if defined(AK_OS_SERENITY) || defined(AK_OS_LINUX)
+ErrorOr<size_t> sendfile(int out_fd, int in_fd, off_t* offset, size_t count);
+#endif
+
 ErrorOr<void> sigaction(int signal, struct sigaction const* action, struct sigaction* old_action);
 #if defined(AK_OS_MACOS) || defined(AK_OS_OPENBSD) || defined(AK_OS_FREEBSD)
 ErrorOr<sig_t> signal(int signal, sig_t handler);
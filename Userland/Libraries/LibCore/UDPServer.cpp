@@ -37,6 +37,8 @@ UDPServer::UDPServer(Object* parent)
 
 UDPServer::~UDPServer()
 {
+    if (m_notifier)
+        m_notifier->close();
     ::close(m_fd);
 }
 
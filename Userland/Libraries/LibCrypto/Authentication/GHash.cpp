@@ -10,6 +10,12 @@
 #include <AK/Types.h>
 #include <LibCrypto/Authentication/GHash.h>
 
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <LibCrypto/CPUFeatures.h>
+#    include <immintrin.h>
+#    define GHASH_HAS_HARDWARE_ACCELERATION
+#endif
+
 namespace {
 
 static u32 to_u32(u8 const* b)
@@ -88,10 +94,60 @@ GHash::TagType GHash::process(ReadonlyBytes aad, ReadonlyBytes cipher)
     return digest;
 }
 
+#ifdef GHASH_HAS_HARDWARE_ACCELERATION
+/// Galois Field multiplication with carry-less multiplication instructions.
+/// Algorithm from: Gueron, Kounavis, "Intel Carry-Less Multiplication Instruction and its Usage for Computing the GCM Mode", algorithm 5.
+[[gnu::target("pclmul,sse2")]] static void galois_multiply_with_clmul(u32 (&z)[4], u32 const (&x)[4], u32 const (&y)[4])
+{
+    // Our big endian words, read from the last to the first, are the byte-reflected operands that the algorithm works with.
+    auto a = _mm_set_epi32(x[0], x[1], x[2], x[3]);
+    auto b = _mm_set_epi32(y[0], y[1], y[2], y[3]);
+
+    // 128x128 -> 256 bit carry-less multiplication into high:low.
+    auto low = _mm_clmulepi64_si128(a, b, 0x00);
+    auto middle = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+    auto high = _mm_clmulepi64_si128(a, b, 0x11);
+    low = _mm_xor_si128(low, _mm_slli_si128(middle, 8));
+    high = _mm_xor_si128(high, _mm_srli_si128(middle, 8));
+
+    // The operands are bit-reflected, so shift the product left by one bit to line it back up.
+    auto low_carries = _mm_srli_epi32(low, 31);
+    auto high_carries = _mm_srli_epi32(high, 31);
+    low = _mm_slli_epi32(low, 1);
+    high = _mm_slli_epi32(high, 1);
+    high = _mm_or_si128(high, _mm_srli_si128(low_carries, 12));
+    high = _mm_or_si128(high, _mm_slli_si128(high_carries, 4));
+    low = _mm_or_si128(low, _mm_slli_si128(low_carries, 4));
+
+    // Reduce modulo x^128 + x^7 + x^2 + x + 1.
+    auto reduction = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(low, 31), _mm_slli_epi32(low, 30)), _mm_slli_epi32(low, 25));
+    auto reduction_carries = _mm_srli_si128(reduction, 4);
+    low = _mm_xor_si128(low, _mm_slli_si128(reduction, 12));
+    auto folded = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(low, 1), _mm_srli_epi32(low, 2)), _mm_srli_epi32(low, 7));
+    folded = _mm_xor_si128(folded, reduction_carries);
+    low = _mm_xor_si128(low, folded);
+    auto result = _mm_xor_si128(high, low);
+
+    u32 words[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(words), result);
+    z[0] = words[3];
+    z[1] = words[2];
+    z[2] = words[1];
+    z[3] = words[0];
+}
+#endif
+
 /// Galois Field multiplication using <x^127 + x^7 + x^2 + x + 1>.
 /// Note that x, y, and z are strictly BE.
 void galois_multiply(u32 (&z)[4], const u32 (&_x)[4], const u32 (&_y)[4])
 {
+#ifdef GHASH_HAS_HARDWARE_ACCELERATION
+    if (cpu_features().pclmulqdq) {
+        galois_multiply_with_clmul(z, _x, _y);
+        return;
+    }
+#endif
+
     u32 x[4] { _x[0], _x[1], _x[2], _x[3] };
     u32 y[4] { _y[0], _y[1], _y[2], _y[3] };
     __builtin_memset(z, 0, sizeof(z));
@@ -26,7 +26,7 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
     while (!(ep < 1)) {
         if (ep.words()[0] % 2 == 1) {
             // exp = (exp * base) % m;
-            multiply_without_allocation(exp, base, temp_1, temp_2, temp_3, temp_multiply);
+            multiply_without_allocation(exp, base, temp_1, temp_multiply);
             divide_without_allocation(temp_multiply, m, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
             exp.set_to(temp_remainder);
         }
@@ -36,7 +36,7 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
         ep.set_to(temp_quotient);
 
         // base = (base * base) % m;
-        multiply_without_allocation(base, base, temp_1, temp_2, temp_3, temp_multiply);
+        multiply_without_allocation(base, base, temp_1, temp_multiply);
         divide_without_allocation(temp_multiply, m, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
         base.set_to(temp_remainder);
 
@@ -178,8 +178,87 @@ void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allo
     result.resize_with_leading_zeros(num_words);
 }
 
+/**
+ * Computes the "almost montgomery" square : x * x * 2 ^ (-num_words * BITS_IN_WORD) % modulo
+ * with the same assumptions and guarantees as almost_montgomery_multiplication_without_allocation().
+ * Instead of interleaving the reduction with the multiplication, this computes the full square first (which only
+ * needs about half the word multiplications), and then reduces it one word at a time.
+ */
+void UnsignedBigIntegerAlgorithms::almost_montgomery_square_without_allocation(
+    UnsignedBigInteger const& x,
+    UnsignedBigInteger const& modulo,
+    UnsignedBigInteger& z,
+    UnsignedBigInteger& temp_scratch,
+    UnsignedBigInteger::Word k,
+    size_t num_words,
+    UnsignedBigInteger& result)
+{
+    VERIFY(x.length() >= num_words);
+    VERIFY(modulo.length() >= num_words);
+
+    z.set_to_0();
+    z.resize_with_leading_zeros(num_words * 2);
+    temp_scratch.set_to_0();
+    temp_scratch.resize_with_leading_zeros(multiplication_scratch_words(num_words, num_words));
+
+    auto x_words = x.m_words.span().trim(num_words);
+    multiply_words(x_words, x_words, z.m_words.span(), temp_scratch.m_words.span());
+
+    UnsignedBigInteger::Word previous_carry { 0 };
+    for (size_t i = 0; i < num_words; ++i) {
+        // z[i->num_words+i] += modulo * (z_i * k), which clears z_i
+        UnsignedBigInteger::Word t = z.m_words[i] * k;
+        UnsignedBigInteger::Word carry = montgomery_fragment(z, i, modulo, t, num_words);
+
+        // Put the carry "right after" the range that we computed above, where the next iteration will pick up what overflows here.
+        u64 sum = static_cast<u64>(z.m_words[num_words + i]) + carry + previous_carry;
+        z.m_words[num_words + i] = static_cast<UnsignedBigInteger::Word>(sum);
+        previous_carry = static_cast<UnsignedBigInteger::Word>(sum >> UnsignedBigInteger::BITS_IN_WORD);
+    }
+
+    if (previous_carry == 0) {
+        // Return the top num_words bytes of Z, which contains our result.
+        shift_right_by_n_words(z, num_words, result);
+        result.resize_with_leading_zeros(num_words);
+        return;
+    }
+
+    // We have a carry, so subtract the modulo from the top half of z into the bottom half, like in almost_montgomery_multiplication_without_allocation().
+    UnsignedBigInteger::Word c { 0 };
+    for (size_t i = 0; i < num_words; ++i) {
+        UnsignedBigInteger::Word z_digit = z.m_words[num_words + i];
+        UnsignedBigInteger::Word modulo_digit = modulo.m_words[i];
+        UnsignedBigInteger::Word new_z_digit = z_digit - modulo_digit - c;
+        z.m_words[i] = new_z_digit;
+        c = ((modulo_digit & ~z_digit) | ((modulo_digit | ~z_digit) & new_z_digit)) >> (UnsignedBigInteger::BITS_IN_WORD - 1);
+    }
+
+    z.m_words.resize(num_words);
+    result.set_to(z);
+    result.resize_with_leading_zeros(num_words);
+}
+
+/**
+ * Picks the sliding window size that minimizes the amount of multiplications for an exponent of this length,
+ * balancing the odd powers we have to precompute against the multiplications we save.
+ * Thresholds from: Menezes, van Oorschot, Vanstone, "Handbook of Applied Cryptography", table 14.16.
+ */
+static size_t sliding_window_size_for_exponent_length(size_t exponent_bits)
+{
+    if (exponent_bits > 671)
+        return 6;
+    if (exponent_bits > 239)
+        return 5;
+    if (exponent_bits > 79)
+        return 4;
+    if (exponent_bits > 23)
+        return 3;
+    return 1;
+}
+
 /**
  * Complexity: still O(N^3) with N the number of words in the largest word, but less complex than the classical mod power.
+ * Uses sliding window exponentiation, so that most bits of the exponent only cost a montgomery square.
  * Note: the montgomery multiplications requires an inverse modulo over 2^32, which is only defined for odd numbers.
  */
 void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocations(
@@ -197,9 +276,7 @@ void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocat
 {
     VERIFY(modulo.is_odd());
 
-    // Note: While this is a constexpr variable for clarity and could be changed in theory,
-    // various optimized parts of the algorithm rely on this value being exactly 4.
-    constexpr size_t window_size = 4;
+    constexpr size_t max_window_size = 6;
 
     size_t num_words = modulo.trimmed_length();
     UnsignedBigInteger::Word k = inverse_wrapped(modulo.m_words[0]);
@@ -220,39 +297,61 @@ void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocat
     one.set_to(1);
     one.resize_with_leading_zeros(num_words);
 
-    // Compute the montgomery powers from 0 to 2^window_size. powers[i] = x^i
-    UnsignedBigInteger powers[1 << window_size];
-    almost_montgomery_multiplication_without_allocation(one, rr, modulo, temp_z, k, num_words, powers[0]);
-    almost_montgomery_multiplication_without_allocation(x, rr, modulo, temp_z, k, num_words, powers[1]);
-    for (size_t i = 2; i < (1 << window_size); ++i)
-        almost_montgomery_multiplication_without_allocation(powers[i - 1], powers[1], modulo, temp_z, k, num_words, powers[i]);
-
-    z.set_to(powers[0]);
-    z.resize_with_leading_zeros(num_words);
+    auto exponent_bits = exponent.one_based_index_of_highest_set_bit();
+    auto window_size = sliding_window_size_for_exponent_length(exponent_bits);
+    auto exponent_bit = [&](size_t index) {
+        return (exponent.m_words[index / UnsignedBigInteger::BITS_IN_WORD] >> (index % UnsignedBigInteger::BITS_IN_WORD)) & 1;
+    };
+
+    // Compute the odd montgomery powers up to 2^window_size, as windows always end on a set bit. powers[i] = x^(2 * i + 1)
+    UnsignedBigInteger powers[1 << (max_window_size - 1)];
+    almost_montgomery_multiplication_without_allocation(x, rr, modulo, temp_z, k, num_words, powers[0]);
+    almost_montgomery_square_without_allocation(powers[0], modulo, temp_z, temp_extra, k, num_words, x);
+    for (size_t i = 1; i < (1u << (window_size - 1)); ++i)
+        almost_montgomery_multiplication_without_allocation(powers[i - 1], x, modulo, temp_z, k, num_words, powers[i]);
+
+    // z = 1 in montgomery form, for exponents of zero.
+    almost_montgomery_multiplication_without_allocation(one, rr, modulo, temp_z, k, num_words, z);
     zz.set_to(0);
     zz.resize_with_leading_zeros(num_words);
 
-    ssize_t exponent_length = exponent.trimmed_length();
-    for (ssize_t word_in_exponent = exponent_length - 1; word_in_exponent >= 0; --word_in_exponent) {
-        UnsignedBigInteger::Word exponent_word = exponent.m_words[word_in_exponent];
-        size_t bit_in_word = 0;
-        while (bit_in_word < UnsignedBigInteger::BITS_IN_WORD) {
-            if (word_in_exponent != exponent_length - 1 || bit_in_word != 0) {
-                almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, k, num_words, zz);
-                almost_montgomery_multiplication_without_allocation(zz, zz, modulo, temp_z, k, num_words, z);
-                almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, k, num_words, zz);
-                almost_montgomery_multiplication_without_allocation(zz, zz, modulo, temp_z, k, num_words, z);
+    // Walk the exponent from its most significant bit, squaring once per bit, and multiplying in a precomputed power
+    // for every window of up to window_size bits that starts and ends with a set bit. Zero bits between windows only cost a square.
+    bool z_is_one = true;
+    ssize_t bit_index = static_cast<ssize_t>(exponent_bits) - 1;
+    while (bit_index >= 0) {
+        if (!exponent_bit(bit_index)) {
+            if (!z_is_one) {
+                almost_montgomery_square_without_allocation(z, modulo, temp_z, temp_extra, k, num_words, zz);
+                swap(z, zz);
             }
-            auto power_index = exponent_word >> (UnsignedBigInteger::BITS_IN_WORD - window_size);
-            auto& power = powers[power_index];
-            almost_montgomery_multiplication_without_allocation(z, power, modulo, temp_z, k, num_words, zz);
+            --bit_index;
+            continue;
+        }
 
+        auto window_end = max(bit_index - static_cast<ssize_t>(window_size) + 1, static_cast<ssize_t>(0));
+        while (!exponent_bit(window_end))
+            ++window_end;
+
+        size_t window_value = 0;
+        for (auto i = bit_index; i >= window_end; --i)
+            window_value = (window_value << 1) | exponent_bit(i);
+
+        auto& power = powers[window_value >> 1];
+        if (z_is_one) {
+            // Squaring one is pointless, just start out with the power.
+            z.set_to(power);
+            z_is_one = false;
+        } else {
+            for (auto i = bit_index; i >= window_end; --i) {
+                almost_montgomery_square_without_allocation(z, modulo, temp_z, temp_extra, k, num_words, zz);
+                swap(z, zz);
+            }
+            almost_montgomery_multiplication_without_allocation(z, power, modulo, temp_z, k, num_words, zz);
             swap(z, zz);
-
-            // Move to the next window
-            exponent_word <<= window_size;
-            bit_in_word += window_size;
         }
+
+        bit_index = window_end - 1;
     }
 
     almost_montgomery_multiplication_without_allocation(z, one, modulo, temp_z, k, num_words, zz);
@@ -9,38 +9,259 @@
 
 namespace Crypto {
 
+using Word = UnsignedBigInteger::Word;
+using DoubleWord = u64;
+
+// Below this many words, the schoolbook method beats Karatsuba's extra additions and bookkeeping.
+static constexpr size_t karatsuba_threshold = 32;
+
+/**
+ * Adds value into accumulator, rippling the carry up through the accumulator.
+ * Returns the carry out of the last word of the accumulator.
+ */
+static Word add_words_into_accumulator(Span<Word> accumulator, Span<Word const> value)
+{
+    VERIFY(value.size() <= accumulator.size());
+
+    Word carry = 0;
+    size_t i = 0;
+    for (; i < value.size(); ++i) {
+        DoubleWord sum = static_cast<DoubleWord>(accumulator[i]) + value[i] + carry;
+        accumulator[i] = static_cast<Word>(sum);
+        carry = static_cast<Word>(sum >> UnsignedBigInteger::BITS_IN_WORD);
+    }
+    for (; carry != 0 && i < accumulator.size(); ++i) {
+        accumulator[i] += carry;
+        carry = accumulator[i] == 0 ? 1 : 0;
+    }
+    return carry;
+}
+
 /**
- * Complexity: O(N^2) where N is the number of words in the larger number
+ * Subtracts value from accumulator, rippling the borrow up through the accumulator.
+ * Returns the borrow out of the last word of the accumulator.
+ */
+static Word subtract_words_from_accumulator(Span<Word> accumulator, Span<Word const> value)
+{
+    VERIFY(value.size() <= accumulator.size());
+
+    Word borrow = 0;
+    size_t i = 0;
+    for (; i < value.size(); ++i) {
+        DoubleWord difference = static_cast<DoubleWord>(accumulator[i]) - value[i] - borrow;
+        accumulator[i] = static_cast<Word>(difference);
+        borrow = static_cast<Word>(difference >> UnsignedBigInteger::BITS_IN_WORD) & 1;
+    }
+    for (; borrow != 0 && i < accumulator.size(); ++i) {
+        borrow = accumulator[i] == 0 ? 1 : 0;
+        accumulator[i] -= 1;
+    }
+    return borrow;
+}
+
+/**
+ * Complexity: O(N*M) where N and M are the number of words in the operands
+ * Multiplies every word of the left operand with all words of the right one, accumulating the
+ * double-word products straight into the output.
+ */
+static void schoolbook_multiply_words(Span<Word const> left, Span<Word const> right, Span<Word> output)
+{
+    output.fill(0);
+    for (size_t i = 0; i < left.size(); ++i) {
+        DoubleWord left_word = left[i];
+        if (left_word == 0)
+            continue;
+
+        // Note: (2^32 - 1)^2 + 2 * (2^32 - 1) == 2^64 - 1, so this can't overflow.
+        DoubleWord carry = 0;
+        for (size_t j = 0; j < right.size(); ++j) {
+            DoubleWord product = left_word * right[j] + output[i + j] + carry;
+            output[i + j] = static_cast<Word>(product);
+            carry = product >> UnsignedBigInteger::BITS_IN_WORD;
+        }
+        output[i + right.size()] = static_cast<Word>(carry);
+    }
+}
+
+/**
+ * Complexity: O(N^2) where N is the number of words in the number, but with about half the multiplications of the schoolbook method
+ * Every cross product number[i] * number[j] shows up twice in the square, so we only compute the ones with
+ * i < j, double them all at once and add the squares of the individual words on top.
+ */
+static void schoolbook_square_words(Span<Word const> number, Span<Word> output)
+{
+    auto length = number.size();
+
+    output.fill(0);
+    for (size_t i = 0; i < length; ++i) {
+        DoubleWord word = number[i];
+        DoubleWord carry = 0;
+        for (size_t j = i + 1; j < length; ++j) {
+            DoubleWord product = word * number[j] + output[i + j] + carry;
+            output[i + j] = static_cast<Word>(product);
+            carry = product >> UnsignedBigInteger::BITS_IN_WORD;
+        }
+        output[i + length] = static_cast<Word>(carry);
+    }
+
+    Word shifted_out_bit = 0;
+    for (auto& word : output) {
+        Word new_shifted_out_bit = word >> (UnsignedBigInteger::BITS_IN_WORD - 1);
+        word = (word << 1) | shifted_out_bit;
+        shifted_out_bit = new_shifted_out_bit;
+    }
+
+    DoubleWord carry = 0;
+    for (size_t i = 0; i < length; ++i) {
+        DoubleWord word = number[i];
+        DoubleWord low = word * word + output[2 * i] + carry;
+        output[2 * i] = static_cast<Word>(low);
+        DoubleWord high = (low >> UnsignedBigInteger::BITS_IN_WORD) + output[2 * i + 1];
+        output[2 * i + 1] = static_cast<Word>(high);
+        carry = high >> UnsignedBigInteger::BITS_IN_WORD;
+    }
+}
+
+/**
+ * Returns the amount of scratch words multiply_words() needs for operands of these lengths.
+ * This follows the same path through the algorithm as multiply_words() itself.
+ */
+size_t UnsignedBigIntegerAlgorithms::multiplication_scratch_words(size_t left_length, size_t right_length)
+{
+    if (left_length < right_length)
+        swap(left_length, right_length);
+
+    if (right_length < karatsuba_threshold)
+        return 0;
+
+    if (left_length >= 2 * right_length)
+        return 2 * right_length + multiplication_scratch_words(right_length, right_length);
+
+    auto half_sum_length = left_length - left_length / 2 + 1;
+    return 4 * half_sum_length + multiplication_scratch_words(half_sum_length, half_sum_length);
+}
+
+/**
+ * Complexity: O(N^log2(3)) where N is the number of words in the larger operand, for large enough operands
+ * Computes output = left * right, where output has exactly left.size() + right.size() words and doesn't overlap
+ * with either operand. Passing the same span as both operands squares it, which is cheaper than multiplying.
+ *
+ * Karatsuba multiplication: splitting both operands at h words, so that left = a1 * B^h + a0 and right = b1 * B^h + b0,
+ * left * right = z2 * B^2h + (z1 - z2 - z0) * B^h + z0 with z0 = a0 * b0, z2 = a1 * b1 and z1 = (a0 + a1) * (b0 + b1),
+ * which takes three half-sized multiplications instead of four.
+ */
+void UnsignedBigIntegerAlgorithms::multiply_words(Span<Word const> left, Span<Word const> right, Span<Word> output, Span<Word> scratch)
+{
+    VERIFY(output.size() == left.size() + right.size());
+
+    bool is_square = left.data() == right.data() && left.size() == right.size();
+
+    if (left.size() < right.size())
+        swap(left, right);
+
+    if (right.size() < karatsuba_threshold) {
+        if (is_square)
+            schoolbook_square_words(left, output);
+        else
+            schoolbook_multiply_words(left, right, output);
+        return;
+    }
+
+    VERIFY(scratch.size() >= multiplication_scratch_words(left.size(), right.size()));
+
+    if (left.size() >= 2 * right.size()) {
+        // The operands are too lopsided to split them at the same point, so cut the larger one into
+        // slices the size of the smaller one, and add up the (balanced) products of all slices.
+        auto product = scratch.slice(0, 2 * right.size());
+        auto remaining_scratch = scratch.slice(product.size());
+
+        output.fill(0);
+        for (size_t offset = 0; offset < left.size(); offset += right.size()) {
+            auto slice = left.slice(offset, min(right.size(), left.size() - offset));
+            auto slice_product = product.trim(slice.size() + right.size());
+            multiply_words(slice, right, slice_product, remaining_scratch);
+            auto carry = add_words_into_accumulator(output.slice(offset), slice_product);
+            VERIFY(carry == 0);
+        }
+        return;
+    }
+
+    auto split = left.size() / 2;
+    auto left_low = left.trim(split);
+    auto left_high = left.slice(split);
+    auto right_low = right.trim(split);
+    auto right_high = right.slice(split);
+
+    // z0 and z2 go straight into their final place in the output, they don't overlap.
+    auto z0 = output.trim(2 * split);
+    auto z2 = output.slice(2 * split);
+    multiply_words(left_low, is_square ? left_low : right_low, z0, scratch);
+    multiply_words(left_high, is_square ? left_high : right_high, z2, scratch);
+
+    // Note: The high half of left is at least as long as any other half, and the sums may carry into one extra word.
+    auto sum_length = left_high.size() + 1;
+    auto left_sum = scratch.slice(0, sum_length);
+    auto right_sum = scratch.slice(sum_length, sum_length);
+    auto z1 = scratch.slice(2 * sum_length, 2 * sum_length);
+    auto remaining_scratch = scratch.slice(4 * sum_length);
+
+    left_sum.fill(0);
+    left_high.copy_to(left_sum);
+    add_words_into_accumulator(left_sum, left_low);
+
+    if (is_square) {
+        multiply_words(left_sum, left_sum, z1, remaining_scratch);
+    } else {
+        right_sum.fill(0);
+        right_high.copy_to(right_sum);
+        add_words_into_accumulator(right_sum, right_low);
+        multiply_words(left_sum, right_sum, z1, remaining_scratch);
+    }
+
+    // z1 - z0 - z2 = a0 * b1 + a1 * b0, which is never negative, and fits into the output above the split.
+    subtract_words_from_accumulator(z1, z0);
+    subtract_words_from_accumulator(z1, z2);
+
+    auto middle = output.slice(split);
+    for (size_t i = middle.size(); i < z1.size(); ++i)
+        VERIFY(z1[i] == 0);
+    auto carry = add_words_into_accumulator(middle, z1.trim(min(z1.size(), middle.size())));
+    VERIFY(carry == 0);
+}
+
+/**
+ * Complexity: O(N*M) where N and M are the number of words in the operands, or O(N^log2(3)) once both are large enough
  * Multiplication method:
- * An integer is equal to the sum of the powers of two
- * according to the indices of its 'on' bits.
- * So to multiple x*y, we go over each '1' bit in x (say the i'th bit),
- * and add y<<i to the result.
+ * Small operands are multiplied word by word (the schoolbook method), large ones are split up
+ * recursively with Karatsuba multiplication, see multiply_words().
+ * temp_scratch is used as scratch space for the Karatsuba multiplication.
  */
 FLATTEN void UnsignedBigIntegerAlgorithms::multiply_without_allocation(
     UnsignedBigInteger const& left,
     UnsignedBigInteger const& right,
-    UnsignedBigInteger& temp_shift_result,
-    UnsignedBigInteger& temp_shift_plus,
-    UnsignedBigInteger& temp_shift,
+    UnsignedBigInteger& temp_scratch,
     UnsignedBigInteger& output)
 {
+    VERIFY(&output != &left && &output != &right && &output != &temp_scratch);
+
     output.set_to_0();
 
-    // iterate all bits
-    for (size_t word_index = 0; word_index < left.length(); ++word_index) {
-        for (size_t bit_index = 0; bit_index < UnsignedBigInteger::BITS_IN_WORD; ++bit_index) {
-            // If the bit is off - skip over it
-            if (!(left.m_words[word_index] & (1 << bit_index)))
-                continue;
+    auto left_length = left.trimmed_length();
+    auto right_length = right.trimmed_length();
+    if (left_length == 0 || right_length == 0)
+        return;
 
-            size_t shift_amount = word_index * UnsignedBigInteger::BITS_IN_WORD + bit_index;
+    output.m_words.resize_and_keep_capacity(left_length + right_length);
+    temp_scratch.set_to_0();
+    temp_scratch.m_words.resize_and_keep_capacity(multiplication_scratch_words(left_length, right_length));
 
-            // output += (right << shift_amount);
-            shift_left_without_allocation(right, shift_amount, temp_shift_result, temp_shift_plus, temp_shift);
-            add_into_accumulator_without_allocation(output, temp_shift);
-        }
-    }
+    auto left_words = left.m_words.span().trim(left_length);
+    // Note: Keep squaring recognizable by passing the exact same span twice.
+    auto right_words = &left == &right ? left_words : right.m_words.span().trim(right_length);
+    multiply_words(left_words, right_words, output.m_words.span(), temp_scratch.m_words.span());
+
+    // The product can be one word shorter than the sum of the lengths.
+    output.clamp_to_trimmed_length();
 }
 
 }
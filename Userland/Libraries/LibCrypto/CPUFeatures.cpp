@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Types.h>
+#include <LibCrypto/CPUFeatures.h>
+
+#if ARCH(X86_64)
+#    include <cpuid.h>
+#endif
+
+namespace Crypto {
+
+#if ARCH(X86_64)
+// cpuid[eax = 1].ecx
+constexpr u32 cpuid_1_ecx_bit_ssse3 = 1 << 9;
+constexpr u32 cpuid_1_ecx_bit_sse41 = 1 << 19;
+constexpr u32 cpuid_1_ecx_bit_aes = 1 << 25;
+constexpr u32 cpuid_1_ecx_bit_pclmulqdq = 1 << 1;
+// cpuid[eax = 7, ecx = 0].ebx
+constexpr u32 cpuid_7_ebx_bit_sha = 1 << 29;
+#endif
+
+static CPUFeatures detect_cpu_features()
+{
+    CPUFeatures features;
+#if ARCH(X86_64)
+    u32 eax, ebx, ecx, edx;
+    u32 max_leaf = __get_cpuid_max(0, nullptr);
+
+    __cpuid(1, eax, ebx, ecx, edx);
+    features.ssse3 = ecx & cpuid_1_ecx_bit_ssse3;
+    features.sse41 = ecx & cpuid_1_ecx_bit_sse41;
+    features.aes_ni = ecx & cpuid_1_ecx_bit_aes;
+    features.pclmulqdq = ecx & cpuid_1_ecx_bit_pclmulqdq;
+
+    if (max_leaf >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        features.sha_ni = ebx & cpuid_7_ebx_bit_sha;
+    }
+#endif
+    return features;
+}
+
+CPUFeatures const& cpu_features()
+{
+    static CPUFeatures const s_features = detect_cpu_features();
+    return s_features;
+}
+
+}
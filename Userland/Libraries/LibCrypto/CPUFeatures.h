@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Platform.h>
+
+namespace Crypto {
+
+// The instruction set extensions that the hardware accelerated code paths rely on.
+// These are detected once, and are all false on anything but x86_64.
+struct CPUFeatures {
+    bool ssse3 { false };
+    bool sse41 { false };
+    bool aes_ni { false };
+    bool pclmulqdq { false };
+    bool sha_ni { false };
+};
+
+CPUFeatures const& cpu_features();
+
+}
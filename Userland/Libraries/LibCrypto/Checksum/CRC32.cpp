@@ -11,10 +11,14 @@
 
 namespace Crypto::Checksum {
 
+// Slicing-by-8: table[k][i] is the CRC of the byte i followed by k zero bytes, which lets us
+// fold eight bytes into the state at once with independent table lookups.
+static constexpr size_t slice_count = 8;
+
 static constexpr auto generate_table()
 {
-    Array<u32, 256> data {};
-    for (auto i = 0u; i < data.size(); i++) {
+    Array<Array<u32, 256>, slice_count> data {};
+    for (auto i = 0u; i < 256; i++) {
         u32 value = i;
 
         for (auto j = 0; j < 8; j++) {
@@ -25,7 +29,12 @@ static constexpr auto generate_table()
             }
         }
 
-        data[i] = value;
+        data[0][i] = value;
+    }
+
+    for (auto i = 0u; i < 256; i++) {
+        for (auto slice = 1u; slice < slice_count; slice++)
+            data[slice][i] = data[0][data[slice - 1][i] & 0xFF] ^ (data[slice - 1][i] >> 8);
     }
     return data;
 }
@@ -34,8 +43,21 @@ static constexpr auto table = generate_table();
 
 void CRC32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state = table[(m_state ^ data.at(i)) & 0xFF] ^ (m_state >> 8);
+    auto const* bytes = data.data();
+    auto remaining = data.size();
+
+    while (remaining >= slice_count) {
+        // Note: The CRC is reflected, so the state lines up with the bytes in little endian order.
+        u32 low = m_state ^ (bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((u32)bytes[3] << 24));
+        u32 high = bytes[4] | (bytes[5] << 8) | (bytes[6] << 16) | ((u32)bytes[7] << 24);
+        m_state = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24]
+            ^ table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^ table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+        bytes += slice_count;
+        remaining -= slice_count;
+    }
+
+    for (size_t i = 0; i < remaining; i++) {
+        m_state = table[0][(m_state ^ bytes[i]) & 0xFF] ^ (m_state >> 8);
     }
 };
 
@@ -8,6 +8,12 @@
 #include <LibCrypto/Cipher/AES.h>
 #include <LibCrypto/Cipher/AESTables.h>
 
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <LibCrypto/CPUFeatures.h>
+#    include <immintrin.h>
+#    define AES_HAS_HARDWARE_ACCELERATION
+#endif
+
 namespace Crypto {
 namespace Cipher {
 
@@ -197,6 +203,41 @@ void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
     }
 }
 
+#ifdef AES_HAS_HARDWARE_ACCELERATION
+static bool has_aes_instructions()
+{
+    auto const& features = cpu_features();
+    return features.aes_ni && features.ssse3;
+}
+
+// Our round keys are stored as big endian words, while the AES instructions want them as plain bytes.
+[[gnu::target("ssse3")]] ALWAYS_INLINE static __m128i load_round_key(u32 const* round_keys, size_t round)
+{
+    auto const byte_swap_words = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(round_keys + round * 4)), byte_swap_words);
+}
+
+[[gnu::target("aes,ssse3")]] static void encrypt_block_with_aes_instructions(u32 const* round_keys, size_t rounds, u8 const* in, u8* out)
+{
+    auto state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in)), load_round_key(round_keys, 0));
+    for (size_t round = 1; round < rounds; ++round)
+        state = _mm_aesenc_si128(state, load_round_key(round_keys, round));
+    state = _mm_aesenclast_si128(state, load_round_key(round_keys, rounds));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), state);
+}
+
+// Note: The decryption key schedule already has the inverse mix-column applied to the middle rounds,
+//       which is the form AESDEC expects its round keys in.
+[[gnu::target("aes,ssse3")]] static void decrypt_block_with_aes_instructions(u32 const* round_keys, size_t rounds, u8 const* in, u8* out)
+{
+    auto state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in)), load_round_key(round_keys, 0));
+    for (size_t round = 1; round < rounds; ++round)
+        state = _mm_aesdec_si128(state, load_round_key(round_keys, round));
+    state = _mm_aesdeclast_si128(state, load_round_key(round_keys, rounds));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), state);
+}
+#endif
+
 void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 {
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
@@ -205,6 +246,13 @@ void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
     auto const& dec_key = key();
     auto const* round_keys = dec_key.round_keys();
 
+#ifdef AES_HAS_HARDWARE_ACCELERATION
+    if (has_aes_instructions()) {
+        encrypt_block_with_aes_instructions(round_keys, dec_key.rounds(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     s0 = get_key(in.bytes().offset_pointer(0)) ^ round_keys[0];
     s1 = get_key(in.bytes().offset_pointer(4)) ^ round_keys[1];
     s2 = get_key(in.bytes().offset_pointer(8)) ^ round_keys[2];
@@ -294,6 +342,13 @@ void AESCipher::decrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
     auto const& dec_key = key();
     auto const* round_keys = dec_key.round_keys();
 
+#ifdef AES_HAS_HARDWARE_ACCELERATION
+    if (has_aes_instructions()) {
+        decrypt_block_with_aes_instructions(round_keys, dec_key.rounds(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     s0 = get_key(in.bytes().offset_pointer(0)) ^ round_keys[0];
     s1 = get_key(in.bytes().offset_pointer(4)) ^ round_keys[1];
     s2 = get_key(in.bytes().offset_pointer(8)) ^ round_keys[2];
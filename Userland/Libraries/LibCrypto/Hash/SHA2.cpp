@@ -7,6 +7,12 @@
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA2.h>
 
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <LibCrypto/CPUFeatures.h>
+#    include <immintrin.h>
+#    define SHA256_HAS_HARDWARE_ACCELERATION
+#endif
+
 namespace Crypto {
 namespace Hash {
 constexpr static auto ROTRIGHT(u32 a, size_t b) { return (a >> b) | (a << (32 - b)); }
@@ -25,8 +31,66 @@ constexpr static auto EP1(u64 x) { return ROTRIGHT(x, 14) ^ ROTRIGHT(x, 18) ^ RO
 constexpr static auto SIGN0(u64 x) { return ROTRIGHT(x, 1) ^ ROTRIGHT(x, 8) ^ (x >> 7); }
 constexpr static auto SIGN1(u64 x) { return ROTRIGHT(x, 19) ^ ROTRIGHT(x, 61) ^ (x >> 6); }
 
+#ifdef SHA256_HAS_HARDWARE_ACCELERATION
+static bool has_sha_instructions()
+{
+    auto const& features = cpu_features();
+    return features.sha_ni && features.sse41;
+}
+
+/// Algorithm from: Gulley et al., "Intel SHA Extensions: New Instructions Supporting the Secure Hash Algorithm on Intel Architecture Processors".
+[[gnu::target("sha,sse4.1")]] static void sha256_transform_with_sha_instructions(u32 (&state)[8], u8 const* data)
+{
+    auto const byte_swap_words = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // The round instructions want the state as ABEF and CDGH, rather than ABCD and EFGH.
+    auto dcba = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[0]));
+    auto hgfe = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[4]));
+    auto cdab = _mm_shuffle_epi32(dcba, 0xB1);
+    auto efgh = _mm_shuffle_epi32(hgfe, 0x1B);
+    auto abef = _mm_alignr_epi8(cdab, efgh, 8);
+    auto cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+    auto abef_before = abef;
+    auto cdgh_before = cdgh;
+
+    __m128i message[4];
+    for (size_t i = 0; i < 16; ++i) {
+        auto& words = message[i % 4];
+        if (i < 4) {
+            words = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i * 16)), byte_swap_words);
+        } else {
+            // W[t] = SIGN1(W[t - 2]) + W[t - 7] + SIGN0(W[t - 15]) + W[t - 16], four words at a time.
+            auto& previous = message[(i - 1) % 4];
+            auto with_sign0 = _mm_sha256msg1_epu32(words, message[(i - 3) % 4]);
+            auto with_minus_7 = _mm_add_epi32(with_sign0, _mm_alignr_epi8(previous, message[(i - 2) % 4], 4));
+            words = _mm_sha256msg2_epu32(with_minus_7, previous);
+        }
+
+        // Each instruction does two rounds, taking the words and round constants for them from the low half.
+        auto words_plus_constants = _mm_add_epi32(words, _mm_loadu_si128(reinterpret_cast<__m128i const*>(&SHA256Constants::RoundConstants[i * 4])));
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, words_plus_constants);
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(words_plus_constants, 0x0E));
+    }
+
+    abef = _mm_add_epi32(abef, abef_before);
+    cdgh = _mm_add_epi32(cdgh, cdgh_before);
+
+    auto feba = _mm_shuffle_epi32(abef, 0x1B);
+    auto dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), _mm_alignr_epi8(dchg, feba, 8));
+}
+#endif
+
 inline void SHA256::transform(u8 const* data)
 {
+#ifdef SHA256_HAS_HARDWARE_ACCELERATION
+    if (has_sha_instructions()) {
+        sha256_transform_with_sha_instructions(m_state, data);
+        return;
+    }
+#endif
+
     u32 m[64];
 
     size_t i = 0;
@@ -68,13 +132,28 @@ inline void SHA256::transform(u8 const* data)
 
 void SHA256::update(u8 const* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
+    while (length > 0) {
         if (m_data_length == BlockSize) {
             transform(m_data_buffer);
             m_bit_length += 512;
             m_data_length = 0;
         }
-        m_data_buffer[m_data_length++] = message[i];
+
+        // Hash whole blocks straight from the message instead of copying them into the buffer first.
+        if (m_data_length == 0) {
+            while (length > BlockSize) {
+                transform(message);
+                m_bit_length += 512;
+                message += BlockSize;
+                length -= BlockSize;
+            }
+        }
+
+        auto copy_length = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, copy_length);
+        m_data_length += copy_length;
+        message += copy_length;
+        length -= copy_length;
     }
 }
 
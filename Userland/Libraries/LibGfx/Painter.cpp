@@ -23,6 +23,8 @@
 #include <AK/Memory.h>
 #include <AK/Queue.h>
 #include <AK/QuickSort.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
 #include <AK/StdLibExtras.h>
 #include <AK/StringBuilder.h>
 #include <AK/Utf32View.h>
@@ -65,6 +67,90 @@ ALWAYS_INLINE Color get_pixel(Gfx::Bitmap const& bitmap, int x, int y)
     return bitmap.get_pixel(x, y);
 }
 
+#ifdef __SSE2__
+using AK::SIMD::f32x4;
+using AK::SIMD::f64x4;
+using AK::SIMD::i32x4;
+using AK::SIMD::u32x4;
+using AK::SIMD::u8x4;
+
+// Blends four source pixels onto four destination pixels, with exactly the same result as Color::blend() for each of them.
+ALWAYS_INLINE static u32x4 blend4(u32x4 destination, u32x4 source)
+{
+    auto destination_alpha = (i32x4)(destination >> 24);
+    auto source_alpha = (i32x4)(source >> 24);
+
+    auto d = 255 * (destination_alpha + source_alpha) - destination_alpha * source_alpha;
+    auto destination_weight = destination_alpha * (255 - source_alpha);
+    auto source_weight = 255 * source_alpha;
+
+    // There is no vectorized integer division, but every number involved fits into a double exactly,
+    // so dividing doubles truncates to the same result. d is only zero if both alphas are, and those
+    // pixels take the source pixel below anyway.
+    auto divisor = __builtin_convertvector(d - (d == 0), f64x4);
+
+    // (d + 1 + (d >> 8)) >> 8 equals d / 255 for every d we can get here.
+    auto result = (u32x4)((d + 1 + (d >> 8)) >> 8) << 24;
+    for (int shift = 0; shift < 24; shift += 8) {
+        auto destination_channel = (i32x4)((destination >> shift) & 0xff);
+        auto source_channel = (i32x4)((source >> shift) & 0xff);
+        auto numerator = __builtin_convertvector(destination_channel * destination_weight + source_weight * source_channel, f64x4);
+        result |= (u32x4)__builtin_convertvector(numerator / divisor, i32x4) << shift;
+    }
+
+    auto take_source = (u32x4)((destination_alpha == 0) | (source_alpha == 255));
+    auto take_destination = (u32x4)(source_alpha == 0) & ~take_source;
+    auto take_result = ~(take_source | take_destination);
+    return (source & take_source) | (destination & take_destination) | (result & take_result);
+}
+#endif
+
+// Blends `width` pixels returned by get_source_pixel(x) onto a scanline. A destination without alpha channel is treated as opaque.
+template<bool destination_has_alpha, typename GetSourcePixel>
+ALWAYS_INLINE static void blend_scanline(ARGB32* destination, int width, GetSourcePixel get_source_pixel)
+{
+    int x = 0;
+#ifdef __SSE2__
+    for (; x + 4 <= width; x += 4) {
+        u32x4 source { get_source_pixel(x), get_source_pixel(x + 1), get_source_pixel(x + 2), get_source_pixel(x + 3) };
+        auto source_alpha = source >> 24;
+        if (AK::SIMD::all(source_alpha == 0xff)) {
+            memcpy(destination + x, &source, sizeof(source));
+            continue;
+        }
+
+        u32x4 destination_pixels;
+        memcpy(&destination_pixels, destination + x, sizeof(destination_pixels));
+        if constexpr (!destination_has_alpha)
+            destination_pixels |= 0xff000000;
+        else if (AK::SIMD::all(source_alpha == 0) && AK::SIMD::none((destination_pixels >> 24) == 0))
+            continue;
+
+        destination_pixels = blend4(destination_pixels, source);
+        memcpy(destination + x, &destination_pixels, sizeof(destination_pixels));
+    }
+#endif
+    for (; x < width; ++x) {
+        auto destination_color = destination_has_alpha ? Color::from_argb(destination[x]) : Color::from_rgb(destination[x]);
+        destination[x] = destination_color.blend(Color::from_argb(get_source_pixel(x))).value();
+    }
+}
+
+// Does the same as Color::interpolate(), but for all four channels at once.
+ALWAYS_INLINE static Color interpolate_pixels(Color a, Color b, float weight)
+{
+#ifdef __SSE2__
+    auto a_channels = __builtin_convertvector(bit_cast<u8x4>(a.value()), i32x4);
+    auto b_channels = __builtin_convertvector(bit_cast<u8x4>(b.value()), i32x4);
+    auto difference = __builtin_convertvector(b_channels - a_channels, f32x4) * weight;
+    // Like round_to(), this rounds according to the current rounding mode.
+    auto result = a_channels + __builtin_ia32_cvtps2dq(difference);
+    return Color::from_argb(bit_cast<u32>(__builtin_convertvector(result, u8x4)));
+#else
+    return a.interpolate(b, weight);
+#endif
+}
+
 Painter::Painter(Gfx::Bitmap& bitmap)
     : m_target(bitmap)
 {
@@ -122,8 +208,7 @@ void Painter::fill_physical_rect(IntRect const& physical_rect, Color color)
     size_t const dst_skip = m_target->pitch() / sizeof(ARGB32);
 
     for (int i = physical_rect.height() - 1; i >= 0; --i) {
-        for (int j = 0; j < physical_rect.width(); ++j)
-            dst[j] = Color::from_argb(dst[j]).blend(color).value();
+        blend_scanline<true>(dst, physical_rect.width(), [&](int) { return color.value(); });
         dst += dst_skip;
     }
 }
@@ -848,37 +933,37 @@ struct BlitState {
 
 // FIXME: This is a hack to support blit_with_opacity() with RGBA8888 source.
 //        Ideally we'd have a more generic solution that allows any source format.
-static void swap_red_and_blue_channels(Color& color)
+ALWAYS_INLINE static u32 swap_red_and_blue_channels(u32 rgba)
 {
-    u32 rgba = color.value();
-    u32 bgra = (rgba & 0xff00ff00)
+    return (rgba & 0xff00ff00)
         | ((rgba & 0x000000ff) << 16)
         | ((rgba & 0x00ff0000) >> 16);
-    color = Color::from_argb(bgra);
 }
 
-// FIXME: This function is very unoptimized.
 template<BlitState::AlphaState has_alpha>
 static void do_blit_with_opacity(BlitState& state)
 {
-    for (int row = 0; row < state.row_count; ++row) {
-        for (int x = 0; x < state.column_count; ++x) {
-            Color dest_color = (has_alpha & BlitState::DstAlpha) ? Color::from_argb(state.dst[x]) : Color::from_rgb(state.dst[x]);
-            if constexpr (has_alpha & BlitState::SrcAlpha) {
-                Color src_color_with_alpha = Color::from_argb(state.src[x]);
-                if (state.src_format == BitmapFormat::RGBA8888)
-                    swap_red_and_blue_channels(src_color_with_alpha);
-                float pixel_opacity = src_color_with_alpha.alpha() / 255.0;
-                src_color_with_alpha.set_alpha(255 * (state.opacity * pixel_opacity));
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
-            } else {
-                Color src_color_with_alpha = Color::from_rgb(state.src[x]);
-                if (state.src_format == BitmapFormat::RGBA8888)
-                    swap_red_and_blue_channels(src_color_with_alpha);
-                src_color_with_alpha.set_alpha(state.opacity * 255);
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
-            }
+    // The opacity only depends on the alpha of the source pixel, so it's computed once for every possible alpha.
+    Array<u8, 256> source_alpha_with_opacity;
+    for (size_t alpha = 0; alpha < source_alpha_with_opacity.size(); ++alpha) {
+        if constexpr (has_alpha & BlitState::SrcAlpha) {
+            float pixel_opacity = alpha / 255.0;
+            source_alpha_with_opacity[alpha] = static_cast<u8>(255 * (state.opacity * pixel_opacity));
+        } else {
+            source_alpha_with_opacity[alpha] = static_cast<u8>(state.opacity * 255);
         }
+    }
+
+    bool const swap_channels = state.src_format == BitmapFormat::RGBA8888;
+    auto get_source_pixel = [&](int x) -> u32 {
+        u32 pixel = state.src[x];
+        if (swap_channels)
+            pixel = swap_red_and_blue_channels(pixel);
+        return (pixel & 0x00ffffff) | (source_alpha_with_opacity[pixel >> 24] << 24);
+    };
+
+    for (int row = 0; row < state.row_count; ++row) {
+        blend_scanline<(has_alpha & BlitState::DstAlpha) != 0>(state.dst, state.column_count, get_source_pixel);
         state.dst += state.dst_pitch;
         state.src += state.src_pitch;
     }
@@ -1242,10 +1327,10 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, IntRect con
                 auto bottom_left = get_pixel(source, scaled_x0, scaled_y1);
                 auto bottom_right = get_pixel(source, scaled_x1, scaled_y1);
 
-                auto top = top_left.interpolate(top_right, x_ratio);
-                auto bottom = bottom_left.interpolate(bottom_right, x_ratio);
+                auto top = interpolate_pixels(top_left, top_right, x_ratio);
+                auto bottom = interpolate_pixels(bottom_left, bottom_right, x_ratio);
 
-                src_pixel = top.interpolate(bottom, y_ratio);
+                src_pixel = interpolate_pixels(top, bottom, y_ratio);
             } else if constexpr (scaling_mode == Painter::ScalingMode::SmoothPixels) {
                 auto scaled_x1 = clamp(desired_x >> 32, clipped_src_rect.left(), clipped_src_rect.right());
                 auto scaled_x0 = clamp(scaled_x1 - 1, clipped_src_rect.left(), clipped_src_rect.right());
@@ -1263,10 +1348,10 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, IntRect con
                 auto bottom_left = get_pixel(source, scaled_x0, scaled_y1);
                 auto bottom_right = get_pixel(source, scaled_x1, scaled_y1);
 
-                auto top = top_left.interpolate(top_right, scaled_x_ratio);
-                auto bottom = bottom_left.interpolate(bottom_right, scaled_x_ratio);
+                auto top = interpolate_pixels(top_left, top_right, scaled_x_ratio);
+                auto bottom = interpolate_pixels(bottom_left, bottom_right, scaled_x_ratio);
 
-                src_pixel = top.interpolate(bottom, scaled_y_ratio);
+                src_pixel = interpolate_pixels(top, bottom, scaled_y_ratio);
             } else {
                 auto scaled_x = clamp(desired_x >> 32, clipped_src_rect.left(), clipped_src_rect.right());
                 auto scaled_y = clamp(desired_y >> 32, clipped_src_rect.top(), clipped_src_rect.bottom());
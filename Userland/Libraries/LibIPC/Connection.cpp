@@ -49,7 +49,7 @@ Core::Stream::LocalSocket& ConnectionBase::fd_passing_socket()
 
 ErrorOr<void> ConnectionBase::post_message(Message const& message)
 {
-    return post_message(message.encode());
+    return post_message(message.encode(&m_payload_pool));
 }
 
 ErrorOr<void> ConnectionBase::post_message(MessageBuffer buffer)
@@ -129,7 +129,7 @@ void ConnectionBase::handle_messages()
     auto messages = move(m_unprocessed_messages);
     for (auto& message : messages) {
         if (message.endpoint_magic() == m_local_endpoint_magic) {
-            if (auto response = m_local_stub.handle(message)) {
+            if (auto response = m_local_stub.handle(message, &m_payload_pool)) {
                 if (auto result = post_message(*response); result.is_error()) {
                     dbgln("IPC::ConnectionBase::handle_messages: {}", result.error());
                 }
@@ -17,6 +17,7 @@
 #include <LibCore/Timer.h>
 #include <LibIPC/Forward.h>
 #include <LibIPC/Message.h>
+#include <LibIPC/SharedPayloadPool.h>
 #include <errno.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -81,6 +82,8 @@ protected:
 
     u32 m_local_endpoint_magic { 0 };
 
+    SharedPayloadPool m_payload_pool;
+
     NonnullOwnPtr<DeferredInvoker> m_deferred_invoker;
 };
 
@@ -4,18 +4,61 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/JsonValue.h>
 #include <AK/URL.h>
 #include <LibCore/AnonymousBuffer.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/Proxy.h>
+#include <LibCore/System.h>
 #include <LibIPC/Decoder.h>
 #include <LibIPC/Dictionary.h>
 #include <LibIPC/File.h>
+#include <LibIPC/SharedPayloadPool.h>
 #include <fcntl.h>
 
 namespace IPC {
 
+ErrorOr<void> Decoder::decode_payload(Bytes bytes)
+{
+    if (bytes.size() < shared_payload_threshold)
+        return decode_into(bytes);
+
+    switch (TRY(decode<PayloadLocation>())) {
+    case PayloadLocation::Inline:
+        return decode_into(bytes);
+    case PayloadLocation::Shared:
+        break;
+    default:
+        return Error::from_string_literal("IPC: Invalid payload location");
+    }
+
+    auto anon_file = TRY(decode<IPC::File>());
+    auto fd = anon_file.take_fd();
+
+    // Mapping more than the peer actually gave us would fault on access.
+    auto stat_or_error = Core::System::fstat(fd);
+    if (stat_or_error.is_error()) {
+        close(fd);
+        return stat_or_error.release_error();
+    }
+    if (static_cast<size_t>(stat_or_error.value().st_size) < sizeof(SharedPayloadHeader) + bytes.size()) {
+        close(fd);
+        return Error::from_string_literal("IPC: Shared payload is too small");
+    }
+
+    auto buffer = TRY(Core::AnonymousBuffer::create_from_anon_fd(fd, sizeof(SharedPayloadHeader) + bytes.size()));
+    auto* header = buffer.data<SharedPayloadHeader>();
+    if (header->size != bytes.size())
+        return Error::from_string_literal("IPC: Shared payload size mismatch");
+
+    memcpy(bytes.data(), header + 1, bytes.size());
+
+    // Let the sender reuse the buffer for its next large payload.
+    AK::atomic_store(&header->in_use, 0u, AK::memory_order_release);
+    return {};
+}
+
 template<>
 ErrorOr<DeprecatedString> decode(Decoder& decoder)
 {
@@ -29,7 +72,7 @@ ErrorOr<DeprecatedString> decode(Decoder& decoder)
     auto text_impl = StringImpl::create_uninitialized(static_cast<size_t>(length), text_buffer);
 
     Bytes bytes { text_buffer, static_cast<size_t>(length) };
-    TRY(decoder.decode_into(bytes));
+    TRY(decoder.decode_payload(bytes));
 
     return DeprecatedString { *text_impl };
 }
@@ -42,9 +85,7 @@ ErrorOr<ByteBuffer> decode(Decoder& decoder)
         return ByteBuffer {};
 
     auto buffer = TRY(ByteBuffer::create_uninitialized(length));
-    auto bytes = buffer.bytes();
-
-    TRY(decoder.decode_into(bytes));
+    TRY(decoder.decode_payload(buffer.bytes()));
     return buffer;
 }
 
@@ -50,6 +50,9 @@ public:
         return {};
     }
 
+    // Reads a payload that the Encoder either put inline, or passed in shared memory if it was large.
+    ErrorOr<void> decode_payload(Bytes);
+
     Core::Stream::LocalSocket& socket() { return m_socket; }
 
 private:
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/BitCast.h>
 #include <AK/ByteBuffer.h>
 #include <AK/DeprecatedString.h>
@@ -14,9 +15,11 @@
 #include <LibCore/AnonymousBuffer.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/Proxy.h>
+#include <LibCore/System.h>
 #include <LibIPC/Dictionary.h>
 #include <LibIPC/Encoder.h>
 #include <LibIPC/File.h>
+#include <LibIPC/SharedPayloadPool.h>
 
 namespace IPC {
 
@@ -61,6 +64,44 @@ void Encoder::encode_u64(u64 value)
     m_buffer.data.unchecked_append((u8)(value >> 56));
 }
 
+void Encoder::encode_payload(ReadonlyBytes bytes)
+{
+    if (bytes.size() < shared_payload_threshold) {
+        m_buffer.data.append(bytes.data(), bytes.size());
+        return;
+    }
+
+    // Running out of shared memory or file descriptors shouldn't take the sender down with it.
+    auto result = encode_shared_payload(bytes);
+    if (!result.is_error())
+        return;
+    dbgln("IPC::Encoder: Failed to share a {} byte payload, sending it inline: {}", bytes.size(), result.error());
+
+    *this << PayloadLocation::Inline;
+    m_buffer.data.append(bytes.data(), bytes.size());
+}
+
+ErrorOr<void> Encoder::encode_shared_payload(ReadonlyBytes bytes)
+{
+    auto buffer = TRY(m_payload_pool ? m_payload_pool->acquire(bytes.size()) : Core::AnonymousBuffer::create_with_size(sizeof(SharedPayloadHeader) + bytes.size()));
+    auto* header = buffer.data<SharedPayloadHeader>();
+
+    auto fd_or_error = Core::System::dup(buffer.fd());
+    if (fd_or_error.is_error()) {
+        // Nobody is going to read this buffer, so hand it straight back to the pool.
+        AK::atomic_store(&header->in_use, 0u, AK::memory_order_release);
+        return fd_or_error.release_error();
+    }
+
+    header->size = bytes.size();
+    AK::atomic_store(&header->in_use, 1u, AK::memory_order_relaxed);
+    memcpy(header + 1, bytes.data(), bytes.size());
+
+    *this << PayloadLocation::Shared;
+    m_buffer.fds.append(adopt_ref(*new AutoCloseFileDescriptor(fd_or_error.release_value())));
+    return {};
+}
+
 Encoder& Encoder::operator<<(unsigned value)
 {
     encode_u32(value);
@@ -151,13 +192,14 @@ Encoder& Encoder::operator<<(DeprecatedString const& value)
     if (value.is_null())
         return *this << (i32)-1;
     *this << static_cast<i32>(value.length());
-    return *this << value.view();
+    encode_payload(value.bytes());
+    return *this;
 }
 
 Encoder& Encoder::operator<<(ByteBuffer const& value)
 {
     *this << static_cast<i32>(value.size());
-    m_buffer.data.append(value.data(), value.size());
+    encode_payload(value.bytes());
     return *this;
 }
 
@@ -25,8 +25,9 @@ bool encode(Encoder&, T const&)
 
 class Encoder {
 public:
-    explicit Encoder(MessageBuffer& buffer)
+    explicit Encoder(MessageBuffer& buffer, SharedPayloadPool* payload_pool = nullptr)
         : m_buffer(buffer)
+        , m_payload_pool(payload_pool)
     {
     }
 
@@ -129,8 +130,11 @@ public:
 private:
     void encode_u32(u32);
     void encode_u64(u64);
+    void encode_payload(ReadonlyBytes);
+    ErrorOr<void> encode_shared_payload(ReadonlyBytes);
 
     MessageBuffer& m_buffer;
+    SharedPayloadPool* m_payload_pool { nullptr };
 };
 
 }
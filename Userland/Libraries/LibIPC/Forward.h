@@ -13,6 +13,7 @@ class Dictionary;
 class Encoder;
 class Message;
 class File;
+class SharedPayloadPool;
 class Stub;
 
 template<typename T>
@@ -11,6 +11,7 @@
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
+#include <LibIPC/Forward.h>
 #include <unistd.h>
 
 namespace IPC {
@@ -54,7 +55,8 @@ public:
     virtual int message_id() const = 0;
     virtual char const* message_name() const = 0;
     virtual bool valid() const = 0;
-    virtual MessageBuffer encode() const = 0;
+    // Large payloads are put in buffers from the pool if one is given.
+    virtual MessageBuffer encode(SharedPayloadPool* = nullptr) const = 0;
 
 protected:
     Message() = default;
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <LibIPC/SharedPayloadPool.h>
+
+namespace IPC {
+
+static ErrorOr<Core::AnonymousBuffer> create_buffer(size_t payload_size)
+{
+    auto buffer = TRY(Core::AnonymousBuffer::create_with_size(round_up_to_power_of_two(sizeof(SharedPayloadHeader) + payload_size, PAGE_SIZE)));
+    AK::atomic_store(&buffer.data<SharedPayloadHeader>()->in_use, 1u, AK::memory_order_relaxed);
+    return buffer;
+}
+
+ErrorOr<Core::AnonymousBuffer> SharedPayloadPool::acquire(size_t payload_size)
+{
+    auto size = sizeof(SharedPayloadHeader) + payload_size;
+
+    // The receiver hands a buffer back by clearing its in_use flag, so no round trip is needed to reuse it.
+    Optional<size_t> reusable_index;
+    Optional<size_t> free_index;
+    for (size_t i = 0; i < m_buffers.size(); ++i) {
+        auto& buffer = m_buffers[i];
+        if (AK::atomic_load(&buffer.data<SharedPayloadHeader>()->in_use, AK::memory_order_acquire) != 0)
+            continue;
+        free_index = i;
+        if (buffer.size() >= size && (!reusable_index.has_value() || buffer.size() < m_buffers[*reusable_index].size()))
+            reusable_index = i;
+    }
+
+    if (reusable_index.has_value()) {
+        auto& buffer = m_buffers[*reusable_index];
+        AK::atomic_store(&buffer.data<SharedPayloadHeader>()->in_use, 1u, AK::memory_order_relaxed);
+        return buffer;
+    }
+
+    auto buffer = TRY(create_buffer(payload_size));
+
+    // Replace a free buffer that turned out to be too small, or grow the pool while there's room.
+    // If every pooled buffer is still being read, this one is used only once.
+    if (free_index.has_value())
+        m_buffers[*free_index] = buffer;
+    else if (m_buffers.size() < max_pooled_buffers)
+        m_buffers.append(buffer);
+
+    return buffer;
+}
+
+}
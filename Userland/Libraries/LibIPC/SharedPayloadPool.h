@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/Noncopyable.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <LibCore/AnonymousBuffer.h>
+
+namespace IPC {
+
+// Payloads at least this large are passed as an anonymous file instead of being written through the socket.
+// They are still copied into the shared memory by the sender and out of it by the receiver, so what this saves
+// is the trip through the kernel's socket buffers, not the copies themselves.
+static constexpr size_t shared_payload_threshold = 64 * KiB;
+
+// Large payloads are preceded by one of these, since the sender falls back to putting them inline
+// if it can't get hold of shared memory or a file descriptor for them.
+enum class PayloadLocation : u8 {
+    Inline,
+    Shared,
+};
+
+// Sits at the start of the shared memory, followed by the payload.
+struct SharedPayloadHeader {
+    // Set by the sender, and cleared by the receiver once it has copied the payload out.
+    u32 in_use;
+    u32 size;
+};
+
+// Keeps the shared memory of payloads around after they've been received, so sending the next
+// large payload over the same connection doesn't have to create and fault in a new buffer.
+class SharedPayloadPool {
+    AK_MAKE_NONCOPYABLE(SharedPayloadPool);
+    AK_MAKE_NONMOVABLE(SharedPayloadPool);
+
+public:
+    SharedPayloadPool() = default;
+
+    // Returns a buffer that is marked as in use, with room for a payload of the given size.
+    ErrorOr<Core::AnonymousBuffer> acquire(size_t payload_size);
+
+private:
+    static constexpr size_t max_pooled_buffers = 4;
+
+    Vector<Core::AnonymousBuffer, max_pooled_buffers> m_buffers;
+};
+
+}
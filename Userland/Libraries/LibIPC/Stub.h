@@ -17,6 +17,7 @@ class BufferStream;
 namespace IPC {
 
 class Message;
+class SharedPayloadPool;
 struct MessageBuffer;
 
 class Stub {
@@ -25,7 +26,7 @@ public:
 
     virtual u32 magic() const = 0;
     virtual DeprecatedString name() const = 0;
-    virtual OwnPtr<MessageBuffer> handle(Message const&) = 0;
+    virtual OwnPtr<MessageBuffer> handle(Message const&, SharedPayloadPool* = nullptr) = 0;
 
 protected:
     Stub() = default;
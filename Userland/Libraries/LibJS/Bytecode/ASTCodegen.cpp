@@ -657,7 +657,7 @@ Bytecode::CodeGenerationErrorOr<void> AssignmentExpression::generate_bytecode(By
                         generator.emit<Bytecode::Op::PutByValue>(*base_object_register, *computed_property_register);
                     } else if (expression.property().is_identifier()) {
                         auto identifier_table_ref = generator.intern_identifier(verify_cast<Identifier>(expression.property()).string());
-                        generator.emit<Bytecode::Op::PutById>(*base_object_register, identifier_table_ref);
+                        generator.emit<Bytecode::Op::PutById>(*base_object_register, identifier_table_ref, generator.next_property_lookup_cache());
                     } else {
                         return Bytecode::CodeGenerationError {
                             &expression,
@@ -1108,7 +1108,7 @@ Bytecode::CodeGenerationErrorOr<void> ObjectExpression::generate_bytecode(Byteco
             if (property_kind != Bytecode::Op::PropertyKind::Spread)
                 TRY(property.value().generate_bytecode(generator));
 
-            generator.emit<Bytecode::Op::PutById>(object_reg, key_name, property_kind);
+            generator.emit<Bytecode::Op::PutById>(object_reg, key_name, generator.next_property_lookup_cache(), property_kind);
         } else {
             TRY(property.key().generate_bytecode(generator));
             auto property_reg = generator.allocate_register();
@@ -1247,7 +1247,7 @@ static Bytecode::CodeGenerationErrorOr<void> generate_object_binding_pattern_byt
             }
 
             generator.emit<Bytecode::Op::Load>(value_reg);
-            generator.emit<Bytecode::Op::GetById>(generator.intern_identifier(identifier));
+            generator.emit<Bytecode::Op::GetById>(generator.intern_identifier(identifier), generator.next_property_lookup_cache());
         } else {
             auto expression = name.get<NonnullRefPtr<Expression>>();
             TRY(expression->generate_bytecode(generator));
@@ -1543,7 +1543,7 @@ Bytecode::CodeGenerationErrorOr<void> CallExpression::generate_bytecode(Bytecode
             generator.emit<Bytecode::Op::GetByValue>(this_reg);
         } else {
             auto identifier_table_ref = generator.intern_identifier(verify_cast<Identifier>(member_expression.property()).string());
-            generator.emit<Bytecode::Op::GetById>(identifier_table_ref);
+            generator.emit<Bytecode::Op::GetById>(identifier_table_ref, generator.next_property_lookup_cache());
         }
         generator.emit<Bytecode::Op::Store>(callee_reg);
     } else {
@@ -1603,11 +1603,11 @@ Bytecode::CodeGenerationErrorOr<void> YieldExpression::generate_bytecode(Bytecod
         // The accumulator is set to an object, for example: { "type": 1 (normal), value: 1337 }
         generator.emit<Bytecode::Op::Store>(received_completion_register);
 
-        generator.emit<Bytecode::Op::GetById>(type_identifier);
+        generator.emit<Bytecode::Op::GetById>(type_identifier, generator.next_property_lookup_cache());
         generator.emit<Bytecode::Op::Store>(received_completion_type_register);
 
         generator.emit<Bytecode::Op::Load>(received_completion_register);
-        generator.emit<Bytecode::Op::GetById>(value_identifier);
+        generator.emit<Bytecode::Op::GetById>(value_identifier, generator.next_property_lookup_cache());
         generator.emit<Bytecode::Op::Store>(received_completion_value_register);
     };
 
@@ -1629,14 +1629,14 @@ Bytecode::CodeGenerationErrorOr<void> YieldExpression::generate_bytecode(Bytecod
         // 5. Let iterator be iteratorRecord.[[Iterator]].
         auto iterator_register = generator.allocate_register();
         auto iterator_identifier = generator.intern_identifier("iterator");
-        generator.emit<Bytecode::Op::GetById>(iterator_identifier);
+        generator.emit<Bytecode::Op::GetById>(iterator_identifier, generator.next_property_lookup_cache());
         generator.emit<Bytecode::Op::Store>(iterator_register);
 
         // Cache iteratorRecord.[[NextMethod]] for use in step 7.a.i.
         auto next_method_register = generator.allocate_register();
         auto next_method_identifier = generator.intern_identifier("next");
         generator.emit<Bytecode::Op::Load>(iterator_record_register);
-        generator.emit<Bytecode::Op::GetById>(next_method_identifier);
+        generator.emit<Bytecode::Op::GetById>(next_method_identifier, generator.next_property_lookup_cache());
         generator.emit<Bytecode::Op::Store>(next_method_register);
 
         // 6. Let received be NormalCompletion(undefined).
@@ -2118,7 +2118,7 @@ Bytecode::CodeGenerationErrorOr<void> TaggedTemplateLiteral::generate_bytecode(B
     generator.emit<Bytecode::Op::Store>(raw_strings_reg);
 
     generator.emit<Bytecode::Op::Load>(strings_reg);
-    generator.emit<Bytecode::Op::PutById>(raw_strings_reg, generator.intern_identifier("raw"));
+    generator.emit<Bytecode::Op::PutById>(raw_strings_reg, generator.intern_identifier("raw"), generator.next_property_lookup_cache());
 
     generator.emit<Bytecode::Op::LoadImmediate>(js_undefined());
     auto this_reg = generator.allocate_register();
@@ -6,14 +6,37 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/FlyString.h>
 #include <AK/NonnullOwnPtrVector.h>
+#include <AK/WeakPtr.h>
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/IdentifierTable.h>
 #include <LibJS/Bytecode/StringTable.h>
+#include <LibJS/Runtime/Shape.h>
 
 namespace JS::Bytecode {
 
+// Remembers where a GetById/PutById found its property for the last few shapes it has seen.
+struct PropertyLookupCache {
+    static constexpr size_t max_entry_count = 4;
+
+    struct Entry {
+        WeakPtr<Shape> shape;
+        u32 shape_serial_number { 0 };
+
+        // The property lives on the prototype of objects with this shape, rather than on the objects themselves.
+        bool is_on_prototype { false };
+        WeakPtr<Shape> prototype_shape;
+        u32 prototype_shape_serial_number { 0 };
+
+        u32 property_offset { 0 };
+    };
+
+    AK::Array<Entry, max_entry_count> entries;
+    size_t next_entry_to_replace { 0 };
+};
+
 struct Executable {
     FlyString name;
     NonnullOwnPtrVector<BasicBlock> basic_blocks;
@@ -22,6 +45,9 @@ struct Executable {
     size_t number_of_registers { 0 };
     bool is_strict_mode { false };
 
+    // NOTE: These are filled in while the (otherwise immutable) executable runs.
+    mutable Vector<PropertyLookupCache> property_lookup_caches;
+
     DeprecatedString const& get_string(StringTableIndex index) const { return string_table->get(index); }
     FlyString const& get_identifier(IdentifierTableIndex index) const { return identifier_table->get(index); }
 
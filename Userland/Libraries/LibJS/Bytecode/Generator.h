@@ -33,6 +33,8 @@ public:
 
     Register allocate_register();
 
+    u32 next_property_lookup_cache() { return m_next_property_lookup_cache++; }
+
     void ensure_enough_space(size_t size)
     {
         // Make sure there's always enough space for a single jump at the end.
@@ -241,6 +243,7 @@ private:
     NonnullOwnPtr<IdentifierTable> m_identifier_table;
 
     u32 m_next_register { 2 };
+    u32 m_next_property_lookup_cache { 0 };
     u32 m_next_block { 1 };
     FunctionKind m_enclosing_function_kind { FunctionKind::Normal };
     Vector<LabelableScope> m_continuable_scopes;
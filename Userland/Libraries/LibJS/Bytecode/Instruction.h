@@ -95,6 +95,12 @@
 
 namespace JS::Bytecode {
 
+enum class RegisterAccess {
+    Read,
+    Write,
+    ReadWrite,
+};
+
 class alignas(void*) Instruction {
 public:
     constexpr static bool IsTerminator = false;
@@ -115,6 +121,15 @@ public:
     void replace_references(Register, Register);
     static void destroy(Instruction&);
 
+    // Calls callback(Register&, RegisterAccess) for every register operand, assigning to the
+    // register renames that operand.
+    template<typename Callback>
+    void visit_registers(Callback);
+
+    // Note: Only instructions with register operands override this.
+    template<typename Callback>
+    void visit_registers_impl(Callback&) { }
+
 protected:
     explicit Instruction(Type type)
         : m_type(type)
@@ -230,6 +230,7 @@ VM::InterpreterExecutionScope Interpreter::ast_interpreter_scope()
 }
 
 AK::Array<OwnPtr<PassManager>, static_cast<UnderlyingType<Interpreter::OptimizationLevel>>(Interpreter::OptimizationLevel::__Count)> Interpreter::s_optimization_pipelines {};
+bool Interpreter::s_optimizations_enabled = false;
 
 Bytecode::PassManager& Interpreter::optimization_pipeline(Interpreter::OptimizationLevel level)
 {
@@ -243,6 +244,11 @@ Bytecode::PassManager& Interpreter::optimization_pipeline(Interpreter::Optimizat
     auto pm = make<PassManager>();
     if (level == OptimizationLevel::None) {
         // No optimization.
+    } else if (level == OptimizationLevel::Default) {
+        pm->add<Passes::GenerateCFG>();
+        pm->add<Passes::EliminateDeadStores>();
+        pm->add<Passes::GenerateCFG>();
+        pm->add<Passes::AllocateRegisters>();
     } else if (level == OptimizationLevel::Optimize) {
         pm->add<Passes::GenerateCFG>();
         pm->add<Passes::UnifySameBlocks>();
@@ -255,6 +261,10 @@ Bytecode::PassManager& Interpreter::optimization_pipeline(Interpreter::Optimizat
         pm->add<Passes::GenerateCFG>();
         pm->add<Passes::PlaceBlocks>();
         pm->add<Passes::EliminateLoads>();
+        pm->add<Passes::GenerateCFG>();
+        pm->add<Passes::EliminateDeadStores>();
+        pm->add<Passes::GenerateCFG>();
+        pm->add<Passes::AllocateRegisters>();
     } else {
         VERIFY_NOT_REACHED();
     }
@@ -75,12 +75,17 @@ public:
 
     enum class OptimizationLevel {
         None,
+        // Only removes dead stores and shares registers, which is cheap and keeps register windows small.
+        Default,
         Optimize,
         __Count,
-        Default = None,
     };
     static Bytecode::PassManager& optimization_pipeline(OptimizationLevel = OptimizationLevel::Default);
 
+    // Whether function bodies are compiled with the Optimize pipeline instead of the default one.
+    static bool optimizations_enabled() { return s_optimizations_enabled; }
+    static void set_optimizations_enabled(bool enabled) { s_optimizations_enabled = enabled; }
+
     VM::InterpreterExecutionScope ast_interpreter_scope();
 
 private:
@@ -97,6 +102,7 @@ private:
     MarkedVector<Value>& registers() { return window().registers; }
 
     static AK::Array<OwnPtr<PassManager>, static_cast<UnderlyingType<Interpreter::OptimizationLevel>>(Interpreter::OptimizationLevel::__Count)> s_optimization_pipelines;
+    static bool s_optimizations_enabled;
 
     VM& m_vm;
     Realm& m_realm;
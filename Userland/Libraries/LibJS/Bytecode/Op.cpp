@@ -489,11 +489,137 @@ ThrowCompletionOr<void> SetVariable::execute_impl(Bytecode::Interpreter& interpr
     return {};
 }
 
+static bool shape_matches(Shape const& shape, WeakPtr<Shape> const& cached_shape, u32 cached_serial_number)
+{
+    return cached_shape.ptr() == &shape && shape.serial_number() == cached_serial_number;
+}
+
+// Returns the object holding the cached property, if the entry applies to this object.
+static Object const* holder_for_cache_entry(Object const& object, PropertyLookupCache::Entry const& entry)
+{
+    if (!shape_matches(object.shape(), entry.shape, entry.shape_serial_number))
+        return nullptr;
+    if (!entry.is_on_prototype)
+        return &object;
+    auto const* prototype = object.shape().prototype();
+    if (!prototype || prototype->may_interfere_with_property_lookup_cache())
+        return nullptr;
+    if (!shape_matches(prototype->shape(), entry.prototype_shape, entry.prototype_shape_serial_number))
+        return nullptr;
+    return prototype;
+}
+
+static void add_cache_entry(PropertyLookupCache& cache, PropertyLookupCache::Entry entry)
+{
+    for (auto& existing_entry : cache.entries) {
+        if (!existing_entry.shape) {
+            existing_entry = move(entry);
+            return;
+        }
+    }
+    // Megamorphic accesses just keep replacing the oldest entry.
+    cache.entries[cache.next_entry_to_replace] = move(entry);
+    cache.next_entry_to_replace = (cache.next_entry_to_replace + 1) % PropertyLookupCache::max_entry_count;
+}
+
+static Optional<Value> get_by_id_from_cache(Object const& object, PropertyLookupCache const& cache)
+{
+    if (object.may_interfere_with_property_lookup_cache())
+        return {};
+    for (auto const& entry : cache.entries) {
+        auto const* holder = holder_for_cache_entry(object, entry);
+        if (!holder)
+            continue;
+        // NOTE: Accessors and not yet materialized intrinsics don't change the shape, so check for them here.
+        auto value = holder->get_direct(entry.property_offset);
+        if (value.is_empty() || value.is_accessor())
+            return {};
+        return value;
+    }
+    return {};
+}
+
+static void update_get_by_id_cache(Object const& object, PropertyKey const& name, PropertyLookupCache& cache)
+{
+    if (!name.is_string() || object.may_interfere_with_property_lookup_cache())
+        return;
+
+    auto property_key = name.to_string_or_symbol();
+    PropertyLookupCache::Entry entry;
+    entry.shape = object.shape().make_weak_ptr();
+    entry.shape_serial_number = object.shape().serial_number();
+
+    Object const* holder = &object;
+    auto metadata = object.shape().lookup(property_key);
+    if (!metadata.has_value()) {
+        // Only look one level up the prototype chain, that's where methods usually live.
+        holder = object.shape().prototype();
+        if (!holder || holder->may_interfere_with_property_lookup_cache())
+            return;
+        metadata = holder->shape().lookup(property_key);
+        if (!metadata.has_value())
+            return;
+        entry.is_on_prototype = true;
+        entry.prototype_shape = holder->shape().make_weak_ptr();
+        entry.prototype_shape_serial_number = holder->shape().serial_number();
+    }
+
+    auto value = holder->get_direct(metadata->offset);
+    if (value.is_empty() || value.is_accessor())
+        return;
+    entry.property_offset = metadata->offset;
+    add_cache_entry(cache, move(entry));
+}
+
+static bool put_by_id_from_cache(Object& object, Value value, PropertyLookupCache const& cache)
+{
+    if (object.may_interfere_with_property_lookup_cache())
+        return false;
+    for (auto const& entry : cache.entries) {
+        if (entry.is_on_prototype || !shape_matches(object.shape(), entry.shape, entry.shape_serial_number))
+            continue;
+        auto existing_value = object.get_direct(entry.property_offset);
+        if (existing_value.is_empty() || existing_value.is_accessor())
+            return false;
+        object.put_direct(entry.property_offset, value);
+        return true;
+    }
+    return false;
+}
+
+static void update_put_by_id_cache(Object const& object, PropertyKey const& name, PropertyLookupCache& cache)
+{
+    if (!name.is_string() || object.may_interfere_with_property_lookup_cache())
+        return;
+
+    // Only assignments to existing, writable data properties can skip [[Set]], everything else may need to transition the shape.
+    auto metadata = object.shape().lookup(name.to_string_or_symbol());
+    if (!metadata.has_value() || !metadata->attributes.is_writable())
+        return;
+    auto value = object.get_direct(metadata->offset);
+    if (value.is_empty() || value.is_accessor())
+        return;
+
+    PropertyLookupCache::Entry entry;
+    entry.shape = object.shape().make_weak_ptr();
+    entry.shape_serial_number = object.shape().serial_number();
+    entry.property_offset = metadata->offset;
+    add_cache_entry(cache, move(entry));
+}
+
 ThrowCompletionOr<void> GetById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
     auto& vm = interpreter.vm();
     auto* object = TRY(interpreter.accumulator().to_object(vm));
-    interpreter.accumulator() = TRY(object->get(interpreter.current_executable().get_identifier(m_property)));
+    auto& cache = interpreter.current_executable().property_lookup_caches[m_cache_index];
+    if (auto value = get_by_id_from_cache(*object, cache); value.has_value()) {
+        interpreter.accumulator() = value.release_value();
+        return {};
+    }
+
+    PropertyKey name = interpreter.current_executable().get_identifier(m_property);
+    interpreter.accumulator() = TRY(object->get(name));
+    update_get_by_id_cache(*object, name, cache);
     return {};
 }
 
@@ -501,9 +627,20 @@ ThrowCompletionOr<void> PutById::execute_impl(Bytecode::Interpreter& interpreter
 {
     auto& vm = interpreter.vm();
     auto* object = TRY(interpreter.reg(m_base).to_object(vm));
-    PropertyKey name = interpreter.current_executable().get_identifier(m_property);
     auto value = interpreter.accumulator();
-    return put_by_property_key(object, value, name, interpreter, m_kind);
+    if (m_kind != PropertyKind::KeyValue) {
+        PropertyKey name = interpreter.current_executable().get_identifier(m_property);
+        return put_by_property_key(object, value, name, interpreter, m_kind);
+    }
+
+    auto& cache = interpreter.current_executable().property_lookup_caches[m_cache_index];
+    if (put_by_id_from_cache(*object, value, cache))
+        return {};
+
+    PropertyKey name = interpreter.current_executable().get_identifier(m_property);
+    TRY(put_by_property_key(object, value, name, interpreter, m_kind));
+    update_put_by_id_cache(*object, name, cache);
+    return {};
 }
 
 ThrowCompletionOr<void> DeleteById::execute_impl(Bytecode::Interpreter& interpreter) const
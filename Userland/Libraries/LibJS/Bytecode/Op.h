@@ -39,6 +39,8 @@ public:
         if (m_src == from)
             m_src = to;
     }
+    template<typename Callback>
+    void visit_registers_impl(Callback& callback) { callback(m_src, RegisterAccess::Read); }
 
 private:
     Register m_src;
@@ -73,6 +75,8 @@ public:
     DeprecatedString to_deprecated_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
     void replace_references_impl(Register, Register) { }
+    template<typename Callback>
+    void visit_registers_impl(Callback& callback) { callback(m_dst, RegisterAccess::Write); }
 
     Register dst() const { return m_dst; }
 
@@ -122,6 +126,11 @@ private:
         {                                                                              \
             if (m_lhs_reg == from)                                                     \
                 m_lhs_reg = to;                                                        \
+        }                                                                              \
+        template<typename Callback>                                                    \
+        void visit_registers_impl(Callback& callback)                                  \
+        {                                                                              \
+            callback(m_lhs_reg, RegisterAccess::Read);                                 \
         }                                                                              \
                                                                                        \
     private:                                                                           \
@@ -252,6 +261,13 @@ public:
     DeprecatedString to_deprecated_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
     void replace_references_impl(Register from, Register to);
+    template<typename Callback>
+    void visit_registers_impl(Callback& callback)
+    {
+        callback(m_from_object, RegisterAccess::Read);
+        for (size_t i = 0; i < m_excluded_names_count; ++i)
+            callback(m_excluded_names[i], RegisterAccess::Read);
+    }
 
     size_t length_impl() const { return sizeof(*this) + sizeof(Register) * m_excluded_names_count; }
 
@@ -301,6 +317,22 @@ public:
     // Note: The underlying element range shall never be changed item, by item
     //       shifting it may be done in the future
     void replace_references_impl(Register from, Register) { VERIFY(!m_element_count || from.index() < start().index() || from.index() > end().index()); }
+    // Note: Every element is visited, renaming them has to keep the range consecutive.
+    template<typename Callback>
+    void visit_registers_impl(Callback& callback)
+    {
+        if (!m_element_count)
+            return;
+        auto start_index = m_elements[0].index();
+        for (size_t i = 0; i < m_element_count; ++i) {
+            Register element { static_cast<u32>(start_index + i) };
+            callback(element, RegisterAccess::Read);
+            if (i == 0)
+                m_elements[0] = element;
+            VERIFY(element.index() == m_elements[0].index() + i);
+        }
+        m_elements[1] = Register { static_cast<u32>(m_elements[0].index() + m_element_count - 1) };
+    }
 
     size_t length_impl() const
     {
@@ -341,6 +373,8 @@ public:
 
     // Note: This should never do anything, the lhs should always be an array, that is currently being constructed
     void replace_references_impl(Register from, Register) { VERIFY(from != m_lhs); }
+    template<typename Callback>
+    void visit_registers_impl(Callback& callback) { callback(m_lhs, RegisterAccess::Read); }
 
 private:
     Register m_lhs;
@@ -373,6 +407,8 @@ public:
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
     // Note: lhs should always be a string in construction, so this should never do anything
     void replace_references_impl(Register from, Register) { VERIFY(from != m_lhs); }
+    template<typename Callback>
+    void visit_registers_impl(Callback& callback) { callback(m_lhs, RegisterAccess::ReadWrite); }
 
 private:
     Register m_lhs;
@@ -506,9 +542,10 @@ private:
 
 class GetById final : public Instruction {
 public:
-    explicit GetById(IdentifierTableIndex property)
+    GetById(IdentifierTableIndex property, u32 cache_index)
         : Instruction(Type::GetById)
         , m_property(property)
+        , m_cache_index(cache_index)
     {
     }
 
@@ -519,6 +556,7 @@ public:
 
 private:
     IdentifierTableIndex m_property;
+    u32 m_cache_index { 0 };
 };
 
 enum class PropertyKind {
@@ -531,11 +569,12 @@ enum class PropertyKind {
 
 class PutById final : public Instruction {
 public:
-    explicit PutById(Register base, IdentifierTableIndex property, PropertyKind kind = PropertyKind::KeyValue)
+    PutById(Register base, IdentifierTableIndex property, u32 cache_index, PropertyKind kind = PropertyKind::KeyValue)
         : Instruction(Type::PutById)
         , m_base(base)
         , m_property(property)
         , m_kind(kind)
+        , m_cache_index(cache_index)
     {
     }
 
@@ -547,11 +586,14 @@ public:
         if (m_base == from)
             m_base = to;
     }
+    template<typename Callback>
+    void visit_registers_impl(Callback& callback) { callback(m_base, RegisterAccess::Read); }
 
 private:
     Register m_base;
     IdentifierTableIndex m_property;
     PropertyKind m_kind;
+    u32 m_cache_index { 0 };
 };
 
 class DeleteById final : public Instruction {
@@ -587,6 +629,8 @@ public:
         if (m_base == from)
             m_base = to;
     }
+    template<typename Callback>
+    void visit_registers_impl(Callback& callback) { callback(m_base, RegisterAccess::Read); }
 
 private:
     Register m_base;
@@ -610,6 +654,12 @@ public:
         if (m_base == from)
             m_base = to;
     }
+    template<typename Callback>
+    void visit_registers_impl(Callback& callback)
+    {
+        callback(m_base, RegisterAccess::Read);
+        callback(m_property, RegisterAccess::Read);
+    }
 
 private:
     Register m_base;
@@ -633,6 +683,8 @@ public:
         if (m_base == from)
             m_base = to;
     }
+    template<typename Callback>
+    void visit_registers_impl(Callback& callback) { callback(m_base, RegisterAccess::Read); }
 
 private:
     Register m_base;
@@ -729,6 +781,12 @@ public:
     DeprecatedString to_deprecated_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
     void replace_references_impl(Register, Register);
+    template<typename Callback>
+    void visit_registers_impl(Callback& callback)
+    {
+        callback(m_callee, RegisterAccess::Read);
+        callback(m_this_value, RegisterAccess::Read);
+    }
 
     Completion throw_type_error_for_callee(Bytecode::Interpreter&, StringView callee_type) const;
 
@@ -1174,6 +1232,22 @@ ALWAYS_INLINE void Instruction::replace_references(Register from, Register to)
 #undef __BYTECODE_OP
 }
 
+template<typename Callback>
+ALWAYS_INLINE void Instruction::visit_registers(Callback callback)
+{
+#define __BYTECODE_OP(op)       \
+    case Instruction::Type::op: \
+        return static_cast<Bytecode::Op::op&>(*this).visit_registers_impl(callback);
+
+    switch (type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+#undef __BYTECODE_OP
+}
+
 ALWAYS_INLINE size_t Instruction::length() const
 {
     if (type() == Type::NewArray)
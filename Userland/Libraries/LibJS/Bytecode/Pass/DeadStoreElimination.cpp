@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/Pass/Liveness.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+static OwnPtr<BasicBlock> eliminate_dead_stores(BasicBlock const& block, RegisterLiveness const& liveness, size_t number_of_registers)
+{
+    Vector<Instruction const*> instructions;
+    for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it)
+        instructions.append(&*it);
+
+    auto live = Bitmap::create(number_of_registers, false).release_value_but_fixme_should_propagate_errors();
+    auto const& live_out = liveness.live_out.find(&block)->value;
+    __builtin_memcpy(live.data(), live_out.view().data(), live.size_in_bytes());
+
+    // A Store only writes its register, so if nothing reads that register before it is
+    // overwritten, the Store can go.
+    HashTable<Instruction const*> dead_stores;
+    for (size_t i = instructions.size(); i > 0; --i) {
+        auto const& instruction = *instructions[i - 1];
+        if (instruction.type() == Instruction::Type::Store) {
+            auto dst = static_cast<Op::Store const&>(instruction).dst().index();
+            if (dst >= first_tracked_register && !live.get(dst) && !liveness.pinned.get(dst)) {
+                dead_stores.set(&instruction);
+                continue;
+            }
+        }
+        update_liveness_backwards(instruction, live);
+    }
+
+    if (dead_stores.is_empty())
+        return nullptr;
+
+    auto new_block = BasicBlock::create(block.name(), block.size());
+    for (auto const* instruction : instructions) {
+        if (dead_stores.contains(instruction))
+            continue;
+        if (instruction->type() == Instruction::Type::NewBigInt) {
+            // FIXME: This is the only non trivially copyable Instruction,
+            //        so we need to do some extra work here
+            new (new_block->next_slot()) Op::NewBigInt(static_cast<Op::NewBigInt const&>(*instruction));
+        } else {
+            memcpy(new_block->next_slot(), instruction, instruction->length());
+        }
+        new_block->grow(instruction->length());
+    }
+    return new_block;
+}
+
+void EliminateDeadStores::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    auto liveness = compute_register_liveness(executable);
+    auto& basic_blocks = executable.executable.basic_blocks;
+
+    // The replaced blocks have to stay alive until nothing refers to them anymore.
+    NonnullOwnPtrVector<BasicBlock> old_blocks;
+    Vector<BasicBlock const*> new_blocks;
+    for (size_t i = 0; i < basic_blocks.size(); ++i) {
+        auto new_block = eliminate_dead_stores(basic_blocks[i], liveness, executable.executable.number_of_registers);
+        if (!new_block)
+            continue;
+        new_blocks.append(new_block.ptr());
+        old_blocks.append(exchange(basic_blocks.ptr_at(i), new_block.release_nonnull()));
+    }
+
+    // Only terminators refer to other blocks.
+    for (auto& block : basic_blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            auto& instruction = const_cast<Instruction&>(*it);
+            if (!instruction.is_terminator())
+                continue;
+            for (size_t i = 0; i < old_blocks.size(); ++i)
+                instruction.replace_references(old_blocks[i], *new_blocks[i]);
+        }
+    }
+
+    finished();
+}
+
+}
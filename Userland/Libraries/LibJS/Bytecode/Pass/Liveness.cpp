@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/Pass/Liveness.h>
+
+namespace JS::Bytecode::Passes {
+
+static Bitmap create_register_set(size_t number_of_registers)
+{
+    return Bitmap::create(number_of_registers, false).release_value_but_fixme_should_propagate_errors();
+}
+
+// Returns whether anything was added to `destination`.
+static bool merge_into(Bitmap& destination, Bitmap const& source)
+{
+    bool changed = false;
+    for (size_t i = 0; i < destination.size_in_bytes(); ++i) {
+        u8 merged = destination.data()[i] | source.view().data()[i];
+        changed |= merged != destination.data()[i];
+        destination.data()[i] = merged;
+    }
+    return changed;
+}
+
+template<typename Callback>
+static void visit_tracked_registers(Instruction const& instruction, Callback callback)
+{
+    const_cast<Instruction&>(instruction).visit_registers([&](Register& reg, RegisterAccess access) {
+        if (reg.index() >= first_tracked_register)
+            callback(reg.index(), access);
+    });
+}
+
+void update_liveness_backwards(Instruction const& instruction, Bitmap& live)
+{
+    // Kill written registers before marking the read ones live, an instruction that reads
+    // and writes the same register needs it to be live before it.
+    visit_tracked_registers(instruction, [&](u32 index, RegisterAccess access) {
+        if (access == RegisterAccess::Write)
+            live.set(index, false);
+    });
+    visit_tracked_registers(instruction, [&](u32 index, RegisterAccess access) {
+        if (access != RegisterAccess::Write)
+            live.set(index, true);
+    });
+}
+
+RegisterLiveness compute_register_liveness(PassPipelineExecutable const& executable)
+{
+    VERIFY(executable.cfg.has_value());
+
+    auto const& basic_blocks = executable.executable.basic_blocks;
+    auto number_of_registers = executable.executable.number_of_registers;
+
+    // Registers read before being written in a block, and registers written anywhere in it.
+    HashMap<BasicBlock const*, Bitmap> read_first;
+    HashMap<BasicBlock const*, Bitmap> written;
+
+    RegisterLiveness liveness;
+    liveness.pinned = create_register_set(number_of_registers);
+
+    for (auto const& block : basic_blocks) {
+        Vector<Instruction const*> instructions;
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it)
+            instructions.append(&*it);
+
+        auto block_read_first = create_register_set(number_of_registers);
+        auto block_written = create_register_set(number_of_registers);
+        for (size_t i = instructions.size(); i > 0; --i) {
+            auto const& instruction = *instructions[i - 1];
+            update_liveness_backwards(instruction, block_read_first);
+            visit_tracked_registers(instruction, [&](u32 index, RegisterAccess access) {
+                if (access != RegisterAccess::Read)
+                    block_written.set(index, true);
+            });
+        }
+
+        read_first.set(&block, move(block_read_first));
+        written.set(&block, move(block_written));
+        liveness.live_in.set(&block, create_register_set(number_of_registers));
+        liveness.live_out.set(&block, create_register_set(number_of_registers));
+    }
+
+    // Blocks are mostly placed in execution order, so walking them backwards converges quickly.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = basic_blocks.size(); i > 0; --i) {
+            auto const* block = &basic_blocks[i - 1];
+            auto& live_out = liveness.live_out.find(block)->value;
+            auto& live_in = liveness.live_in.find(block)->value;
+
+            if (auto successors = executable.cfg->find(block); successors != executable.cfg->end()) {
+                for (auto const* successor : successors->value)
+                    merge_into(live_out, liveness.live_in.find(successor)->value);
+            }
+
+            auto const& block_read_first = read_first.find(block)->value;
+            auto const& block_written = written.find(block)->value;
+            for (size_t byte = 0; byte < live_in.size_in_bytes(); ++byte) {
+                u8 new_live_in = block_read_first.view().data()[byte] | (live_out.data()[byte] & ~block_written.view().data()[byte]);
+                changed |= new_live_in != live_in.data()[byte];
+                live_in.data()[byte] = new_live_in;
+            }
+        }
+    }
+
+    merge_into(liveness.pinned, liveness.live_in.find(&basic_blocks.first())->value);
+    for (auto const& block : basic_blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            if ((*it).type() != Instruction::Type::EnterUnwindContext)
+                continue;
+            auto const& enter_unwind_context = static_cast<Op::EnterUnwindContext const&>(*it);
+            if (auto const& handler = enter_unwind_context.handler_target(); handler.has_value())
+                merge_into(liveness.pinned, liveness.live_in.find(&handler->block())->value);
+            if (auto const& finalizer = enter_unwind_context.finalizer_target(); finalizer.has_value())
+                merge_into(liveness.pinned, liveness.live_in.find(&finalizer->block())->value);
+        }
+    }
+
+    return liveness;
+}
+
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Bitmap.h>
+#include <AK/HashMap.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// The accumulator and the register the generator reserves after it are used implicitly,
+// the liveness analysis only tracks the registers handed out by Generator::allocate_register().
+static constexpr u32 first_tracked_register = 2;
+
+struct RegisterLiveness {
+    HashMap<BasicBlock const*, Bitmap> live_in;
+    HashMap<BasicBlock const*, Bitmap> live_out;
+
+    // Registers that may be read on paths the CFG has no edges for. Exception handlers and
+    // finalizers can be entered from anywhere inside their try block, and a register that is
+    // read before it is written observes the empty value it was created with.
+    // Their stores have to stay, and they can't share a slot with any other register.
+    Bitmap pinned;
+};
+
+// Needs an up to date CFG.
+RegisterLiveness compute_register_liveness(PassPipelineExecutable const&);
+
+// Turns the set of registers live after the instruction into the set live before it.
+void update_liveness_backwards(Instruction const&, Bitmap& live);
+
+}
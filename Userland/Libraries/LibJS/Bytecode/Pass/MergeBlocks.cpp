@@ -8,6 +8,16 @@
 
 namespace JS::Bytecode::Passes {
 
+// Blocks created by earlier passes (including this one) don't know their terminator, so look for it.
+static Instruction const* find_terminator(BasicBlock const& block)
+{
+    for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+        if ((*it).is_terminator())
+            return &*it;
+    }
+    return nullptr;
+}
+
 void MergeBlocks::perform(PassPipelineExecutable& executable)
 {
     started();
@@ -30,7 +40,8 @@ void MergeBlocks::perform(PassPipelineExecutable& executable)
         if (executable.exported_blocks->contains(*entry.value.begin()))
             continue;
 
-        if (entry.key->terminator()->type() != Instruction::Type::Jump)
+        auto const* terminator = find_terminator(*entry.key);
+        if (!terminator || terminator->type() != Instruction::Type::Jump)
             continue;
 
         {
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/QuickSort.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/Pass/Liveness.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// Linear scan over the blocks in placement order. Each register gets the interval from the first
+// to the last position it is live or referenced at, registers with disjoint intervals can share a slot.
+void AllocateRegisters::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    auto liveness = compute_register_liveness(executable);
+    auto& basic_blocks = executable.executable.basic_blocks;
+    auto number_of_registers = executable.executable.number_of_registers;
+
+    Vector<size_t> interval_start;
+    Vector<size_t> interval_end;
+    interval_start.ensure_capacity(number_of_registers);
+    interval_end.ensure_capacity(number_of_registers);
+    for (size_t i = 0; i < number_of_registers; ++i) {
+        interval_start.unchecked_append(NumericLimits<size_t>::max());
+        interval_end.unchecked_append(0);
+    }
+
+    auto extend_interval = [&](u32 index, size_t position) {
+        interval_start[index] = min(interval_start[index], position);
+        interval_end[index] = max(interval_end[index], position);
+    };
+    auto extend_intervals = [&](Bitmap const& live, size_t position) {
+        for (u32 index = first_tracked_register; index < number_of_registers; ++index) {
+            if (live.get(index))
+                extend_interval(index, position);
+        }
+    };
+
+    // Besides the pinned registers, NewArray elements have to stay consecutive and in order,
+    // so they keep a slot of their own as well.
+    auto exclusive = Bitmap::create(number_of_registers, false).release_value_but_fixme_should_propagate_errors();
+    __builtin_memcpy(exclusive.data(), liveness.pinned.view().data(), exclusive.size_in_bytes());
+
+    size_t position = 0;
+    for (auto const& block : basic_blocks) {
+        extend_intervals(liveness.live_in.find(&block)->value, ++position);
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            auto& instruction = const_cast<Instruction&>(*it);
+            ++position;
+            if (instruction.type() == Instruction::Type::NewArray) {
+                auto const& new_array = static_cast<Op::NewArray const&>(instruction);
+                if (new_array.element_count())
+                    exclusive.set_range<true, false>(new_array.start().index(), new_array.element_count());
+            }
+            instruction.visit_registers([&](Register& reg, RegisterAccess) {
+                if (reg.index() >= first_tracked_register)
+                    extend_interval(reg.index(), position);
+            });
+        }
+        extend_intervals(liveness.live_out.find(&block)->value, ++position);
+    }
+
+    Vector<u32> new_index;
+    new_index.resize(number_of_registers);
+    for (u32 index = 0; index < first_tracked_register; ++index)
+        new_index[index] = index;
+
+    u32 next_register = first_tracked_register;
+    Vector<u32> shareable_registers;
+    for (u32 index = first_tracked_register; index < number_of_registers; ++index) {
+        if (interval_start[index] == NumericLimits<size_t>::max())
+            continue;
+        if (exclusive.get(index))
+            new_index[index] = next_register++;
+        else
+            shareable_registers.append(index);
+    }
+
+    quick_sort(shareable_registers, [&](u32 a, u32 b) { return interval_start[a] < interval_start[b]; });
+
+    struct ActiveRegister {
+        size_t interval_end;
+        u32 slot;
+    };
+    Vector<ActiveRegister> active_registers;
+    Vector<u32> free_slots;
+    for (auto index : shareable_registers) {
+        active_registers.remove_all_matching([&](auto const& active) {
+            if (active.interval_end >= interval_start[index])
+                return false;
+            free_slots.append(active.slot);
+            return true;
+        });
+        auto slot = free_slots.is_empty() ? next_register++ : free_slots.take_last();
+        new_index[index] = slot;
+        active_registers.append({ interval_end[index], slot });
+    }
+
+    for (auto& block : basic_blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            const_cast<Instruction&>(*it).visit_registers([&](Register& reg, RegisterAccess) {
+                reg = Register { new_index[reg.index()] };
+            });
+        }
+    }
+
+    executable.executable.number_of_registers = next_register;
+
+    finished();
+}
+
+}
@@ -145,6 +145,28 @@ private:
     virtual void perform(PassPipelineExecutable&) override;
 };
 
+// Removes Stores to registers that are not read afterwards. Replaces the blocks it changes,
+// so the CFG has to be regenerated after it.
+class EliminateDeadStores : public Pass {
+public:
+    EliminateDeadStores() = default;
+    virtual ~EliminateDeadStores() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Renumbers registers so that registers that are never live at the same time share a slot,
+// and shrinks the executable's register count accordingly.
+class AllocateRegisters : public Pass {
+public:
+    AllocateRegisters() = default;
+    virtual ~AllocateRegisters() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
 }
 
 }
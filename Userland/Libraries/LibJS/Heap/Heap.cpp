@@ -96,7 +96,10 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
     perf_event(PERF_EVENT_SIGNPOST, gc_perf_string_id, global_gc_counter++);
 #endif
 
-    auto collection_measurement_timer = Core::ElapsedTimer::start_new();
+    Core::ElapsedTimer collection_measurement_timer(true);
+    collection_measurement_timer.start();
+    // NOTE: ElapsedTimer only counts whole milliseconds, which most pauses don't even last.
+    auto collection_start_time = Time::now_monotonic();
     if (collection_type == CollectionType::CollectGarbage) {
         if (m_gc_deferrals) {
             m_should_gc_when_deferral_ends = true;
@@ -108,6 +111,20 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
     }
     finalize_unmarked_cells();
     sweep_dead_cells(print_report, collection_measurement_timer);
+    record_pause(Time::now_monotonic() - collection_start_time);
+}
+
+void Heap::record_pause(Time pause)
+{
+    ++m_statistics.collection_count;
+    m_statistics.total_pause_time += pause;
+    m_statistics.longest_pause_time = max(m_statistics.longest_pause_time, pause);
+
+    auto pause_ms = pause.to_milliseconds();
+    size_t bucket = 0;
+    while (bucket < Statistics::pause_histogram_bucket_count - 1 && pause_ms >= (1ll << bucket))
+        ++bucket;
+    ++m_statistics.pause_histogram[bucket];
 }
 
 void Heap::gather_roots(HashTable<Cell*>& roots)
@@ -214,8 +231,19 @@ public:
         dbgln_if(HEAP_DEBUG, "  ! {}", &cell);
 
         cell.set_marked(true);
-        cell.visit_edges(*this);
+        m_work_queue.append(&cell);
+    }
+
+    // NOTE: Edges are visited from an explicit work queue rather than recursively,
+    //       so long chains of cells can't run us out of stack.
+    void mark_all_live_cells()
+    {
+        while (!m_work_queue.is_empty())
+            m_work_queue.take_last()->visit_edges(*this);
     }
+
+private:
+    Vector<Cell*> m_work_queue;
 };
 
 void Heap::mark_live_cells(HashTable<Cell*> const& roots)
@@ -225,6 +253,7 @@ void Heap::mark_live_cells(HashTable<Cell*> const& roots)
     MarkingVisitor visitor;
     for (auto* root : roots)
         visitor.visit(root);
+    visitor.mark_all_live_cells();
 
     for (auto& inverse_root : m_uprooted_cells)
         inverse_root->set_marked(false);
@@ -304,6 +333,10 @@ void Heap::sweep_dead_cells(bool print_report, Core::ElapsedTimer const& measure
         });
     }
 
+    m_statistics.collected_bytes += collected_cell_bytes;
+    m_statistics.surviving_bytes += live_cell_bytes;
+    m_statistics.live_bytes_after_last_collection = live_cell_bytes;
+
     int time_spent = measurement_timer.elapsed();
 
     if (print_report) {
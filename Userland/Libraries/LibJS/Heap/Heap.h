@@ -6,11 +6,13 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/Badge.h>
 #include <AK/HashTable.h>
 #include <AK/IntrusiveList.h>
 #include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/Time.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCore/Forward.h>
@@ -57,6 +59,23 @@ public:
 
     void collect_garbage(CollectionType = CollectionType::CollectGarbage, bool print_report = false);
 
+    struct Statistics {
+        // Pauses are bucketed by powers of two: < 1 ms, < 2 ms, < 4 ms, ..., and everything longer than that.
+        static constexpr size_t pause_histogram_bucket_count = 10;
+
+        size_t collection_count { 0 };
+        Time total_pause_time;
+        Time longest_pause_time;
+        AK::Array<size_t, pause_histogram_bucket_count> pause_histogram {};
+
+        u64 collected_bytes { 0 };
+        // NOTE: There is only one generation, so this is the sum of the live bytes left behind by every collection.
+        u64 surviving_bytes { 0 };
+        u64 live_bytes_after_last_collection { 0 };
+    };
+
+    Statistics const& statistics() const { return m_statistics; }
+
     VM& vm() { return m_vm; }
 
     bool should_collect_on_every_allocation() const { return m_should_collect_on_every_allocation; }
@@ -88,6 +107,7 @@ private:
     void mark_live_cells(HashTable<Cell*> const& live_cells);
     void finalize_unmarked_cells();
     void sweep_dead_cells(bool print_report, Core::ElapsedTimer const&);
+    void record_pause(Time);
 
     CellAllocator& allocator_for_size(size_t);
 
@@ -121,6 +141,8 @@ private:
     bool m_should_gc_when_deferral_ends { false };
 
     bool m_collecting_garbage { false };
+
+    Statistics m_statistics;
 };
 
 }
@@ -706,6 +706,8 @@ ThrowCompletionOr<Value> perform_eval(VM& vm, Value x, CallerMode strict_caller,
 
         auto executable = executable_result.release_value();
         executable->name = "eval"sv;
+        auto optimization_level = Bytecode::Interpreter::optimizations_enabled() ? Bytecode::Interpreter::OptimizationLevel::Optimize : Bytecode::Interpreter::OptimizationLevel::Default;
+        Bytecode::Interpreter::optimization_pipeline(optimization_level).perform(*executable);
         if (Bytecode::g_dump_bytecode)
             executable->dump();
         auto result_or_error = bytecode_interpreter->run_and_return_frame(*executable, nullptr);
@@ -14,6 +14,7 @@ ArgumentsObject::ArgumentsObject(Realm& realm, Environment& environment)
     : Object(ConstructWithPrototypeTag::Tag, *realm.intrinsics().object_prototype())
     , m_environment(environment)
 {
+    set_may_interfere_with_property_lookup_cache();
 }
 
 void ArgumentsObject::initialize(Realm& realm)
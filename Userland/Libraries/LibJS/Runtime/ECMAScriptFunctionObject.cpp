@@ -819,7 +819,8 @@ Completion ECMAScriptFunctionObject::ordinary_call_evaluate_body()
 
                 auto bytecode_executable = executable_result.release_value();
                 bytecode_executable->name = name;
-                auto& passes = Bytecode::Interpreter::optimization_pipeline();
+                auto optimization_level = Bytecode::Interpreter::optimizations_enabled() ? Bytecode::Interpreter::OptimizationLevel::Optimize : Bytecode::Interpreter::OptimizationLevel::Default;
+                auto& passes = Bytecode::Interpreter::optimization_pipeline(optimization_level);
                 passes.perform(*bytecode_executable);
                 if constexpr (JS_BYTECODE_DEBUG) {
                     dbgln("Optimisation passes took {}us", passes.elapsed());
@@ -172,9 +172,14 @@ public:
     bool has_parameter_map() const { return m_has_parameter_map; }
     void set_has_parameter_map() { m_has_parameter_map = true; }
 
+    // Objects with exotic [[Get]] or [[Set]] behavior must not have their own properties served from the bytecode property lookup caches.
+    bool may_interfere_with_property_lookup_cache() const { return m_may_interfere_with_property_lookup_cache; }
+    void set_may_interfere_with_property_lookup_cache() { m_may_interfere_with_property_lookup_cache = true; }
+
     virtual void visit_edges(Cell::Visitor&) override;
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value) { m_storage[index] = value; }
 
     IndexedProperties const& indexed_properties() const { return m_indexed_properties; }
     IndexedProperties& indexed_properties() { return m_indexed_properties; }
@@ -207,6 +212,8 @@ protected:
     // [[ParameterMap]]
     bool m_has_parameter_map { false };
 
+    bool m_may_interfere_with_property_lookup_cache { false };
+
 private:
     void set_shape(Shape& shape) { m_shape = &shape; }
 
@@ -68,6 +68,10 @@ public:
     HashMap<StringOrSymbol, PropertyMetadata> const& property_table() const;
     u32 property_count() const { return m_property_count; }
 
+    // Bumped whenever the shape is changed in place instead of through a transition (i.e. unique shapes),
+    // so anything caching by Shape* can tell that the properties or prototype have moved since.
+    u32 serial_number() const { return m_serial_number; }
+
     struct Property {
         StringOrSymbol key;
         PropertyMetadata value;
@@ -75,7 +79,11 @@ public:
 
     Vector<Property> property_table_ordered() const;
 
-    void set_prototype_without_transition(Object* new_prototype) { m_prototype = new_prototype; }
+    void set_prototype_without_transition(Object* new_prototype)
+    {
+        m_prototype = new_prototype;
+        ++m_serial_number;
+    }
 
     void remove_property_from_unique_shape(StringOrSymbol const&, size_t offset);
     void add_property_to_unique_shape(StringOrSymbol const&, PropertyAttributes attributes);
@@ -103,6 +111,7 @@ private:
     StringOrSymbol m_property_key;
     Object* m_prototype { nullptr };
     u32 m_property_count { 0 };
+    u32 m_serial_number { 0 };
 
     PropertyAttributes m_attributes { 0 };
     TransitionType m_transition_type : 6 { TransitionType::Invalid };
@@ -0,0 +1,116 @@
+// The same property access is repeated on objects whose layout changes in between,
+// each access has to see the current state of the object.
+
+describe("get", () => {
+    test("objects with different shapes", () => {
+        const get = o => o.foo;
+        const objects = [{ foo: 1 }, { bar: 0, foo: 2 }, { baz: 0, bar: 0, foo: 3 }, { foo: 4, a: 0 }, { b: 0, foo: 5 }];
+        for (let i = 0; i < 3; ++i) {
+            objects.forEach((object, index) => {
+                expect(get(object)).toBe(index + 1);
+            });
+        }
+        expect(get({})).toBeUndefined();
+    });
+
+    test("property shadows prototype property", () => {
+        const get = o => o.foo;
+        const prototype = { foo: "prototype" };
+        const o = Object.create(prototype);
+        expect(get(o)).toBe("prototype");
+        o.foo = "own";
+        expect(get(o)).toBe("own");
+        delete o.foo;
+        expect(get(o)).toBe("prototype");
+    });
+
+    test("prototype property changes", () => {
+        const get = o => o.foo;
+        const prototype = { foo: 1 };
+        const o = Object.create(prototype);
+        expect(get(o)).toBe(1);
+        prototype.foo = 2;
+        expect(get(o)).toBe(2);
+        delete prototype.foo;
+        expect(get(o)).toBeUndefined();
+    });
+
+    test("prototype changes", () => {
+        const get = o => o.foo;
+        const o = Object.create({ foo: 1 });
+        expect(get(o)).toBe(1);
+        Object.setPrototypeOf(o, { foo: 2 });
+        expect(get(o)).toBe(2);
+        Object.setPrototypeOf(o, null);
+        expect(get(o)).toBeUndefined();
+    });
+
+    test("data property becomes accessor", () => {
+        const get = o => o.foo;
+        const o = { foo: 1 };
+        expect(get(o)).toBe(1);
+        Object.defineProperty(o, "foo", {
+            get() {
+                return 2;
+            },
+        });
+        expect(get(o)).toBe(2);
+    });
+
+    test("properties are deleted from object with many properties", () => {
+        const get = o => o.foo;
+        const o = {};
+        for (let i = 0; i < 200; ++i) o[`p${i}`] = i;
+        o.foo = "foo";
+        expect(get(o)).toBe("foo");
+        delete o.p0;
+        expect(get(o)).toBe("foo");
+        delete o.foo;
+        expect(get(o)).toBeUndefined();
+    });
+});
+
+describe("put", () => {
+    test("object becomes frozen", () => {
+        const put = (o, value) => {
+            o.foo = value;
+        };
+        const o = { foo: 1 };
+        put(o, 2);
+        expect(o.foo).toBe(2);
+        Object.freeze(o);
+        put(o, 3);
+        expect(o.foo).toBe(2);
+    });
+
+    test("data property becomes accessor", () => {
+        let setterValue;
+        const put = (o, value) => {
+            o.foo = value;
+        };
+        const o = { foo: 1 };
+        put(o, 2);
+        expect(o.foo).toBe(2);
+        Object.defineProperty(o, "foo", {
+            set(value) {
+                setterValue = value;
+            },
+        });
+        put(o, 3);
+        expect(setterValue).toBe(3);
+    });
+
+    test("objects with different shapes", () => {
+        const put = (o, value) => {
+            o.foo = value;
+        };
+        const objects = [{ foo: 0 }, { bar: 0, foo: 0 }, { baz: 0, foo: 0 }, {}, Object.create({ foo: 0 })];
+        for (let i = 0; i < 3; ++i) {
+            objects.forEach((object, index) => {
+                put(object, index + i);
+                expect(object.foo).toBe(index + i);
+            });
+        }
+        expect(Object.getPrototypeOf(objects[4]).foo).toBe(0);
+    });
+});
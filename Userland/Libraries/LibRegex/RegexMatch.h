@@ -204,6 +204,11 @@ public:
         return m_view.get<Utf8View>();
     }
 
+    bool is_string_view() const { return m_view.has<StringView>(); }
+    bool is_u32_view() const { return m_view.has<Utf32View>(); }
+    bool is_u16_view() const { return m_view.has<Utf16View>(); }
+    bool is_u8_view() const { return m_view.has<Utf8View>(); }
+
     bool unicode() const { return m_unicode; }
     void set_unicode(bool unicode) { m_unicode = unicode; }
 
@@ -7,6 +7,7 @@
 #include <AK/BumpAllocator.h>
 #include <AK/Debug.h>
 #include <AK/DeprecatedString.h>
+#include <AK/MemMem.h>
 #include <AK/StringBuilder.h>
 #include <LibRegex/RegexMatcher.h>
 #include <LibRegex/RegexParser.h>
@@ -60,6 +61,8 @@ Regex<Parser>::Regex(Regex&& regex)
     , parser_result(move(regex.parser_result))
     , matcher(move(regex.matcher))
     , start_offset(regex.start_offset)
+    , pike_vm(move(regex.pike_vm))
+    , literal_prefix(move(regex.literal_prefix))
 {
     if (matcher)
         matcher->reset_pattern({}, this);
@@ -74,6 +77,8 @@ Regex<Parser>& Regex<Parser>::operator=(Regex&& regex)
     if (matcher)
         matcher->reset_pattern({}, this);
     start_offset = regex.start_offset;
+    pike_vm = move(regex.pike_vm);
+    literal_prefix = move(regex.literal_prefix);
     return *this;
 }
 
@@ -99,6 +104,42 @@ DeprecatedString Regex<Parser>::error_string(Optional<DeprecatedString> message)
     return eb.build();
 }
 
+// Returns the first position at or after start_position where the view contains the given prefix.
+static Optional<size_t> find_literal_prefix(RegexStringView const& view, Span<u32 const> prefix, size_t start_position)
+{
+    auto find_in = [&](auto const* code_units, size_t length) -> Optional<size_t> {
+        if (prefix.size() > length)
+            return {};
+        for (size_t position = start_position; position <= length - prefix.size(); ++position) {
+            if (code_units[position] != prefix[0])
+                continue;
+            size_t i = 1;
+            while (i < prefix.size() && code_units[position + i] == prefix[i])
+                ++i;
+            if (i == prefix.size())
+                return position;
+        }
+        return {};
+    };
+
+    if (view.is_u32_view())
+        return find_in(view.u32_view().code_points(), view.u32_view().length());
+    if (view.is_u16_view())
+        return find_in(view.u16_view().data(), view.u16_view().length_in_code_units());
+
+    auto bytes = view.is_u8_view() ? view.u8_view().as_string() : view.string_view();
+    if (start_position > bytes.length())
+        return {};
+
+    Vector<u8, 16> needle;
+    for (auto ch : prefix)
+        needle.append(ch);
+    auto offset = AK::memmem_optional(bytes.characters_without_null_termination() + start_position, bytes.length() - start_position, needle.data(), needle.size());
+    if (!offset.has_value())
+        return {};
+    return start_position + *offset;
+}
+
 template<typename Parser>
 RegexResult Matcher<Parser>::match(RegexStringView view, Optional<typename ParserTraits<Parser>::OptionsType> regex_options) const
 {
@@ -185,6 +226,13 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
 
     auto single_match_only = input.regex_options.has_flag_set(AllFlags::SingleMatch);
 
+    // When searching, positions where a match can't start are skipped instead of being tried one by one.
+    auto& literal_prefix = m_pattern->literal_prefix;
+    auto& pike_vm = m_pattern->pike_vm;
+    auto can_skip_ahead = continue_search
+        && !input.regex_options.has_flag_set(AllFlags::MatchNotEndOfLine)
+        && !input.regex_options.has_flag_set(AllFlags::MatchNotBeginOfLine);
+
     for (auto const& view : views) {
         if (lines_to_skip != 0) {
             ++input.line;
@@ -226,7 +274,18 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             }
         }
 
+        // Positions are code units in these views, which is what the skipping below relies on.
+        auto can_skip_ahead_in_view = can_skip_ahead && !view.unicode();
+        auto can_use_literal_prefix = can_skip_ahead_in_view && !literal_prefix.is_empty() && !input.regex_options.has_flag_set(AllFlags::Insensitive);
+
         for (; view_index <= view_length; ++view_index) {
+            if (can_use_literal_prefix) {
+                auto position = find_literal_prefix(view, literal_prefix, view_index);
+                if (!position.has_value())
+                    break;
+                view_index = *position;
+            }
+
             if (view_index == view_length && input.regex_options.has_flag_set(AllFlags::Multiline))
                 break;
 
@@ -248,7 +307,21 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             state.instruction_position = 0;
             state.repetition_marks.clear();
 
-            auto success = execute(input, state, operations);
+            bool success;
+            if (pike_vm.has_value() && can_skip_ahead_in_view) {
+                // Try every remaining start position in a single pass over the input.
+                auto last_start_position = view_length - match_length_minimum;
+                if (input.regex_options.has_flag_set(AllFlags::Multiline))
+                    last_start_position = min(last_start_position, view_length - 1);
+                auto start_position = pike_vm->execute(m_pattern->parser_result.bytecode, input, state, last_start_position, operations);
+                if (!start_position.has_value())
+                    break;
+                view_index = *start_position;
+                success = true;
+            } else {
+                success = execute(input, state, operations);
+            }
+
             if (success) {
                 succeeded = true;
 
@@ -414,6 +487,9 @@ private:
 template<class Parser>
 bool Matcher<Parser>::execute(MatchInput const& input, MatchState& state, size_t& operations) const
 {
+    if (m_pattern->pike_vm.has_value())
+        return m_pattern->pike_vm->execute(m_pattern->parser_result.bytecode, input, state, state.string_position, operations).has_value();
+
     BumpAllocatedLinkedList<MatchState> states_to_try_next;
 #if REGEX_DEBUG
     size_t recursion_level = 0;
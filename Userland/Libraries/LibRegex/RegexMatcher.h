@@ -10,6 +10,7 @@
 #include "RegexMatch.h"
 #include "RegexOptions.h"
 #include "RegexParser.h"
+#include "RegexPikeVM.h"
 
 #include <AK/Forward.h>
 #include <AK/GenericLexer.h>
@@ -88,6 +89,11 @@ public:
     OwnPtr<Matcher<Parser>> matcher { nullptr };
     mutable size_t start_offset { 0 };
 
+    // Set if the bytecode can run without backtracking, see PikeVM.
+    Optional<PikeVM> pike_vm;
+    // Characters every match has to start with, used to skip ahead to the next possible match when searching.
+    Vector<u32> literal_prefix;
+
     static regex::Parser::Result parse_pattern(StringView pattern, typename ParserTraits<Parser>::OptionsType regex_options = {});
 
     explicit Regex(DeprecatedString pattern, typename ParserTraits<Parser>::OptionsType regex_options = {});
@@ -233,6 +239,7 @@ public:
 private:
     void run_optimization_passes();
     void attempt_rewrite_loops_as_atomic_groups(BasicBlockList const&);
+    void find_literal_prefix();
 };
 
 // free standing functions for match, search and has_match
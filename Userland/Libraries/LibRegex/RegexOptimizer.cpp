@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/CharacterTypes.h>
 #include <AK/QuickSort.h>
 #include <AK/RedBlackTree.h>
 #include <AK/Stack.h>
@@ -28,6 +29,60 @@ void Regex<Parser>::run_optimization_passes()
     attempt_rewrite_loops_as_atomic_groups(split_basic_blocks(parser_result.bytecode));
 
     parser_result.bytecode.flatten();
+
+    if (parser_result.error != Error::NoError)
+        return;
+
+    pike_vm = PikeVM::create(parser_result.bytecode);
+    find_literal_prefix();
+}
+
+template<typename Parser>
+void Regex<Parser>::find_literal_prefix()
+{
+    auto& bytecode = parser_result.bytecode;
+    auto bytecode_size = bytecode.size();
+
+    MatchState state;
+    while (state.instruction_position < bytecode_size) {
+        auto& opcode = bytecode.get_opcode(state);
+        switch (opcode.opcode_id()) {
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+        case OpCodeId::Checkpoint:
+            break;
+        case OpCodeId::Compare: {
+            if (static_cast<OpCode_Compare const&>(opcode).arguments_count() != 1)
+                return;
+            auto offset = state.instruction_position + 3;
+            auto compare_type = static_cast<CharacterCompareType>(bytecode.at(offset++));
+            if (compare_type == CharacterCompareType::Char) {
+                auto ch = bytecode.at(offset);
+                // Only ASCII characters look the same in every kind of view the pattern can be matched against.
+                if (!is_ascii(ch))
+                    return;
+                literal_prefix.append(ch);
+                break;
+            }
+            if (compare_type == CharacterCompareType::String) {
+                auto length = bytecode.at(offset++);
+                for (size_t i = 0; i < length; ++i) {
+                    auto ch = bytecode.at(offset + i);
+                    if (!is_ascii(ch))
+                        return;
+                    literal_prefix.append(ch);
+                }
+                break;
+            }
+            return;
+        }
+        default:
+            return;
+        }
+        state.instruction_position += opcode.size();
+    }
 }
 
 template<typename Parser>
@@ -0,0 +1,447 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashMap.h>
+#include <AK/NumericLimits.h>
+#include <LibRegex/RegexPikeVM.h>
+
+namespace regex {
+
+static constexpr size_t no_checkpoint = NumericLimits<size_t>::max();
+
+// Each capture group takes up four slots in a thread, mirroring the fields of the Match the backtracking VM keeps for it.
+enum CaptureGroupSlot {
+    LeftColumn,
+    Column,
+    Length,
+    CommittedBy, // One past the index of the instruction that saved the group, or zero if it hasn't been saved.
+};
+
+Optional<PikeVM> PikeVM::create(ByteCode const& bytecode)
+{
+    PikeVM vm;
+    HashMap<size_t, size_t> instruction_at_bytecode_position;
+    HashMap<size_t, size_t> checkpoint_at_bytecode_position;
+    size_t capture_group_count = 0;
+
+    auto bytecode_size = bytecode.size();
+    MatchState state;
+    while (state.instruction_position < bytecode_size) {
+        auto& opcode = bytecode.get_opcode(state);
+        auto position = state.instruction_position;
+        Instruction instruction { .opcode = opcode.opcode_id(), .bytecode_position = position, .next = position + opcode.size() };
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare: {
+            auto const& compare = static_cast<OpCode_Compare const&>(opcode);
+            // Backreferences depend on which path through the pattern was taken, so they can't be shared between threads.
+            for (auto& pair : compare.flat_compares()) {
+                if (pair.type == CharacterCompareType::Reference)
+                    return {};
+            }
+            if (compare.arguments_count() == 1 && static_cast<CharacterCompareType>(bytecode.at(position + 3)) == CharacterCompareType::Char) {
+                instruction.is_single_character_compare = true;
+                instruction.argument = bytecode.at(position + 4);
+            }
+            break;
+        }
+        case OpCodeId::Jump:
+            instruction.target = instruction.next + static_cast<OpCode_Jump const&>(opcode).offset();
+            break;
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump:
+            instruction.target = instruction.next + static_cast<OpCode_ForkJump const&>(opcode).offset();
+            break;
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay:
+            instruction.target = instruction.next + static_cast<OpCode_ForkStay const&>(opcode).offset();
+            break;
+        case OpCodeId::JumpNonEmpty: {
+            auto const& jump = static_cast<OpCode_JumpNonEmpty const&>(opcode);
+            instruction.target = instruction.next + jump.offset();
+            // Resolved to a checkpoint index once all of them are known.
+            instruction.argument = instruction.next + jump.checkpoint();
+            instruction.form = jump.form();
+            break;
+        }
+        case OpCodeId::Checkpoint:
+            instruction.argument = vm.m_checkpoint_count++;
+            checkpoint_at_bytecode_position.set(position, instruction.argument);
+            break;
+        case OpCodeId::SaveLeftCaptureGroup:
+            instruction.argument = static_cast<OpCode_SaveLeftCaptureGroup const&>(opcode).id();
+            capture_group_count = max(capture_group_count, instruction.argument + 1);
+            break;
+        case OpCodeId::SaveRightCaptureGroup:
+            instruction.argument = static_cast<OpCode_SaveRightCaptureGroup const&>(opcode).id();
+            capture_group_count = max(capture_group_count, instruction.argument + 1);
+            break;
+        case OpCodeId::SaveRightNamedCaptureGroup: {
+            auto const& save = static_cast<OpCode_SaveRightNamedCaptureGroup const&>(opcode);
+            instruction.argument = save.id();
+            instruction.capture_group_name = save.name();
+            capture_group_count = max(capture_group_count, instruction.argument + 1);
+            break;
+        }
+        case OpCodeId::ClearCaptureGroup:
+            instruction.argument = static_cast<OpCode_ClearCaptureGroup const&>(opcode).id();
+            capture_group_count = max(capture_group_count, instruction.argument + 1);
+            break;
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+        case OpCodeId::CheckBoundary:
+            break;
+        case OpCodeId::Save:
+        case OpCodeId::Restore:
+        case OpCodeId::GoBack:
+        case OpCodeId::FailForks:
+        case OpCodeId::Repeat:
+        case OpCodeId::ResetRepeat:
+        case OpCodeId::Exit:
+            // Lookarounds and counted repetitions keep state that would have to be part of a thread's identity.
+            return {};
+        }
+
+        instruction_at_bytecode_position.set(position, vm.m_instructions.size());
+        vm.m_instructions.append(instruction);
+        state.instruction_position = instruction.next;
+    }
+
+    // Anything at or past the end of the bytecode is where the backtracking VM exits with a match.
+    auto resolve = [&](size_t bytecode_position) -> Optional<size_t> {
+        if (bytecode_position >= bytecode_size)
+            return vm.m_instructions.size();
+        return instruction_at_bytecode_position.get(bytecode_position);
+    };
+
+    for (auto& instruction : vm.m_instructions) {
+        auto next = resolve(instruction.next);
+        if (!next.has_value())
+            return {};
+        instruction.next = *next;
+
+        switch (instruction.opcode) {
+        case OpCodeId::JumpNonEmpty:
+            instruction.argument = checkpoint_at_bytecode_position.get(instruction.argument).value_or(no_checkpoint);
+            [[fallthrough]];
+        case OpCodeId::Jump:
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump:
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay: {
+            auto target = resolve(instruction.target);
+            if (!target.has_value())
+                return {};
+            instruction.target = *target;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    vm.m_capture_group_count = capture_group_count;
+    vm.m_slot_count = capture_group_count * slots_per_capture_group + vm.m_checkpoint_count;
+    return vm;
+}
+
+Optional<size_t> PikeVM::execute(ByteCode const& bytecode, MatchInput const& input, MatchState& state, size_t last_start_position, size_t& operations) const
+{
+    auto instruction_count = m_instructions.size();
+    auto checkpoint_slots_offset = m_capture_group_count * slots_per_capture_group;
+    auto view_length = input.view.length();
+    auto is_unicode = input.view.unicode();
+    auto is_insensitive = input.regex_options.has_flag_set(AllFlags::Insensitive);
+    auto copy_matches = input.regex_options.has_flag_set(AllFlags::StringCopyMatches);
+    // Outside of these, looking at a single code unit can see a different character than Compare does.
+    auto can_compare_code_units = !is_unicode && !is_insensitive && (input.view.is_string_view() || input.view.is_u32_view());
+
+    ThreadList current;
+    ThreadList next;
+
+    // Threads that still have to be followed from the current position, lowest priority first.
+    ThreadList pending;
+    Vector<size_t> slots;
+    slots.resize(m_slot_count);
+
+    // The step in which each instruction was last reached; whoever gets there first in a step has the highest priority.
+    Vector<size_t> visited_in_step;
+    visited_in_step.resize(instruction_count);
+    size_t step = 0;
+
+    size_t position = state.string_position;
+    size_t code_unit_position = state.string_position_in_code_units;
+
+    Optional<size_t> match_start_position;
+    size_t match_end_position = 0;
+    size_t match_end_code_unit_position = 0;
+    Vector<size_t> match_slots;
+
+    MatchState scratch_state;
+    auto run_opcode = [&](Instruction const& instruction) {
+        scratch_state.string_position = position;
+        scratch_state.string_position_in_code_units = code_unit_position;
+        scratch_state.instruction_position = instruction.bytecode_position;
+        return bytecode.get_opcode(scratch_state).execute(input, scratch_state);
+    };
+
+    auto fork = [&](size_t instruction) {
+        pending.threads.append({ .instruction = instruction, .slots_offset = pending.slots.size() });
+        pending.slots.extend(slots);
+    };
+
+    // Follows a thread through everything that doesn't consume input, and returns whether it (or one of its forks) matched.
+    auto follow = [&](size_t start_instruction, size_t start_position) {
+        fork(start_instruction);
+        while (!pending.threads.is_empty()) {
+            auto thread = pending.threads.take_last();
+            for (size_t i = 0; i < m_slot_count; ++i)
+                slots[i] = pending.slots[thread.slots_offset + i];
+            pending.slots.shrink(thread.slots_offset);
+
+            auto instruction_index = thread.instruction;
+            for (;;) {
+                ++operations;
+                if (instruction_index == instruction_count) {
+                    // Everything still pending has a lower priority than this match.
+                    match_start_position = start_position;
+                    match_end_position = position;
+                    match_end_code_unit_position = code_unit_position;
+                    match_slots = slots;
+                    pending.clear();
+                    return true;
+                }
+
+                if (visited_in_step[instruction_index] == step)
+                    break;
+                visited_in_step[instruction_index] = step;
+
+                auto const& instruction = m_instructions[instruction_index];
+                bool thread_died = false;
+                switch (instruction.opcode) {
+                case OpCodeId::Compare: {
+                    size_t new_position;
+                    size_t new_code_unit_position;
+                    if (instruction.is_single_character_compare && can_compare_code_units) {
+                        if (position >= view_length || input.view[code_unit_position] != instruction.argument) {
+                            thread_died = true;
+                            break;
+                        }
+                        new_position = position + 1;
+                        new_code_unit_position = code_unit_position + 1;
+                    } else {
+                        if (run_opcode(instruction) != ExecutionResult::Continue) {
+                            thread_died = true;
+                            break;
+                        }
+                        new_position = scratch_state.string_position;
+                        new_code_unit_position = scratch_state.string_position_in_code_units;
+                    }
+
+                    if (new_position == position) {
+                        instruction_index = instruction.next;
+                        break;
+                    }
+
+                    next.threads.append({ instruction.next, new_position, new_code_unit_position, start_position, next.slots.size() });
+                    next.slots.extend(slots);
+                    thread_died = true;
+                    break;
+                }
+                case OpCodeId::Jump:
+                    instruction_index = instruction.target;
+                    break;
+                case OpCodeId::ForkJump:
+                case OpCodeId::ForkReplaceJump:
+                    fork(instruction.next);
+                    instruction_index = instruction.target;
+                    break;
+                case OpCodeId::ForkStay:
+                case OpCodeId::ForkReplaceStay:
+                    fork(instruction.target);
+                    instruction_index = instruction.next;
+                    break;
+                case OpCodeId::JumpNonEmpty: {
+                    instruction_index = instruction.next;
+                    if (instruction.argument == no_checkpoint)
+                        break;
+                    auto checkpoint = slots[checkpoint_slots_offset + instruction.argument];
+                    if (checkpoint == 0 || checkpoint - 1 == position)
+                        break;
+                    switch (instruction.form) {
+                    case OpCodeId::Jump:
+                        instruction_index = instruction.target;
+                        break;
+                    case OpCodeId::ForkJump:
+                    case OpCodeId::ForkReplaceJump:
+                        fork(instruction.next);
+                        instruction_index = instruction.target;
+                        break;
+                    case OpCodeId::ForkStay:
+                    case OpCodeId::ForkReplaceStay:
+                        fork(instruction.target);
+                        break;
+                    default:
+                        break;
+                    }
+                    break;
+                }
+                case OpCodeId::Checkpoint:
+                    slots[checkpoint_slots_offset + instruction.argument] = position + 1;
+                    instruction_index = instruction.next;
+                    break;
+                case OpCodeId::SaveLeftCaptureGroup:
+                    slots[instruction.argument * slots_per_capture_group + LeftColumn] = position;
+                    instruction_index = instruction.next;
+                    break;
+                case OpCodeId::SaveRightCaptureGroup:
+                case OpCodeId::SaveRightNamedCaptureGroup: {
+                    auto* group = slots.data() + instruction.argument * slots_per_capture_group;
+                    auto start_of_group = group[LeftColumn];
+                    if (position < start_of_group) {
+                        thread_died = true;
+                        break;
+                    }
+                    if (start_of_group >= group[Column]) {
+                        group[Column] = start_of_group;
+                        group[Length] = position - start_of_group;
+                        group[CommittedBy] = instruction_index + 1;
+                        // A Match that owns a copy of its string doesn't remember where the group was opened.
+                        if (copy_matches)
+                            group[LeftColumn] = 0;
+                    }
+                    instruction_index = instruction.next;
+                    break;
+                }
+                case OpCodeId::ClearCaptureGroup: {
+                    auto* group = slots.data() + instruction.argument * slots_per_capture_group;
+                    for (size_t i = 0; i < slots_per_capture_group; ++i)
+                        group[i] = 0;
+                    instruction_index = instruction.next;
+                    break;
+                }
+                case OpCodeId::CheckBegin:
+                case OpCodeId::CheckEnd:
+                case OpCodeId::CheckBoundary:
+                    if (run_opcode(instruction) != ExecutionResult::Continue) {
+                        thread_died = true;
+                        break;
+                    }
+                    instruction_index = instruction.next;
+                    break;
+                default:
+                    thread_died = true;
+                    break;
+                }
+
+                if (thread_died)
+                    break;
+            }
+        }
+        return false;
+    };
+
+    for (;;) {
+        ++step;
+        next.clear();
+
+        bool matched = false;
+        for (auto const& thread : current.threads) {
+            if (thread.position > position) {
+                // Still in the middle of consuming a multi-character string; keep its place in line.
+                next.threads.append({ thread.instruction, thread.position, thread.code_unit_position, thread.start_position, next.slots.size() });
+                next.slots.append(current.slots.data() + thread.slots_offset, m_slot_count);
+                continue;
+            }
+
+            for (size_t i = 0; i < m_slot_count; ++i)
+                slots[i] = current.slots[thread.slots_offset + i];
+            if (follow(thread.instruction, thread.start_position)) {
+                matched = true;
+                break;
+            }
+        }
+
+        // A match that starts here has a lower priority than every one that started before.
+        if (!matched && !match_start_position.has_value() && position <= last_start_position) {
+            slots.span().fill(0);
+            follow(0, position);
+        }
+
+        swap(current, next);
+
+        auto next_position = NumericLimits<size_t>::max();
+        size_t next_code_unit_position = 0;
+        for (auto const& thread : current.threads) {
+            if (thread.position < next_position) {
+                next_position = thread.position;
+                next_code_unit_position = thread.code_unit_position;
+            }
+        }
+        if (!match_start_position.has_value() && position < last_start_position && position + 1 < next_position) {
+            next_position = position + 1;
+            if (is_unicode)
+                next_code_unit_position = code_unit_position + input.view.length_of_code_point(input.view[code_unit_position]);
+            else
+                next_code_unit_position = code_unit_position + 1;
+        }
+
+        if (next_position == NumericLimits<size_t>::max())
+            break;
+        position = next_position;
+        code_unit_position = next_code_unit_position;
+    }
+
+    if (!match_start_position.has_value())
+        return {};
+
+    state.string_position = match_end_position;
+    state.string_position_in_code_units = match_end_code_unit_position;
+    materialize_capture_groups(input, state, match_slots);
+    return match_start_position;
+}
+
+void PikeVM::materialize_capture_groups(MatchInput const& input, MatchState& state, Span<size_t const> slots) const
+{
+    if (m_capture_group_count == 0)
+        return;
+
+    if (input.match_index >= state.capture_group_matches.size())
+        state.capture_group_matches.resize(input.match_index + 1);
+
+    auto& groups = state.capture_group_matches.at(input.match_index);
+    groups.clear_with_capacity();
+    groups.resize(m_capture_group_count);
+
+    for (size_t id = 0; id < m_capture_group_count; ++id) {
+        auto const* group = slots.data() + id * slots_per_capture_group;
+        if (group[CommittedBy] == 0) {
+            groups[id].left_column = group[LeftColumn];
+            continue;
+        }
+
+        auto start_position = group[Column];
+        auto view = input.view.substring_view(start_position, group[Length]);
+        auto name = m_instructions[group[CommittedBy] - 1].capture_group_name;
+        auto& match = groups[id];
+
+        // This builds the same Match as OpCode_SaveRight(Named)CaptureGroup would have.
+        if (name.is_null()) {
+            if (input.regex_options & AllFlags::StringCopyMatches)
+                match = { view.to_deprecated_string(), input.line, start_position, input.global_offset + start_position };
+            else
+                match = { view, input.line, start_position, input.global_offset + start_position };
+        } else {
+            if (input.regex_options & AllFlags::StringCopyMatches)
+                match = { view.to_deprecated_string(), name, input.line, start_position, input.global_offset + start_position };
+            else
+                match = { view, name, input.line, start_position, input.global_offset + start_position };
+        }
+        match.left_column = group[LeftColumn];
+    }
+}
+
+}
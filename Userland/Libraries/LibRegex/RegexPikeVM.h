@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "RegexByteCode.h"
+#include "RegexMatch.h"
+
+#include <AK/Optional.h>
+#include <AK/StringView.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace regex {
+
+// Runs bytecode that doesn't need backtracking (no backreferences, lookarounds or counted repetitions) as a Pike VM:
+// all alternatives are advanced through the input in lockstep, in the order the backtracking VM would try them in,
+// and only the highest priority one of those that reach the same instruction at the same position is kept.
+// This finds the same match as Matcher::execute(), but in time linear in the length of the input.
+class PikeVM {
+public:
+    static Optional<PikeVM> create(ByteCode const&);
+
+    // Looks for a match starting anywhere from state.string_position up to (and including) last_start_position,
+    // and returns the start position of the first one, just as trying each of those positions in turn with the
+    // backtracking VM would. On success, the state holds the end position and capture groups of the match.
+    Optional<size_t> execute(ByteCode const&, MatchInput const&, MatchState&, size_t last_start_position, size_t& operations) const;
+
+private:
+    struct Instruction {
+        OpCodeId opcode;
+        size_t bytecode_position { 0 };
+        size_t next { 0 };
+        size_t target { 0 };
+        // Capture group id, checkpoint index, or the character a single character Compare matches.
+        size_t argument { 0 };
+        OpCodeId form { OpCodeId::Jump };
+        bool is_single_character_compare { false };
+        StringView capture_group_name {};
+    };
+
+    struct Thread {
+        size_t instruction { 0 };
+        size_t position { 0 };
+        size_t code_unit_position { 0 };
+        size_t start_position { 0 };
+        size_t slots_offset { 0 };
+    };
+
+    struct ThreadList {
+        Vector<Thread> threads;
+        Vector<size_t> slots;
+
+        void clear()
+        {
+            threads.clear_with_capacity();
+            slots.clear_with_capacity();
+        }
+    };
+
+    PikeVM() = default;
+
+    void materialize_capture_groups(MatchInput const&, MatchState&, Span<size_t const> slots) const;
+
+    static constexpr size_t slots_per_capture_group = 4;
+
+    Vector<Instruction> m_instructions;
+    size_t m_capture_group_count { 0 };
+    size_t m_checkpoint_count { 0 };
+    size_t m_slot_count { 0 };
+};
+
+}
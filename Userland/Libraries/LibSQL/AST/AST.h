@@ -9,6 +9,7 @@
 #pragma once
 
 #include <AK/DeprecatedString.h>
+#include <AK/NonnullOwnPtr.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/RefCounted.h>
@@ -1066,6 +1067,7 @@ public:
     RefPtr<GroupByClause> const& group_by_clause() const { return m_group_by_clause; }
     NonnullRefPtrVector<OrderingTerm> const& ordering_term_list() const { return m_ordering_term_list; }
     RefPtr<LimitClause> const& limit_clause() const { return m_limit_clause; }
+    ResultOr<NonnullOwnPtr<QueryOperator>> create_plan(ExecutionContext&) const;
     ResultOr<ResultSet> execute(ExecutionContext&) const override;
 
 private:
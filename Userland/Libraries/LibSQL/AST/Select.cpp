@@ -5,16 +5,127 @@
  */
 
 #include <AK/NumericLimits.h>
+#include <AK/TypeCasts.h>
 #include <LibSQL/AST/AST.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Meta.h>
+#include <LibSQL/QueryPlan.h>
 #include <LibSQL/Row.h>
 
 namespace SQL::AST {
 
-ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
+// Splits a WHERE clause into the terms that are AND-ed together, so each of them can be applied as early as possible.
+static void split_conjunction(NonnullRefPtr<Expression> const& expression, Vector<NonnullRefPtr<Expression>>& conjuncts)
+{
+    if (is<BinaryOperatorExpression>(*expression)) {
+        auto const& binary_expression = static_cast<BinaryOperatorExpression const&>(*expression);
+        if (binary_expression.type() == BinaryOperator::And) {
+            split_conjunction(binary_expression.lhs(), conjuncts);
+            split_conjunction(binary_expression.rhs(), conjuncts);
+            return;
+        }
+    }
+
+    // A parenthesized expression is a chain of one expression.
+    if (is<ChainedExpression>(*expression)) {
+        auto const& chained_expression = static_cast<ChainedExpression const&>(*expression);
+        if (chained_expression.expressions().size() == 1) {
+            split_conjunction(chained_expression.expressions().ptr_at(0), conjuncts);
+            return;
+        }
+    }
+
+    conjuncts.append(expression);
+}
+
+// Collects the columns an expression refers to. Returns false if the expression may depend on
+// more than the current row, or contains something we don't know how to look into.
+static bool collect_column_references(Expression const& expression, Vector<ColumnNameExpression const*>& columns)
+{
+    if (is<ColumnNameExpression>(expression)) {
+        columns.append(&static_cast<ColumnNameExpression const&>(expression));
+        return true;
+    }
+
+    if (is<NumericLiteral>(expression) || is<StringLiteral>(expression) || is<BlobLiteral>(expression) || is<NullLiteral>(expression) || is<Placeholder>(expression))
+        return true;
+
+    if (is<ExistsExpression>(expression) || is<InSelectionExpression>(expression) || is<InTableExpression>(expression))
+        return false;
+
+    if (is<BetweenExpression>(expression)) {
+        auto const& between_expression = static_cast<BetweenExpression const&>(expression);
+        return collect_column_references(*between_expression.expression(), columns)
+            && collect_column_references(*between_expression.lhs(), columns)
+            && collect_column_references(*between_expression.rhs(), columns);
+    }
+
+    if (is<MatchExpression>(expression)) {
+        auto const& match_expression = static_cast<MatchExpression const&>(expression);
+        if (match_expression.escape() && !collect_column_references(*match_expression.escape(), columns))
+            return false;
+        return collect_column_references(*match_expression.lhs(), columns)
+            && collect_column_references(*match_expression.rhs(), columns);
+    }
+
+    if (is<InChainedExpression>(expression)) {
+        auto const& in_chained_expression = static_cast<InChainedExpression const&>(expression);
+        return collect_column_references(*in_chained_expression.expression(), columns)
+            && collect_column_references(*in_chained_expression.expression_chain(), columns);
+    }
+
+    if (is<NestedDoubleExpression>(expression)) {
+        auto const& nested_expression = static_cast<NestedDoubleExpression const&>(expression);
+        return collect_column_references(*nested_expression.lhs(), columns)
+            && collect_column_references(*nested_expression.rhs(), columns);
+    }
+
+    if (is<NestedExpression>(expression))
+        return collect_column_references(*static_cast<NestedExpression const&>(expression).expression(), columns);
+
+    if (is<ChainedExpression>(expression)) {
+        for (auto const& chained : static_cast<ChainedExpression const&>(expression).expressions()) {
+            if (!collect_column_references(chained, columns))
+                return false;
+        }
+        return true;
+    }
+
+    if (is<CaseExpression>(expression)) {
+        auto const& case_expression = static_cast<CaseExpression const&>(expression);
+        if (case_expression.case_expression() && !collect_column_references(*case_expression.case_expression(), columns))
+            return false;
+        for (auto const& clause : case_expression.when_then_clauses()) {
+            if (!collect_column_references(*clause.when, columns) || !collect_column_references(*clause.then, columns))
+                return false;
+        }
+        return !case_expression.else_expression() || collect_column_references(*case_expression.else_expression(), columns);
+    }
+
+    return false;
+}
+
+// Finds the column a column name refers to the same way ColumnNameExpression::evaluate does, but only
+// succeeds if that's unambiguous. Anything else is left for evaluation to report.
+static Optional<size_t> resolve_column(TupleDescriptor const& descriptor, ColumnNameExpression const& column)
+{
+    Optional<size_t> index;
+    for (size_t i = 0; i < descriptor.size(); ++i) {
+        if (!column.table_name().is_empty() && descriptor[i].table != column.table_name())
+            continue;
+        if (descriptor[i].name != column.column_name())
+            continue;
+        if (index.has_value())
+            return {};
+        index = i;
+    }
+    return index;
+}
+
+ResultOr<NonnullOwnPtr<QueryOperator>> Select::create_plan(ExecutionContext& context) const
 {
     NonnullRefPtrVector<ResultColumn> columns;
+    Vector<NonnullRefPtr<TableDef>> tables;
 
     auto const& result_column_list = this->result_column_list();
     VERIFY(!result_column_list.is_empty());
@@ -33,6 +144,9 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
                         ""));
             }
         }
+
+        if (table_def->num_columns() != 0)
+            tables.append(move(table_def));
     }
 
     if (result_column_list.size() != 1 || result_column_list[0].type() != ResultType::All) {
@@ -46,72 +160,111 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
         }
     }
 
-    ResultSet result { SQLCommand::Select };
-
+    // The row produced by the k-th join consists of the columns of the first k+1 tables.
     auto descriptor = adopt_ref(*new TupleDescriptor);
-    Tuple tuple(descriptor);
-    Vector<Tuple> rows;
-    descriptor->empend("__unity__"sv);
-    tuple.append(Value { true });
-    rows.append(tuple);
+    Vector<size_t> first_column_of_table;
+    for (auto const& table : tables) {
+        first_column_of_table.append(descriptor->size());
+        descriptor->extend(table->to_tuple_descriptor());
+    }
 
-    for (auto& table_descriptor : table_or_subquery_list()) {
-        if (!table_descriptor.is_table())
-            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
+    auto table_of_column = [&](size_t column_index) {
+        size_t table_index = 0;
+        while (table_index + 1 < first_column_of_table.size() && first_column_of_table[table_index + 1] <= column_index)
+            ++table_index;
+        return table_index;
+    };
 
-        auto table_def = TRY(context.database->get_table(table_descriptor.schema_name(), table_descriptor.table_name()));
-        if (table_def->num_columns() == 0)
+    // Every term of the WHERE clause is evaluated right after the last table it refers to is read.
+    // Terms that only refer to the table being read are evaluated while scanning it, so rows that
+    // don't match are never joined with anything.
+    Vector<Vector<Predicate>> scan_predicates;
+    Vector<Vector<Predicate>> join_predicates;
+    Vector<Optional<JoinOperator::EquiJoinKey>> join_keys;
+    scan_predicates.resize(tables.size());
+    join_predicates.resize(tables.size());
+    join_keys.resize(tables.size());
+    Vector<Predicate> remaining_predicates;
+
+    Vector<NonnullRefPtr<Expression>> conjuncts;
+    if (where_clause())
+        split_conjunction(*where_clause(), conjuncts);
+    auto predicate_type = conjuncts.size() > 1 ? Predicate::Type::AndOperand : Predicate::Type::Condition;
+
+    for (auto const& conjunct : conjuncts) {
+        Predicate predicate { conjunct, predicate_type };
+        Vector<ColumnNameExpression const*> column_references;
+        if (tables.is_empty() || !collect_column_references(*conjunct, column_references)) {
+            remaining_predicates.append(move(predicate));
             continue;
+        }
 
-        auto old_descriptor_size = descriptor->size();
-        descriptor->extend(table_def->to_tuple_descriptor());
+        Vector<size_t> column_indices;
+        for (auto const* column : column_references) {
+            auto index = resolve_column(*descriptor, *column);
+            if (!index.has_value())
+                break;
+            column_indices.append(index.value());
+        }
+        if (column_indices.size() != column_references.size()) {
+            remaining_predicates.append(move(predicate));
+            continue;
+        }
 
-        while (!rows.is_empty() && (rows.first().size() == old_descriptor_size)) {
-            auto cartesian_row = rows.take_first();
-            auto table_rows = TRY(context.database->select_all(*table_def));
+        size_t last_table = 0;
+        bool refers_to_other_tables = false;
+        for (auto column_index : column_indices)
+            last_table = max(last_table, table_of_column(column_index));
+        for (auto column_index : column_indices)
+            refers_to_other_tables |= table_of_column(column_index) != last_table;
 
-            for (auto& table_row : table_rows) {
-                auto new_row = cartesian_row;
-                new_row.extend(table_row);
-                rows.append(new_row);
-            }
+        if (last_table == 0 || !refers_to_other_tables) {
+            scan_predicates[last_table].append(move(predicate));
+            continue;
         }
-    }
 
-    bool has_ordering { false };
-    auto sort_descriptor = adopt_ref(*new TupleDescriptor);
-    for (auto& term : m_ordering_term_list) {
-        sort_descriptor->append(TupleElementDescriptor { .order = term.order() });
-        has_ordering = true;
-    }
-    Tuple sort_key(sort_descriptor);
+        join_predicates[last_table].append(move(predicate));
+
+        // A join on `earlier_table.column = last_table.column` can find its matching rows through a hash table.
+        if (join_keys[last_table].has_value() || !is<BinaryOperatorExpression>(*conjunct))
+            continue;
+        auto const& binary_expression = static_cast<BinaryOperatorExpression const&>(*conjunct);
+        if (binary_expression.type() != BinaryOperator::Equals)
+            continue;
+        if (!is<ColumnNameExpression>(*binary_expression.lhs()) || !is<ColumnNameExpression>(*binary_expression.rhs()))
+            continue;
 
-    for (auto& row : rows) {
-        context.current_row = &row;
+        auto lhs_index = column_indices[0];
+        auto rhs_index = column_indices[1];
+        if (table_of_column(lhs_index) == last_table)
+            swap(lhs_index, rhs_index);
 
-        if (where_clause()) {
-            auto where_result = TRY(where_clause()->evaluate(context)).to_bool();
-            if (!where_result.has_value() || !where_result.value())
-                continue;
-        }
+        auto type = (*descriptor)[lhs_index].type;
+        if (type != (*descriptor)[rhs_index].type || (type != SQLType::Text && type != SQLType::Integer))
+            continue;
 
-        tuple.clear();
+        join_keys[last_table] = JoinOperator::EquiJoinKey {
+            .outer_column_index = lhs_index,
+            .inner_column_index = rhs_index - first_column_of_table[last_table],
+        };
+    }
 
-        for (auto& col : columns) {
-            auto value = TRY(col.expression()->evaluate(context));
-            tuple.append(value);
+    NonnullOwnPtr<QueryOperator> plan = make<SingleRowOperator>();
+    if (!tables.is_empty()) {
+        plan = make<ScanOperator>(tables[0], move(scan_predicates[0]));
+        for (size_t i = 1; i < tables.size(); ++i) {
+            auto inner = make<ScanOperator>(tables[i], move(scan_predicates[i]));
+            plan = make<JoinOperator>(move(plan), move(inner), join_keys[i], move(join_predicates[i]));
         }
+    }
 
-        if (has_ordering) {
-            sort_key.clear();
-            for (auto& term : m_ordering_term_list) {
-                auto value = TRY(term.expression()->evaluate(context));
-                sort_key.append(value);
-            }
-        }
+    for (auto& predicate : remaining_predicates)
+        plan = make<FilterOperator>(move(plan), move(predicate));
 
-        result.insert_row(tuple, sort_key);
-    }
+    if (!m_ordering_term_list.is_empty())
+        plan = make<SortOperator>(move(plan), m_ordering_term_list);
+
+    plan = make<ProjectOperator>(move(plan), move(columns));
 
     if (m_limit_clause != nullptr) {
         size_t limit_value = NumericLimits<size_t>::max();
@@ -137,7 +290,24 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
             }
         }
 
-        result.limit(offset_value, limit_value);
+        plan = make<LimitOperator>(move(plan), offset_value, limit_value);
+    }
+
+    return plan;
+}
+
+ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
+{
+    auto plan = TRY(create_plan(context));
+
+    ResultSet result { SQLCommand::Select };
+    Tuple sort_key;
+
+    for (;;) {
+        auto row = TRY(plan->next(context));
+        if (!row.has_value())
+            break;
+        result.insert_row(row.release_value(), sort_key);
     }
 
     return result;
@@ -42,6 +42,7 @@ public:
     ResultOr<NonnullRefPtr<TableDef>> get_table(DeprecatedString const&, DeprecatedString const&);
 
     ErrorOr<Vector<Row>> select_all(TableDef const&);
+    ErrorOr<Row> read_row(TableDef const&, u32 pointer);
     ErrorOr<Vector<Row>> match(TableDef const&, Key const&);
     ErrorOr<void> insert(Row&);
     ErrorOr<void> remove(Row&);
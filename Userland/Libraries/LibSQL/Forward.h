@@ -21,11 +21,13 @@ class IndexNode;
 class IndexDef;
 class Key;
 class KeyPartDef;
+class QueryOperator;
 class Relation;
 class Result;
 class ResultSet;
 class Row;
 class SchemaDef;
+class SelectCursor;
 class Serializer;
 class TableDef;
 class TreeNode;
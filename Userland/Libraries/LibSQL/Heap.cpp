@@ -63,6 +63,8 @@ ErrorOr<void> Heap::open()
     if (m_version != current_version) {
         dbgln_if(SQL_DEBUG, "Heap file {} opened has incompatible version {}. Deleting for version {}.", name(), m_version, current_version);
         m_file = nullptr;
+        m_clean_pages.clear();
+        m_pages.clear();
 
         TRY(Core::System::unlink(name()));
         return open();
@@ -79,8 +81,8 @@ ErrorOr<ByteBuffer> Heap::read_block(u32 block)
         return Error::from_string_literal("Heap()::read_block(): Heap file not opened");
     }
 
-    if (auto buffer = m_write_ahead_log.get(block); buffer.has_value())
-        return TRY(ByteBuffer::copy(*buffer));
+    if (auto* page = cached_page(block))
+        return TRY(ByteBuffer::copy(page->buffer));
 
     if (block >= m_next_block) {
         warnln("Heap({})::read_block({}): block # out of range (>= {})"sv, name(), block, m_next_block);
@@ -96,37 +98,91 @@ ErrorOr<ByteBuffer> Heap::read_block(u32 block)
     dbgln_if(SQL_DEBUG, "{:hex-dump}", bytes.trim(8));
     TRY(buffer.try_resize(bytes.size()));
 
-    return buffer;
+    auto* page = TRY(cache_page(block, move(buffer)));
+    return TRY(ByteBuffer::copy(page->buffer));
 }
 
-ErrorOr<void> Heap::write_block(u32 block, ByteBuffer& buffer)
+void Heap::add_to_wal(u32 block, ByteBuffer& buffer)
 {
-    if (!m_file) {
-        warnln("Heap({})::write_block({}): Heap file not opened"sv, name(), block);
-        return Error::from_string_literal("Heap()::write_block(): Heap file not opened");
-    }
-    if (block > m_next_block) {
-        warnln("Heap({})::write_block({}): block # out of range (> {})"sv, name(), block, m_next_block);
-        return Error::from_string_literal("Heap()::write_block(): block # out of range");
+    dbgln_if(SQL_DEBUG, "Adding to WAL: block #{}, size {}", block, buffer.size());
+    dbgln_if(SQL_DEBUG, "{:hex-dump}", buffer.bytes().trim(8));
+
+    auto& page = m_pages.ensure(block, [&] {
+        auto page = make<Page>();
+        page->block = block;
+        return page;
+    });
+
+    page->buffer = buffer;
+    if (!page->is_dirty) {
+        m_clean_pages.remove(*page);
+        page->is_dirty = true;
+        m_write_ahead_log.append(block);
     }
-    if (buffer.size() > BLOCKSIZE) {
-        warnln("Heap({})::write_block({}): Oversized block ({} > {})"sv, name(), block, buffer.size(), BLOCKSIZE);
-        return Error::from_string_literal("Heap()::write_block(): Oversized block");
+}
+
+Heap::Page* Heap::cached_page(u32 block)
+{
+    auto page = m_pages.get(block);
+    if (!page.has_value())
+        return nullptr;
+
+    if (!(*page)->is_dirty)
+        m_clean_pages.append(**page);
+    return *page;
+}
+
+ErrorOr<Heap::Page*> Heap::cache_page(u32 block, ByteBuffer buffer)
+{
+    VERIFY(!m_pages.contains(block));
+
+    auto page = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Page));
+    page->block = block;
+    page->buffer = move(buffer);
+
+    auto* page_ptr = page.ptr();
+    TRY(m_pages.try_set(block, move(page)));
+    m_clean_pages.append(*page_ptr);
+
+    evict_pages();
+    return page_ptr;
+}
+
+void Heap::evict_pages()
+{
+    while (m_pages.size() > m_page_cache_size && !m_clean_pages.is_empty()) {
+        auto* page = m_clean_pages.take_first();
+        dbgln_if(SQL_DEBUG, "Evicting heap block {} from the page cache", page->block);
+        m_pages.remove(page->block);
     }
+}
 
-    dbgln_if(SQL_DEBUG, "Write heap block {} size {}", block, buffer.size());
-    TRY(seek_block(block));
+void Heap::set_page_cache_size(size_t page_cache_size)
+{
+    VERIFY(page_cache_size > 0);
+    m_page_cache_size = page_cache_size;
+    evict_pages();
+}
 
-    if (auto current_size = buffer.size(); current_size < BLOCKSIZE) {
-        TRY(buffer.try_resize(BLOCKSIZE));
-        memset(buffer.offset_pointer(current_size), 0, BLOCKSIZE - current_size);
+ErrorOr<void> Heap::write_blocks(u32 first_block, ReadonlyBytes blocks)
+{
+    VERIFY(blocks.size() % BLOCKSIZE == 0);
+    auto last_block = first_block + blocks.size() / BLOCKSIZE - 1;
+
+    if (!m_file) {
+        warnln("Heap({})::write_blocks({}): Heap file not opened"sv, name(), first_block);
+        return Error::from_string_literal("Heap()::write_blocks(): Heap file not opened");
+    }
+    if (last_block > m_next_block) {
+        warnln("Heap({})::write_blocks({}): block # out of range ({} > {})"sv, name(), first_block, last_block, m_next_block);
+        return Error::from_string_literal("Heap()::write_blocks(): block # out of range");
     }
 
-    dbgln_if(SQL_DEBUG, "{:hex-dump}", buffer.bytes().trim(8));
-    TRY(m_file->write(buffer));
+    dbgln_if(SQL_DEBUG, "Write heap blocks {} to {}", first_block, last_block);
+    TRY(seek_block(first_block));
+    TRY(m_file->write_entire_buffer(blocks));
 
-    if (block == m_end_of_file)
-        m_end_of_file++;
+    m_end_of_file = max(m_end_of_file, last_block + 1);
     return {};
 }
 
@@ -169,18 +225,45 @@ u32 Heap::new_record_pointer()
 ErrorOr<void> Heap::flush()
 {
     VERIFY(m_file);
-    Vector<u32> blocks;
-    for (auto& wal_entry : m_write_ahead_log) {
-        blocks.append(wal_entry.key);
-    }
-    quick_sort(blocks);
-    for (auto& block : blocks) {
-        auto buffer_it = m_write_ahead_log.find(block);
-        VERIFY(buffer_it != m_write_ahead_log.end());
+    quick_sort(m_write_ahead_log);
+
+    // Runs of consecutive blocks are written with a single write. New blocks are allocated at
+    // the end of the file, so most of a commit usually ends up in a handful of writes.
+    ByteBuffer run;
+    u32 run_start = 0;
+    for (size_t i = 0; i < m_write_ahead_log.size(); ++i) {
+        auto block = m_write_ahead_log[i];
+        auto const& page = *m_pages.get(block).value();
+
+        if (page.buffer.size() > BLOCKSIZE) {
+            warnln("Heap({})::flush(): Oversized block {} ({} > {})"sv, name(), block, page.buffer.size(), BLOCKSIZE);
+            return Error::from_string_literal("Heap()::flush(): Oversized block");
+        }
+
         dbgln_if(SQL_DEBUG, "Flushing block {} to {}", block, name());
-        TRY(write_block(block, buffer_it->value));
+        dbgln_if(SQL_DEBUG, "{:hex-dump}", page.buffer.bytes().trim(8));
+        if (run.is_empty())
+            run_start = block;
+
+        auto offset = run.size();
+        TRY(run.try_resize(offset + BLOCKSIZE));
+        memcpy(run.offset_pointer(offset), page.buffer.data(), page.buffer.size());
+        memset(run.offset_pointer(offset + page.buffer.size()), 0, BLOCKSIZE - page.buffer.size());
+
+        if (i + 1 == m_write_ahead_log.size() || m_write_ahead_log[i + 1] != block + 1) {
+            TRY(write_blocks(run_start, run));
+            run.clear();
+        }
+    }
+
+    for (auto block : m_write_ahead_log) {
+        auto& page = *m_pages.get(block).value();
+        page.is_dirty = false;
+        m_clean_pages.append(page);
     }
     m_write_ahead_log.clear();
+    evict_pages();
+
     dbgln_if(SQL_DEBUG, "WAL flushed. Heap size = {}", size());
     return {};
 }
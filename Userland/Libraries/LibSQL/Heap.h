@@ -10,6 +10,8 @@
 #include <AK/Debug.h>
 #include <AK/DeprecatedString.h>
 #include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
 #include <AK/Vector.h>
 #include <LibCore/Object.h>
 #include <LibCore/Stream.h>
@@ -81,19 +83,36 @@ public:
         update_zero_block();
     }
 
-    void add_to_wal(u32 block, ByteBuffer& buffer)
-    {
-        dbgln_if(SQL_DEBUG, "Adding to WAL: block #{}, size {}", block, buffer.size());
-        dbgln_if(SQL_DEBUG, "{:hex-dump}", buffer.bytes().trim(8));
-        m_write_ahead_log.set(block, buffer);
-    }
-
+    void add_to_wal(u32 block, ByteBuffer& buffer);
     ErrorOr<void> flush();
 
+    // The number of blocks kept in memory. Blocks in the write-ahead log are kept until they are flushed,
+    // even if there are more of them than that.
+    static constexpr inline size_t default_page_cache_size = 1024;
+    size_t page_cache_size() const { return m_page_cache_size; }
+    void set_page_cache_size(size_t);
+
 private:
     explicit Heap(DeprecatedString);
 
-    ErrorOr<void> write_block(u32, ByteBuffer&);
+    /**
+     * A block of the heap file held in memory. Clean pages are kept in least
+     * recently used order, and are dropped once the cache grows beyond its size.
+     * Dirty pages make up the write-ahead log; they stay pinned in the cache
+     * until they are written to the file.
+     */
+    struct Page {
+        u32 block { 0 };
+        ByteBuffer buffer;
+        bool is_dirty { false };
+        IntrusiveListNode<Page> lru_list_node;
+    };
+
+    Page* cached_page(u32 block);
+    ErrorOr<Page*> cache_page(u32 block, ByteBuffer);
+    void evict_pages();
+
+    ErrorOr<void> write_blocks(u32 first_block, ReadonlyBytes);
     ErrorOr<void> seek_block(u32);
     ErrorOr<void> read_zero_block();
     void initialize_zero_block();
@@ -108,7 +127,11 @@ private:
     u32 m_table_columns_root { 0 };
     u32 m_version { current_version };
     Array<u32, 16> m_user_values { 0 };
-    HashMap<u32, ByteBuffer> m_write_ahead_log;
+
+    size_t m_page_cache_size { default_page_cache_size };
+    HashMap<u32, NonnullOwnPtr<Page>> m_pages;
+    IntrusiveList<&Page::lru_list_node> m_clean_pages;
+    Vector<u32> m_write_ahead_log;
 };
 
 }
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/QuickSort.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/QueryPlan.h>
+#include <LibSQL/Row.h>
+
+namespace SQL {
+
+ResultOr<bool> evaluate_predicate(AST::ExecutionContext& context, Predicate const& predicate)
+{
+    auto result = TRY(predicate.expression->evaluate(context)).to_bool();
+    if (!result.has_value() && predicate.type == Predicate::Type::AndOperand)
+        return Result { SQLCommand::Unknown, SQLErrorCode::BooleanOperatorTypeMismatch, AST::BinaryOperator_name(AST::BinaryOperator::And) };
+    return result.has_value() && result.value();
+}
+
+static ResultOr<bool> evaluate_predicates(AST::ExecutionContext& context, Tuple& row, Vector<Predicate> const& predicates)
+{
+    context.current_row = &row;
+    for (auto const& predicate : predicates) {
+        if (!TRY(evaluate_predicate(context, predicate)))
+            return false;
+    }
+    return true;
+}
+
+SingleRowOperator::SingleRowOperator()
+    : QueryOperator(adopt_ref(*new TupleDescriptor))
+{
+}
+
+ResultOr<Optional<Tuple>> SingleRowOperator::next(AST::ExecutionContext&)
+{
+    if (m_produced_row)
+        return Optional<Tuple> {};
+    m_produced_row = true;
+    return Tuple { m_descriptor };
+}
+
+ScanOperator::ScanOperator(NonnullRefPtr<TableDef> table, Vector<Predicate> predicates)
+    : QueryOperator(table->to_tuple_descriptor())
+    , m_table(move(table))
+    , m_predicates(move(predicates))
+    , m_next_pointer(m_table->pointer())
+{
+}
+
+ResultOr<Optional<Tuple>> ScanOperator::next(AST::ExecutionContext& context)
+{
+    while (m_next_pointer != 0) {
+        auto table_row = TRY(context.database->read_row(*m_table, m_next_pointer));
+        m_next_pointer = table_row.next_pointer();
+
+        // NOTE: Deserialized rows only know the names of their columns, but the predicates
+        //       and everything downstream need the table they belong to as well.
+        Tuple row { m_descriptor };
+        VERIFY(row.size() == table_row.size());
+        for (size_t i = 0; i < row.size(); ++i)
+            row[i] = table_row[i];
+
+        if (TRY(evaluate_predicates(context, row, m_predicates)))
+            return row;
+    }
+    return Optional<Tuple> {};
+}
+
+FilterOperator::FilterOperator(NonnullOwnPtr<QueryOperator> input, Predicate predicate)
+    : QueryOperator(input->descriptor())
+    , m_input(move(input))
+    , m_predicate(move(predicate))
+{
+}
+
+ResultOr<Optional<Tuple>> FilterOperator::next(AST::ExecutionContext& context)
+{
+    for (;;) {
+        auto row = TRY(m_input->next(context));
+        if (!row.has_value())
+            return row;
+
+        context.current_row = &row.value();
+        if (TRY(evaluate_predicate(context, m_predicate)))
+            return row;
+    }
+}
+
+static NonnullRefPtr<TupleDescriptor> joined_descriptor(TupleDescriptor const& outer, TupleDescriptor const& inner)
+{
+    auto descriptor = adopt_ref(*new TupleDescriptor);
+    descriptor->extend(outer);
+    descriptor->extend(inner);
+    return descriptor;
+}
+
+JoinOperator::JoinOperator(NonnullOwnPtr<QueryOperator> outer, NonnullOwnPtr<QueryOperator> inner, Optional<EquiJoinKey> key, Vector<Predicate> predicates)
+    : QueryOperator(joined_descriptor(outer->descriptor(), inner->descriptor()))
+    , m_outer(move(outer))
+    , m_inner(move(inner))
+    , m_key(move(key))
+    , m_predicates(move(predicates))
+{
+}
+
+// NOTE: Only columns of the same type are used as join keys, and for those, equal values
+//       have equal string representations. Null never equals anything, so it has no key.
+u32 JoinOperator::hash_key(Value const& value)
+{
+    VERIFY(!value.is_null());
+    return value.to_deprecated_string().hash();
+}
+
+ResultOr<void> JoinOperator::read_inner_rows(AST::ExecutionContext& context)
+{
+    m_has_read_inner_rows = true;
+    for (;;) {
+        auto row = TRY(m_inner->next(context));
+        if (!row.has_value())
+            break;
+
+        if (m_key.has_value()) {
+            auto const& key = row.value()[m_key->inner_column_index];
+            if (key.is_null())
+                continue;
+            m_inner_rows_by_key.ensure(hash_key(key)).append(m_inner_rows.size());
+        }
+        m_inner_rows.append(row.release_value());
+    }
+    return {};
+}
+
+ResultOr<Optional<Tuple>> JoinOperator::next(AST::ExecutionContext& context)
+{
+    if (!m_has_read_inner_rows)
+        TRY(read_inner_rows(context));
+
+    for (;;) {
+        if (!m_outer_row.has_value()) {
+            m_outer_row = TRY(m_outer->next(context));
+            if (!m_outer_row.has_value())
+                return Optional<Tuple> {};
+
+            m_candidates = nullptr;
+            m_next_candidate = 0;
+            if (m_key.has_value()) {
+                auto const& key = m_outer_row.value()[m_key->outer_column_index];
+                if (!key.is_null()) {
+                    if (auto it = m_inner_rows_by_key.find(hash_key(key)); it != m_inner_rows_by_key.end())
+                        m_candidates = &it->value;
+                }
+            }
+        }
+
+        auto candidate_count = m_key.has_value() ? (m_candidates ? m_candidates->size() : 0) : m_inner_rows.size();
+        while (m_next_candidate < candidate_count) {
+            auto inner_index = m_key.has_value() ? m_candidates->at(m_next_candidate) : m_next_candidate;
+            ++m_next_candidate;
+
+            Tuple row { m_descriptor };
+            auto const& outer_row = m_outer_row.value();
+            auto const& inner_row = m_inner_rows[inner_index];
+            for (size_t i = 0; i < outer_row.size(); ++i)
+                row[i] = outer_row[i];
+            for (size_t i = 0; i < inner_row.size(); ++i)
+                row[outer_row.size() + i] = inner_row[i];
+
+            if (TRY(evaluate_predicates(context, row, m_predicates)))
+                return row;
+        }
+
+        m_outer_row.clear();
+    }
+}
+
+SortOperator::SortOperator(NonnullOwnPtr<QueryOperator> input, NonnullRefPtrVector<AST::OrderingTerm> ordering_terms)
+    : QueryOperator(input->descriptor())
+    , m_input(move(input))
+    , m_ordering_terms(move(ordering_terms))
+{
+}
+
+ResultOr<void> SortOperator::sort_input(AST::ExecutionContext& context)
+{
+    m_is_sorted = true;
+
+    auto sort_descriptor = adopt_ref(*new TupleDescriptor);
+    for (auto const& term : m_ordering_terms)
+        sort_descriptor->append(TupleElementDescriptor { .order = term.order() });
+
+    Vector<ResultRow> rows;
+    for (;;) {
+        auto row = TRY(m_input->next(context));
+        if (!row.has_value())
+            break;
+
+        Tuple sort_key(sort_descriptor);
+        sort_key.clear();
+        context.current_row = &row.value();
+        for (auto const& term : m_ordering_terms)
+            sort_key.append(TRY(term.expression()->evaluate(context)));
+        rows.append({ row.release_value(), move(sort_key) });
+    }
+
+    // Rows with equal sort keys stay in the order they were produced in.
+    Vector<size_t> order;
+    order.ensure_capacity(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i)
+        order.unchecked_append(i);
+    quick_sort(order, [&](size_t a, size_t b) {
+        auto compare = rows[a].sort_key.compare(rows[b].sort_key);
+        return compare < 0 || (compare == 0 && a < b);
+    });
+
+    m_rows.ensure_capacity(rows.size());
+    for (auto index : order)
+        m_rows.unchecked_append(move(rows[index].row));
+    return {};
+}
+
+ResultOr<Optional<Tuple>> SortOperator::next(AST::ExecutionContext& context)
+{
+    if (!m_is_sorted)
+        TRY(sort_input(context));
+
+    if (m_next_row >= m_rows.size())
+        return Optional<Tuple> {};
+    return move(m_rows[m_next_row++]);
+}
+
+ProjectOperator::ProjectOperator(NonnullOwnPtr<QueryOperator> input, NonnullRefPtrVector<AST::ResultColumn> columns)
+    : QueryOperator(adopt_ref(*new TupleDescriptor))
+    , m_input(move(input))
+    , m_columns(move(columns))
+{
+}
+
+ResultOr<Optional<Tuple>> ProjectOperator::next(AST::ExecutionContext& context)
+{
+    auto row = TRY(m_input->next(context));
+    if (!row.has_value())
+        return row;
+
+    // NOTE: The descriptor is filled in from the values of the first row.
+    Tuple result { m_descriptor };
+    result.clear();
+    context.current_row = &row.value();
+    for (auto const& column : m_columns)
+        result.append(TRY(column.expression()->evaluate(context)));
+    return result;
+}
+
+LimitOperator::LimitOperator(NonnullOwnPtr<QueryOperator> input, size_t offset, size_t limit)
+    : QueryOperator(input->descriptor())
+    , m_input(move(input))
+    , m_offset(offset)
+    , m_limit(limit)
+{
+}
+
+ResultOr<Optional<Tuple>> LimitOperator::next(AST::ExecutionContext& context)
+{
+    for (; m_offset > 0; --m_offset) {
+        if (!TRY(m_input->next(context)).has_value())
+            return Optional<Tuple> {};
+    }
+
+    if (m_produced_rows >= m_limit)
+        return Optional<Tuple> {};
+
+    auto row = TRY(m_input->next(context));
+    if (row.has_value())
+        ++m_produced_rows;
+    return row;
+}
+
+SelectCursor::SelectCursor(NonnullRefPtr<AST::Select const> statement, NonnullRefPtr<Database> database, Vector<Value> placeholder_values)
+    : m_statement(move(statement))
+    , m_placeholder_values(move(placeholder_values))
+    , m_context { move(database), m_statement.ptr(), m_placeholder_values.span(), nullptr }
+{
+}
+
+ResultOr<NonnullOwnPtr<SelectCursor>> SelectCursor::create(NonnullRefPtr<AST::Select const> statement, NonnullRefPtr<Database> database, Vector<Value> placeholder_values)
+{
+    auto cursor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) SelectCursor(move(statement), move(database), move(placeholder_values))));
+    cursor->m_root = TRY(cursor->m_statement->create_plan(cursor->m_context));
+    return cursor;
+}
+
+}
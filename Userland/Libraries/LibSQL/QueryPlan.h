@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Forward.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Result.h>
+#include <LibSQL/ResultSet.h>
+#include <LibSQL/Tuple.h>
+
+namespace SQL {
+
+/**
+ * A SELECT is executed as a tree of operators. Rows are pulled through the
+ * tree one at a time, so only the operators that need all of their input
+ * (the inner side of a join, and sorting) hold more than a single row.
+ */
+class QueryOperator {
+public:
+    virtual ~QueryOperator() = default;
+
+    // Returns the next row, or an empty Optional once the operator is exhausted.
+    virtual ResultOr<Optional<Tuple>> next(AST::ExecutionContext&) = 0;
+
+    NonnullRefPtr<TupleDescriptor> const& descriptor() const { return m_descriptor; }
+
+protected:
+    explicit QueryOperator(NonnullRefPtr<TupleDescriptor> descriptor)
+        : m_descriptor(move(descriptor))
+    {
+    }
+
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+};
+
+struct Predicate {
+    enum class Type {
+        // A WHERE clause that is a single term. Anything that isn't true counts as false.
+        Condition,
+        // One of the terms of a WHERE clause that was split on AND. Just like the operands of an AND
+        // that is evaluated as a whole, it must evaluate to a boolean.
+        AndOperand,
+    };
+
+    NonnullRefPtr<AST::Expression> expression;
+    Type type { Type::Condition };
+};
+
+// Returns whether `predicate` holds for the context's current row.
+ResultOr<bool> evaluate_predicate(AST::ExecutionContext&, Predicate const&);
+
+// Produces a single row without any columns, for SELECTs without tables.
+class SingleRowOperator final : public QueryOperator {
+public:
+    SingleRowOperator();
+    virtual ResultOr<Optional<Tuple>> next(AST::ExecutionContext&) override;
+
+private:
+    bool m_produced_row { false };
+};
+
+// Walks the rows of a table, only producing the rows that match all of the pushed down predicates.
+class ScanOperator final : public QueryOperator {
+public:
+    ScanOperator(NonnullRefPtr<TableDef>, Vector<Predicate> predicates);
+    virtual ResultOr<Optional<Tuple>> next(AST::ExecutionContext&) override;
+
+private:
+    NonnullRefPtr<TableDef> m_table;
+    Vector<Predicate> m_predicates;
+    u32 m_next_pointer { 0 };
+};
+
+// Produces the rows of its input that match the predicate.
+class FilterOperator final : public QueryOperator {
+public:
+    FilterOperator(NonnullOwnPtr<QueryOperator> input, Predicate predicate);
+    virtual ResultOr<Optional<Tuple>> next(AST::ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<QueryOperator> m_input;
+    Predicate m_predicate;
+};
+
+/**
+ * Joins every row of the outer input with the matching rows of the inner input,
+ * which is read once and kept in memory. If the join has an equality between a
+ * column of each side, the inner rows are put into a hash table on that column
+ * so every outer row only visits the inner rows that can match. Otherwise every
+ * pair of rows is tried.
+ */
+class JoinOperator final : public QueryOperator {
+public:
+    struct EquiJoinKey {
+        size_t outer_column_index { 0 };
+        size_t inner_column_index { 0 };
+    };
+
+    JoinOperator(NonnullOwnPtr<QueryOperator> outer, NonnullOwnPtr<QueryOperator> inner, Optional<EquiJoinKey>, Vector<Predicate> predicates);
+    virtual ResultOr<Optional<Tuple>> next(AST::ExecutionContext&) override;
+
+private:
+    ResultOr<void> read_inner_rows(AST::ExecutionContext&);
+    static u32 hash_key(Value const&);
+
+    NonnullOwnPtr<QueryOperator> m_outer;
+    NonnullOwnPtr<QueryOperator> m_inner;
+    Optional<EquiJoinKey> m_key;
+    Vector<Predicate> m_predicates;
+
+    bool m_has_read_inner_rows { false };
+    Vector<Tuple> m_inner_rows;
+    HashMap<u32, Vector<size_t>> m_inner_rows_by_key;
+
+    Optional<Tuple> m_outer_row;
+    Vector<size_t> const* m_candidates { nullptr };
+    size_t m_next_candidate { 0 };
+};
+
+// Reads all of its input and produces it again ordered by the ordering terms.
+class SortOperator final : public QueryOperator {
+public:
+    SortOperator(NonnullOwnPtr<QueryOperator> input, NonnullRefPtrVector<AST::OrderingTerm> ordering_terms);
+    virtual ResultOr<Optional<Tuple>> next(AST::ExecutionContext&) override;
+
+private:
+    ResultOr<void> sort_input(AST::ExecutionContext&);
+
+    NonnullOwnPtr<QueryOperator> m_input;
+    NonnullRefPtrVector<AST::OrderingTerm> m_ordering_terms;
+    bool m_is_sorted { false };
+    Vector<Tuple> m_rows;
+    size_t m_next_row { 0 };
+};
+
+// Evaluates the result columns for every row of its input.
+class ProjectOperator final : public QueryOperator {
+public:
+    ProjectOperator(NonnullOwnPtr<QueryOperator> input, NonnullRefPtrVector<AST::ResultColumn> columns);
+    virtual ResultOr<Optional<Tuple>> next(AST::ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<QueryOperator> m_input;
+    NonnullRefPtrVector<AST::ResultColumn> m_columns;
+};
+
+// Skips the first `offset` rows of its input, and stops after `limit` rows.
+class LimitOperator final : public QueryOperator {
+public:
+    LimitOperator(NonnullOwnPtr<QueryOperator> input, size_t offset, size_t limit);
+    virtual ResultOr<Optional<Tuple>> next(AST::ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<QueryOperator> m_input;
+    size_t m_offset { 0 };
+    size_t m_limit { 0 };
+    size_t m_produced_rows { 0 };
+};
+
+/**
+ * An executing SELECT statement. Owns everything the operator tree needs, so
+ * the rows can be pulled long after the statement was started, e.g. one at a
+ * time as a client consumes them.
+ */
+class SelectCursor {
+public:
+    static ResultOr<NonnullOwnPtr<SelectCursor>> create(NonnullRefPtr<AST::Select const>, NonnullRefPtr<Database>, Vector<Value> placeholder_values);
+
+    ResultOr<Optional<Tuple>> next() { return m_root->next(m_context); }
+
+private:
+    SelectCursor(NonnullRefPtr<AST::Select const>, NonnullRefPtr<Database>, Vector<Value> placeholder_values);
+
+    NonnullRefPtr<AST::Select const> m_statement;
+    Vector<Value> m_placeholder_values;
+    AST::ExecutionContext m_context;
+    OwnPtr<QueryOperator> m_root;
+};
+
+}
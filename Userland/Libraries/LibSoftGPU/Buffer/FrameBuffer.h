@@ -34,9 +34,9 @@ public:
         return adopt_ref(*new FrameBuffer(rect, color_buffer, depth_buffer, stencil_buffer));
     }
 
-    NonnullRefPtr<Typed2DBuffer<C>> color_buffer() { return m_color_buffer; }
-    NonnullRefPtr<Typed2DBuffer<D>> depth_buffer() { return m_depth_buffer; }
-    NonnullRefPtr<Typed2DBuffer<S>> stencil_buffer() { return m_stencil_buffer; }
+    NonnullRefPtr<Typed2DBuffer<C>> const& color_buffer() { return m_color_buffer; }
+    NonnullRefPtr<Typed2DBuffer<D>> const& depth_buffer() { return m_depth_buffer; }
+    NonnullRefPtr<Typed2DBuffer<S>> const& stencil_buffer() { return m_stencil_buffer; }
     Gfx::IntRect rect() const { return m_rect; }
 
 private:
@@ -24,6 +24,11 @@ static constexpr int MAX_TEXTURE_SIZE = 2048;
 static constexpr float MAX_TEXTURE_LOD_BIAS = 2.f;
 static constexpr int SUBPIXEL_BITS = 4;
 
+// Triangles are sorted into square tiles of this size, which are rasterized in parallel. Tiles need to
+// consist of whole pixel quads, so that no quad is ever shared between two tiles.
+static constexpr int RASTERIZER_TILE_SIZE = 64;
+static_assert(RASTERIZER_TILE_SIZE % 2 == 0);
+
 static constexpr int NUM_SHADER_INPUTS = 64;
 
 // Verify that we have enough inputs to hold vertex color and texture coordinates for all fixed function texture units
@@ -7,6 +7,7 @@
  */
 
 #include <AK/AnyOf.h>
+#include <AK/Atomic.h>
 #include <AK/Error.h>
 #include <AK/Math.h>
 #include <AK/NumericLimits.h>
@@ -28,13 +29,14 @@
 
 namespace SoftGPU {
 
-static i64 g_num_rasterized_triangles;
-static i64 g_num_pixels;
-static i64 g_num_pixels_shaded;
-static i64 g_num_pixels_blended;
-static i64 g_num_sampler_calls;
-static i64 g_num_stencil_writes;
-static i64 g_num_quads;
+// These are updated by all rasterizer threads at once
+static Atomic<i64, AK::MemoryOrder::memory_order_relaxed> g_num_rasterized_triangles;
+static Atomic<i64, AK::MemoryOrder::memory_order_relaxed> g_num_pixels;
+static Atomic<i64, AK::MemoryOrder::memory_order_relaxed> g_num_pixels_shaded;
+static Atomic<i64, AK::MemoryOrder::memory_order_relaxed> g_num_pixels_blended;
+static Atomic<i64, AK::MemoryOrder::memory_order_relaxed> g_num_sampler_calls;
+static Atomic<i64, AK::MemoryOrder::memory_order_relaxed> g_num_stencil_writes;
+static Atomic<i64, AK::MemoryOrder::memory_order_relaxed> g_num_quads;
 
 using AK::abs;
 using AK::SIMD::any;
@@ -218,17 +220,17 @@ ALWAYS_INLINE static void test_alpha(PixelQuad& quad, GPU::AlphaTestFunction alp
 }
 
 template<typename CB1, typename CB2, typename CB3>
-ALWAYS_INLINE void Device::rasterize(Gfx::IntRect& render_bounds, CB1 set_coverage_mask, CB2 set_quad_depth, CB3 set_quad_attributes)
+ALWAYS_INLINE void Device::rasterize(Gfx::IntRect& render_bounds, ShaderProcessor& shader_processor, CB1 set_coverage_mask, CB2 set_quad_depth, CB3 set_quad_attributes)
 {
     // Return if alpha testing is a no-op
     if (m_options.enable_alpha_test && m_options.alpha_test_func == GPU::AlphaTestFunction::Never)
         return;
     auto const alpha_test_ref_value = expand4(m_options.alpha_test_ref_value);
 
-    // Buffers
-    auto color_buffer = m_frame_buffer->color_buffer();
-    auto depth_buffer = m_frame_buffer->depth_buffer();
-    auto stencil_buffer = m_frame_buffer->stencil_buffer();
+    // Buffers; note that their reference counts must not be touched here, since we might be on a rasterizer thread
+    auto& color_buffer = *m_frame_buffer->color_buffer();
+    auto& depth_buffer = *m_frame_buffer->depth_buffer();
+    auto& stencil_buffer = *m_frame_buffer->stencil_buffer();
 
     // Stencil configuration and writing
     auto const& stencil_configuration = m_stencil_configuration[GPU::Face::Front];
@@ -284,7 +286,6 @@ ALWAYS_INLINE void Device::rasterize(Gfx::IntRect& render_bounds, CB1 set_covera
     auto const qy1 = render_bounds_bottom & ~1;
 
     // Rasterize all quads
-    // FIXME: this could be embarrassingly parallel
     for (int qy = qy0; qy <= qy1; qy += 2) {
         for (int qx = qx0; qx <= qx1; qx += 2) {
             PixelQuad quad;
@@ -310,10 +311,10 @@ ALWAYS_INLINE void Device::rasterize(Gfx::IntRect& render_bounds, CB1 set_covera
             GPU::StencilType* stencil_ptrs[4];
             i32x4 stencil_value;
             if (m_options.enable_stencil_test) {
-                stencil_ptrs[0] = coverage_bits & 1 ? &stencil_buffer->scanline(qy)[qx] : nullptr;
-                stencil_ptrs[1] = coverage_bits & 2 ? &stencil_buffer->scanline(qy)[qx + 1] : nullptr;
-                stencil_ptrs[2] = coverage_bits & 4 ? &stencil_buffer->scanline(qy + 1)[qx] : nullptr;
-                stencil_ptrs[3] = coverage_bits & 8 ? &stencil_buffer->scanline(qy + 1)[qx + 1] : nullptr;
+                stencil_ptrs[0] = coverage_bits & 1 ? &stencil_buffer.scanline(qy)[qx] : nullptr;
+                stencil_ptrs[1] = coverage_bits & 2 ? &stencil_buffer.scanline(qy)[qx + 1] : nullptr;
+                stencil_ptrs[2] = coverage_bits & 4 ? &stencil_buffer.scanline(qy + 1)[qx] : nullptr;
+                stencil_ptrs[3] = coverage_bits & 8 ? &stencil_buffer.scanline(qy + 1)[qx + 1] : nullptr;
 
                 stencil_value = load4_masked(stencil_ptrs[0], stencil_ptrs[1], stencil_ptrs[2], stencil_ptrs[3], quad.mask);
                 stencil_value &= stencil_configuration.test_mask;
@@ -366,10 +367,10 @@ ALWAYS_INLINE void Device::rasterize(Gfx::IntRect& render_bounds, CB1 set_covera
 
             // Depth testing
             GPU::DepthType* depth_ptrs[4] = {
-                coverage_bits & 1 ? &depth_buffer->scanline(qy)[qx] : nullptr,
-                coverage_bits & 2 ? &depth_buffer->scanline(qy)[qx + 1] : nullptr,
-                coverage_bits & 4 ? &depth_buffer->scanline(qy + 1)[qx] : nullptr,
-                coverage_bits & 8 ? &depth_buffer->scanline(qy + 1)[qx + 1] : nullptr,
+                coverage_bits & 1 ? &depth_buffer.scanline(qy)[qx] : nullptr,
+                coverage_bits & 2 ? &depth_buffer.scanline(qy)[qx + 1] : nullptr,
+                coverage_bits & 4 ? &depth_buffer.scanline(qy + 1)[qx] : nullptr,
+                coverage_bits & 8 ? &depth_buffer.scanline(qy + 1)[qx + 1] : nullptr,
             };
             if (m_options.enable_depth_test) {
                 set_quad_depth(quad);
@@ -466,7 +467,7 @@ ALWAYS_INLINE void Device::rasterize(Gfx::IntRect& render_bounds, CB1 set_covera
             INCREASE_STATISTICS_COUNTER(g_num_pixels_shaded, maskcount(quad.mask));
 
             set_quad_attributes(quad);
-            shade_fragments(quad);
+            shade_fragments(quad, shader_processor);
 
             // Alpha testing
             if (m_options.enable_alpha_test) {
@@ -485,10 +486,10 @@ ALWAYS_INLINE void Device::rasterize(Gfx::IntRect& render_bounds, CB1 set_covera
                 continue;
 
             GPU::ColorType* color_ptrs[4] = {
-                coverage_bits & 1 ? &color_buffer->scanline(qy)[qx] : nullptr,
-                coverage_bits & 2 ? &color_buffer->scanline(qy)[qx + 1] : nullptr,
-                coverage_bits & 4 ? &color_buffer->scanline(qy + 1)[qx] : nullptr,
-                coverage_bits & 8 ? &color_buffer->scanline(qy + 1)[qx + 1] : nullptr,
+                coverage_bits & 1 ? &color_buffer.scanline(qy)[qx] : nullptr,
+                coverage_bits & 2 ? &color_buffer.scanline(qy)[qx + 1] : nullptr,
+                coverage_bits & 4 ? &color_buffer.scanline(qy + 1)[qx] : nullptr,
+                coverage_bits & 8 ? &color_buffer.scanline(qy + 1)[qx + 1] : nullptr,
             };
 
             u32x4 dst_u32;
@@ -565,6 +566,7 @@ void Device::rasterize_line_antialiased(GPU::Vertex& from, GPU::Vertex& to)
     f32x4 distance_along_line;
     rasterize(
         render_bounds,
+        m_shader_processor,
         [&from_coords4, &distance_along_line, &line_vector4, &line_dot4, &line_radius](auto& quad) {
             auto const screen_coordinates4 = to_vec2_f32x4(quad.screen_coordinates);
             auto const pixel_vector = screen_coordinates4 - from_coords4;
@@ -621,6 +623,7 @@ void Device::rasterize_point_aliased(GPU::Vertex& point)
     // Rasterize the point as a rect
     rasterize(
         point_rect,
+        m_shader_processor,
         [](auto& quad) {
             // We already passed in point_rect, so this doesn't matter
             quad.mask = expand4(~0);
@@ -653,6 +656,7 @@ void Device::rasterize_point_antialiased(GPU::Vertex& point)
     // Rasterize using a 2D signed distance field for a circle
     rasterize(
         render_bounds,
+        m_shader_processor,
         [&center4, &radius](auto& quad) {
             auto screen_coords = to_vec2_f32x4(quad.screen_coordinates);
             auto distance_to_point = length(center4 - screen_coords) - radius;
@@ -681,7 +685,7 @@ void Device::rasterize_point(GPU::Vertex& point)
         rasterize_point_aliased(point);
 }
 
-void Device::rasterize_triangle(Triangle& triangle)
+bool Device::setup_triangle(Triangle& triangle)
 {
     INCREASE_STATISTICS_COUNTER(g_num_rasterized_triangles, 1);
 
@@ -691,17 +695,17 @@ void Device::rasterize_triangle(Triangle& triangle)
 
     auto triangle_area = edge_function(v0, v1, v2);
     if (triangle_area == 0)
-        return;
+        return false;
 
     // Perform face culling
     if (m_options.enable_culling) {
         bool is_front = (m_options.front_face == GPU::WindingOrder::CounterClockwise ? triangle_area > 0 : triangle_area < 0);
 
         if (!is_front && m_options.cull_back)
-            return;
+            return false;
 
         if (is_front && m_options.cull_front)
-            return;
+            return false;
     }
 
     // Force counter-clockwise ordering of vertices
@@ -711,11 +715,138 @@ void Device::rasterize_triangle(Triangle& triangle)
         triangle_area *= -1;
     }
 
+    triangle.subpixel_coordinates[0] = v0;
+    triangle.subpixel_coordinates[1] = v1;
+    triangle.subpixel_coordinates[2] = v2;
+    triangle.area = triangle_area;
+
+    // Calculate render bounds based on the triangle's vertices
+    auto& render_bounds = triangle.render_bounds;
+    render_bounds.set_left(min(min(v0.x(), v1.x()), v2.x()) / subpixel_factor);
+    render_bounds.set_right(max(max(v0.x(), v1.x()), v2.x()) / subpixel_factor);
+    render_bounds.set_top(min(min(v0.y(), v1.y()), v2.y()) / subpixel_factor);
+    render_bounds.set_bottom(max(max(v0.y(), v1.y()), v2.y()) / subpixel_factor);
+
+    // Calculate depth offset to apply
+    triangle.depth_offset = 0.f;
+    if (m_options.depth_offset_enabled) {
+        auto const& vertex0 = triangle.vertices[0];
+        auto const& vertex1 = triangle.vertices[1];
+        auto const& vertex2 = triangle.vertices[2];
+
+        // OpenGL 2.0 § 3.5.5 allows us to approximate the maximum slope
+        auto delta_z = max(
+            max(
+                abs(vertex0.window_coordinates.z() - vertex1.window_coordinates.z()),
+                abs(vertex1.window_coordinates.z() - vertex2.window_coordinates.z())),
+            abs(vertex2.window_coordinates.z() - vertex0.window_coordinates.z()));
+        auto depth_max_slope = max(delta_z / render_bounds.width(), delta_z / render_bounds.height());
+
+        // Calculate total depth offset
+        triangle.depth_offset = depth_max_slope * m_options.depth_offset_factor + NumericLimits<float>::epsilon() * m_options.depth_offset_constant;
+    }
+
+    return true;
+}
+
+void Device::bin_triangles()
+{
+    auto const frame_buffer_rect = m_frame_buffer->rect();
+    m_tile_columns = ceil_div(frame_buffer_rect.width(), RASTERIZER_TILE_SIZE);
+    auto const tile_rows = ceil_div(frame_buffer_rect.height(), RASTERIZER_TILE_SIZE);
+    m_tile_bins.resize(m_tile_columns * tile_rows);
+
+    auto tile_bounds = frame_buffer_rect;
+    if (m_options.scissor_enabled)
+        tile_bounds.intersect(m_options.scissor_box);
+
+    for (u32 triangle_index = 0; triangle_index < m_processed_triangles.size(); ++triangle_index) {
+        auto& triangle = m_processed_triangles[triangle_index];
+        if (!setup_triangle(triangle))
+            continue;
+
+        auto const bounds = triangle.render_bounds.intersected(tile_bounds);
+        if (bounds.is_empty())
+            continue;
+
+        for (int tile_y = bounds.top() / RASTERIZER_TILE_SIZE; tile_y <= bounds.bottom() / RASTERIZER_TILE_SIZE; ++tile_y) {
+            for (int tile_x = bounds.left() / RASTERIZER_TILE_SIZE; tile_x <= bounds.right() / RASTERIZER_TILE_SIZE; ++tile_x) {
+                auto const tile_index = static_cast<size_t>(tile_y) * m_tile_columns + tile_x;
+                auto& bin = m_tile_bins[tile_index];
+                if (bin.is_empty())
+                    m_occupied_tiles.append(tile_index);
+                bin.append(triangle_index);
+            }
+        }
+    }
+}
+
+void Device::rasterize_binned_triangles()
+{
+    // Every pixel belongs to exactly one tile, and each tile draws its triangles in submission order. This
+    // gives the exact same result as drawing all triangles one after the other, no matter how the tiles
+    // are spread over the threads.
+    auto rasterize_tile = [&](size_t index) {
+        auto const tile_index = m_occupied_tiles[index];
+        Gfx::IntRect const tile_rect {
+            static_cast<int>(tile_index % m_tile_columns) * RASTERIZER_TILE_SIZE,
+            static_cast<int>(tile_index / m_tile_columns) * RASTERIZER_TILE_SIZE,
+            RASTERIZER_TILE_SIZE,
+            RASTERIZER_TILE_SIZE,
+        };
+
+        // The shader processor keeps its registers around while executing, so every tile needs its own
+        ShaderProcessor shader_processor { m_samplers };
+
+        auto& bin = m_tile_bins[tile_index];
+        for (auto triangle_index : bin)
+            rasterize_triangle(m_processed_triangles[triangle_index], tile_rect, shader_processor);
+        bin.clear_with_capacity();
+    };
+
+    if (m_occupied_tiles.size() > 1)
+        ensure_thread_pool();
+
+    if (m_thread_pool) {
+        m_thread_pool->for_each_index(m_occupied_tiles.size(), rasterize_tile);
+    } else {
+        for (size_t i = 0; i < m_occupied_tiles.size(); ++i)
+            rasterize_tile(i);
+    }
+    m_occupied_tiles.clear_with_capacity();
+}
+
+void Device::ensure_thread_pool()
+{
+    // The threads are only started once there are several tiles to draw, so that creating a context does not
+    // require the "thread" promise. On a single processor, everything is rasterized on the calling thread.
+    if (m_thread_pool || m_thread_pool_unavailable)
+        return;
+
+    auto helper_count = Threading::ThreadPool::processor_count() - 1;
+    if (helper_count == 0) {
+        m_thread_pool_unavailable = true;
+        return;
+    }
+    m_thread_pool = make<Threading::ThreadPool>(helper_count, "SoftGPU"sv);
+}
+
+void Device::rasterize_triangle(Triangle const& triangle, Gfx::IntRect const& tile_rect, ShaderProcessor& shader_processor)
+{
+    // Only rasterize the part of the triangle that lies within this tile
+    auto render_bounds = triangle.render_bounds.intersected(tile_rect);
+    if (render_bounds.is_empty())
+        return;
+
     auto const& vertex0 = triangle.vertices[0];
     auto const& vertex1 = triangle.vertices[1];
     auto const& vertex2 = triangle.vertices[2];
 
-    auto const one_over_area = 1.0f / triangle_area;
+    auto const v0 = triangle.subpixel_coordinates[0];
+    auto const v1 = triangle.subpixel_coordinates[1];
+    auto const v2 = triangle.subpixel_coordinates[2];
+
+    auto const one_over_area = 1.0f / triangle.area;
 
     // This function calculates the 3 edge values for the pixel relative to the triangle.
     auto calculate_edge_values4 = [v0, v1, v2](Vector2<i32x4> const& p) -> Vector3<i32x4> {
@@ -743,13 +874,6 @@ void Device::rasterize_triangle(Triangle& triangle)
             && edges.z() >= zero.z();
     };
 
-    // Calculate render bounds based on the triangle's vertices
-    Gfx::IntRect render_bounds;
-    render_bounds.set_left(min(min(v0.x(), v1.x()), v2.x()) / subpixel_factor);
-    render_bounds.set_right(max(max(v0.x(), v1.x()), v2.x()) / subpixel_factor);
-    render_bounds.set_top(min(min(v0.y(), v1.y()), v2.y()) / subpixel_factor);
-    render_bounds.set_bottom(max(max(v0.y(), v1.y()), v2.y()) / subpixel_factor);
-
     // Calculate depth of fragment for fog;
     // OpenGL 1.5 chapter 3.10: "An implementation may choose to approximate the
     // eye-coordinate distance from the eye to each fragment center by |Ze|."
@@ -770,29 +894,15 @@ void Device::rasterize_triangle(Triangle& triangle)
         expand4(vertex2.window_coordinates.w()),
     };
 
-    // Calculate depth offset to apply
-    float depth_offset = 0.f;
-    if (m_options.depth_offset_enabled) {
-        // OpenGL 2.0 § 3.5.5 allows us to approximate the maximum slope
-        auto delta_z = max(
-            max(
-                abs(vertex0.window_coordinates.z() - vertex1.window_coordinates.z()),
-                abs(vertex1.window_coordinates.z() - vertex2.window_coordinates.z())),
-            abs(vertex2.window_coordinates.z() - vertex0.window_coordinates.z()));
-        auto depth_max_slope = max(delta_z / render_bounds.width(), delta_z / render_bounds.height());
-
-        // Calculate total depth offset
-        depth_offset = depth_max_slope * m_options.depth_offset_factor + NumericLimits<float>::epsilon() * m_options.depth_offset_constant;
-    }
-
     auto const window_z_coordinates = Vector3<f32x4> {
-        expand4(vertex0.window_coordinates.z() + depth_offset),
-        expand4(vertex1.window_coordinates.z() + depth_offset),
-        expand4(vertex2.window_coordinates.z() + depth_offset),
+        expand4(vertex0.window_coordinates.z() + triangle.depth_offset),
+        expand4(vertex1.window_coordinates.z() + triangle.depth_offset),
+        expand4(vertex2.window_coordinates.z() + triangle.depth_offset),
     };
 
     rasterize(
         render_bounds,
+        shader_processor,
         [&](auto& quad) {
             auto edge_values = calculate_edge_values4(quad.screen_coordinates * subpixel_factor + half_pixel_offset);
             quad.mask = test_point4(edge_values);
@@ -1030,7 +1140,8 @@ void Device::draw_primitives(GPU::PrimitiveType primitive_type, FloatMatrix4x4 c
     // 3.   If culling is enabled, we cull the desired faces (https://learnopengl.com/Advanced-OpenGL/Face-culling)
     // 4.   Each element of the vertex is then divided by w to bring the positions into NDC (Normalized Device Coordinates)
     // 5.   The triangle's vertices are sorted in a counter-clockwise orientation
-    // 6.   The triangles are then sent off to the rasterizer and drawn to the screen
+    // 6.   The triangles are sorted into the screen tiles they touch
+    // 7.   The tiles are then sent off to the rasterizer threads and drawn to the screen
 
     if (vertices.is_empty())
         return;
@@ -1207,14 +1318,14 @@ void Device::draw_primitives(GPU::PrimitiveType primitive_type, FloatMatrix4x4 c
         }
     }
 
-    for (auto& triangle : m_processed_triangles)
-        rasterize_triangle(triangle);
+    bin_triangles();
+    rasterize_binned_triangles();
 }
 
-ALWAYS_INLINE void Device::shade_fragments(PixelQuad& quad)
+ALWAYS_INLINE void Device::shade_fragments(PixelQuad& quad, ShaderProcessor& shader_processor)
 {
     if (m_current_fragment_shader) {
-        m_shader_processor.execute(quad, *m_current_fragment_shader);
+        shader_processor.execute(quad, *m_current_fragment_shader);
         return;
     }
 
@@ -1586,15 +1697,15 @@ void Device::draw_statistics_overlay(Gfx::Bitmap& target)
         builder.append(DeprecatedString::formatted("Timings      : {:.1}ms {:.1}FPS\n",
             static_cast<double>(milliseconds) / frame_counter,
             (milliseconds > 0) ? 1000.0 * frame_counter / milliseconds : 9999.0));
-        builder.append(DeprecatedString::formatted("Triangles    : {}\n", g_num_rasterized_triangles));
+        builder.append(DeprecatedString::formatted("Triangles    : {}\n", g_num_rasterized_triangles.load()));
         builder.append(DeprecatedString::formatted("SIMD usage   : {}%\n", g_num_quads > 0 ? g_num_pixels_shaded * 25 / g_num_quads : 0));
         builder.append(DeprecatedString::formatted("Pixels       : {}, Stencil: {}%, Shaded: {}%, Blended: {}%, Overdraw: {}%\n",
-            g_num_pixels,
+            g_num_pixels.load(),
             g_num_pixels > 0 ? g_num_stencil_writes * 100 / g_num_pixels : 0,
             g_num_pixels > 0 ? g_num_pixels_shaded * 100 / g_num_pixels : 0,
             g_num_pixels_shaded > 0 ? g_num_pixels_blended * 100 / g_num_pixels_shaded : 0,
             num_rendertarget_pixels > 0 ? g_num_pixels_shaded * 100 / num_rendertarget_pixels - 100 : 0));
-        builder.append(DeprecatedString::formatted("Sampler calls: {}\n", g_num_sampler_calls));
+        builder.append(DeprecatedString::formatted("Sampler calls: {}\n", g_num_sampler_calls.load()));
 
         debug_string = builder.to_deprecated_string();
 
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <AK/Array.h>
+#include <AK/NonnullOwnPtr.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/RefPtr.h>
 #include <AK/Vector.h>
@@ -38,6 +39,7 @@
 #include <LibSoftGPU/Shader.h>
 #include <LibSoftGPU/ShaderProcessor.h>
 #include <LibSoftGPU/Triangle.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace SoftGPU {
 
@@ -91,7 +93,7 @@ private:
     GPU::ImageDataLayout depth_buffer_data_layout(Vector2<u32> size, Vector2<i32> offset);
 
     template<typename CB1, typename CB2, typename CB3>
-    void rasterize(Gfx::IntRect& render_bounds, CB1 set_coverage_mask, CB2 set_quad_depth, CB3 set_quad_attributes);
+    void rasterize(Gfx::IntRect& render_bounds, ShaderProcessor&, CB1 set_coverage_mask, CB2 set_quad_depth, CB3 set_quad_attributes);
 
     void rasterize_line_aliased(GPU::Vertex&, GPU::Vertex&);
     void rasterize_line_antialiased(GPU::Vertex&, GPU::Vertex&);
@@ -101,9 +103,13 @@ private:
     void rasterize_point_antialiased(GPU::Vertex&);
     void rasterize_point(GPU::Vertex&);
 
-    void rasterize_triangle(Triangle&);
+    bool setup_triangle(Triangle&);
+    void bin_triangles();
+    void rasterize_binned_triangles();
+    void ensure_thread_pool();
+    void rasterize_triangle(Triangle const&, Gfx::IntRect const& tile_rect, ShaderProcessor&);
     void setup_blend_factors();
-    void shade_fragments(PixelQuad&);
+    void shade_fragments(PixelQuad&, ShaderProcessor&);
 
     RefPtr<FrameBuffer<GPU::ColorType, GPU::DepthType, GPU::StencilType>> m_frame_buffer {};
     GPU::RasterizerOptions m_options;
@@ -112,6 +118,10 @@ private:
     Vector<Triangle> m_triangle_list;
     Vector<Triangle> m_processed_triangles;
     Vector<GPU::Vertex> m_clipped_vertices;
+    // The indices of the processed triangles that touch each tile, in submission order
+    Vector<Vector<u32>> m_tile_bins;
+    Vector<size_t> m_occupied_tiles;
+    size_t m_tile_columns { 0 };
     Array<Sampler, GPU::NUM_TEXTURE_UNITS> m_samplers;
     AlphaBlendFactors m_alpha_blend_factors;
     Array<GPU::Light, NUM_LIGHTS> m_lights;
@@ -122,6 +132,8 @@ private:
     Array<GPU::TextureUnitConfiguration, GPU::NUM_TEXTURE_UNITS> m_texture_unit_configuration;
     RefPtr<Shader> m_current_fragment_shader;
     ShaderProcessor m_shader_processor;
+    OwnPtr<Threading::ThreadPool> m_thread_pool;
+    bool m_thread_pool_unavailable { false };
 };
 
 }
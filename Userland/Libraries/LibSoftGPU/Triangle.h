@@ -9,12 +9,19 @@
 #pragma once
 
 #include <LibGPU/Vertex.h>
+#include <LibGfx/Rect.h>
 #include <LibGfx/Vector2.h>
 
 namespace SoftGPU {
 
 struct Triangle {
     GPU::Vertex vertices[3];
+
+    // Filled in by triangle setup, once the vertices are in window coordinates and ordered counter-clockwise
+    IntVector2 subpixel_coordinates[3];
+    i32 area { 0 };
+    Gfx::IntRect render_bounds;
+    float depth_offset { 0.f };
 };
 
 }
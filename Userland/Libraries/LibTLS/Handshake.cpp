@@ -218,17 +218,16 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
 
     // TODO: Compare Hashes
     dbgln_if(TLS_DEBUG, "FIXME: handle_handshake_finished :: Check message validity");
-    m_context.connection_status = ConnectionStatus::Established;
 
-    if (m_handshake_timeout_timer) {
-        // Disable the handshake timeout timer as handshake has been established.
-        m_handshake_timeout_timer->stop();
-        m_handshake_timeout_timer->remove_from_parent();
-        m_handshake_timeout_timer = nullptr;
+    if (m_context.is_resumed_session) {
+        // In an abbreviated handshake the server finishes first, and the connection can't be used
+        // until we've sent our own ChangeCipherSpec and Finished.
+        write_packets = WritePacketStage::Finished;
+        return index + size;
     }
 
-    if (on_connected)
-        on_connected();
+    remember_session();
+    did_establish_connection();
 
     return index + size;
 }
@@ -538,7 +537,7 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 auto packet = build_handshake_finished();
                 write_packet(packet);
             }
-            m_context.connection_status = ConnectionStatus::Established;
+            did_establish_connection();
             break;
         }
         payload_size++;
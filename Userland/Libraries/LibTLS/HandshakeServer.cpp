@@ -104,6 +104,24 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         write_packets = WritePacketStage::ServerHandshake;
     }
 
+    // RFC 5246 section 7.3: If the server echoes the session ID we offered, it agreed to resume that session,
+    // and goes straight to its ChangeCipherSpec and Finished without sending certificates or key exchange.
+    if (m_context.offered_session.has_value()) {
+        auto session = m_context.offered_session.release_value();
+        if (session.session_id_size == m_context.session_id_size && memcmp(session.session_id, m_context.session_id, session.session_id_size) == 0) {
+            if (session.cipher != cipher) {
+                dbgln("Server resumed a session with a different cipher suite");
+                return (i8)Error::NotSafe;
+            }
+            dbgln_if(TLS_DEBUG, "Resuming session");
+            m_context.master_key = move(session.master_key);
+            if (!expand_key())
+                return (i8)Error::NotUnderstood;
+            m_context.is_resumed_session = true;
+            m_context.connection_status = ConnectionStatus::KeyExchange;
+        }
+    }
+
     // Presence of extensions is determined by availability of bytes after compression_method
     if (buffer.size() - res >= 2) {
         auto extensions_bytes_total = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res += 2)));
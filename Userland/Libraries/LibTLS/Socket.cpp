@@ -145,6 +145,7 @@ void TLSv12::setup_connection()
                     m_handshake_timeout_timer->restart(m_max_wait_time_for_handshake_in_seconds * 1000);
                 }
             });
+        offer_session_to_resume();
         auto packet = build_hello();
         write_packet(packet);
         write_into_socket();
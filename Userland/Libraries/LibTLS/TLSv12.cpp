@@ -7,6 +7,7 @@
 #include <AK/Base64.h>
 #include <AK/Debug.h>
 #include <AK/Endian.h>
+#include <AK/HashMap.h>
 #include <LibCore/ConfigFile.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/File.h>
@@ -427,6 +428,79 @@ void TLSv12::pseudorandom_function(Bytes output, ReadonlyBytes secret, u8 const*
     }
 }
 
+// Sessions we can offer to resume, by host name. Whether the server still knows them is up to the server.
+static constexpr size_t max_resumable_sessions = 64;
+
+static HashMap<DeprecatedString, ResumableSession>& resumable_sessions()
+{
+    static HashMap<DeprecatedString, ResumableSession> sessions;
+    return sessions;
+}
+
+bool TLSv12::can_resume_sessions() const
+{
+    // An abbreviated handshake skips the certificates, so only share sessions between connections that
+    // would have trusted the same ones.
+    auto const& options = m_context.options;
+    return options.allow_session_resumption
+        && options.validate_certificates
+        && !options.allow_self_signed_certificates
+        && !options.root_certificates.has_value()
+        && !m_context.extensions.SNI.is_empty();
+}
+
+void TLSv12::offer_session_to_resume()
+{
+    if (!can_resume_sessions())
+        return;
+
+    auto it = resumable_sessions().find(m_context.extensions.SNI);
+    if (it == resumable_sessions().end())
+        return;
+
+    auto const& session = it->value;
+    memcpy(m_context.session_id, session.session_id, session.session_id_size);
+    m_context.session_id_size = session.session_id_size;
+    m_context.offered_session = session;
+    dbgln_if(TLS_DEBUG, "Offering to resume a session with {}", m_context.extensions.SNI);
+}
+
+void TLSv12::remember_session()
+{
+    if (!can_resume_sessions() || m_context.session_id_size == 0)
+        return;
+
+    auto master_key = ByteBuffer::copy(m_context.master_key);
+    if (master_key.is_error())
+        return;
+
+    ResumableSession session;
+    memcpy(session.session_id, m_context.session_id, m_context.session_id_size);
+    session.session_id_size = m_context.session_id_size;
+    session.cipher = m_context.cipher;
+    session.master_key = master_key.release_value();
+
+    auto& sessions = resumable_sessions();
+    if (sessions.size() >= max_resumable_sessions && !sessions.contains(m_context.extensions.SNI))
+        sessions.remove(sessions.begin());
+    sessions.set(m_context.extensions.SNI, move(session));
+}
+
+void TLSv12::did_establish_connection()
+{
+    m_context.connection_status = ConnectionStatus::Established;
+
+    if (m_handshake_timeout_timer) {
+        // Disable the handshake timeout timer as handshake has been established.
+        m_handshake_timeout_timer->stop();
+        m_handshake_timeout_timer->remove_from_parent();
+        m_handshake_timeout_timer = nullptr;
+    }
+
+    if (on_connected)
+        on_connected();
+}
+
 TLSv12::TLSv12(StreamVariantType stream, Options options)
     : m_stream(move(stream))
 {
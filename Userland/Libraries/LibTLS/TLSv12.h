@@ -256,6 +256,7 @@ struct Options {
     OPTION_WITH_DEFAULTS(bool, use_compression, false)
     OPTION_WITH_DEFAULTS(bool, validate_certificates, true)
     OPTION_WITH_DEFAULTS(bool, allow_self_signed_certificates, false)
+    OPTION_WITH_DEFAULTS(bool, allow_session_resumption, true)
     OPTION_WITH_DEFAULTS(Optional<Vector<Certificate>>, root_certificates, )
     OPTION_WITH_DEFAULTS(Function<void(AlertDescription)>, alert_handler, [](auto) {})
     OPTION_WITH_DEFAULTS(Function<void()>, finish_callback, [] {})
@@ -264,6 +265,14 @@ struct Options {
 #undef OPTION_WITH_DEFAULTS
 };
 
+// What we need to know to resume a session with an abbreviated handshake (RFC 5246 section 7.3).
+struct ResumableSession {
+    u8 session_id[32];
+    u8 session_id_size { 0 };
+    CipherSuite cipher;
+    ByteBuffer master_key;
+};
+
 struct Context {
     bool verify_chain(StringView host) const;
     bool verify_certificate_pair(Certificate const& subject, Certificate const& issuer) const;
@@ -274,6 +283,9 @@ struct Context {
     u8 local_random[32];
     u8 session_id[32];
     u8 session_id_size { 0 };
+    // The session we asked the server to resume in our ClientHello, if any.
+    Optional<ResumableSession> offered_session;
+    bool is_resumed_session { false };
     CipherSuite cipher;
     bool is_server { false };
     Vector<Certificate> certificates;
@@ -445,6 +457,11 @@ public:
 private:
     void setup_connection();
 
+    bool can_resume_sessions() const;
+    void offer_session_to_resume();
+    void remember_session();
+    void did_establish_connection();
+
     void consume(ReadonlyBytes record);
 
     ByteBuffer hmac_message(ReadonlyBytes buf, Optional<ReadonlyBytes> const buf2, size_t mac_length, bool local = false);
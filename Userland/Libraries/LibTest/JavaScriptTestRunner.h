@@ -362,6 +362,8 @@ inline JSFileResult TestRunner::run_file_test(DeprecatedString const& test_path)
     if (g_run_bytecode) {
         auto executable = MUST(JS::Bytecode::Generator::generate(test_script->parse_node()));
         executable->name = test_path;
+        auto optimization_level = JS::Bytecode::Interpreter::optimizations_enabled() ? JS::Bytecode::Interpreter::OptimizationLevel::Optimize : JS::Bytecode::Interpreter::OptimizationLevel::Default;
+        JS::Bytecode::Interpreter::optimization_pipeline(optimization_level).perform(*executable);
         if (JS::Bytecode::g_dump_bytecode)
             executable->dump();
         JS::Bytecode::Interpreter bytecode_interpreter(interpreter->realm());
@@ -381,6 +383,8 @@ inline JSFileResult TestRunner::run_file_test(DeprecatedString const& test_path)
         if (!executable_result.is_error()) {
             auto executable = executable_result.release_value();
             executable->name = test_path;
+            auto optimization_level = JS::Bytecode::Interpreter::optimizations_enabled() ? JS::Bytecode::Interpreter::OptimizationLevel::Optimize : JS::Bytecode::Interpreter::OptimizationLevel::Default;
+            JS::Bytecode::Interpreter::optimization_pipeline(optimization_level).perform(*executable);
             if (JS::Bytecode::g_dump_bytecode)
                 executable->dump();
             JS::Bytecode::Interpreter bytecode_interpreter(interpreter->realm());
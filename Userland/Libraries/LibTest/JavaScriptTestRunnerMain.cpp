@@ -88,6 +88,7 @@ int main(int argc, char** argv)
 #endif
     bool print_json = false;
     bool per_file = false;
+    bool enable_bytecode_optimizations = false;
     char const* specified_test_root = nullptr;
     DeprecatedString common_path;
     DeprecatedString test_glob;
@@ -113,6 +114,7 @@ int main(int argc, char** argv)
     args_parser.add_option(per_file, "Show detailed per-file results as JSON (implies -j)", "per-file", 0);
     args_parser.add_option(g_collect_on_every_allocation, "Collect garbage after every allocation", "collect-often", 'g');
     args_parser.add_option(g_run_bytecode, "Use the bytecode interpreter", "run-bytecode", 'b');
+    args_parser.add_option(enable_bytecode_optimizations, "Enable the bytecode optimization passes", "enable-bytecode-optimizations", 'e');
     args_parser.add_option(JS::Bytecode::g_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
     args_parser.add_option(test_glob, "Only run tests matching the given glob", "filter", 'f', "glob");
     for (auto& entry : g_extra_args)
@@ -135,6 +137,12 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (enable_bytecode_optimizations && !g_run_bytecode) {
+        warnln("--enable-bytecode-optimizations can only be used when --run-bytecode is specified.");
+        return 1;
+    }
+    JS::Bytecode::Interpreter::set_optimizations_enabled(enable_bytecode_optimizations);
+
     DeprecatedString test_root;
 
     if (specified_test_root) {
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibThreading/ThreadPool.h>
+#include <unistd.h>
+
+namespace Threading {
+
+ThreadPool::ThreadPool(size_t thread_count, StringView thread_name)
+{
+    m_threads.ensure_capacity(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        auto thread = Thread::construct([this] {
+            run_worker();
+            return 0;
+        },
+            thread_name);
+        thread->start();
+        m_threads.unchecked_append(move(thread));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        MutexLocker locker(m_mutex);
+        m_should_exit = true;
+        m_work_available.broadcast();
+    }
+    for (auto& thread : m_threads)
+        (void)thread.join();
+}
+
+size_t ThreadPool::processor_count()
+{
+    auto count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? static_cast<size_t>(count) : 1;
+}
+
+void ThreadPool::submit(Function<void()> work)
+{
+    if (m_threads.is_empty()) {
+        work();
+        return;
+    }
+
+    MutexLocker locker(m_mutex);
+    m_work.enqueue(move(work));
+    m_work_available.signal();
+}
+
+void ThreadPool::wait_for_all()
+{
+    MutexLocker locker(m_mutex);
+    while (!m_work.is_empty() || m_running_work_count > 0)
+        m_work_finished.wait();
+}
+
+void ThreadPool::run_worker()
+{
+    for (;;) {
+        Function<void()> work;
+        {
+            MutexLocker locker(m_mutex);
+            while (m_work.is_empty() && !m_should_exit)
+                m_work_available.wait();
+            if (m_work.is_empty())
+                return;
+            work = m_work.dequeue();
+            ++m_running_work_count;
+        }
+
+        work();
+
+        MutexLocker locker(m_mutex);
+        --m_running_work_count;
+        if (m_work.is_empty() && m_running_work_count == 0)
+            m_work_finished.broadcast();
+    }
+}
+
+}
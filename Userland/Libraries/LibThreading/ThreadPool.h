@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Queue.h>
+#include <AK/StdLibExtras.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+
+namespace Threading {
+
+// A fixed set of threads that run the work submitted to them in submission order.
+class ThreadPool {
+    AK_MAKE_NONCOPYABLE(ThreadPool);
+    AK_MAKE_NONMOVABLE(ThreadPool);
+
+public:
+    explicit ThreadPool(size_t thread_count, StringView thread_name = "ThreadPool"sv);
+    // Finishes all submitted work before joining the threads.
+    ~ThreadPool();
+
+    // The number of processors the system has online, which is at least one.
+    static size_t processor_count();
+
+    size_t thread_count() const { return m_threads.size(); }
+
+    // Without any threads, the work runs right away on the calling thread.
+    void submit(Function<void()>);
+
+    // Blocks until all work submitted so far has finished.
+    void wait_for_all();
+
+    // Calls callback(index) for every index in [0, count) and returns once all of those calls have returned.
+    // The calls are spread over the pool's threads and the calling thread, in no particular order.
+    template<typename Callback>
+    void for_each_index(size_t count, Callback callback)
+    {
+        Atomic<size_t> next_index { 0 };
+        auto run = [&] {
+            for (;;) {
+                auto index = next_index.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+                if (index >= count)
+                    return;
+                callback(index);
+            }
+        };
+
+        // The calling thread takes part as well, so one helper fewer than there is work suffices.
+        auto helper_count = min(thread_count(), count > 0 ? count - 1 : 0);
+        for (size_t i = 0; i < helper_count; ++i)
+            submit([&] { run(); });
+        run();
+        wait_for_all();
+    }
+
+private:
+    void run_worker();
+
+    NonnullRefPtrVector<Thread> m_threads;
+    Mutex m_mutex;
+    ConditionVariable m_work_available { m_mutex };
+    ConditionVariable m_work_finished { m_mutex };
+    Queue<Function<void()>> m_work;
+    size_t m_running_work_count { 0 };
+    bool m_should_exit { false };
+};
+
+}
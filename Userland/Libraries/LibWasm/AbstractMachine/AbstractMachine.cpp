@@ -471,6 +471,13 @@ Optional<InstantiationError> AbstractMachine::allocate_all_initial_phase(Module
         }
     });
 
+    // Now that every function, table, memory and global has an address, references to them can be resolved.
+    auto imported_function_count = module_instance.functions().size() - module.functions().size();
+    for (auto address : module_instance.functions().span().slice(imported_function_count)) {
+        auto& function = m_store.get(address)->get<WasmFunction>();
+        function.set_compiled_function(CompiledFunction::create(m_store, module_instance, function.type(), function.code()));
+    }
+
     return result;
 }
 
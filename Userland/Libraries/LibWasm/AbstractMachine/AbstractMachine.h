@@ -11,6 +11,7 @@
 #include <AK/HashTable.h>
 #include <AK/OwnPtr.h>
 #include <AK/Result.h>
+#include <LibWasm/AbstractMachine/CompiledFunction.h>
 #include <LibWasm/Types.h>
 
 namespace Wasm {
@@ -270,11 +271,14 @@ public:
     auto& type() const { return m_type; }
     auto& module() const { return m_module; }
     auto& code() const { return m_code; }
+    CompiledFunction const* compiled_function() const { return m_compiled_function.ptr(); }
+    void set_compiled_function(RefPtr<CompiledFunction> compiled_function) { m_compiled_function = move(compiled_function); }
 
 private:
     FunctionType m_type;
     ModuleInstance const& m_module;
     Module::Function const& m_code;
+    RefPtr<CompiledFunction> m_compiled_function;
 };
 
 class HostFunction {
@@ -478,11 +482,12 @@ private:
 
 class Frame {
 public:
-    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity)
+    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity, CompiledFunction const* compiled_function = nullptr)
         : m_module(module)
         , m_locals(move(locals))
         , m_expression(expression)
         , m_arity(arity)
+        , m_compiled_function(compiled_function)
     {
     }
 
@@ -491,12 +496,14 @@ public:
     auto& locals() { return m_locals; }
     auto& expression() const { return m_expression; }
     auto arity() const { return m_arity; }
+    auto compiled_function() const { return m_compiled_function; }
 
 private:
     ModuleInstance const& m_module;
     Vector<Value> m_locals;
     Expression const& m_expression;
     size_t m_arity { 0 };
+    CompiledFunction const* m_compiled_function { nullptr };
 };
 
 class Stack {
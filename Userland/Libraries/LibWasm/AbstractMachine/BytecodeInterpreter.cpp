@@ -5,6 +5,7 @@
  */
 
 #include <AK/Debug.h>
+#include <AK/ScopeGuard.h>
 #include <LibWasm/AbstractMachine/AbstractMachine.h>
 #include <LibWasm/AbstractMachine/BytecodeInterpreter.h>
 #include <LibWasm/AbstractMachine/Configuration.h>
@@ -32,6 +33,9 @@ namespace Wasm {
 void BytecodeInterpreter::interpret(Configuration& configuration)
 {
     m_trap.clear();
+    if (auto const* compiled_function = configuration.frame().compiled_function(); compiled_function && configuration.ip() == 0 && can_run_compiled_functions())
+        return interpret_compiled(configuration, *compiled_function);
+
     auto& instructions = configuration.frame().expression().instructions();
     auto max_ip_value = InstructionPointer { instructions.size() };
     auto& current_ip_value = configuration.ip();
@@ -966,6 +970,395 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     }
 }
 
+template<typename T>
+ALWAYS_INLINE static T from_slot(u64 slot)
+{
+    if constexpr (IsSame<T, float>)
+        return bit_cast<float>(static_cast<u32>(slot));
+    else if constexpr (IsSame<T, double>)
+        return bit_cast<double>(slot);
+    else
+        return static_cast<T>(slot);
+}
+
+template<typename T>
+ALWAYS_INLINE static u64 to_slot(T value)
+{
+    if constexpr (IsSame<T, float>)
+        return bit_cast<u32>(value);
+    else if constexpr (IsSame<T, double>)
+        return bit_cast<u64>(value);
+    else
+        return static_cast<MakeUnsigned<T>>(value);
+}
+
+static u64 value_to_slot(Value const& value)
+{
+    return value.value().visit(
+        [](Reference const& reference) {
+            return reference.ref().visit(
+                [](Reference::Null const&) -> u64 { return 0; },
+                [](Reference::Func const& function) -> u64 { return function.address.value() + 1; },
+                [](Reference::Extern const& extern_) -> u64 { return extern_.address.value() + 1; });
+        },
+        [](auto number) { return to_slot(number); });
+}
+
+static Value slot_to_value(u64 slot, ValueType type)
+{
+    switch (type.kind()) {
+    case ValueType::I32:
+        return Value(from_slot<i32>(slot));
+    case ValueType::I64:
+        return Value(from_slot<i64>(slot));
+    case ValueType::F32:
+        return Value(from_slot<float>(slot));
+    case ValueType::F64:
+        return Value(from_slot<double>(slot));
+    case ValueType::FunctionReference:
+    case ValueType::NullFunctionReference:
+        if (slot == 0)
+            return Value(Reference { Reference::Null { ValueType(ValueType::FunctionReference) } });
+        return Value(Reference { Reference::Func { slot - 1 } });
+    case ValueType::ExternReference:
+    case ValueType::NullExternReference:
+        if (slot == 0)
+            return Value(Reference { Reference::Null { ValueType(ValueType::ExternReference) } });
+        return Value(Reference { Reference::Extern { slot - 1 } });
+    }
+    VERIFY_NOT_REACHED();
+}
+
+void BytecodeInterpreter::interpret_compiled(Configuration& configuration, CompiledFunction const& function)
+{
+    auto base = m_registers_in_use;
+    if (m_registers.size() < base + function.slot_count())
+        m_registers.resize(base + function.slot_count());
+
+    auto& locals = configuration.frame().locals();
+    auto parameter_count = min(function.type().parameters().size(), locals.size());
+    for (size_t i = 0; i < parameter_count; ++i)
+        m_registers[base + i] = value_to_slot(locals[i]);
+
+    auto succeeded = configuration.should_limit_instruction_count()
+        ? run_compiled<true>(configuration, function, base)
+        : run_compiled<false>(configuration, function, base);
+    if (!succeeded)
+        return;
+
+    // Leave the results on the stack, as if the function body had run to completion.
+    auto& results = function.type().results();
+    for (size_t i = 0; i < results.size(); ++i)
+        configuration.stack().push(slot_to_value(m_registers[base + i], results[i]));
+    configuration.ip() = configuration.frame().expression().instructions().size();
+}
+
+template<bool should_limit_instruction_count>
+bool BytecodeInterpreter::call_from_compiled_code(Configuration& configuration, FunctionAddress address, size_t arguments_base)
+{
+    if (m_stack_info.size_free() < Constants::minimum_stack_space_to_keep_free) {
+        m_trap = Trap { "m_stack_info.size_free() >= Constants::minimum_stack_space_to_keep_free" };
+        return false;
+    }
+
+    auto* instance = configuration.store().get(address);
+    if (!instance) {
+        m_trap = Trap { "Call to nonexistent function" };
+        return false;
+    }
+
+    if (auto* wasm_function = instance->get_pointer<WasmFunction>(); wasm_function && wasm_function->compiled_function())
+        return run_compiled<should_limit_instruction_count>(configuration, *wasm_function->compiled_function(), arguments_base);
+
+    // Anything else goes through the configuration, which will use the stack-based interpreter for wasm code.
+    FunctionType const* type { nullptr };
+    instance->visit([&](auto const& function) { type = &function.type(); });
+
+    Vector<Value> arguments;
+    arguments.ensure_capacity(type->parameters().size());
+    for (size_t i = 0; i < type->parameters().size(); ++i)
+        arguments.unchecked_append(slot_to_value(m_registers[arguments_base + i], type->parameters()[i]));
+
+    Result result { Trap { ""sv } };
+    {
+        CallFrameHandle handle { *this, configuration };
+        result = configuration.call(*this, address, move(arguments));
+    }
+
+    if (result.is_trap()) {
+        m_trap = move(result.trap());
+        return false;
+    }
+
+    // Results come back in the order call_address() pushes them onto the stack in: the last one first.
+    auto& results = result.values();
+    if (results.size() != type->results().size()) {
+        m_trap = Trap { "Call returned an unexpected number of values" };
+        return false;
+    }
+    for (size_t i = 0; i < results.size(); ++i)
+        m_registers[arguments_base + i] = value_to_slot(results[results.size() - i - 1]);
+    return true;
+}
+
+template<typename PopType, typename PushType, typename Operator>
+ALWAYS_INLINE bool BytecodeInterpreter::compiled_binary_operation(u64* slots, CompiledInstruction const& instruction)
+{
+    auto lhs = from_slot<PopType>(slots[instruction.lhs]);
+    auto rhs = from_slot<PopType>(slots[instruction.rhs]);
+    auto call_result = Operator {}(lhs, rhs);
+    if constexpr (IsSpecializationOf<decltype(call_result), AK::Result>) {
+        if (call_result.is_error()) {
+            m_trap = Trap { call_result.error() };
+            return false;
+        }
+        slots[instruction.destination] = to_slot<PushType>(call_result.release_value());
+    } else {
+        slots[instruction.destination] = to_slot<PushType>(call_result);
+    }
+    return true;
+}
+
+template<typename PopType, typename PushType, typename Operator>
+ALWAYS_INLINE bool BytecodeInterpreter::compiled_unary_operation(u64* slots, CompiledInstruction const& instruction)
+{
+    auto call_result = Operator {}(from_slot<PopType>(slots[instruction.lhs]));
+    if constexpr (IsSpecializationOf<decltype(call_result), AK::Result>) {
+        if (call_result.is_error()) {
+            m_trap = Trap { call_result.error() };
+            return false;
+        }
+        slots[instruction.destination] = to_slot<PushType>(call_result.release_value());
+    } else {
+        slots[instruction.destination] = to_slot<PushType>(call_result);
+    }
+    return true;
+}
+
+template<typename ReadType, typename PushType>
+ALWAYS_INLINE bool BytecodeInterpreter::compiled_load(u64* slots, CompiledInstruction const& instruction, u8 const* memory_data, u64 memory_size)
+{
+    u64 address = static_cast<u64>(static_cast<u32>(slots[instruction.lhs])) + instruction.immediate;
+    if (address + sizeof(ReadType) > memory_size) {
+        m_trap = Trap { "Memory access out of bounds" };
+        dbgln("LibWasm: Memory access out of bounds (expected {} to be less than or equal to {})", address + sizeof(ReadType), memory_size);
+        return false;
+    }
+
+    ReadType value;
+    if constexpr (IsFloatingPoint<ReadType>) {
+        using RawType = Conditional<IsSame<ReadType, float>, u32, u64>;
+        LittleEndian<RawType> raw_value;
+        __builtin_memcpy(&raw_value, memory_data + address, sizeof(raw_value));
+        value = bit_cast<ReadType>(static_cast<RawType>(raw_value));
+    } else {
+        LittleEndian<ReadType> raw_value;
+        __builtin_memcpy(&raw_value, memory_data + address, sizeof(raw_value));
+        value = raw_value;
+    }
+    slots[instruction.destination] = to_slot<PushType>(static_cast<PushType>(value));
+    return true;
+}
+
+template<typename PopType, typename StoreType>
+ALWAYS_INLINE bool BytecodeInterpreter::compiled_store(u64* slots, CompiledInstruction const& instruction, u8* memory_data, u64 memory_size)
+{
+    u64 address = static_cast<u64>(static_cast<u32>(slots[instruction.lhs])) + instruction.immediate;
+    if (address + sizeof(StoreType) > memory_size) {
+        m_trap = Trap { "Memory access out of bounds" };
+        dbgln("LibWasm: Memory access out of bounds (expected 0 <= {} and {} <= {})", address, address + sizeof(StoreType), memory_size);
+        return false;
+    }
+
+    auto value = static_cast<StoreType>(from_slot<PopType>(slots[instruction.rhs]));
+    if constexpr (IsFloatingPoint<StoreType>) {
+        using RawType = Conditional<IsSame<StoreType, float>, u32, u64>;
+        LittleEndian<RawType> raw_value = bit_cast<RawType>(value);
+        __builtin_memcpy(memory_data + address, &raw_value, sizeof(raw_value));
+    } else {
+        LittleEndian<StoreType> raw_value = value;
+        __builtin_memcpy(memory_data + address, &raw_value, sizeof(raw_value));
+    }
+    return true;
+}
+
+template<bool should_limit_instruction_count>
+bool BytecodeInterpreter::run_compiled(Configuration& configuration, CompiledFunction const& function, size_t registers_base)
+{
+    auto previous_registers_in_use = m_registers_in_use;
+    m_registers_in_use = registers_base + function.slot_count();
+    if (m_registers.size() < m_registers_in_use)
+        m_registers.resize(m_registers_in_use);
+    ScopeGuard restore_registers_in_use = [&] { m_registers_in_use = previous_registers_in_use; };
+
+    auto* slots = m_registers.data() + registers_base;
+    for (size_t i = function.type().parameters().size(); i < function.local_count(); ++i)
+        slots[i] = 0;
+
+    auto& module = function.module();
+    MemoryInstance* memory = nullptr;
+    u8* memory_data = nullptr;
+    u64 memory_size = 0;
+    auto refresh_memory = [&] {
+        if (module.memories().is_empty())
+            return;
+        memory = configuration.store().get(module.memories().first());
+        memory_data = memory->data().data();
+        memory_size = memory->size();
+    };
+    refresh_memory();
+
+    auto const* instructions = function.instructions().data();
+    auto const* next_instruction = instructions;
+    u64 executed_instructions = 0;
+
+    for (;;) {
+        if constexpr (should_limit_instruction_count) {
+            if (executed_instructions++ >= Constants::max_allowed_executed_instructions_per_call) [[unlikely]] {
+                m_trap = Trap { "Exceeded maximum allowed number of instructions" };
+                return false;
+            }
+        }
+
+        auto const& instruction = *next_instruction++;
+        switch (instruction.opcode) {
+#define M(name, PopType, PushType, Operator)                                                                     \
+    case CompiledOpcode::name:                                                                                   \
+        if (!compiled_binary_operation<PopType, PushType, Operators::Operator>(slots, instruction)) [[unlikely]] \
+            return false;                                                                                        \
+        continue;
+            ENUMERATE_WASM_COMPILED_BINARY_OPERATIONS(M)
+#undef M
+#define M(name, PopType, PushType, Operator)                                                                    \
+    case CompiledOpcode::name:                                                                                  \
+        if (!compiled_unary_operation<PopType, PushType, Operators::Operator>(slots, instruction)) [[unlikely]] \
+            return false;                                                                                       \
+        continue;
+            ENUMERATE_WASM_COMPILED_UNARY_OPERATIONS(M)
+#undef M
+#define M(name, ReadType, PushType)                                                                        \
+    case CompiledOpcode::name:                                                                             \
+        if (!compiled_load<ReadType, PushType>(slots, instruction, memory_data, memory_size)) [[unlikely]] \
+            return false;                                                                                  \
+        continue;
+            ENUMERATE_WASM_COMPILED_LOADS(M)
+#undef M
+#define M(name, PopType, StoreType)                                                                         \
+    case CompiledOpcode::name:                                                                              \
+        if (!compiled_store<PopType, StoreType>(slots, instruction, memory_data, memory_size)) [[unlikely]] \
+            return false;                                                                                   \
+        continue;
+            ENUMERATE_WASM_COMPILED_STORES(M)
+#undef M
+        case CompiledOpcode::Copy:
+            slots[instruction.destination] = slots[instruction.lhs];
+            continue;
+        case CompiledOpcode::Const:
+            slots[instruction.destination] = instruction.immediate;
+            continue;
+        case CompiledOpcode::Jump:
+            next_instruction = instructions + instruction.immediate;
+            continue;
+        case CompiledOpcode::JumpIfZero:
+            if (static_cast<u32>(slots[instruction.lhs]) == 0)
+                next_instruction = instructions + instruction.immediate;
+            continue;
+        case CompiledOpcode::JumpIfNotZero:
+            if (static_cast<u32>(slots[instruction.lhs]) != 0)
+                next_instruction = instructions + instruction.immediate;
+            continue;
+        case CompiledOpcode::Branch:
+            for (size_t i = 0; i < instruction.rhs; ++i)
+                slots[instruction.destination + i] = slots[instruction.lhs + i];
+            next_instruction = instructions + instruction.immediate;
+            continue;
+        case CompiledOpcode::BranchTable:
+            next_instruction += min<u64>(static_cast<u32>(slots[instruction.lhs]), instruction.immediate);
+            continue;
+        case CompiledOpcode::Return:
+            for (size_t i = 0; i < instruction.rhs; ++i)
+                slots[i] = slots[instruction.lhs + i];
+            return true;
+        case CompiledOpcode::Call:
+        case CompiledOpcode::CallIndirect: {
+            FunctionAddress address;
+            if (instruction.opcode == CompiledOpcode::Call) {
+                address = module.functions()[instruction.immediate];
+            } else {
+                auto* table = configuration.store().get(module.tables()[instruction.rhs]);
+                auto index = static_cast<i32>(slots[instruction.lhs]);
+                if (index < 0) {
+                    m_trap = Trap { "index.value() >= 0" };
+                    return false;
+                }
+                if (static_cast<size_t>(index) >= table->elements().size()) {
+                    m_trap = Trap { "static_cast<size_t>(index.value()) < table_instance->elements().size()" };
+                    return false;
+                }
+                auto& element = table->elements()[index];
+                if (!element.has_value()) {
+                    m_trap = Trap { "element.has_value()" };
+                    return false;
+                }
+                auto* reference = element->ref().get_pointer<Reference::Func>();
+                if (!reference) {
+                    m_trap = Trap { "element->ref().has<Reference::Func>()" };
+                    return false;
+                }
+                address = reference->address;
+
+                // The callee finds its arguments and leaves its results in our registers, so it had better agree on how many there are.
+                auto* callee = configuration.store().get(address);
+                FunctionType const* callee_type { nullptr };
+                callee->visit([&](auto const& function) { callee_type = &function.type(); });
+                auto& expected_type = module.types()[instruction.immediate];
+                if (callee_type->parameters() != expected_type.parameters() || callee_type->results() != expected_type.results()) {
+                    m_trap = Trap { "Indirect call type mismatch" };
+                    return false;
+                }
+            }
+
+            if (!call_from_compiled_code<should_limit_instruction_count>(configuration, address, registers_base + instruction.destination))
+                return false;
+            // The callee may have grown the registers or the memory.
+            slots = m_registers.data() + registers_base;
+            refresh_memory();
+            continue;
+        }
+        case CompiledOpcode::Select:
+            slots[instruction.destination] = static_cast<u32>(slots[instruction.immediate]) != 0 ? slots[instruction.lhs] : slots[instruction.rhs];
+            continue;
+        case CompiledOpcode::GlobalGet: {
+            auto* global = configuration.store().get(module.globals()[instruction.immediate]);
+            slots[instruction.destination] = value_to_slot(global->value());
+            continue;
+        }
+        case CompiledOpcode::GlobalSet: {
+            auto* global = configuration.store().get(module.globals()[instruction.immediate]);
+            global->set_value(slot_to_value(slots[instruction.lhs], global->value().type()));
+            continue;
+        }
+        case CompiledOpcode::MemorySize:
+            slots[instruction.destination] = to_slot<i32>(static_cast<i32>(memory_size / Constants::page_size));
+            continue;
+        case CompiledOpcode::MemoryGrow: {
+            i32 old_pages = memory_size / Constants::page_size;
+            auto new_pages = static_cast<i32>(slots[instruction.lhs]);
+            slots[instruction.destination] = to_slot<i32>(memory->grow(new_pages * Constants::page_size) ? old_pages : -1);
+            refresh_memory();
+            continue;
+        }
+        case CompiledOpcode::RefIsNull:
+            slots[instruction.destination] = slots[instruction.lhs] == 0 ? 1 : 0;
+            continue;
+        case CompiledOpcode::Unreachable:
+            m_trap = Trap { "Unreachable" };
+            return false;
+        }
+        VERIFY_NOT_REACHED();
+    }
+}
+
 void DebuggerBytecodeInterpreter::interpret(Configuration& configuration, InstructionPointer& ip, Instruction const& instruction)
 {
     if (pre_interpret_hook) {
@@ -34,6 +34,20 @@ struct BytecodeInterpreter : public Interpreter {
 
 protected:
     virtual void interpret(Configuration&, InstructionPointer&, Instruction const&);
+    virtual bool can_run_compiled_functions() const { return true; }
+    void interpret_compiled(Configuration&, CompiledFunction const&);
+    template<bool should_limit_instruction_count>
+    bool run_compiled(Configuration&, CompiledFunction const&, size_t registers_base);
+    template<bool should_limit_instruction_count>
+    bool call_from_compiled_code(Configuration&, FunctionAddress, size_t arguments_base);
+    template<typename PopType, typename PushType, typename Operator>
+    bool compiled_binary_operation(u64* slots, CompiledInstruction const&);
+    template<typename PopType, typename PushType, typename Operator>
+    bool compiled_unary_operation(u64* slots, CompiledInstruction const&);
+    template<typename ReadType, typename PushType>
+    bool compiled_load(u64* slots, CompiledInstruction const&, u8 const* memory_data, u64 memory_size);
+    template<typename PopType, typename StoreType>
+    bool compiled_store(u64* slots, CompiledInstruction const&, u8* memory_data, u64 memory_size);
     void branch_to_label(Configuration&, LabelIndex);
     template<typename ReadT, typename PushT>
     void load_and_push(Configuration&, Instruction const&);
@@ -67,6 +81,10 @@ protected:
 
     Optional<Trap> m_trap;
     StackInfo m_stack_info;
+
+    // The register slots of all compiled functions that are currently running, callees above their callers.
+    Vector<u64> m_registers;
+    size_t m_registers_in_use { 0 };
 };
 
 struct DebuggerBytecodeInterpreter : public BytecodeInterpreter {
@@ -77,6 +95,7 @@ struct DebuggerBytecodeInterpreter : public BytecodeInterpreter {
 
 private:
     virtual void interpret(Configuration&, InstructionPointer&, Instruction const&) override;
+    virtual bool can_run_compiled_functions() const override { return !pre_interpret_hook && !post_interpret_hook; }
 };
 
 }
@@ -0,0 +1,605 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/NumericLimits.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/AbstractMachine/CompiledFunction.h>
+#include <LibWasm/Opcode.h>
+#include <LibWasm/Printer/Printer.h>
+
+namespace Wasm {
+
+namespace {
+
+// Turns the operand stack of a (validated) function body into register slots. Every operand stack entry
+// has a fixed slot given by its depth, but an entry created by local.get keeps referring to the local's
+// slot until something could change the local, which saves most of the copies a stack machine makes.
+class FunctionCompiler {
+public:
+    FunctionCompiler(Store& store, ModuleInstance const& module, FunctionType const& type, Module::Function const& function)
+        : m_store(store)
+        , m_module(module)
+        , m_type(type)
+        , m_function(function)
+        , m_local_count(type.parameters().size() + function.locals().size())
+    {
+    }
+
+    bool compile();
+
+    Vector<CompiledInstruction> take_instructions() { return move(m_instructions); }
+    size_t local_count() const { return m_local_count; }
+    size_t slot_count() const { return m_local_count + m_max_height; }
+
+private:
+    struct ControlFrame {
+        enum class Kind {
+            Function,
+            Block,
+            Loop,
+            If,
+        };
+
+        Kind kind;
+        size_t height { 0 };
+        size_t parameter_count { 0 };
+        size_t result_count { 0 };
+        size_t loop_start { 0 };
+        Vector<size_t> jumps_to_end {};
+        Optional<size_t> jump_to_else {};
+        bool is_unreachable { false };
+
+        size_t label_arity() const { return kind == Kind::Loop ? parameter_count : result_count; }
+    };
+
+    bool compile_instruction(Instruction const&);
+    bool enter_block(ControlFrame::Kind, BlockType const&);
+    bool compile_else();
+    bool compile_end();
+    bool compile_branch(LabelIndex);
+    bool compile_branch_if(LabelIndex);
+    bool compile_branch_table(Instruction::TableBranchArgs const&);
+    bool compile_return();
+    bool compile_call(FunctionType const&, CompiledInstruction);
+
+    u32 canonical_slot(size_t height) const { return static_cast<u32>(m_local_count + height); }
+    Optional<u32> pop();
+    u32 push();
+    void push_reference(u32 slot);
+    bool has_operands(size_t count) const { return m_stack.size() >= m_control.last().height + count; }
+    void materialize(size_t index);
+    void materialize_top(size_t count);
+    void materialize_references_to(u32 slot);
+
+    size_t emit(CompiledInstruction);
+    void emit_with_result(CompiledInstruction);
+    void bind_jumps(Vector<size_t> const&);
+
+    Store& m_store;
+    ModuleInstance const& m_module;
+    FunctionType const& m_type;
+    Module::Function const& m_function;
+    size_t m_local_count { 0 };
+
+    Vector<CompiledInstruction> m_instructions;
+    Vector<u32> m_stack;
+    Vector<ControlFrame> m_control;
+    size_t m_max_height { 0 };
+    size_t m_unreachable_depth { 0 };
+    Optional<size_t> m_last_result_producer;
+};
+
+Optional<u32> FunctionCompiler::pop()
+{
+    if (!has_operands(1))
+        return {};
+    return m_stack.take_last();
+}
+
+u32 FunctionCompiler::push()
+{
+    auto slot = canonical_slot(m_stack.size());
+    push_reference(slot);
+    return slot;
+}
+
+void FunctionCompiler::push_reference(u32 slot)
+{
+    m_stack.append(slot);
+    m_max_height = max(m_max_height, m_stack.size());
+}
+
+void FunctionCompiler::materialize(size_t index)
+{
+    auto slot = canonical_slot(index);
+    if (m_stack[index] == slot)
+        return;
+    emit({ .opcode = CompiledOpcode::Copy, .destination = slot, .lhs = m_stack[index] });
+    m_stack[index] = slot;
+}
+
+void FunctionCompiler::materialize_top(size_t count)
+{
+    for (size_t i = m_stack.size() - count; i < m_stack.size(); ++i)
+        materialize(i);
+}
+
+void FunctionCompiler::materialize_references_to(u32 slot)
+{
+    for (size_t i = 0; i < m_stack.size(); ++i) {
+        if (m_stack[i] == slot)
+            materialize(i);
+    }
+}
+
+size_t FunctionCompiler::emit(CompiledInstruction instruction)
+{
+    m_last_result_producer.clear();
+    m_instructions.append(instruction);
+    return m_instructions.size() - 1;
+}
+
+// Emits an instruction that only writes its result to `destination`, which is the slot of the entry on top
+// of the stack. If that value is stored to a local right away, the instruction can write to the local instead.
+void FunctionCompiler::emit_with_result(CompiledInstruction instruction)
+{
+    m_last_result_producer = emit(instruction);
+}
+
+void FunctionCompiler::bind_jumps(Vector<size_t> const& jumps)
+{
+    for (auto index : jumps)
+        m_instructions[index].immediate = m_instructions.size();
+}
+
+bool FunctionCompiler::enter_block(ControlFrame::Kind kind, BlockType const& block_type)
+{
+    size_t parameter_count = 0;
+    size_t result_count = 0;
+    switch (block_type.kind()) {
+    case BlockType::Empty:
+        break;
+    case BlockType::Type:
+        result_count = 1;
+        break;
+    case BlockType::Index: {
+        auto index = block_type.type_index().value();
+        if (index >= m_module.types().size())
+            return false;
+        auto& type = m_module.types()[index];
+        parameter_count = type.parameters().size();
+        result_count = type.results().size();
+        break;
+    }
+    }
+
+    // Everything on the stack must be where the code after the block expects it, no matter how it is left.
+    if (kind == ControlFrame::Kind::If) {
+        auto condition = pop();
+        if (!condition.has_value() || !has_operands(parameter_count))
+            return false;
+        for (size_t i = 0; i < m_stack.size(); ++i)
+            materialize(i);
+        auto jump = emit({ .opcode = CompiledOpcode::JumpIfZero, .lhs = *condition });
+        m_control.append({ .kind = kind, .height = m_stack.size() - parameter_count, .parameter_count = parameter_count, .result_count = result_count, .jump_to_else = jump });
+        return true;
+    }
+
+    if (!has_operands(parameter_count))
+        return false;
+    for (size_t i = 0; i < m_stack.size(); ++i)
+        materialize(i);
+    m_last_result_producer.clear();
+    m_control.append({ .kind = kind, .height = m_stack.size() - parameter_count, .parameter_count = parameter_count, .result_count = result_count, .loop_start = m_instructions.size() });
+    return true;
+}
+
+bool FunctionCompiler::compile_else()
+{
+    auto& frame = m_control.last();
+    if (frame.kind != ControlFrame::Kind::If || !frame.jump_to_else.has_value())
+        return false;
+
+    if (!frame.is_unreachable) {
+        if (m_stack.size() != frame.height + frame.result_count)
+            return false;
+        materialize_top(frame.result_count);
+        frame.jumps_to_end.append(emit({ .opcode = CompiledOpcode::Jump }));
+    }
+
+    m_instructions[*frame.jump_to_else].immediate = m_instructions.size();
+    frame.jump_to_else.clear();
+    frame.is_unreachable = false;
+    m_last_result_producer.clear();
+
+    // The parameters are still where the condition left them.
+    m_stack.shrink(frame.height);
+    for (size_t i = 0; i < frame.parameter_count; ++i)
+        push();
+    return true;
+}
+
+bool FunctionCompiler::compile_end()
+{
+    if (m_control.size() < 2)
+        return false;
+
+    auto frame = m_control.take_last();
+    if (!frame.is_unreachable) {
+        if (m_stack.size() != frame.height + frame.result_count)
+            return false;
+        materialize_top(frame.result_count);
+    }
+
+    bind_jumps(frame.jumps_to_end);
+    if (frame.jump_to_else.has_value())
+        m_instructions[*frame.jump_to_else].immediate = m_instructions.size();
+    m_last_result_producer.clear();
+
+    m_stack.shrink(frame.height);
+    for (size_t i = 0; i < frame.result_count; ++i)
+        push();
+    return true;
+}
+
+bool FunctionCompiler::compile_return()
+{
+    auto count = m_type.results().size();
+    if (!has_operands(count))
+        return false;
+    if (count > 1)
+        materialize_top(count);
+
+    auto source = count == 1 ? m_stack.last() : canonical_slot(m_stack.size() - count);
+    emit({ .opcode = CompiledOpcode::Return, .lhs = source, .rhs = static_cast<u32>(count) });
+    return true;
+}
+
+// Emits a single instruction that transfers control to the label, taking the label's values along.
+bool FunctionCompiler::compile_branch(LabelIndex label)
+{
+    if (label.value() >= m_control.size())
+        return false;
+
+    auto& target = m_control[m_control.size() - label.value() - 1];
+    if (target.kind == ControlFrame::Kind::Function)
+        return compile_return();
+
+    auto arity = target.label_arity();
+    if (!has_operands(arity))
+        return false;
+    if (arity > 1)
+        materialize_top(arity);
+
+    auto source = arity == 1 ? m_stack.last() : canonical_slot(m_stack.size() - arity);
+    auto destination = canonical_slot(target.height);
+    auto count = source == destination ? 0u : static_cast<u32>(arity);
+    auto index = emit({ .opcode = CompiledOpcode::Branch, .destination = destination, .lhs = source, .rhs = count, .immediate = target.loop_start });
+    if (target.kind != ControlFrame::Kind::Loop)
+        target.jumps_to_end.append(index);
+    return true;
+}
+
+bool FunctionCompiler::compile_branch_if(LabelIndex label)
+{
+    auto condition = pop();
+    if (!condition.has_value() || label.value() >= m_control.size())
+        return false;
+
+    auto& target = m_control[m_control.size() - label.value() - 1];
+    auto arity = target.label_arity();
+    if (!has_operands(arity))
+        return false;
+    materialize_top(arity);
+
+    if (target.kind != ControlFrame::Kind::Function && canonical_slot(m_stack.size() - arity) == canonical_slot(target.height)) {
+        auto index = emit({ .opcode = CompiledOpcode::JumpIfNotZero, .lhs = *condition, .immediate = target.loop_start });
+        if (target.kind != ControlFrame::Kind::Loop)
+            target.jumps_to_end.append(index);
+        return true;
+    }
+
+    auto skip = emit({ .opcode = CompiledOpcode::JumpIfZero, .lhs = *condition });
+    if (!compile_branch(label))
+        return false;
+    m_instructions[skip].immediate = m_instructions.size();
+    m_last_result_producer.clear();
+    return true;
+}
+
+bool FunctionCompiler::compile_branch_table(Instruction::TableBranchArgs const& arguments)
+{
+    auto index = pop();
+    if (!index.has_value() || arguments.default_.value() >= m_control.size())
+        return false;
+
+    // Every entry of the table has to be a single instruction.
+    auto arity = m_control[m_control.size() - arguments.default_.value() - 1].label_arity();
+    if (!has_operands(arity))
+        return false;
+    if (arity > 1)
+        materialize_top(arity);
+
+    emit({ .opcode = CompiledOpcode::BranchTable, .lhs = *index, .immediate = arguments.labels.size() });
+    for (auto label : arguments.labels) {
+        if (!compile_branch(label))
+            return false;
+    }
+    return compile_branch(arguments.default_);
+}
+
+bool FunctionCompiler::compile_call(FunctionType const& type, CompiledInstruction instruction)
+{
+    auto parameter_count = type.parameters().size();
+    if (!has_operands(parameter_count))
+        return false;
+
+    // The callee's registers start at its first argument, so the arguments have to be where the stack puts them.
+    materialize_top(parameter_count);
+    m_stack.shrink(m_stack.size() - parameter_count);
+    instruction.destination = canonical_slot(m_stack.size());
+    emit(instruction);
+
+    for (size_t i = 0; i < type.results().size(); ++i)
+        push();
+    return true;
+}
+
+bool FunctionCompiler::compile_instruction(Instruction const& instruction)
+{
+    auto opcode = instruction.opcode();
+
+    auto unary = [&](CompiledOpcode compiled_opcode) {
+        auto operand = pop();
+        if (!operand.has_value())
+            return false;
+        emit_with_result({ .opcode = compiled_opcode, .destination = push(), .lhs = *operand });
+        return true;
+    };
+
+    auto binary = [&](CompiledOpcode compiled_opcode) {
+        auto rhs = pop();
+        auto lhs = pop();
+        if (!lhs.has_value() || !rhs.has_value())
+            return false;
+        emit_with_result({ .opcode = compiled_opcode, .destination = push(), .lhs = *lhs, .rhs = *rhs });
+        return true;
+    };
+
+    auto load = [&](CompiledOpcode compiled_opcode) {
+        auto address = pop();
+        if (!address.has_value() || m_module.memories().is_empty())
+            return false;
+        auto offset = instruction.arguments().get<Instruction::MemoryArgument>().offset;
+        emit_with_result({ .opcode = compiled_opcode, .destination = push(), .lhs = *address, .immediate = offset });
+        return true;
+    };
+
+    auto store = [&](CompiledOpcode compiled_opcode) {
+        auto value = pop();
+        auto address = pop();
+        if (!address.has_value() || !value.has_value() || m_module.memories().is_empty())
+            return false;
+        auto offset = instruction.arguments().get<Instruction::MemoryArgument>().offset;
+        emit({ .opcode = compiled_opcode, .lhs = *address, .rhs = *value, .immediate = offset });
+        return true;
+    };
+
+    auto constant = [&](u64 bits) {
+        emit_with_result({ .opcode = CompiledOpcode::Const, .destination = push(), .immediate = bits });
+        return true;
+    };
+
+    auto mark_unreachable = [&] {
+        m_stack.shrink(m_control.last().height);
+        m_control.last().is_unreachable = true;
+        return true;
+    };
+
+    auto set_local = [&](size_t index) {
+        if (index >= m_local_count || !has_operands(1))
+            return false;
+
+        auto local = static_cast<u32>(index);
+        auto is_referenced_below_top = false;
+        for (size_t i = 0; i + 1 < m_stack.size(); ++i)
+            is_referenced_below_top |= m_stack[i] == local;
+
+        if (m_last_result_producer.has_value() && !is_referenced_below_top) {
+            auto& producer = m_instructions[*m_last_result_producer];
+            if (producer.destination == m_stack.last()) {
+                producer.destination = local;
+                m_stack.last() = local;
+                m_last_result_producer.clear();
+                return true;
+            }
+        }
+
+        materialize_references_to(local);
+        auto source = m_stack.last();
+        if (source != local)
+            emit({ .opcode = CompiledOpcode::Copy, .destination = local, .lhs = source });
+        return true;
+    };
+
+    switch (opcode.value()) {
+    case Instructions::unreachable.value():
+        emit({ .opcode = CompiledOpcode::Unreachable });
+        return mark_unreachable();
+    case Instructions::nop.value():
+        return true;
+    case Instructions::block.value():
+        return enter_block(ControlFrame::Kind::Block, instruction.arguments().get<Instruction::StructuredInstructionArgs>().block_type);
+    case Instructions::loop.value():
+        return enter_block(ControlFrame::Kind::Loop, instruction.arguments().get<Instruction::StructuredInstructionArgs>().block_type);
+    case Instructions::if_.value():
+        return enter_block(ControlFrame::Kind::If, instruction.arguments().get<Instruction::StructuredInstructionArgs>().block_type);
+    case Instructions::structured_else.value():
+        return compile_else();
+    case Instructions::structured_end.value():
+        return compile_end();
+    case Instructions::br.value():
+        return compile_branch(instruction.arguments().get<LabelIndex>()) && mark_unreachable();
+    case Instructions::br_if.value():
+        return compile_branch_if(instruction.arguments().get<LabelIndex>());
+    case Instructions::br_table.value():
+        return compile_branch_table(instruction.arguments().get<Instruction::TableBranchArgs>()) && mark_unreachable();
+    case Instructions::return_.value():
+        return compile_return() && mark_unreachable();
+    case Instructions::call.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>().value();
+        if (index >= m_module.functions().size())
+            return false;
+        auto* function = m_store.get(m_module.functions()[index]);
+        if (!function)
+            return false;
+        FunctionType const* type { nullptr };
+        function->visit([&](auto const& function) { type = &function.type(); });
+        return compile_call(*type, { .opcode = CompiledOpcode::Call, .immediate = index });
+    }
+    case Instructions::call_indirect.value(): {
+        auto& arguments = instruction.arguments().get<Instruction::IndirectCallArgs>();
+        auto element_index = pop();
+        if (!element_index.has_value() || arguments.type.value() >= m_module.types().size() || arguments.table.value() >= m_module.tables().size())
+            return false;
+        auto& type = m_module.types()[arguments.type.value()];
+        return compile_call(type, { .opcode = CompiledOpcode::CallIndirect, .lhs = *element_index, .rhs = static_cast<u32>(arguments.table.value()), .immediate = arguments.type.value() });
+    }
+    case Instructions::drop.value():
+        return pop().has_value();
+    case Instructions::select.value():
+    case Instructions::select_typed.value(): {
+        auto condition = pop();
+        auto rhs = pop();
+        auto lhs = pop();
+        if (!condition.has_value() || !rhs.has_value() || !lhs.has_value())
+            return false;
+        emit_with_result({ .opcode = CompiledOpcode::Select, .destination = push(), .lhs = *lhs, .rhs = *rhs, .immediate = *condition });
+        return true;
+    }
+    case Instructions::local_get.value(): {
+        auto index = instruction.arguments().get<LocalIndex>().value();
+        if (index >= m_local_count)
+            return false;
+        push_reference(static_cast<u32>(index));
+        m_last_result_producer.clear();
+        return true;
+    }
+    case Instructions::local_set.value():
+        return set_local(instruction.arguments().get<LocalIndex>().value()) && pop().has_value();
+    case Instructions::local_tee.value():
+        return set_local(instruction.arguments().get<LocalIndex>().value());
+    case Instructions::global_get.value():
+        if (instruction.arguments().get<GlobalIndex>().value() >= m_module.globals().size())
+            return false;
+        emit_with_result({ .opcode = CompiledOpcode::GlobalGet, .destination = push(), .immediate = instruction.arguments().get<GlobalIndex>().value() });
+        return true;
+    case Instructions::global_set.value(): {
+        auto value = pop();
+        if (!value.has_value() || instruction.arguments().get<GlobalIndex>().value() >= m_module.globals().size())
+            return false;
+        emit({ .opcode = CompiledOpcode::GlobalSet, .lhs = *value, .immediate = instruction.arguments().get<GlobalIndex>().value() });
+        return true;
+    }
+    case Instructions::memory_size.value():
+        if (m_module.memories().is_empty())
+            return false;
+        emit_with_result({ .opcode = CompiledOpcode::MemorySize, .destination = push() });
+        return true;
+    case Instructions::memory_grow.value():
+        if (m_module.memories().is_empty())
+            return false;
+        return unary(CompiledOpcode::MemoryGrow);
+    case Instructions::i32_const.value():
+        return constant(static_cast<u32>(instruction.arguments().get<i32>()));
+    case Instructions::i64_const.value():
+        return constant(static_cast<u64>(instruction.arguments().get<i64>()));
+    case Instructions::f32_const.value():
+        return constant(bit_cast<u32>(instruction.arguments().get<float>()));
+    case Instructions::f64_const.value():
+        return constant(bit_cast<u64>(instruction.arguments().get<double>()));
+    case Instructions::ref_null.value():
+        return constant(0);
+    case Instructions::ref_func.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>().value();
+        if (index >= m_module.functions().size())
+            return false;
+        return constant(m_module.functions()[index].value() + 1);
+    }
+    case Instructions::ref_is_null.value():
+        return unary(CompiledOpcode::RefIsNull);
+#define M(name, ...)                   \
+    case Instructions::name.value(): \
+        return binary(CompiledOpcode::name);
+        ENUMERATE_WASM_COMPILED_BINARY_OPERATIONS(M)
+#undef M
+#define M(name, ...)                   \
+    case Instructions::name.value(): \
+        return unary(CompiledOpcode::name);
+        ENUMERATE_WASM_COMPILED_UNARY_OPERATIONS(M)
+#undef M
+#define M(name, ...)                   \
+    case Instructions::name.value(): \
+        return load(CompiledOpcode::name);
+        ENUMERATE_WASM_COMPILED_LOADS(M)
+#undef M
+#define M(name, ...)                   \
+    case Instructions::name.value(): \
+        return store(CompiledOpcode::name);
+        ENUMERATE_WASM_COMPILED_STORES(M)
+#undef M
+    default:
+        dbgln_if(WASM_TRACE_DEBUG, "Not compiling function because of instruction {}", instruction_name(opcode));
+        return false;
+    }
+}
+
+bool FunctionCompiler::compile()
+{
+    m_control.append({ .kind = ControlFrame::Kind::Function, .result_count = m_type.results().size() });
+
+    for (auto& instruction : m_function.body().instructions()) {
+        if (m_control.last().is_unreachable) {
+            // Nothing can get here, so skip ahead to where the enclosing block continues.
+            auto opcode = instruction.opcode();
+            if (opcode == Instructions::block || opcode == Instructions::loop || opcode == Instructions::if_) {
+                ++m_unreachable_depth;
+                continue;
+            }
+            if (opcode == Instructions::structured_end && m_unreachable_depth > 0) {
+                --m_unreachable_depth;
+                continue;
+            }
+            if (m_unreachable_depth > 0 || (opcode != Instructions::structured_end && opcode != Instructions::structured_else))
+                continue;
+        }
+
+        if (!compile_instruction(instruction))
+            return false;
+    }
+
+    if (m_control.size() != 1)
+        return false;
+    if (!m_control.last().is_unreachable) {
+        if (m_stack.size() != m_type.results().size() || !compile_return())
+            return false;
+    }
+
+    return slot_count() <= NumericLimits<u32>::max();
+}
+
+}
+
+RefPtr<CompiledFunction> CompiledFunction::create(Store& store, ModuleInstance const& module, FunctionType const& type, Module::Function const& function)
+{
+    FunctionCompiler compiler { store, module, type, function };
+    if (!compiler.compile())
+        return nullptr;
+    return adopt_ref(*new CompiledFunction(module, type, compiler.take_instructions(), compiler.local_count(), compiler.slot_count()));
+}
+
+}
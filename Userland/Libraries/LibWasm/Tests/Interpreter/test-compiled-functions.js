@@ -0,0 +1,177 @@
+// Functions are compiled into a register form when they are instantiated, except for those that
+// use instructions only the stack interpreter supports, like memory.init here. The module was
+// assembled from:
+//
+// (module
+//   (type $binary (func (param i32 i32) (result i32)))
+//   (type $unary (func (param i32) (result i32)))
+//   (table 2 funcref)
+//   (memory 1)
+//   (global $counter (mut i32) (i32.const 0))
+//   (elem (i32.const 0) $fib $add)
+//   (data $bytes "\01\02\03\04")
+//   (func $add (export "add") (type $binary)
+//     (i32.add (local.get 0) (local.get 1)))
+//   (func $fib (export "fib") (type $unary)
+//     (if (result i32) (i32.lt_s (local.get 0) (i32.const 2))
+//       (then (local.get 0))
+//       (else (i32.add (call $fib (i32.sub (local.get 0) (i32.const 1)))
+//                      (call $fib (i32.sub (local.get 0) (i32.const 2)))))))
+//   (func (export "sum_to") (param $n i32) (result i64) (local $sum i64)
+//     (block (br_if 0 (i32.eqz (local.get $n)))
+//       (loop
+//         (local.set $sum (i64.add (local.get $sum) (i64.extend_i32_u (local.get $n))))
+//         (br_if 0 (local.tee $n (i32.sub (local.get $n) (i32.const 1))))))
+//     (local.get $sum))
+//   (func (export "classify") (type $unary)
+//     (block (block (block (br_table 0 1 2 (local.get 0)))
+//       (return (i32.const 10)))
+//       (return (i32.const 20)))
+//     (i32.const 30))
+//   (func (export "branch_with_value") (type $unary)
+//     (block (result i32) (drop (br_if 0 (i32.const 1) (local.get 0))) (i32.const 2)))
+//   (func (export "div") (type $binary)
+//     (i32.div_s (local.get 0) (local.get 1)))
+//   (func (export "max") (type $binary)
+//     (select (local.get 0) (local.get 1) (i32.gt_s (local.get 0) (local.get 1))))
+//   (func (export "counter") (result i32)
+//     (global.set $counter (i32.add (global.get $counter) (i32.const 1)))
+//     (global.get $counter))
+//   (func (export "store_load") (type $binary)
+//     (i32.store (local.get 0) (local.get 1))
+//     (i32.load (local.get 0)))
+//   (func (export "grow") (type $unary)
+//     (memory.grow (local.get 0)))
+//   (func (export "call_indirect") (param $index i32) (param $argument i32) (result i32)
+//     (call_indirect (type $unary) (local.get $argument) (local.get $index)))
+//   (func (export "trap")
+//     (unreachable))
+//   (func (export "hypot") (param f64 f64) (result f64)
+//     (f64.sqrt (f64.add (f64.mul (local.get 0) (local.get 0))
+//                        (f64.mul (local.get 1) (local.get 1)))))
+//   (func $sum_bytes (export "sum_bytes") (param $address i32) (param $length i32) (result i32)
+//     (local $sum i32)
+//     (block (br_if 0 (i32.eqz (local.get $length)))
+//       (loop
+//         (local.set $sum (i32.add (local.get $sum) (i32.load8_u (local.get $address))))
+//         (local.set $address (i32.add (local.get $address) (i32.const 1)))
+//         (br_if 0 (local.tee $length (i32.sub (local.get $length) (i32.const 1))))))
+//     (local.get $sum))
+//   (func $init_and_sum (export "init_and_sum") (type $unary)
+//     (memory.init $bytes (local.get 0) (i32.const 0) (i32.const 4))
+//     (call $sum_bytes (local.get 0) (i32.const 4)))
+//   (func (export "call_init_and_sum") (type $unary)
+//     (i32.add (call $init_and_sum (local.get 0)) (i32.const 1000))))
+// prettier-ignore
+const binary = new Uint8Array([
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x25, 0x07, 0x60, 0x02, 0x7f, 0x7f, 0x01,
+    0x7f, 0x60, 0x01, 0x7f, 0x01, 0x7f, 0x60, 0x01, 0x7f, 0x01, 0x7e, 0x60, 0x00, 0x01, 0x7f, 0x60,
+    0x00, 0x00, 0x60, 0x02, 0x7c, 0x7c, 0x01, 0x7c, 0x60, 0x03, 0x7f, 0x7f, 0x7f, 0x01, 0x7f, 0x03,
+    0x11, 0x10, 0x00, 0x01, 0x02, 0x01, 0x01, 0x00, 0x00, 0x03, 0x00, 0x01, 0x00, 0x04, 0x05, 0x00,
+    0x01, 0x01, 0x04, 0x04, 0x01, 0x70, 0x00, 0x02, 0x05, 0x03, 0x01, 0x00, 0x01, 0x06, 0x06, 0x01,
+    0x7f, 0x01, 0x41, 0x00, 0x0b, 0x07, 0xad, 0x01, 0x10, 0x03, 0x61, 0x64, 0x64, 0x00, 0x00, 0x03,
+    0x66, 0x69, 0x62, 0x00, 0x01, 0x06, 0x73, 0x75, 0x6d, 0x5f, 0x74, 0x6f, 0x00, 0x02, 0x08, 0x63,
+    0x6c, 0x61, 0x73, 0x73, 0x69, 0x66, 0x79, 0x00, 0x03, 0x11, 0x62, 0x72, 0x61, 0x6e, 0x63, 0x68,
+    0x5f, 0x77, 0x69, 0x74, 0x68, 0x5f, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x00, 0x04, 0x03, 0x64, 0x69,
+    0x76, 0x00, 0x05, 0x03, 0x6d, 0x61, 0x78, 0x00, 0x06, 0x07, 0x63, 0x6f, 0x75, 0x6e, 0x74, 0x65,
+    0x72, 0x00, 0x07, 0x0a, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x5f, 0x6c, 0x6f, 0x61, 0x64, 0x00, 0x08,
+    0x04, 0x67, 0x72, 0x6f, 0x77, 0x00, 0x09, 0x0d, 0x63, 0x61, 0x6c, 0x6c, 0x5f, 0x69, 0x6e, 0x64,
+    0x69, 0x72, 0x65, 0x63, 0x74, 0x00, 0x0a, 0x04, 0x74, 0x72, 0x61, 0x70, 0x00, 0x0b, 0x05, 0x68,
+    0x79, 0x70, 0x6f, 0x74, 0x00, 0x0c, 0x09, 0x73, 0x75, 0x6d, 0x5f, 0x62, 0x79, 0x74, 0x65, 0x73,
+    0x00, 0x0d, 0x0c, 0x69, 0x6e, 0x69, 0x74, 0x5f, 0x61, 0x6e, 0x64, 0x5f, 0x73, 0x75, 0x6d, 0x00,
+    0x0e, 0x11, 0x63, 0x61, 0x6c, 0x6c, 0x5f, 0x69, 0x6e, 0x69, 0x74, 0x5f, 0x61, 0x6e, 0x64, 0x5f,
+    0x73, 0x75, 0x6d, 0x00, 0x0f, 0x09, 0x08, 0x01, 0x00, 0x41, 0x00, 0x0b, 0x02, 0x01, 0x00, 0x0c,
+    0x01, 0x01, 0x0a, 0x91, 0x02, 0x10, 0x07, 0x00, 0x20, 0x00, 0x20, 0x01, 0x6a, 0x0b, 0x1c, 0x00,
+    0x20, 0x00, 0x41, 0x02, 0x48, 0x04, 0x7f, 0x20, 0x00, 0x05, 0x20, 0x00, 0x41, 0x01, 0x6b, 0x10,
+    0x01, 0x20, 0x00, 0x41, 0x02, 0x6b, 0x10, 0x01, 0x6a, 0x0b, 0x0b, 0x22, 0x01, 0x01, 0x7e, 0x02,
+    0x40, 0x20, 0x00, 0x45, 0x0d, 0x00, 0x03, 0x40, 0x20, 0x01, 0x20, 0x00, 0xad, 0x7c, 0x21, 0x01,
+    0x20, 0x00, 0x41, 0x01, 0x6b, 0x22, 0x00, 0x0d, 0x00, 0x0b, 0x0b, 0x20, 0x01, 0x0b, 0x1a, 0x00,
+    0x02, 0x40, 0x02, 0x40, 0x02, 0x40, 0x20, 0x00, 0x0e, 0x02, 0x00, 0x01, 0x02, 0x0b, 0x41, 0x0a,
+    0x0f, 0x0b, 0x41, 0x14, 0x0f, 0x0b, 0x41, 0x1e, 0x0b, 0x0e, 0x00, 0x02, 0x7f, 0x41, 0x01, 0x20,
+    0x00, 0x0d, 0x00, 0x1a, 0x41, 0x02, 0x0b, 0x0b, 0x07, 0x00, 0x20, 0x00, 0x20, 0x01, 0x6d, 0x0b,
+    0x0c, 0x00, 0x20, 0x00, 0x20, 0x01, 0x20, 0x00, 0x20, 0x01, 0x4a, 0x1b, 0x0b, 0x0b, 0x00, 0x23,
+    0x00, 0x41, 0x01, 0x6a, 0x24, 0x00, 0x23, 0x00, 0x0b, 0x0e, 0x00, 0x20, 0x00, 0x20, 0x01, 0x36,
+    0x02, 0x00, 0x20, 0x00, 0x28, 0x02, 0x00, 0x0b, 0x06, 0x00, 0x20, 0x00, 0x40, 0x00, 0x0b, 0x09,
+    0x00, 0x20, 0x01, 0x20, 0x00, 0x11, 0x01, 0x00, 0x0b, 0x03, 0x00, 0x00, 0x0b, 0x0e, 0x00, 0x20,
+    0x00, 0x20, 0x00, 0xa2, 0x20, 0x01, 0x20, 0x01, 0xa2, 0xa0, 0x9f, 0x0b, 0x2b, 0x01, 0x01, 0x7f,
+    0x02, 0x40, 0x20, 0x01, 0x45, 0x0d, 0x00, 0x03, 0x40, 0x20, 0x02, 0x20, 0x00, 0x2d, 0x00, 0x00,
+    0x6a, 0x21, 0x02, 0x20, 0x00, 0x41, 0x01, 0x6a, 0x21, 0x00, 0x20, 0x01, 0x41, 0x01, 0x6b, 0x22,
+    0x01, 0x0d, 0x00, 0x0b, 0x0b, 0x20, 0x02, 0x0b, 0x12, 0x00, 0x20, 0x00, 0x41, 0x00, 0x41, 0x04,
+    0xfc, 0x08, 0x00, 0x00, 0x20, 0x00, 0x41, 0x04, 0x10, 0x0d, 0x0b, 0x0a, 0x00, 0x20, 0x00, 0x10,
+    0x0e, 0x41, 0xe8, 0x07, 0x6a, 0x0b, 0x0b, 0x07, 0x01, 0x01, 0x04, 0x01, 0x02, 0x03, 0x04,
+]);
+
+const module = parseWebAssemblyModule(binary);
+const call = (name, ...args) => module.invoke(module.getExport(name), ...args);
+
+test("functions are compiled unless they use something only the stack interpreter supports", () => {
+    const compiled = ["add", "fib", "sum_to", "call_indirect", "sum_bytes", "call_init_and_sum"];
+    for (const name of compiled) {
+        expect(isCompiledWasmFunction(module.getExport(name))).toBeTrue();
+    }
+    expect(isCompiledWasmFunction(module.getExport("init_and_sum"))).toBeFalse();
+});
+
+test("arithmetic", () => {
+    expect(call("add", 40, 2)).toBe(42);
+    expect(call("add", 2147483647, 1)).toBe(-2147483648);
+    expect(call("div", -7, 2)).toBe(-3);
+    expect(call("hypot", 3, 4)).toBe(5);
+});
+
+test("calls and recursion", () => {
+    expect(call("fib", 0)).toBe(0);
+    expect(call("fib", 1)).toBe(1);
+    expect(call("fib", 20)).toBe(6765);
+});
+
+test("loops and branches", () => {
+    expect(call("sum_to", 0)).toBe(0n);
+    expect(call("sum_to", 100000)).toBe(5000050000n);
+    expect(call("classify", 0)).toBe(10);
+    expect(call("classify", 1)).toBe(20);
+    expect(call("classify", 2)).toBe(30);
+    expect(call("classify", 3)).toBe(30);
+    expect(call("classify", -1)).toBe(30);
+    expect(call("branch_with_value", 0)).toBe(2);
+    expect(call("branch_with_value", 7)).toBe(1);
+});
+
+test("select and globals", () => {
+    expect(call("max", 3, -4)).toBe(3);
+    expect(call("max", -3, 4)).toBe(4);
+    const first = call("counter");
+    expect(call("counter")).toBe(first + 1);
+});
+
+test("memory", () => {
+    expect(call("store_load", 16, 1234567)).toBe(1234567);
+    expect(() => call("store_load", 65533, 1)).toThrowWithMessage(TypeError, "Execution trapped");
+    expect(call("grow", 1)).toBe(1);
+    expect(call("store_load", 65536, 99)).toBe(99);
+    expect(call("grow", 100000)).toBe(-1);
+});
+
+test("indirect calls", () => {
+    expect(call("call_indirect", 0, 10)).toBe(55);
+    // The table entry has a different signature than the call expects.
+    expect(() => call("call_indirect", 1, 10)).toThrowWithMessage(TypeError, "Execution trapped");
+    expect(() => call("call_indirect", 2, 10)).toThrowWithMessage(TypeError, "Execution trapped");
+});
+
+test("traps", () => {
+    expect(() => call("trap")).toThrowWithMessage(TypeError, "Execution trapped: Unreachable");
+    expect(() => call("div", 1, 0)).toThrowWithMessage(TypeError, "Execution trapped");
+});
+
+test("compiled and stack interpreted functions call each other", () => {
+    expect(call("init_and_sum", 100)).toBe(10);
+    expect(call("call_init_and_sum", 200)).toBe(1010);
+    expect(call("sum_bytes", 200, 4)).toBe(10);
+    // A trap in the stack interpreted callee unwinds through its compiled caller.
+    expect(() => call("call_init_and_sum", 65536 * 16)).toThrowWithMessage(
+        TypeError,
+        "Execution trapped"
+    );
+    expect(call("add", 1, 2)).toBe(3);
+});
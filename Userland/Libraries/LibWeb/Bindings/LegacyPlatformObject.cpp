@@ -13,6 +13,7 @@ namespace Web::Bindings {
 LegacyPlatformObject::LegacyPlatformObject(JS::Object& prototype)
     : PlatformObject(prototype)
 {
+    set_may_interfere_with_property_lookup_cache();
 }
 
 LegacyPlatformObject::~LegacyPlatformObject() = default;
@@ -24,6 +24,7 @@ namespace Web::Bindings {
 LocationObject::LocationObject(JS::Realm& realm)
     : PlatformObject(realm)
 {
+    set_may_interfere_with_property_lookup_cache();
     set_prototype(&cached_web_prototype(realm, "Location"));
 }
 
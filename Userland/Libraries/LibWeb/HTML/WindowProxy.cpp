@@ -23,6 +23,7 @@ namespace Web::HTML {
 WindowProxy::WindowProxy(JS::Realm& realm)
     : JS::Object(realm, nullptr)
 {
+    set_may_interfere_with_property_lookup_cache();
 }
 
 // 7.4.1 [[GetPrototypeOf]] ( ), https://html.spec.whatwg.org/multipage/window-object.html#windowproxy-getprototypeof
@@ -9,7 +9,7 @@
 #include "Mixer.h"
 namespace AudioServer {
 
-// This is in buffer counts.
+// This is in counts of HARDWARE_BUFFER_SIZE samples.
 // As each buffer is approx 1/40 of a second, this means about 1/4 of a second of fade time.
 constexpr int DEFAULT_FADE_TIME = 10;
 
@@ -50,9 +50,10 @@ public:
         return m_old_value * (1 - m_current_fade) + m_new_value * (m_current_fade);
     }
 
-    void advance_time()
+    // Advances the fade by the given number of time steps, which may be fractional.
+    void advance_time(double steps = 1)
     {
-        m_current_fade += 1.0 / static_cast<double>(m_fade_time);
+        m_current_fade += steps / static_cast<double>(m_fade_time);
         m_current_fade = clamp(m_current_fade, 0.0, 1.0);
     }
 
@@ -8,8 +8,6 @@
 #include "Mixer.h"
 #include <AK/Array.h>
 #include <AK/Format.h>
-#include <AK/MemoryStream.h>
-#include <AK/NumericLimits.h>
 #include <AudioServer/ConnectionFromClient.h>
 #include <AudioServer/Mixer.h>
 #include <LibCore/ConfigFile.h>
@@ -30,6 +28,9 @@ Mixer::Mixer(NonnullRefPtr<Core::ConfigFile> config)
           },
           "AudioServer[mixer]"sv))
     , m_config(move(config))
+    , m_period_size(clamp(m_config->read_num_entry<size_t>("Mixer", "PeriodSize", HARDWARE_BUFFER_SIZE), MIN_PERIOD_SIZE, MAX_PERIOD_SIZE))
+    , m_mix_buffer(FixedArray<Audio::Sample>::must_create_but_fixme_should_propagate_errors(m_period_size))
+    , m_output_buffer(FixedArray<i16>::must_create_but_fixme_should_propagate_errors(m_period_size * 2))
 {
     if (!m_device->open(Core::OpenMode::WriteOnly)) {
         dbgln("Can't open audio device: {}", m_device->error_string());
@@ -48,6 +49,7 @@ NonnullRefPtr<ClientAudioStream> Mixer::create_queue(ConnectionFromClient& clien
     {
         Threading::MutexLocker const locker(m_pending_mutex);
         m_pending_mixing.append(*queue);
+        m_has_pending_mixing.store(true, AK::MemoryOrder::memory_order_release);
     }
     // Signal the mixer thread to start back up, in case nobody was connected before.
     m_mixing_necessary.signal();
@@ -59,8 +61,14 @@ void Mixer::mix()
 {
     decltype(m_pending_mixing) active_mix_queues;
 
+    // Fades are specified in periods of the default size.
+    auto const fade_steps_per_period = static_cast<double>(m_period_size) / static_cast<double>(HARDWARE_BUFFER_SIZE);
+    auto const headroom_gain = Audio::log_volume_to_gain(SAMPLE_HEADROOM);
+    auto const output_size_in_bytes = static_cast<int>(m_output_buffer.size() * sizeof(i16));
+
     for (;;) {
-        {
+        // Only take the lock if there are new streams, or if we have to wait for some.
+        if (active_mix_queues.is_empty() || m_has_pending_mixing.load(AK::MemoryOrder::memory_order_acquire)) {
             Threading::MutexLocker const locker(m_pending_mutex);
             // While we have nothing to mix, wait on the condition.
             m_mixing_necessary.wait_while([this, &active_mix_queues]() { return m_pending_mixing.is_empty() && active_mix_queues.is_empty(); });
@@ -68,13 +76,14 @@ void Mixer::mix()
                 active_mix_queues.extend(move(m_pending_mixing));
                 m_pending_mixing.clear();
             }
+            m_has_pending_mixing.store(false, AK::MemoryOrder::memory_order_relaxed);
         }
 
         active_mix_queues.remove_all_matching([&](auto& entry) { return !entry->is_connected(); });
 
-        Array<Audio::Sample, HARDWARE_BUFFER_SIZE> mixed_buffer;
+        m_mix_buffer.fill_with({});
 
-        m_main_volume.advance_time();
+        m_main_volume.advance_time(fade_steps_per_period);
 
         // Mix the buffers together into the output
         for (auto& queue : active_mix_queues) {
@@ -82,42 +91,22 @@ void Mixer::mix()
                 queue->clear();
                 continue;
             }
-            queue->volume().advance_time();
-
-            for (auto& mixed_sample : mixed_buffer) {
-                Audio::Sample sample;
-                if (!queue->get_next_sample(sample))
-                    break;
-                if (queue->is_muted())
-                    continue;
-                sample.log_multiply(SAMPLE_HEADROOM);
-                sample.log_multiply(static_cast<float>(queue->volume()));
-                mixed_sample += sample;
-            }
+            queue->volume().advance_time(fade_steps_per_period);
+
+            // The volume only changes between periods, so the gain is the same for every sample of this one.
+            float gain = 0;
+            if (!queue->is_muted())
+                gain = headroom_gain * Audio::log_volume_to_gain(static_cast<float>(queue->volume()));
+            queue->mix_into(m_mix_buffer.span(), gain);
         }
 
         // Even though it's not realistic, the user expects no sound at 0%.
-        if (m_muted || m_main_volume < 0.01) {
-            m_device->write(m_zero_filled_buffer.data(), static_cast<int>(m_zero_filled_buffer.size()));
-        } else {
-            OutputMemoryStream stream { m_stream_buffer };
-
-            for (auto& mixed_sample : mixed_buffer) {
-                mixed_sample.log_multiply(static_cast<float>(m_main_volume));
-                mixed_sample.clip();
+        if (m_muted || m_main_volume < 0.01)
+            m_output_buffer.fill_with(0);
+        else
+            Audio::convert_to_i16(m_output_buffer.span(), m_mix_buffer.span(), Audio::log_volume_to_gain(static_cast<float>(m_main_volume)));
 
-                LittleEndian<i16> out_sample;
-                out_sample = static_cast<i16>(mixed_sample.left * NumericLimits<i16>::max());
-                stream << out_sample;
-
-                out_sample = static_cast<i16>(mixed_sample.right * NumericLimits<i16>::max());
-                stream << out_sample;
-            }
-
-            VERIFY(stream.is_end());
-            VERIFY(!stream.has_any_error());
-            m_device->write(stream.data(), static_cast<int>(stream.size()));
-        }
+        m_device->write(reinterpret_cast<u8 const*>(m_output_buffer.data()), output_size_in_bytes);
     }
 }
 
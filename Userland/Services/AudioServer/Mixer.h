@@ -12,10 +12,12 @@
 #include <AK/Atomic.h>
 #include <AK/Badge.h>
 #include <AK/ByteBuffer.h>
+#include <AK/FixedArray.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/Queue.h>
 #include <AK/RefCounted.h>
 #include <AK/WeakPtr.h>
+#include <LibAudio/Mixing.h>
 #include <LibAudio/Queue.h>
 #include <LibCore/File.h>
 #include <LibCore/Timer.h>
@@ -29,10 +31,11 @@ namespace AudioServer {
 // Headroom, i.e. fixed attenuation for all audio streams.
 // This is to prevent clipping when two streams with low headroom (e.g. normalized & compressed) are playing.
 constexpr double SAMPLE_HEADROOM = 0.95;
-// The size of the buffer in samples that the hardware receives through write() calls to the audio device.
+// The default size of the buffer in samples that the hardware receives through write() calls to the audio device.
+// This can be changed with the PeriodSize key of the [Mixer] group in the config; smaller periods reduce latency.
 constexpr size_t HARDWARE_BUFFER_SIZE = 512;
-// The hardware buffer size in bytes; there's two channels of 16-bit samples.
-constexpr size_t HARDWARE_BUFFER_SIZE_BYTES = HARDWARE_BUFFER_SIZE * 2 * sizeof(i16);
+constexpr size_t MIN_PERIOD_SIZE = 64;
+constexpr size_t MAX_PERIOD_SIZE = 4096;
 
 class ConnectionFromClient;
 
@@ -41,32 +44,40 @@ public:
     explicit ClientAudioStream(ConnectionFromClient&);
     ~ClientAudioStream() = default;
 
-    bool get_next_sample(Audio::Sample& sample)
+    // Adds the next samples of the stream, multiplied by the gain, to the destination.
+    // A gain of zero skips the samples without mixing them.
+    void mix_into(Span<Audio::Sample> destination, float gain)
     {
         if (m_paused)
-            return false;
-
-        if (m_in_chunk_location >= m_current_audio_chunk.size()) {
-            auto result = m_buffer->try_dequeue();
-            if (result.is_error()) {
-                if (result.error() == Audio::AudioQueue::QueueStatus::Empty) {
-                    dbgln("Audio client {} can't keep up!", m_client->client_id());
-                    // Note: Even though we only check client state here, we will probably close the client much earlier.
-                    if (!m_client->is_open()) {
-                        dbgln("Client socket {} has closed, closing audio server connection.", m_client->client_id());
-                        m_client->shutdown();
+            return;
+
+        size_t mixed_samples = 0;
+        while (mixed_samples < destination.size()) {
+            if (m_in_chunk_location >= m_current_audio_chunk.size()) {
+                // The client hands us chunks through a lock-free queue in shared memory, so this never blocks.
+                auto result = m_buffer->try_dequeue();
+                if (result.is_error()) {
+                    if (result.error() == Audio::AudioQueue::QueueStatus::Empty) {
+                        dbgln("Audio client {} can't keep up!", m_client->client_id());
+                        // Note: Even though we only check client state here, we will probably close the client much earlier.
+                        if (!m_client->is_open()) {
+                            dbgln("Client socket {} has closed, closing audio server connection.", m_client->client_id());
+                            m_client->shutdown();
+                        }
                     }
-                }
 
-                return false;
+                    return;
+                }
+                m_current_audio_chunk = result.release_value();
+                m_in_chunk_location = 0;
             }
-            m_current_audio_chunk = result.release_value();
-            m_in_chunk_location = 0;
-        }
 
-        sample = m_current_audio_chunk[m_in_chunk_location++];
-
-        return true;
+            auto sample_count = min(m_current_audio_chunk.size() - m_in_chunk_location, destination.size() - mixed_samples);
+            if (gain != 0)
+                Audio::mix_into(destination.slice(mixed_samples, sample_count), m_current_audio_chunk.span().slice(m_in_chunk_location, sample_count), gain);
+            m_in_chunk_location += sample_count;
+            mixed_samples += sample_count;
+        }
     }
 
     bool is_connected() const { return m_client && m_client->is_open(); }
@@ -94,7 +105,7 @@ public:
 private:
     OwnPtr<Audio::AudioQueue> m_buffer;
     Array<Audio::Sample, Audio::AUDIO_BUFFER_SIZE> m_current_audio_chunk;
-    size_t m_in_chunk_location;
+    size_t m_in_chunk_location { Audio::AUDIO_BUFFER_SIZE };
 
     bool m_paused { true };
     bool m_muted { false };
@@ -126,6 +137,8 @@ private:
     void request_setting_sync();
 
     Vector<NonnullRefPtr<ClientAudioStream>> m_pending_mixing;
+    // Lets the mixer thread check for new streams without taking the mutex every period.
+    Atomic<bool> m_has_pending_mixing { false };
     Threading::Mutex m_pending_mutex;
     Threading::ConditionVariable m_mixing_necessary { m_pending_mutex };
 
@@ -139,8 +152,10 @@ private:
     NonnullRefPtr<Core::ConfigFile> m_config;
     RefPtr<Core::Timer> m_config_write_timer;
 
-    Array<u8, HARDWARE_BUFFER_SIZE_BYTES> m_stream_buffer;
-    Array<u8, HARDWARE_BUFFER_SIZE_BYTES> const m_zero_filled_buffer {};
+    size_t m_period_size { HARDWARE_BUFFER_SIZE };
+    FixedArray<Audio::Sample> m_mix_buffer;
+    // Two channels of 16-bit samples.
+    FixedArray<i16> m_output_buffer;
 
     void mix();
 };
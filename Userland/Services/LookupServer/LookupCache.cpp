@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "LookupCache.h"
+#include <AK/Debug.h>
+
+namespace LookupServer {
+
+LookupCache::LookupCache(size_t max_entries, u32 negative_ttl)
+    : m_max_entries(max_entries)
+    , m_negative_ttl(negative_ttl)
+{
+    VERIFY(m_max_entries > 0);
+}
+
+bool LookupCache::Entry::remove_expired(time_t now)
+{
+    answers.remove_all_matching([&](auto& answer) { return now >= answer.received_time() + answer.ttl(); });
+    negative_answers.remove_all_matching([&](auto& negative_answer) { return now >= negative_answer.expiry_time; });
+    return !answers.is_empty() || !negative_answers.is_empty();
+}
+
+Optional<Vector<Answer>> LookupCache::lookup(Name const& name, RecordType record_type)
+{
+    auto it = m_entries.find(name);
+    if (it == m_entries.end()) {
+        ++m_statistics.misses;
+        return {};
+    }
+
+    auto& entry = *it->value;
+    if (!entry.remove_expired(time(nullptr))) {
+        remove_entry(entry);
+        ++m_statistics.misses;
+        return {};
+    }
+
+    m_lru_list.prepend(entry);
+
+    Vector<Answer> answers;
+    for (auto& answer : entry.answers) {
+        if (answer.type() == record_type)
+            answers.append(answer);
+    }
+    if (!answers.is_empty()) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {} answer(s)", name.as_string(), answers.size());
+        ++m_statistics.hits;
+        return answers;
+    }
+
+    if (!entry.negative_answers.find_if([&](auto& negative_answer) { return negative_answer.type == record_type; }).is_end()) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "Negative cache hit: {} has no {} records", name.as_string(), record_type);
+        ++m_statistics.negative_hits;
+        return answers;
+    }
+
+    ++m_statistics.misses;
+    return {};
+}
+
+LookupCache::Entry& LookupCache::ensure_entry(Name const& name)
+{
+    if (auto it = m_entries.find(name); it != m_entries.end()) {
+        m_lru_list.prepend(*it->value);
+        return *it->value;
+    }
+
+    if (m_entries.size() >= m_max_entries) {
+        auto& least_recently_used = *m_lru_list.last();
+        dbgln_if(LOOKUPSERVER_DEBUG, "Evicting cache entry: {}", least_recently_used.name.as_string());
+        remove_entry(least_recently_used);
+        ++m_statistics.evictions;
+    }
+
+    auto entry = make<Entry>(name);
+    auto& entry_ref = *entry;
+    m_lru_list.prepend(entry_ref);
+    m_entries.set(name, move(entry));
+    return entry_ref;
+}
+
+void LookupCache::remove_entry(Entry& entry)
+{
+    m_lru_list.remove(entry);
+    auto name = entry.name;
+    m_entries.remove(name);
+}
+
+void LookupCache::put(Answer const& answer)
+{
+    if (answer.has_expired())
+        return;
+
+    auto& entry = ensure_entry(answer.name());
+
+    if (answer.mdns_cache_flush()) {
+        auto now = time(nullptr);
+
+        entry.answers.remove_all_matching([&](Answer const& other_answer) {
+            if (other_answer.type() != answer.type() || other_answer.class_code() != answer.class_code())
+                return false;
+
+            if (other_answer.received_time() >= now - 1)
+                return false;
+
+            dbgln_if(LOOKUPSERVER_DEBUG, "Removing cache entry: {}", other_answer.name());
+            return true;
+        });
+    }
+
+    // A fresh copy of a record we already have only needs to take over its TTL.
+    entry.answers.remove_all_matching([&](Answer const& other_answer) {
+        return other_answer.type() == answer.type() && other_answer.class_code() == answer.class_code() && other_answer.record_data() == answer.record_data();
+    });
+    entry.answers.append(answer);
+
+    entry.negative_answers.remove_all_matching([&](auto& negative_answer) { return negative_answer.type == answer.type(); });
+}
+
+void LookupCache::put_negative(Name const& name, RecordType record_type)
+{
+    if (m_negative_ttl == 0)
+        return;
+
+    auto& entry = ensure_entry(name);
+    auto expiry_time = time(nullptr) + m_negative_ttl;
+    for (auto& negative_answer : entry.negative_answers) {
+        if (negative_answer.type == record_type) {
+            negative_answer.expiry_time = expiry_time;
+            return;
+        }
+    }
+    entry.negative_answers.append({ record_type, expiry_time });
+}
+
+void LookupCache::remove_expired()
+{
+    auto now = time(nullptr);
+    Vector<Entry&> expired_entries;
+    for (auto& entry : m_lru_list) {
+        if (!entry.remove_expired(now))
+            expired_entries.append(entry);
+    }
+    for (auto& entry : expired_entries)
+        remove_entry(entry);
+}
+
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibDNS/Answer.h>
+#include <LibDNS/Name.h>
+#include <time.h>
+
+namespace LookupServer {
+
+using namespace DNS;
+
+// Holds the answers we got from nameservers until their TTL runs out, along with the record types
+// that names are known not to have (NXDOMAIN, or no answers of that type), for a short while.
+// Once the cache is full, the names that were looked up least recently are evicted first.
+class LookupCache {
+public:
+    struct Statistics {
+        u64 hits { 0 };
+        u64 negative_hits { 0 };
+        u64 misses { 0 };
+        u64 evictions { 0 };
+    };
+
+    LookupCache(size_t max_entries, u32 negative_ttl);
+
+    // Returns the unexpired answers of the given type, an empty vector if the name is known not to have
+    // any, or nothing if we'll have to ask.
+    Optional<Vector<Answer>> lookup(Name const&, RecordType);
+
+    void put(Answer const&);
+    void put_negative(Name const&, RecordType);
+
+    void remove_expired();
+
+    size_t size() const { return m_entries.size(); }
+    Statistics const& statistics() const { return m_statistics; }
+
+private:
+    struct NegativeAnswer {
+        RecordType type;
+        time_t expiry_time;
+    };
+
+    struct Entry {
+        explicit Entry(Name const& name)
+            : name(name)
+        {
+        }
+
+        // Drops whatever has expired by now, and returns whether anything is left.
+        bool remove_expired(time_t now);
+
+        Name name;
+        Vector<Answer> answers;
+        Vector<NegativeAnswer, 1> negative_answers;
+        IntrusiveListNode<Entry> lru_node;
+    };
+
+    Entry& ensure_entry(Name const&);
+    void remove_entry(Entry&);
+
+    size_t m_max_entries { 0 };
+    u32 m_negative_ttl { 0 };
+
+    HashMap<Name, NonnullOwnPtr<Entry>, Name::Traits> m_entries;
+    // Most recently used first.
+    IntrusiveList<&Entry::lru_node> m_lru_list;
+
+    Statistics m_statistics;
+};
+
+}
@@ -25,6 +25,10 @@ namespace LookupServer {
 static LookupServer* s_the;
 // NOTE: This is the TTL we return for the hostname or answers from /etc/hosts.
 static constexpr u32 s_static_ttl = 86400;
+// How long we remember that a name doesn't exist, or doesn't have records of some type, by default.
+// RFC 2308 would have us use the SOA record from the authority section, but we don't parse those.
+static constexpr u32 s_default_negative_ttl = 60;
+static constexpr size_t s_default_cache_size = 1024;
 
 LookupServer& LookupServer::the()
 {
@@ -41,6 +45,14 @@ LookupServer::LookupServer()
     dbgln("Using network config file at {}", config->filename());
     m_nameservers = config->read_entry("DNS", "Nameservers", "1.1.1.1,1.0.0.1").split(',');
 
+    auto cache_size = max<size_t>(config->read_num_entry<size_t>("DNS", "CacheSize", s_default_cache_size), 1);
+    auto negative_ttl = config->read_num_entry<u32>("DNS", "NegativeCacheTTL", s_default_negative_ttl);
+    m_lookup_cache = make<LookupCache>(cache_size, negative_ttl);
+
+    // Expired answers are skipped on lookup anyway, this just gives back their memory.
+    m_cache_cleanup_timer = Core::Timer::create_repeating(60 * 1000, [this] { m_lookup_cache->remove_expired(); }, this);
+    m_cache_cleanup_timer->start();
+
     load_etc_hosts();
 
     auto maybe_file_watcher = Core::FileWatcher::create();
@@ -169,23 +181,19 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, RecordType record
     }
 
     // Third, try our cache.
-    if (auto cached_answers = m_lookup_cache.find(name); cached_answers != m_lookup_cache.end()) {
-        for (auto& answer : cached_answers->value) {
-            // TODO: Actually remove expired answers from the cache.
-            if (answer.type() == record_type && !answer.has_expired()) {
-                dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
-                add_answer(answer);
-            }
-        }
-        if (!answers.is_empty())
-            return answers;
+    // NOTE: Requests are handled one at a time, so when several clients ask for the same name at once,
+    //       only the first one goes out to the network and the others are answered from here.
+    if (auto cached_answers = m_lookup_cache->lookup(name, record_type); cached_answers.has_value()) {
+        for (auto& answer : *cached_answers)
+            add_answer(answer);
+        return answers;
     }
 
     // Fourth, look up .local names using mDNS instead of DNS nameservers.
     if (name.as_string().ends_with(".local"sv)) {
         answers = TRY(m_mdns->lookup(name, record_type));
         for (auto& answer : answers)
-            put_in_cache(answer);
+            m_lookup_cache->put(answer);
         return answers;
     }
 
@@ -287,14 +295,24 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, DeprecatedString
         }
     }
 
+    // Only cache the name as nonexistent once we know the response is for the question we asked. Otherwise,
+    // a single spoofed NXDOMAIN response would make the name unresolvable until the negative entry expires.
+    if (response.code() == Packet::Code::NXDOMAIN) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "LookupServer: '{}' does not exist", name.as_string());
+        m_lookup_cache->put_negative(name, record_type);
+        return Vector<Answer> {};
+    }
+
     if (response.answer_count() < 1) {
         dbgln("LookupServer: No answers :(");
+        if (response.code() == Packet::Code::NOERROR)
+            m_lookup_cache->put_negative(name, record_type);
         return Vector<Answer> {};
     }
 
     Vector<Answer, 8> answers;
     for (auto& answer : response.answers()) {
-        put_in_cache(answer);
+        m_lookup_cache->put(answer);
         if (answer.type() != record_type)
             continue;
         answers.append(answer);
@@ -303,36 +321,4 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, DeprecatedString
     return answers;
 }
 
-void LookupServer::put_in_cache(Answer const& answer)
-{
-    if (answer.has_expired())
-        return;
-
-    // Prevent the cache from growing too big.
-    // TODO: Evict least used entries.
-    if (m_lookup_cache.size() >= 256)
-        m_lookup_cache.remove(m_lookup_cache.begin());
-
-    auto it = m_lookup_cache.find(answer.name());
-    if (it == m_lookup_cache.end())
-        m_lookup_cache.set(answer.name(), { answer });
-    else {
-        if (answer.mdns_cache_flush()) {
-            auto now = time(nullptr);
-
-            it->value.remove_all_matching([&](Answer const& other_answer) {
-                if (other_answer.type() != answer.type() || other_answer.class_code() != answer.class_code())
-                    return false;
-
-                if (other_answer.received_time() >= now - 1)
-                    return false;
-
-                dbgln_if(LOOKUPSERVER_DEBUG, "Removing cache entry: {}", other_answer.name());
-                return true;
-            });
-        }
-        it->value.append(answer);
-    }
-}
-
 }
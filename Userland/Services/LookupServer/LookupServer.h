@@ -8,9 +8,11 @@
 
 #include "ConnectionFromClient.h"
 #include "DNSServer.h"
+#include "LookupCache.h"
 #include "MulticastDNS.h"
 #include <LibCore/FileWatcher.h>
 #include <LibCore/Object.h>
+#include <LibCore/Timer.h>
 #include <LibDNS/Name.h>
 #include <LibDNS/Packet.h>
 #include <LibIPC/MultiServer.h>
@@ -26,11 +28,12 @@ public:
     static LookupServer& the();
     ErrorOr<Vector<Answer>> lookup(Name const& name, RecordType record_type);
 
+    LookupCache const& cache() const { return *m_lookup_cache; }
+
 private:
     LookupServer();
 
     void load_etc_hosts();
-    void put_in_cache(Answer const&);
 
     ErrorOr<Vector<Answer>> lookup(Name const& hostname, DeprecatedString const& nameserver, bool& did_get_response, RecordType record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
 
@@ -40,7 +43,8 @@ private:
     Vector<DeprecatedString> m_nameservers;
     RefPtr<Core::FileWatcher> m_file_watcher;
     HashMap<Name, Vector<Answer>, Name::Traits> m_etc_hosts;
-    HashMap<Name, Vector<Answer>, Name::Traits> m_lookup_cache;
+    OwnPtr<LookupCache> m_lookup_cache;
+    RefPtr<Core::Timer> m_cache_cleanup_timer;
 };
 
 }
@@ -14,6 +14,15 @@ namespace RequestServer::ConnectionCache {
 HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<Core::Stream::TCPSocket, Core::Stream::Socket>>>> g_tcp_connection_cache {};
 HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<TLS::TLSv12>>>> g_tls_connection_cache {};
 
+size_t g_max_concurrent_connections_per_origin = 6;
+size_t g_connection_keep_alive_time_milliseconds = 10'000;
+
+void load_configuration(Core::ConfigFile const& config)
+{
+    g_max_concurrent_connections_per_origin = max<size_t>(config.read_num_entry<size_t>("Connections", "MaxPerOrigin", g_max_concurrent_connections_per_origin), 1);
+    g_connection_keep_alive_time_milliseconds = config.read_num_entry<size_t>("Connections", "KeepAliveTimeMilliseconds", g_connection_keep_alive_time_milliseconds);
+}
+
 void request_did_finish(URL const& url, Core::Stream::Socket const* socket)
 {
     if (!socket) {
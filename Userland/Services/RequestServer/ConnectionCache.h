@@ -12,6 +12,7 @@
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/URL.h>
 #include <AK/Vector.h>
+#include <LibCore/ConfigFile.h>
 #include <LibCore/ElapsedTimer.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/NetworkJob.h>
@@ -127,8 +128,11 @@ extern HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<TLS::
 void request_did_finish(URL const&, Core::Stream::Socket const*);
 void dump_jobs();
 
-constexpr static size_t MaxConcurrentConnectionsPerURL = 4;
-constexpr static size_t ConnectionKeepAliveTimeMilliseconds = 10'000;
+// These can be configured in the [Connections] group of /etc/RequestServer.ini.
+extern size_t g_max_concurrent_connections_per_origin;
+extern size_t g_connection_keep_alive_time_milliseconds;
+
+void load_configuration(Core::ConfigFile const&);
 
 template<typename T>
 ErrorOr<void> recreate_socket_if_needed(T& connection, URL const& url)
@@ -179,10 +183,12 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job,
     Proxy proxy { proxy_data };
 
     using ReturnType = decltype(&sockets_for_url[0]);
-    auto it = sockets_for_url.find_if([](auto& connection) { return connection->request_queue.is_empty(); });
+    // Reuse an idle kept-alive connection if there is one, as that saves us the TCP and TLS handshakes.
+    // Otherwise, open another connection rather than queueing behind a busy one, as long as the origin's limit allows it.
+    auto it = sockets_for_url.find_if([](auto& connection) { return !connection->has_started; });
     auto did_add_new_connection = false;
     auto failed_to_find_a_socket = it.is_end();
-    if (failed_to_find_a_socket && sockets_for_url.size() < ConnectionCache::MaxConcurrentConnectionsPerURL) {
+    if (failed_to_find_a_socket && sockets_for_url.size() < ConnectionCache::g_max_concurrent_connections_per_origin) {
         using ConnectionType = RemoveCVReference<decltype(cache.begin()->value->at(0))>;
         auto connection_result = proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url);
         if (connection_result.is_error()) {
@@ -203,7 +209,7 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job,
         sockets_for_url.append(make<ConnectionType>(
             socket_result.release_value(),
             typename ConnectionType::QueueType {},
-            Core::Timer::create_single_shot(ConnectionKeepAliveTimeMilliseconds, nullptr)));
+            Core::Timer::create_single_shot(g_connection_keep_alive_time_milliseconds, nullptr)));
         sockets_for_url.last().proxy = move(proxy);
         did_add_new_connection = true;
     }
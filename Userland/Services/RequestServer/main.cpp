@@ -5,12 +5,14 @@
  */
 
 #include <AK/OwnPtr.h>
+#include <LibCore/ConfigFile.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalServer.h>
 #include <LibCore/System.h>
 #include <LibIPC/SingleServer.h>
 #include <LibMain/Main.h>
 #include <LibTLS/Certificate.h>
+#include <RequestServer/ConnectionCache.h>
 #include <RequestServer/ConnectionFromClient.h>
 #include <RequestServer/GeminiProtocol.h>
 #include <RequestServer/HttpProtocol.h>
@@ -36,6 +38,9 @@ ErrorOr<int> serenity_main(Main::Arguments)
     // Ensure the certificates are read out here.
     [[maybe_unused]] auto& certs = DefaultRootCACertificates::the();
 
+    auto config = TRY(Core::ConfigFile::open_for_system("RequestServer"));
+    RequestServer::ConnectionCache::load_configuration(*config);
+
     Core::EventLoop event_loop;
     // FIXME: Establish a connection to LookupServer and then drop "unix"?
     TRY(Core::System::unveil("/tmp/portal/lookup", "rw"));
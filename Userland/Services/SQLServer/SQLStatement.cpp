@@ -72,6 +72,11 @@ Optional<SQL::ExecutionID> SQLStatement::execute(Vector<SQL::Value> placeholder_
     m_ongoing_executions.set(execution_id);
 
     deferred_invoke([this, placeholder_values = move(placeholder_values), execution_id] {
+        if (is<SQL::AST::Select>(*m_statement)) {
+            execute_select(execution_id, placeholder_values);
+            return;
+        }
+
         auto execution_result = m_statement->execute(connection()->database(), placeholder_values);
         m_ongoing_executions.remove(execution_id);
 
@@ -108,6 +113,42 @@ Optional<SQL::ExecutionID> SQLStatement::execute(Vector<SQL::Value> placeholder_
     return execution_id;
 }
 
+// Rows of a SELECT are produced as they are sent, so the client gets the first
+// rows without waiting for the whole result, and the result is never held in memory.
+void SQLStatement::execute_select(SQL::ExecutionID execution_id, Vector<SQL::Value> placeholder_values)
+{
+    auto cursor_or_error = SQL::SelectCursor::create(static_ptr_cast<SQL::AST::Select const>(m_statement), connection()->database(), move(placeholder_values));
+    if (cursor_or_error.is_error()) {
+        m_ongoing_executions.remove(execution_id);
+        report_error(cursor_or_error.release_error(), execution_id);
+        return;
+    }
+
+    auto cursor = cursor_or_error.release_value();
+    auto first_row = cursor->next();
+    m_ongoing_executions.remove(execution_id);
+
+    if (first_row.is_error()) {
+        report_error(first_row.release_error(), execution_id);
+        return;
+    }
+
+    auto client_connection = ConnectionFromClient::client_connection_for(connection()->client_id());
+    if (!client_connection) {
+        warnln("Cannot return statement execution results. Client disconnected");
+        return;
+    }
+
+    auto row = first_row.release_value();
+    if (!row.has_value()) {
+        client_connection->async_execution_success(statement_id(), execution_id, false, 0, 0, 0);
+        return;
+    }
+
+    client_connection->async_execution_success(statement_id(), execution_id, true, 0, 0, 0);
+    next(execution_id, move(cursor), row.release_value(), 0);
+}
+
 bool SQLStatement::should_send_result_rows(SQL::ResultSet const& result) const
 {
     if (result.is_empty())
@@ -142,4 +183,30 @@ void SQLStatement::next(SQL::ExecutionID execution_id, SQL::ResultSet result, si
     }
 }
 
+void SQLStatement::next(SQL::ExecutionID execution_id, NonnullOwnPtr<SQL::SelectCursor> cursor, SQL::Tuple row, size_t result_size)
+{
+    auto client_connection = ConnectionFromClient::client_connection_for(connection()->client_id());
+    if (!client_connection) {
+        warnln("Cannot yield next result. Client disconnected");
+        return;
+    }
+
+    client_connection->async_next_result(statement_id(), execution_id, row.take_data());
+    ++result_size;
+
+    auto next_row = cursor->next();
+    if (next_row.is_error()) {
+        report_error(next_row.release_error(), execution_id);
+        return;
+    }
+
+    if (auto row = next_row.release_value(); row.has_value()) {
+        deferred_invoke([this, execution_id, cursor = move(cursor), row = row.release_value(), result_size]() mutable {
+            next(execution_id, move(cursor), move(row), result_size);
+        });
+    } else {
+        client_connection->async_results_exhausted(statement_id(), execution_id, result_size);
+    }
+}
+
 }
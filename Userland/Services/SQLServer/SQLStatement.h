@@ -7,10 +7,12 @@
 #pragma once
 
 #include <AK/DeprecatedString.h>
+#include <AK/NonnullOwnPtr.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/Vector.h>
 #include <LibCore/Object.h>
 #include <LibSQL/AST/AST.h>
+#include <LibSQL/QueryPlan.h>
 #include <LibSQL/Result.h>
 #include <LibSQL/ResultSet.h>
 #include <LibSQL/Type.h>
@@ -36,6 +38,9 @@ private:
 
     bool should_send_result_rows(SQL::ResultSet const& result) const;
     void next(SQL::ExecutionID execution_id, SQL::ResultSet result, size_t result_size);
+
+    void execute_select(SQL::ExecutionID execution_id, Vector<SQL::Value> placeholder_values);
+    void next(SQL::ExecutionID execution_id, NonnullOwnPtr<SQL::SelectCursor> cursor, SQL::Tuple row, size_t result_size);
     void report_error(SQL::Result, SQL::ExecutionID execution_id);
 
     SQL::StatementID m_statement_id { 0 };
@@ -15,10 +15,11 @@
 #include <AK/URL.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/DirIterator.h>
+#include <LibCore/EventLoop.h>
 #include <LibCore/File.h>
-#include <LibCore/FileStream.h>
 #include <LibCore/MappedFile.h>
 #include <LibCore/MimeData.h>
+#include <LibCore/System.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 #include <WebServer/Client.h>
@@ -29,9 +30,14 @@
 
 namespace WebServer {
 
-Client::Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket> socket, Core::Object* parent)
+// How long a kept-alive connection may stay idle before we close it.
+static constexpr int keep_alive_timeout_seconds = 5;
+
+Client::Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket> socket, int socket_fd, Threading::ThreadPool& thread_pool, Core::Object* parent)
     : Core::Object(parent)
     , m_socket(move(socket))
+    , m_socket_fd(socket_fd)
+    , m_thread_pool(thread_pool)
 {
 }
 
@@ -43,7 +49,11 @@ void Client::die()
 
 void Client::start()
 {
+    m_idle_timer = Core::Timer::create_single_shot(keep_alive_timeout_seconds * 1000, [this] { die(); }, this);
+
     m_socket->on_ready_to_read = [this] {
+        m_idle_timer->stop();
+
         StringBuilder builder;
 
         auto maybe_buffer = ByteBuffer::create_uninitialized(m_socket->buffer_size());
@@ -81,16 +91,45 @@ void Client::start()
             builder.append("\r\n"sv);
         }
 
+        if (!m_socket->is_open())
+            return;
+
         auto request = builder.to_byte_buffer();
         dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", DeprecatedString::copy(request));
 
-        auto maybe_did_handle = handle_request(request);
-        if (maybe_did_handle.is_error()) {
-            warnln("Failed to handle the request: {}", maybe_did_handle.error());
-        }
+        // Opening, reading and sending the file may block, so that happens on the thread pool while
+        // this thread goes on accepting and reading from other clients. We don't look at the socket
+        // again until the response has been sent.
+        m_socket->set_notifications_enabled(false);
+        auto& event_loop = Core::EventLoop::current();
+        m_thread_pool.submit([this, &event_loop, request = move(request)] {
+            auto maybe_keep_alive = handle_request(request);
+            if (maybe_keep_alive.is_error())
+                warnln("Failed to handle the request: {}", maybe_keep_alive.error());
+
+            bool keep_alive = !maybe_keep_alive.is_error() && maybe_keep_alive.value();
+            event_loop.deferred_invoke([this, keep_alive] { did_handle_request(keep_alive); });
+            // The event loop is most likely blocked waiting on sockets, and posting alone doesn't wake it up.
+            event_loop.wake();
+        });
+    };
+}
 
+void Client::did_handle_request(bool keep_alive)
+{
+    if (!keep_alive || !m_socket->is_open()) {
         die();
-    };
+        return;
+    }
+
+    m_socket->set_notifications_enabled(true);
+    m_idle_timer->restart();
+}
+
+static bool wants_keep_alive(HTTP::HttpRequest const& request)
+{
+    auto it = request.headers().find_if([](auto& header) { return header.name.equals_ignoring_case("Connection"sv); });
+    return !it.is_end() && it->value.trim_whitespace().equals_ignoring_case("keep-alive"sv);
 }
 
 ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
@@ -100,6 +139,7 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
         return false;
     auto& request = request_or_error.value();
     auto resource_decoded = URL::percent_decode(request.resource());
+    m_keep_alive = wants_keep_alive(request);
 
     if constexpr (WEBSERVER_DEBUG) {
         dbgln("Got HTTP request: {} {}", request.method_name(), request.resource());
@@ -110,7 +150,7 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
 
     if (request.method() != HTTP::HttpRequest::Method::GET) {
         TRY(send_error_response(501, request));
-        return false;
+        return m_keep_alive;
     }
 
     // Check for credentials if they are required
@@ -121,7 +161,7 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
             Vector<String> headers {};
             TRY(headers.try_append(basic_auth_header));
             TRY(send_error_response(401, request, move(headers)));
-            return false;
+            return m_keep_alive;
         }
     }
 
@@ -141,7 +181,7 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
             red.append("/"sv);
 
             TRY(send_redirect(red.to_deprecated_string(), request));
-            return true;
+            return m_keep_alive;
         }
 
         StringBuilder index_html_path_builder;
@@ -150,7 +190,7 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
         auto index_html_path = TRY(index_html_path_builder.to_string());
         if (!Core::File::exists(index_html_path)) {
             TRY(handle_directory_listing(requested_path, real_path, request));
-            return true;
+            return m_keep_alive;
         }
         real_path = index_html_path;
     }
@@ -158,25 +198,23 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
     auto file = Core::File::construct(real_path.bytes_as_string_view());
     if (!file->open(Core::OpenMode::ReadOnly)) {
         TRY(send_error_response(404, request));
-        return false;
+        return m_keep_alive;
     }
 
     if (file->is_device()) {
         TRY(send_error_response(403, request));
-        return false;
+        return m_keep_alive;
     }
 
-    Core::InputFileStream stream { file };
-
     auto const info = ContentInfo {
         .type = TRY(String::from_deprecated_string(Core::guess_mime_type_based_on_filename(real_path.bytes_as_string_view()))),
-        .length = TRY(Core::File::size(real_path.bytes_as_string_view()))
+        .length = static_cast<size_t>(TRY(Core::System::fstat(file->fd())).st_size)
     };
-    TRY(send_response(stream, request, move(info)));
-    return true;
+    TRY(send_file_response(*file, request, move(info)));
+    return m_keep_alive;
 }
 
-ErrorOr<void> Client::send_response(InputStream& response, HTTP::HttpRequest const& request, ContentInfo content_info)
+ErrorOr<void> Client::send_response_headers(HTTP::HttpRequest const& request, ContentInfo const& content_info)
 {
     StringBuilder builder;
     builder.append("HTTP/1.0 200 OK\r\n"sv);
@@ -189,11 +227,38 @@ ErrorOr<void> Client::send_response(InputStream& response, HTTP::HttpRequest con
     else
         builder.appendff("Content-Type: {}\r\n", content_info.type);
     builder.appendff("Content-Length: {}\r\n", content_info.length);
+    if (m_keep_alive)
+        builder.appendff("Connection: keep-alive\r\nKeep-Alive: timeout={}\r\n", keep_alive_timeout_seconds);
+    else
+        builder.append("Connection: close\r\n"sv);
     builder.append("\r\n"sv);
 
     auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket->write(builder_contents));
+    TRY(m_socket->write_entire_buffer(builder_contents));
     log_response(200, request);
+    return {};
+}
+
+ErrorOr<void> Client::send_file_response(Core::File& file, HTTP::HttpRequest const& request, ContentInfo content_info)
+{
+    TRY(send_response_headers(request, content_info));
+
+    // The kernel copies the file straight into the socket, without the contents passing through our address space.
+    off_t offset = 0;
+    while (static_cast<size_t>(offset) < content_info.length) {
+        auto nsent = TRY(Core::System::sendfile(m_socket_fd, file.fd(), &offset, content_info.length - offset));
+        // The file got shorter while we were sending it. As the length has been promised already, the client has to go.
+        if (nsent == 0) {
+            m_keep_alive = false;
+            break;
+        }
+    }
+    return {};
+}
+
+ErrorOr<void> Client::send_response(InputStream& response, HTTP::HttpRequest const& request, ContentInfo content_info)
+{
+    TRY(send_response_headers(request, content_info));
 
     char buffer[PAGE_SIZE];
     do {
@@ -213,14 +278,6 @@ ErrorOr<void> Client::send_response(InputStream& response, HTTP::HttpRequest con
         }
     } while (true);
 
-    auto keep_alive = false;
-    if (auto it = request.headers().find_if([](auto& header) { return header.name.equals_ignoring_case("Connection"sv); }); !it.is_end()) {
-        if (it->value.trim_whitespace().equals_ignoring_case("keep-alive"sv))
-            keep_alive = true;
-    }
-    if (!keep_alive)
-        m_socket->close();
-
     return {};
 }
 
@@ -231,6 +288,8 @@ ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest
     builder.append("Location: "sv);
     builder.append(redirect_path);
     builder.append("\r\n"sv);
+    builder.append("Content-Length: 0\r\n"sv);
+    builder.append(m_keep_alive ? "Connection: keep-alive\r\n"sv : "Connection: close\r\n"sv);
     builder.append("\r\n"sv);
 
     auto builder_contents = builder.to_byte_buffer();
@@ -240,25 +299,24 @@ ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest
     return {};
 }
 
+// NOTE: Requests are handled on several threads, and the initialization of function-local statics is thread-safe.
 static DeprecatedString folder_image_data()
 {
-    static DeprecatedString cache;
-    if (cache.is_empty()) {
+    static DeprecatedString cache = [] {
         auto file = Core::MappedFile::map("/res/icons/16x16/filetype-folder.png"sv).release_value_but_fixme_should_propagate_errors();
         // FIXME: change to TRY() and make method fallible
-        cache = MUST(encode_base64(file->bytes())).to_deprecated_string();
-    }
+        return MUST(encode_base64(file->bytes())).to_deprecated_string();
+    }();
     return cache;
 }
 
 static DeprecatedString file_image_data()
 {
-    static DeprecatedString cache;
-    if (cache.is_empty()) {
+    static DeprecatedString cache = [] {
         auto file = Core::MappedFile::map("/res/icons/16x16/filetype-unknown.png"sv).release_value_but_fixme_should_propagate_errors();
         // FIXME: change to TRY() and make method fallible
-        cache = MUST(encode_base64(file->bytes())).to_deprecated_string();
-    }
+        return MUST(encode_base64(file->bytes())).to_deprecated_string();
+    }();
     return cache;
 }
 
@@ -362,6 +420,7 @@ ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const
     }
     header_builder.append("Content-Type: text/html; charset=UTF-8\r\n"sv);
     header_builder.appendff("Content-Length: {}\r\n", content_builder.length());
+    header_builder.append(m_keep_alive ? "Connection: keep-alive\r\n"sv : "Connection: close\r\n"sv);
     header_builder.append("\r\n"sv);
     TRY(m_socket->write(header_builder.to_byte_buffer()));
     TRY(m_socket->write(content_builder.to_byte_buffer()));
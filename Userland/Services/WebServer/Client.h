@@ -8,10 +8,13 @@
 #pragma once
 
 #include <AK/String.h>
+#include <LibCore/Forward.h>
 #include <LibCore/Object.h>
 #include <LibCore/Stream.h>
+#include <LibCore/Timer.h>
 #include <LibHTTP/Forward.h>
 #include <LibHTTP/HttpRequest.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace WebServer {
 
@@ -22,15 +25,21 @@ public:
     void start();
 
 private:
-    Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket>, Core::Object* parent);
+    Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket>, int socket_fd, Threading::ThreadPool&, Core::Object* parent);
 
     struct ContentInfo {
         String type;
         size_t length {};
     };
 
+    // Runs on a thread of the pool, and returns whether the connection should be kept alive.
     ErrorOr<bool> handle_request(ReadonlyBytes);
+    // Runs on the event loop's thread again once the request has been handled.
+    void did_handle_request(bool keep_alive);
+
+    ErrorOr<void> send_response_headers(HTTP::HttpRequest const&, ContentInfo const&);
     ErrorOr<void> send_response(InputStream&, HTTP::HttpRequest const&, ContentInfo);
+    ErrorOr<void> send_file_response(Core::File&, HTTP::HttpRequest const&, ContentInfo);
     ErrorOr<void> send_redirect(StringView redirect, HTTP::HttpRequest const&);
     ErrorOr<void> send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
     void die();
@@ -39,6 +48,10 @@ private:
     bool verify_credentials(Vector<HTTP::HttpRequest::Header> const&);
 
     NonnullOwnPtr<Core::Stream::BufferedTCPSocket> m_socket;
+    int m_socket_fd { -1 };
+    Threading::ThreadPool& m_thread_pool;
+    RefPtr<Core::Timer> m_idle_timer;
+    bool m_keep_alive { false };
 };
 
 }
@@ -11,9 +11,10 @@ namespace WebServer {
 
 static Configuration* s_configuration = nullptr;
 
-Configuration::Configuration(DeprecatedString document_root_path, Optional<HTTP::HttpRequest::BasicAuthenticationCredentials> credentials)
+Configuration::Configuration(DeprecatedString document_root_path, Optional<HTTP::HttpRequest::BasicAuthenticationCredentials> credentials, size_t worker_count)
     : m_document_root_path(move(document_root_path))
     , m_credentials(move(credentials))
+    , m_worker_count(worker_count)
 {
     VERIFY(!s_configuration);
     s_configuration = this;
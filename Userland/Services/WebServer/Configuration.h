@@ -15,16 +15,19 @@ namespace WebServer {
 
 class Configuration {
 public:
-    Configuration(DeprecatedString document_root_path, Optional<HTTP::HttpRequest::BasicAuthenticationCredentials> credentials = {});
+    Configuration(DeprecatedString document_root_path, Optional<HTTP::HttpRequest::BasicAuthenticationCredentials> credentials = {}, size_t worker_count = 0);
 
     DeprecatedString const& document_root_path() const { return m_document_root_path; }
     Optional<HTTP::HttpRequest::BasicAuthenticationCredentials> const& credentials() const { return m_credentials; }
+    // How many threads handle requests. With none, requests are handled on the event loop's thread.
+    size_t worker_count() const { return m_worker_count; }
 
     static Configuration const& the();
 
 private:
     DeprecatedString m_document_root_path;
     Optional<HTTP::HttpRequest::BasicAuthenticationCredentials> m_credentials;
+    size_t m_worker_count { 0 };
 };
 
 }
@@ -15,6 +15,7 @@
 #include <LibCore/TCPServer.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibMain/Main.h>
+#include <LibThreading/ThreadPool.h>
 #include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
 #include <stdio.h>
@@ -31,12 +32,14 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     DeprecatedString username;
     DeprecatedString password;
     DeprecatedString document_root_path = default_document_root_path.to_deprecated_string();
+    size_t worker_count = Threading::ThreadPool::processor_count();
 
     Core::ArgsParser args_parser;
     args_parser.add_option(listen_address, "IP address to listen on", "listen-address", 'l', "listen_address");
     args_parser.add_option(port, "Port to listen on", "port", 'p', "port");
     args_parser.add_option(username, "HTTP basic authentication username", "user", 'U', "username");
     args_parser.add_option(password, "HTTP basic authentication password", "pass", 'P', "password");
+    args_parser.add_option(worker_count, "Number of threads handling requests (0 handles them on the main thread)", "workers", 'j', "count");
     args_parser.add_positional_argument(document_root_path, "Path to serve the contents of", "path", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
@@ -62,16 +65,18 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         return 1;
     }
 
-    TRY(Core::System::pledge("stdio accept rpath inet unix"));
+    TRY(Core::System::pledge("stdio accept rpath inet unix thread"));
 
     Optional<HTTP::HttpRequest::BasicAuthenticationCredentials> credentials;
     if (!username.is_empty() && !password.is_empty())
         credentials = HTTP::HttpRequest::BasicAuthenticationCredentials { username, password };
 
-    WebServer::Configuration configuration(real_document_root_path, credentials);
+    WebServer::Configuration configuration(real_document_root_path, credentials, worker_count);
 
     Core::EventLoop loop;
 
+    Threading::ThreadPool thread_pool(configuration.worker_count(), "WebServer"sv);
+
     auto server = TRY(Core::TCPServer::try_create());
 
     server->on_ready_to_accept = [&] {
@@ -81,7 +86,11 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             return;
         }
 
-        auto maybe_buffered_socket = Core::Stream::BufferedTCPSocket::create(maybe_client_socket.release_value());
+        auto client_socket = maybe_client_socket.release_value();
+        // The fd stays valid for as long as the buffered socket is alive, and lets us hand files to sendfile().
+        auto client_socket_fd = client_socket->fd().value();
+
+        auto maybe_buffered_socket = Core::Stream::BufferedTCPSocket::create(move(client_socket));
         if (maybe_buffered_socket.is_error()) {
             warnln("Could not obtain a buffered socket for the client: {}", maybe_buffered_socket.error());
             return;
@@ -89,7 +98,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
         // FIXME: Propagate errors
         MUST(maybe_buffered_socket.value()->set_blocking(true));
-        auto client = WebServer::Client::construct(maybe_buffered_socket.release_value(), server);
+        auto client = WebServer::Client::construct(maybe_buffered_socket.release_value(), client_socket_fd, thread_pool, server);
         client->start();
     };
 
@@ -105,6 +114,6 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     TRY(Core::System::unveil(real_document_root_path, "r"sv));
     TRY(Core::System::unveil(nullptr, nullptr));
 
-    TRY(Core::System::pledge("stdio accept rpath"));
+    TRY(Core::System::pledge("stdio accept rpath thread"));
     return loop.exec();
 }
@@ -42,7 +42,64 @@ static WallpaperMode mode_to_enum(DeprecatedString const& name)
     return WallpaperMode::Center;
 }
 
+// Screens are painted in square tiles of this size, which are spread over the compositor's threads.
+static constexpr int composition_tile_size = 128;
+
+// What compose() needs to know to paint a window, captured before any painting starts.
+struct ComposedWindow {
+    WindowFrame* frame { nullptr };
+    Gfx::IntPoint transition_offset;
+    Gfx::IntRect unconstrained_frame_rect;
+    Gfx::IntRect window_rect;
+    Vector<Gfx::IntRect, 4> frame_rects;
+    Gfx::Bitmap const* backing_store { nullptr };
+    Gfx::IntRect backing_rect;
+    Color background_color;
+    float opacity { 1.0f };
+    bool paint_frame { false };
+    bool is_opaque { false };
+    bool is_unresponsive { false };
+};
+
+// Paints either a window or, without a window, the wallpaper into a rect of a screen.
+struct CompositionCommand {
+    enum class Target {
+        BackBitmap,
+        TempBitmap,
+    };
+
+    Target target;
+    Gfx::IntRect rect;
+    Optional<size_t> window_index;
+    WindowFrame::PerScaleRenderedCache* frame_cache { nullptr };
+    // Whether every pixel of the rect ends up opaque, hiding all previous commands.
+    bool is_opaque { false };
+};
+
+struct CompositionTile {
+    Screen* screen { nullptr };
+    Gfx::IntRect rect;
+};
+
+template<typename Callback>
+static void for_each_composition_tile(Screen& screen, Gfx::IntRect const& rect, Callback callback)
+{
+    auto screen_rect = screen.rect();
+    auto rect_on_screen = rect.intersected(screen_rect);
+    if (rect_on_screen.is_empty())
+        return;
+
+    // Tiles are aligned to the screen, so the same pixels always end up in the same tile.
+    auto first_x = screen_rect.x() + (rect_on_screen.x() - screen_rect.x()) / composition_tile_size * composition_tile_size;
+    auto first_y = screen_rect.y() + (rect_on_screen.y() - screen_rect.y()) / composition_tile_size * composition_tile_size;
+    for (int y = first_y; y <= rect_on_screen.bottom(); y += composition_tile_size) {
+        for (int x = first_x; x <= rect_on_screen.right(); x += composition_tile_size)
+            callback(Gfx::IntRect { x, y, composition_tile_size, composition_tile_size }.intersected(screen_rect));
+    }
+}
+
 Compositor::Compositor()
+    : m_thread_pool(make<Threading::ThreadPool>(Threading::ThreadPool::processor_count() - 1, "Compositor"sv))
 {
     m_display_link_notify_timer = add<Core::Timer>(
         1000 / 60, [this] {
@@ -304,25 +361,15 @@ void Compositor::compose()
     if (!cursor_screen.compositor_screen_data().m_cursor_back_bitmap || m_invalidated_cursor)
         check_restore_cursor_back(cursor_screen, cursor_rect);
 
-    auto paint_wallpaper = [&](Screen& screen, Gfx::Painter& painter, Gfx::IntRect const& rect, Gfx::IntRect const& screen_rect) {
-        if (m_wallpaper) {
-            if (m_wallpaper_mode == WallpaperMode::Center) {
-                Gfx::IntPoint offset { (screen.width() - m_wallpaper->width()) / 2, (screen.height() - m_wallpaper->height()) / 2 };
+    // Nothing is painted while walking the windows. Instead, we record what to paint where, and then
+    // paint the screens tile by tile on all of the compositor's threads. Painting must therefore only
+    // read what is recorded here, and never reach out to the window manager, windows or frames.
+    Vector<ComposedWindow> composed_windows;
+    Vector<Vector<CompositionCommand>> commands_per_screen;
+    commands_per_screen.resize(Screen::count());
 
-                // FIXME: If the wallpaper is opaque and covers the whole rect, no need to fill with color!
-                painter.fill_rect(rect, background_color);
-                painter.blit_offset(rect.location(), *m_wallpaper, rect.translated(-screen_rect.location()), offset);
-            } else if (m_wallpaper_mode == WallpaperMode::Tile) {
-                painter.draw_tiled_bitmap(rect, *m_wallpaper);
-            } else if (m_wallpaper_mode == WallpaperMode::Stretch) {
-                VERIFY(screen.compositor_screen_data().m_wallpaper_bitmap);
-                painter.blit(rect.location(), *screen.compositor_screen_data().m_wallpaper_bitmap, rect);
-            } else {
-                VERIFY_NOT_REACHED();
-            }
-        } else {
-            painter.fill_rect(rect, background_color);
-        }
+    auto add_command = [&](Screen& screen, CompositionCommand command) {
+        commands_per_screen[screen.index()].append(move(command));
     };
 
     {
@@ -335,8 +382,7 @@ void Compositor::compose()
                 if (!screen_render_rect.is_empty()) {
                     dbgln_if(COMPOSE_DEBUG, "  render wallpaper opaque: {} on screen #{}", screen_render_rect, screen.index());
                     prepare_rect(screen, render_rect);
-                    auto& back_painter = *screen.compositor_screen_data().m_back_painter;
-                    paint_wallpaper(screen, back_painter, render_rect, screen_rect);
+                    add_command(screen, { CompositionCommand::Target::BackBitmap, render_rect, {}, nullptr, true });
                 }
                 return IterationDecision::Continue;
             });
@@ -349,8 +395,7 @@ void Compositor::compose()
                 if (!screen_render_rect.is_empty()) {
                     dbgln_if(COMPOSE_DEBUG, "  render wallpaper transparent: {} on screen #{}", screen_render_rect, screen.index());
                     prepare_transparency_rect(screen, render_rect);
-                    auto& temp_painter = *screen.compositor_screen_data().m_temp_painter;
-                    paint_wallpaper(screen, temp_painter, render_rect, screen_rect);
+                    add_command(screen, { CompositionCommand::Target::TempBitmap, render_rect, {}, nullptr, false });
                 }
                 return IterationDecision::Continue;
             });
@@ -358,6 +403,8 @@ void Compositor::compose()
         });
     }
 
+    auto window_background_color = wm.palette().window();
+
     auto compose_window = [&](Window& window) -> IterationDecision {
         if (window.screens().is_empty()) {
             // This window doesn't intersect with any screens, so there's nothing to render
@@ -366,35 +413,29 @@ void Compositor::compose()
         auto transition_offset = window_transition_offset(window);
         auto frame_rect = window.frame().render_rect().translated(transition_offset);
         auto window_rect = window.rect().translated(transition_offset);
-        auto frame_rects = frame_rect.shatter(window_rect);
 
         dbgln_if(COMPOSE_DEBUG, "  window {} frame rect: {}", window.title(), frame_rect);
 
-        RefPtr<Gfx::Bitmap> backing_store = window.backing_store();
-        auto compose_window_rect = [&](Screen& screen, Gfx::Painter& painter, const Gfx::IntRect& rect) {
-            if (!window.is_fullscreen()) {
-                rect.for_each_intersected(frame_rects, [&](const Gfx::IntRect& intersected_rect) {
-                    Gfx::PainterStateSaver saver(painter);
-                    painter.add_clip_rect(intersected_rect);
-                    painter.translate(transition_offset);
-                    dbgln_if(COMPOSE_DEBUG, "    render frame: {}", intersected_rect);
-                    window.frame().paint(screen, painter, intersected_rect.translated(-transition_offset));
-                    return IterationDecision::Continue;
-                });
-            }
-
-            auto clear_window_rect = [&](const Gfx::IntRect& clear_rect) {
-                auto fill_color = wm.palette().window();
-                if (!window.is_opaque())
-                    fill_color.set_alpha(255 * window.opacity());
-                painter.fill_rect(clear_rect, fill_color);
-            };
-
-            if (!backing_store) {
-                clear_window_rect(window_rect.intersected(rect));
-                return;
-            }
+        ComposedWindow composed_window {
+            .frame = &window.frame(),
+            .transition_offset = transition_offset,
+            .unconstrained_frame_rect = window.frame().unconstrained_render_rect(),
+            .window_rect = window_rect,
+            .frame_rects = {},
+            .backing_store = window.backing_store(),
+            .backing_rect = {},
+            .background_color = window_background_color,
+            .opacity = window.opacity(),
+            .paint_frame = !window.is_fullscreen(),
+            .is_opaque = window.is_opaque(),
+            .is_unresponsive = window.client() && window.client()->is_unresponsive(),
+        };
+        if (composed_window.paint_frame)
+            composed_window.frame_rects = frame_rect.shatter(window_rect);
+        if (!composed_window.is_opaque)
+            composed_window.background_color.set_alpha(255 * window.opacity());
 
+        if (auto* backing_store = composed_window.backing_store) {
             // Decide where we would paint this window's backing store.
             // This is subtly different from widow.rect(), because window
             // size may be different from its backing store size. This
@@ -403,7 +444,7 @@ void Compositor::compose()
             // we want to try to blit the backing store at the same place
             // it was previously, and fill the rest of the window with its
             // background color.
-            Gfx::IntRect backing_rect;
+            auto& backing_rect = composed_window.backing_rect;
             backing_rect.set_size(backing_store->size());
             switch (WindowManager::the().resize_direction_of_window(window)) {
             case ResizeDirection::None:
@@ -430,34 +471,23 @@ void Compositor::compose()
                 VERIFY_NOT_REACHED();
                 break;
             }
+        }
 
-            Gfx::IntRect dirty_rect_in_backing_coordinates = rect.intersected(window_rect)
-                                                                 .intersected(backing_rect)
-                                                                 .translated(-backing_rect.location());
-
-            if (!dirty_rect_in_backing_coordinates.is_empty()) {
-                auto dst = backing_rect.location().translated(dirty_rect_in_backing_coordinates.location());
-
-                if (window.client() && window.client()->is_unresponsive()) {
-                    if (window.is_opaque()) {
-                        painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [](Color src) {
-                            return src.to_grayscale().darkened(0.75f);
-                        });
-                    } else {
-                        u8 alpha = 255 * window.opacity();
-                        painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [&](Color src) {
-                            auto color = src.to_grayscale().darkened(0.75f);
-                            color.set_alpha(alpha);
-                            return color;
-                        });
-                    }
-                } else {
-                    painter.blit(dst, *backing_store, dirty_rect_in_backing_coordinates, window.opacity());
-                }
-            }
+        // Within the window rect, an opaque window paints every pixel opaquely, which hides anything below it.
+        bool window_rect_is_opaque = composed_window.is_opaque
+            && composed_window.background_color.alpha() == 255
+            && (!composed_window.backing_store || !composed_window.backing_store->has_alpha_channel());
+
+        auto window_index = composed_windows.size();
+        composed_windows.append(move(composed_window));
 
-            for (auto background_rect : window_rect.shatter(backing_rect))
-                clear_window_rect(background_rect);
+        // The frame is painted from its cache, which has to be up to date before the tiles are painted.
+        auto frame_cache_for_rect = [&](Screen& screen, Gfx::IntRect const& rect) -> WindowFrame::PerScaleRenderedCache* {
+            for (auto& frame_part : composed_windows[window_index].frame_rects) {
+                if (frame_part.intersects(rect))
+                    return window.frame().render_to_cache(screen);
+            }
+            return nullptr;
         };
 
         auto& dirty_rects = window.dirty_rects();
@@ -482,10 +512,7 @@ void Compositor::compose()
                     dbgln_if(COMPOSE_DEBUG, "    render opaque: {} on screen #{}", screen_render_rect, screen->index());
 
                     prepare_rect(*screen, screen_render_rect);
-                    auto& back_painter = *screen->compositor_screen_data().m_back_painter;
-                    Gfx::PainterStateSaver saver(back_painter);
-                    back_painter.add_clip_rect(screen_render_rect);
-                    compose_window_rect(*screen, back_painter, screen_render_rect);
+                    add_command(*screen, { CompositionCommand::Target::BackBitmap, screen_render_rect, window_index, frame_cache_for_rect(*screen, screen_render_rect), true });
                 }
                 return IterationDecision::Continue;
             });
@@ -503,9 +530,8 @@ void Compositor::compose()
                         continue;
                     dbgln_if(COMPOSE_DEBUG, "    render wallpaper: {} on screen #{}", screen_render_rect, screen->index());
 
-                    auto& temp_painter = *screen->compositor_screen_data().m_temp_painter;
                     prepare_transparency_rect(*screen, screen_render_rect);
-                    paint_wallpaper(*screen, temp_painter, screen_render_rect, screen_rect);
+                    add_command(*screen, { CompositionCommand::Target::TempBitmap, screen_render_rect, {}, nullptr, false });
                 }
                 return IterationDecision::Continue;
             });
@@ -521,10 +547,8 @@ void Compositor::compose()
                     dbgln_if(COMPOSE_DEBUG, "    render transparent: {} on screen #{}", screen_render_rect, screen->index());
 
                     prepare_transparency_rect(*screen, screen_render_rect);
-                    auto& temp_painter = *screen->compositor_screen_data().m_temp_painter;
-                    Gfx::PainterStateSaver saver(temp_painter);
-                    temp_painter.add_clip_rect(screen_render_rect);
-                    compose_window_rect(*screen, temp_painter, screen_render_rect);
+                    bool is_opaque = window_rect_is_opaque && window_rect.contains(screen_render_rect);
+                    add_command(*screen, { CompositionCommand::Target::TempBitmap, screen_render_rect, window_index, frame_cache_for_rect(*screen, screen_render_rect), is_opaque });
                 }
                 return IterationDecision::Continue;
             });
@@ -532,7 +556,7 @@ void Compositor::compose()
         return IterationDecision::Continue;
     };
 
-    // Paint the window stack.
+    // Record the window stack.
     if (m_invalidated_window) {
         auto* fullscreen_window = wm.active_fullscreen_window();
         if (fullscreen_window && fullscreen_window->is_opaque()) {
@@ -545,7 +569,144 @@ void Compositor::compose()
                 return IterationDecision::Continue;
             });
         }
+    }
+
+    auto paint_wallpaper = [&](Screen& screen, Gfx::Painter& painter, Gfx::IntRect const& rect, Gfx::IntRect const& screen_rect) {
+        if (m_wallpaper) {
+            if (m_wallpaper_mode == WallpaperMode::Center) {
+                Gfx::IntPoint offset { (screen.width() - m_wallpaper->width()) / 2, (screen.height() - m_wallpaper->height()) / 2 };
+
+                // FIXME: If the wallpaper is opaque and covers the whole rect, no need to fill with color!
+                painter.fill_rect(rect, background_color);
+                painter.blit_offset(rect.location(), *m_wallpaper, rect.translated(-screen_rect.location()), offset);
+            } else if (m_wallpaper_mode == WallpaperMode::Tile) {
+                painter.draw_tiled_bitmap(rect, *m_wallpaper);
+            } else if (m_wallpaper_mode == WallpaperMode::Stretch) {
+                VERIFY(screen.compositor_screen_data().m_wallpaper_bitmap);
+                painter.blit(rect.location(), *screen.compositor_screen_data().m_wallpaper_bitmap, rect);
+            } else {
+                VERIFY_NOT_REACHED();
+            }
+        } else {
+            painter.fill_rect(rect, background_color);
+        }
+    };
+
+    auto paint_window_rect = [&](Gfx::Painter& painter, ComposedWindow const& window, WindowFrame::PerScaleRenderedCache* frame_cache, Gfx::IntRect const& rect) {
+        if (frame_cache) {
+            rect.for_each_intersected(window.frame_rects, [&](const Gfx::IntRect& intersected_rect) {
+                Gfx::PainterStateSaver saver(painter);
+                painter.add_clip_rect(intersected_rect);
+                painter.translate(window.transition_offset);
+                dbgln_if(COMPOSE_DEBUG, "    render frame: {}", intersected_rect);
+                frame_cache->paint(*window.frame, painter, intersected_rect.translated(-window.transition_offset), window.unconstrained_frame_rect);
+                return IterationDecision::Continue;
+            });
+        }
+
+        if (!window.backing_store) {
+            painter.fill_rect(window.window_rect.intersected(rect), window.background_color);
+            return;
+        }
+
+        auto const& backing_store = *window.backing_store;
+        auto const& backing_rect = window.backing_rect;
+        Gfx::IntRect dirty_rect_in_backing_coordinates = rect.intersected(window.window_rect)
+                                                             .intersected(backing_rect)
+                                                             .translated(-backing_rect.location());
+
+        if (!dirty_rect_in_backing_coordinates.is_empty()) {
+            auto dst = backing_rect.location().translated(dirty_rect_in_backing_coordinates.location());
+
+            if (window.is_unresponsive) {
+                if (window.is_opaque) {
+                    painter.blit_filtered(dst, backing_store, dirty_rect_in_backing_coordinates, [](Color src) {
+                        return src.to_grayscale().darkened(0.75f);
+                    });
+                } else {
+                    u8 alpha = 255 * window.opacity;
+                    painter.blit_filtered(dst, backing_store, dirty_rect_in_backing_coordinates, [&](Color src) {
+                        auto color = src.to_grayscale().darkened(0.75f);
+                        color.set_alpha(alpha);
+                        return color;
+                    });
+                }
+            } else {
+                painter.blit(dst, backing_store, dirty_rect_in_backing_coordinates, window.opacity);
+            }
+        }
+
+        for (auto background_rect : window.window_rect.shatter(backing_rect))
+            painter.fill_rect(background_rect, window.background_color);
+    };
 
+    Vector<CompositionTile> tiles;
+    Screen::for_each([&](auto& screen) {
+        auto& commands = commands_per_screen[screen.index()];
+        if (commands.is_empty())
+            return IterationDecision::Continue;
+        auto bounding_rect = commands.first().rect;
+        for (auto& command : commands)
+            bounding_rect = bounding_rect.united(command.rect);
+        for_each_composition_tile(screen, bounding_rect, [&](Gfx::IntRect const& tile_rect) {
+            for (auto& command : commands) {
+                if (command.rect.intersects(tile_rect)) {
+                    tiles.append({ &screen, tile_rect });
+                    break;
+                }
+            }
+        });
+        return IterationDecision::Continue;
+    });
+
+    // Painters hold a reference to the bitmap they paint into, and Bitmap isn't reference counted atomically.
+    // So the painters of every tile are created (and destroyed) here, and the workers only ever use them.
+    Vector<NonnullOwnPtr<Gfx::Painter>> tile_painters;
+    tile_painters.ensure_capacity(tiles.size() * 2);
+    for (auto& tile : tiles) {
+        auto& screen_data = tile.screen->compositor_screen_data();
+        tile_painters.unchecked_append(make<Gfx::Painter>(*screen_data.m_back_bitmap));
+        tile_painters.unchecked_append(make<Gfx::Painter>(*screen_data.m_temp_bitmap));
+    }
+
+    m_thread_pool->for_each_index(tiles.size(), [&](size_t tile_index) {
+        auto& tile = tiles[tile_index];
+        auto& screen = *tile.screen;
+        auto& commands = commands_per_screen[screen.index()];
+
+        // Whatever is below a command that paints the whole tile opaquely is never going to be seen.
+        size_t first_visible_command = 0;
+        for (size_t i = commands.size(); i > 0; --i) {
+            auto& command = commands[i - 1];
+            if (command.is_opaque && command.rect.contains(tile.rect)) {
+                first_visible_command = i - 1;
+                break;
+            }
+        }
+
+        auto& back_painter = *tile_painters[tile_index * 2];
+        auto& temp_painter = *tile_painters[tile_index * 2 + 1];
+        for (auto* painter : { &back_painter, &temp_painter }) {
+            painter->translate(-screen.rect().location());
+            painter->add_clip_rect(tile.rect);
+        }
+
+        for (size_t i = first_visible_command; i < commands.size(); ++i) {
+            auto& command = commands[i];
+            if (!command.rect.intersects(tile.rect))
+                continue;
+            auto& painter = command.target == CompositionCommand::Target::BackBitmap ? back_painter : temp_painter;
+            if (!command.window_index.has_value()) {
+                paint_wallpaper(screen, painter, command.rect, screen.rect());
+                continue;
+            }
+            Gfx::PainterStateSaver saver(painter);
+            painter.add_clip_rect(command.rect);
+            paint_window_rect(painter, composed_windows[command.window_index.value()], command.frame_cache, command.rect);
+        }
+    });
+
+    if (m_invalidated_window) {
         // Check that there are no overlapping transparent and opaque flush rectangles
         VERIFY(![&]() {
             bool is_overlapping = false;
@@ -573,13 +734,35 @@ void Compositor::compose()
         }
 
         // Copy anything rendered to the temporary buffer to the back buffer
+        tiles.clear_with_capacity();
         Screen::for_each([&](auto& screen) {
-            auto screen_rect = screen.rect();
-            auto& screen_data = screen.compositor_screen_data();
-            for (auto& rect : screen_data.m_flush_transparent_rects.rects())
-                screen_data.m_back_painter->blit(rect.location(), *screen_data.m_temp_bitmap, rect.translated(-screen_rect.location()));
+            auto& flush_transparent_rects = screen.compositor_screen_data().m_flush_transparent_rects;
+            if (flush_transparent_rects.is_empty())
+                return IterationDecision::Continue;
+            auto bounding_rect = flush_transparent_rects.rects().first();
+            for (auto& rect : flush_transparent_rects.rects())
+                bounding_rect = bounding_rect.united(rect);
+            for_each_composition_tile(screen, bounding_rect, [&](Gfx::IntRect const& tile_rect) {
+                if (flush_transparent_rects.intersects(tile_rect))
+                    tiles.append({ &screen, tile_rect });
+            });
             return IterationDecision::Continue;
         });
+
+        tile_painters.clear_with_capacity();
+        for (auto& tile : tiles)
+            tile_painters.append(make<Gfx::Painter>(*tile.screen->compositor_screen_data().m_back_bitmap));
+
+        m_thread_pool->for_each_index(tiles.size(), [&](size_t tile_index) {
+            auto& tile = tiles[tile_index];
+            auto screen_rect = tile.screen->rect();
+            auto& screen_data = tile.screen->compositor_screen_data();
+            auto& back_painter = *tile_painters[tile_index];
+            back_painter.translate(-screen_rect.location());
+            back_painter.add_clip_rect(tile.rect);
+            for (auto& rect : screen_data.m_flush_transparent_rects.rects())
+                back_painter.blit(rect.location(), *screen_data.m_temp_bitmap, rect.translated(-screen_rect.location()));
+        });
     }
 
     m_invalidated_any = false;
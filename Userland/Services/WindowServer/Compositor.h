@@ -12,6 +12,7 @@
 #include <LibGfx/Color.h>
 #include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Font/Font.h>
+#include <LibThreading/ThreadPool.h>
 #include <WindowServer/Overlays.h>
 
 namespace WindowServer {
@@ -252,6 +253,9 @@ private:
     Optional<Gfx::Color> m_custom_background_color;
 
     HashTable<Animation*> m_animations;
+
+    // The main thread is one of the compositing threads as well.
+    NonnullOwnPtr<Threading::ThreadPool> m_thread_pool;
 };
 
 }
@@ -350,7 +350,11 @@ void WindowFrame::paint(Screen& screen, Gfx::Painter& painter, Gfx::IntRect cons
 
 void WindowFrame::PerScaleRenderedCache::paint(WindowFrame& frame, Gfx::Painter& painter, Gfx::IntRect const& rect)
 {
-    auto frame_rect = frame.unconstrained_render_rect();
+    paint(frame, painter, rect, frame.unconstrained_render_rect());
+}
+
+void WindowFrame::PerScaleRenderedCache::paint(WindowFrame& frame, Gfx::Painter& painter, Gfx::IntRect const& rect, Gfx::IntRect const& frame_rect)
+{
     auto window_rect = frame.window().rect();
     if (m_top_bottom) {
         auto top_bottom_height = frame_rect.height() - window_rect.height();
@@ -30,6 +30,8 @@ public:
 
     public:
         void paint(WindowFrame&, Gfx::Painter&, Gfx::IntRect const&);
+        // Doesn't look up the frame's geometry, so the compositor can call this off the main thread.
+        void paint(WindowFrame&, Gfx::Painter&, Gfx::IntRect const& rect, Gfx::IntRect const& frame_rect);
         void render(WindowFrame&, Screen&);
         Optional<HitTestResult> hit_test(WindowFrame&, Gfx::IntPoint, Gfx::IntPoint);
 
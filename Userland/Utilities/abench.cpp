@@ -4,9 +4,12 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/FixedArray.h>
+#include <AK/Math.h>
 #include <AK/NumericLimits.h>
 #include <AK/Types.h>
 #include <LibAudio/Loader.h>
+#include <LibAudio/Mixing.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/ElapsedTimer.h>
 #include <LibCore/File.h>
@@ -17,17 +20,79 @@
 // The Kernel has problems with large anonymous buffers, so let's limit sample reads ourselves.
 static constexpr size_t MAX_CHUNK_SIZE = 1 * MiB / 2;
 
+// Mixes synthetic streams the same way AudioServer does, one period at a time.
+static int benchmark_mixing(size_t stream_count, size_t period_size)
+{
+    constexpr u32 sample_rate = 44100;
+    // Enough audio to get stable timings.
+    constexpr size_t benchmark_seconds = 10;
+    constexpr size_t stream_length = sample_rate;
+
+    Vector<FixedArray<Audio::Sample>> streams;
+    for (size_t i = 0; i < stream_count; ++i) {
+        auto stream = FixedArray<Audio::Sample>::must_create_but_fixme_should_propagate_errors(stream_length);
+        auto frequency = 220.f + 55.f * static_cast<float>(i);
+        for (size_t j = 0; j < stream_length; ++j)
+            stream[j] = Audio::Sample { AK::sin(2.f * AK::Pi<float> * frequency * static_cast<float>(j) / sample_rate) };
+        streams.append(move(stream));
+    }
+
+    auto mix_buffer = FixedArray<Audio::Sample>::must_create_but_fixme_should_propagate_errors(period_size);
+    auto output_buffer = FixedArray<i16>::must_create_but_fixme_should_propagate_errors(period_size * 2);
+    auto gain = Audio::log_volume_to_gain(0.95f) * Audio::log_volume_to_gain(0.8f);
+
+    size_t period_count = benchmark_seconds * sample_rate / period_size;
+    size_t position = 0;
+
+    Core::ElapsedTimer timer { true };
+    timer.start();
+    for (size_t period = 0; period < period_count; ++period) {
+        mix_buffer.fill_with({});
+        auto sample_count = min(period_size, stream_length - position);
+        for (auto& stream : streams)
+            Audio::mix_into(mix_buffer.span().trim(sample_count), stream.span().slice(position, sample_count), gain);
+        Audio::convert_to_i16(output_buffer.span(), mix_buffer.span(), Audio::log_volume_to_gain(1.f));
+        position = (position + sample_count) % stream_length;
+    }
+    auto elapsed_microseconds = static_cast<double>(timer.elapsed_time().to_microseconds());
+
+    auto realtime_microseconds = static_cast<double>(period_count * period_size) / sample_rate * 1'000'000.;
+    auto cpu_percentage = elapsed_microseconds / realtime_microseconds * 100.;
+    outln("Mixed {} streams in {} periods of {} samples in {:06.3f} s, {:9.3f} µs/period", stream_count, period_count, period_size, elapsed_microseconds / 1'000'000., elapsed_microseconds / static_cast<double>(period_count));
+    outln("CPU usage: {:6.3f}% total, {:6.3f}% per stream (of realtime at {} Hz)", cpu_percentage, cpu_percentage / static_cast<double>(stream_count), sample_rate);
+
+    return 0;
+}
+
 ErrorOr<int> serenity_main(Main::Arguments args)
 {
     StringView path {};
     int sample_count = -1;
+    size_t mix_stream_count = 0;
+    size_t period_size = 512;
 
     Core::ArgsParser args_parser;
-    args_parser.set_general_help("Benchmark audio loading");
-    args_parser.add_positional_argument(path, "Path to audio file", "path");
+    args_parser.set_general_help("Benchmark audio loading, or mixing of many streams");
+    args_parser.add_positional_argument(path, "Path to audio file", "path", Core::ArgsParser::Required::No);
     args_parser.add_option(sample_count, "How many samples to load at maximum", "sample-count", 's', "samples");
+    args_parser.add_option(mix_stream_count, "Benchmark mixing this many synthetic streams instead of loading a file", "mix", 'm', "streams");
+    args_parser.add_option(period_size, "How many samples to mix at once", "period-size", 'p', "samples");
     args_parser.parse(args);
 
+    if (mix_stream_count > 0) {
+        TRY(Core::System::pledge("stdio"));
+        if (period_size == 0 || period_size > 44100) {
+            warnln("The period size must be between 1 and 44100 samples");
+            return 1;
+        }
+        return benchmark_mixing(mix_stream_count, period_size);
+    }
+
+    if (path.is_empty()) {
+        warnln("Either a path to an audio file or --mix is required");
+        return 1;
+    }
+
     TRY(Core::System::unveil(Core::File::absolute_path(path), "r"sv));
     TRY(Core::System::unveil(nullptr, nullptr));
     TRY(Core::System::pledge("stdio recvfd rpath"));
@@ -5,8 +5,10 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/ByteBuffer.h>
 #include <AK/DeprecatedString.h>
+#include <AK/Random.h>
 #include <AK/ScopeGuard.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
@@ -15,6 +17,7 @@
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -40,6 +43,7 @@ static Result average_result(Vector<Result> const& results)
 }
 
 static ErrorOr<Result> benchmark(DeprecatedString const& filename, int file_size, ByteBuffer& buffer, bool allow_cache);
+static ErrorOr<u64> random_read_benchmark(DeprecatedString const& filename, int file_size, ByteBuffer& buffer, size_t queue_depth, int time_per_benchmark, bool allow_cache);
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
@@ -48,6 +52,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     Vector<size_t> file_sizes;
     Vector<size_t> block_sizes;
     bool allow_cache = false;
+    bool random_read = false;
+    Vector<size_t> queue_depths;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(allow_cache, "Allow using disk cache", "cache", 'c');
@@ -55,6 +61,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(time_per_benchmark, "Time elapsed per benchmark", "time-per-benchmark", 't', "time-per-benchmark");
     args_parser.add_option(file_sizes, "A comma-separated list of file sizes", "file-size", 'f', "file-size");
     args_parser.add_option(block_sizes, "A comma-separated list of block sizes", "block-size", 'b', "block-size");
+    args_parser.add_option(random_read, "Measure random read IOPS instead of sequential throughput", "random-read", 'r');
+    args_parser.add_option(queue_depths, "A comma-separated list of random read queue depths (concurrent readers)", "queue-depth", 'q', "queue-depth");
     args_parser.parse(arguments);
 
     if (file_sizes.size() == 0) {
@@ -63,6 +71,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     if (block_sizes.size() == 0) {
         block_sizes = { 8192, 32768, 65536 };
     }
+    if (queue_depths.size() == 0) {
+        queue_depths = { 1, 4, 16, 32 };
+    }
 
     umask(0644);
 
@@ -78,6 +89,18 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
                 warnln("Not enough memory to allocate space for block size = {}", block_size);
                 continue;
             }
+            if (random_read) {
+                for (auto queue_depth : queue_depths) {
+                    if (queue_depth == 0)
+                        continue;
+                    outln("Running: file_size={} block_size={} queue_depth={}", file_size, block_size, queue_depth);
+                    auto iops = TRY(random_read_benchmark(filename, file_size, buffer_result.value(), queue_depth, time_per_benchmark, allow_cache));
+                    outln("Finished: iops={} read_bps={}", iops, iops * block_size);
+                    sleep(1);
+                }
+                continue;
+            }
+
             Vector<Result> results;
 
             outln("Running: file_size={} block_size={}", file_size, block_size);
@@ -141,3 +164,79 @@ ErrorOr<Result> benchmark(DeprecatedString const& filename, int file_size, ByteB
     result.read_bps = (u64)(timer.elapsed() ? (file_size / timer.elapsed()) : file_size) * 1000;
     return result;
 }
+
+ErrorOr<u64> random_read_benchmark(DeprecatedString const& filename, int file_size, ByteBuffer& buffer, size_t queue_depth, int time_per_benchmark, bool allow_cache)
+{
+    int fd = TRY(Core::System::open(filename, O_CREAT | O_TRUNC | O_RDWR, 0644));
+
+    auto fd_cleanup = ScopeGuard([fd, filename] {
+        auto void_or_error = Core::System::close(fd);
+        if (void_or_error.is_error())
+            warnln("{}", void_or_error.release_error());
+
+        void_or_error = Core::System::unlink(filename);
+        if (void_or_error.is_error())
+            warnln("{}", void_or_error.release_error());
+    });
+
+    ssize_t total_written = 0;
+    while (total_written < file_size) {
+        auto nwritten = TRY(Core::System::write(fd, buffer));
+        total_written += nwritten;
+    }
+
+    int flags = O_RDONLY;
+    if (!allow_cache)
+        flags |= O_DIRECT;
+    int read_fd = TRY(Core::System::open(filename, flags));
+    ScopeGuard read_fd_cleanup = [read_fd] { (void)Core::System::close(read_fd); };
+
+    // Every reader keeps one request in flight, so the number of readers is the queue depth the disk sees.
+    struct ReaderContext {
+        int fd;
+        size_t block_size;
+        u32 block_count;
+        i64 duration_ms;
+        Core::ElapsedTimer timer;
+        Atomic<u64> total_reads { 0 };
+        Atomic<bool> failed { false };
+    };
+    ReaderContext context { read_fd, buffer.size(), static_cast<u32>(file_size / buffer.size()), time_per_benchmark * 1000, Core::ElapsedTimer::start_new() };
+
+    auto reader = [](void* data) -> void* {
+        auto& context = *static_cast<ReaderContext*>(data);
+        auto buffer = ByteBuffer::create_uninitialized(context.block_size);
+        if (buffer.is_error()) {
+            context.failed = true;
+            return nullptr;
+        }
+        while (context.timer.elapsed() < context.duration_ms) {
+            auto offset = static_cast<off_t>(get_random_uniform(context.block_count)) * context.block_size;
+            if (pread(context.fd, buffer.value().data(), context.block_size, offset) < 0) {
+                context.failed = true;
+                return nullptr;
+            }
+            ++context.total_reads;
+        }
+        return nullptr;
+    };
+
+    Vector<pthread_t> readers;
+    for (size_t i = 0; i < queue_depth; ++i) {
+        pthread_t thread_id;
+        if (int rc = pthread_create(&thread_id, nullptr, reader, &context); rc != 0) {
+            context.failed = true;
+            break;
+        }
+        readers.append(thread_id);
+    }
+    for (auto thread_id : readers)
+        pthread_join(thread_id, nullptr);
+
+    if (context.failed)
+        return Error::from_string_literal("Failed to read from the benchmark file");
+
+    auto elapsed = context.timer.elapsed();
+    auto total_reads = context.total_reads.load();
+    return elapsed ? total_reads * 1000 / elapsed : total_reads;
+}
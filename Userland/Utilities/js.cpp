@@ -185,6 +185,24 @@ static DeprecatedString read_next_piece()
     return piece.to_deprecated_string();
 }
 
+static void print_gc_statistics(JS::Heap const& heap)
+{
+    auto const& statistics = heap.statistics();
+    warnln("Garbage collector statistics:");
+    warnln("       Collections: {}", statistics.collection_count);
+    warnln("  Total pause time: {} ms", statistics.total_pause_time.to_milliseconds());
+    warnln("     Longest pause: {} ms", statistics.longest_pause_time.to_milliseconds());
+    warnln("   Collected bytes: {}", statistics.collected_bytes);
+    warnln("   Surviving bytes: {} ({} after the last collection)", statistics.surviving_bytes, statistics.live_bytes_after_last_collection);
+    warnln("   Pause histogram:");
+    for (size_t i = 0; i < statistics.pause_histogram.size(); ++i) {
+        if (i == statistics.pause_histogram.size() - 1)
+            warnln("     >= {:4} ms: {}", 1 << (i - 1), statistics.pause_histogram[i]);
+        else
+            warnln("      < {:4} ms: {}", 1 << i, statistics.pause_histogram[i]);
+    }
+}
+
 static bool write_to_file(DeprecatedString const& path)
 {
     int fd = open(path.characters(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
@@ -233,11 +251,10 @@ static ErrorOr<bool> parse_and_run(JS::Interpreter& interpreter, StringView sour
 
             auto executable = executable_result.release_value();
             executable->name = source_name;
-            if (s_opt_bytecode) {
-                auto& passes = JS::Bytecode::Interpreter::optimization_pipeline(JS::Bytecode::Interpreter::OptimizationLevel::Optimize);
-                passes.perform(*executable);
+            auto& passes = JS::Bytecode::Interpreter::optimization_pipeline(s_opt_bytecode ? JS::Bytecode::Interpreter::OptimizationLevel::Optimize : JS::Bytecode::Interpreter::OptimizationLevel::Default);
+            passes.perform(*executable);
+            if (s_opt_bytecode)
                 dbgln("Optimisation passes took {}us", passes.elapsed());
-            }
 
             if (JS::Bytecode::g_dump_bytecode)
                 executable->dump();
@@ -601,6 +618,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     TRY(Core::System::pledge("stdio rpath wpath cpath tty sigaction"));
 
     bool gc_on_every_allocation = false;
+    bool gc_statistics = false;
     bool disable_syntax_highlight = false;
     StringView evaluate_script;
     Vector<StringView> script_paths;
@@ -616,6 +634,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(s_strip_ansi, "Disable ANSI colors", "disable-ansi-colors", 'i');
     args_parser.add_option(s_disable_source_location_hints, "Disable source location hints", "disable-source-location-hints", 'h');
     args_parser.add_option(gc_on_every_allocation, "GC on every allocation", "gc-on-every-allocation", 'g');
+    args_parser.add_option(gc_statistics, "Print garbage collector statistics (pause histogram, surviving bytes) on exit", "gc-statistics", 0);
     args_parser.add_option(disable_syntax_highlight, "Disable live syntax highlighting", "no-syntax-highlight", 's');
     args_parser.add_option(evaluate_script, "Evaluate argument as a script", "evaluate", 'c', "script");
     args_parser.add_positional_argument(script_paths, "Path to script files", "scripts", Core::ArgsParser::Required::No);
@@ -623,6 +642,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     bool syntax_highlight = !disable_syntax_highlight;
 
+    // Function bodies are compiled lazily, so they have to know about -p as well.
+    JS::Bytecode::Interpreter::set_optimizations_enabled(s_opt_bytecode);
+
     g_vm = JS::VM::create();
     g_vm->enable_default_host_import_module_dynamically_hook();
 
@@ -858,6 +880,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         s_editor->on_tab_complete = move(complete);
         TRY(repl(*interpreter));
         s_editor->save_history(s_history_path);
+        if (gc_statistics)
+            print_gc_statistics(interpreter->heap());
     } else {
         interpreter = JS::Interpreter::create<ScriptObject>(*g_vm);
         auto& console_object = *interpreter->realm().intrinsics().console_object();
@@ -900,7 +924,10 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
         // We resolve modules as if it is the first file
 
-        if (!TRY(parse_and_run(*interpreter, builder.string_view(), source_name)))
+        auto succeeded = TRY(parse_and_run(*interpreter, builder.string_view(), source_name));
+        if (gc_statistics)
+            print_gc_statistics(interpreter->heap());
+        if (!succeeded)
             return 1;
     }
 